@@ -0,0 +1,88 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include "benchmark_report.h"
+
+// Compares two benchmark result files written by QueryBenchmark::export_json.
+// Exit status: 0 no regression, 1 significant regression, 2 usage or input error.
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "usage: " << argv[0] << " <baseline.json> <current.json> [--threshold 0.05]" << std::endl;
+        return 2;
+    }
+
+    double threshold = 0.05;
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--threshold" && i + 1 < argc) {
+            std::string value = argv[++i];
+            size_t parsed = 0;
+            try {
+                threshold = std::stod(value, &parsed);
+            } catch (const std::exception&) {
+                parsed = 0;
+            }
+            if (parsed != value.size() || !(threshold >= 0.0)) {
+                std::cerr << "invalid threshold: " << value << std::endl;
+                return 2;
+            }
+        } else {
+            std::cerr << "unknown argument: " << arg << std::endl;
+            return 2;
+        }
+    }
+
+    BenchmarkReport baseline;
+    BenchmarkReport current;
+    try {
+        baseline = BenchmarkReport::load(argv[1]);
+        current = BenchmarkReport::load(argv[2]);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+
+    std::cout << "Baseline: " << baseline.metadata.git_revision << " (" << baseline.metadata.timestamp << ")" << std::endl;
+    std::cout << "Current:  " << current.metadata.git_revision << " (" << current.metadata.timestamp << ")" << std::endl;
+    if (baseline.metadata.cpu_model != current.metadata.cpu_model ||
+        baseline.metadata.compiler != current.metadata.compiler) {
+        std::cout << "Warning: results come from different machines or compilers" << std::endl;
+    }
+    if (baseline.metadata.parameters != current.metadata.parameters) {
+        std::cout << "Warning: dataset or harness parameters differ" << std::endl;
+    }
+
+    std::cout << std::endl << std::left << std::setw(36) << "Benchmark"
+              << std::right << std::setw(14) << "Baseline ms"
+              << std::setw(14) << "Current ms"
+              << std::setw(10) << "Change"
+              << std::setw(8) << "t" << "  Verdict" << std::endl;
+    std::cout << std::string(92, '-') << std::endl;
+
+    size_t regressions = 0;
+    for (const auto& comparison : compare_reports(baseline, current, threshold)) {
+        std::string verdict = "unchanged";
+        if (comparison.missing) {
+            verdict = comparison.current_ms > 0.0 ? "new" : "removed";
+        } else if (comparison.regression) {
+            verdict = "REGRESSION";
+            ++regressions;
+        } else if (comparison.improvement) {
+            verdict = "improved";
+        } else if (comparison.significant) {
+            verdict = "within threshold";
+        }
+
+        std::cout << std::left << std::setw(36) << comparison.key.substr(0, 35)
+                  << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(14) << comparison.baseline_ms
+                  << std::setw(14) << comparison.current_ms
+                  << std::setprecision(1) << std::setw(9) << comparison.change * 100.0 << "%"
+                  << std::setprecision(2) << std::setw(8) << comparison.t_statistic
+                  << "  " << verdict << std::endl;
+    }
+
+    std::cout << std::endl << regressions << " significant regression(s) above "
+              << std::setprecision(1) << threshold * 100.0 << "%" << std::endl;
+    return regressions > 0 ? 1 : 0;
+}
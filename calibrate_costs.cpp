@@ -0,0 +1,36 @@
+#include <iostream>
+#include <string>
+#include "cost_calibration.h"
+
+// Fits the cost model's constants to this machine and writes a profile that
+// cost models load at startup (see CostConstants::active).
+// Exit status: 0 written, 1 calibration or write error, 2 usage error.
+int main(int argc, char* argv[]) {
+    std::string output = CostConstants::DEFAULT_PROFILE;
+    CalibrationOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--quick") {
+            options.sizes = {10000, 20000, 40000};
+        } else if (arg == "--repetitions" && i + 1 < argc) {
+            options.repetitions = std::stoul(argv[++i]);
+        } else if (!arg.empty() && arg[0] != '-') {
+            output = arg;
+        } else {
+            std::cerr << "usage: " << argv[0] << " [profile] [--quick] [--repetitions n]" << std::endl;
+            return 2;
+        }
+    }
+
+    try {
+        CostCalibrator calibrator(options);
+        CostConstants constants = calibrator.calibrate();
+        calibrator.print_report();
+        constants.save(output);
+        std::cout << "\nWrote " << output << ":\n" << constants.to_string();
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
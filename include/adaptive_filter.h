@@ -0,0 +1,46 @@
+#pragma once
+#include "expression_vm.h"
+#include <string>
+#include <vector>
+
+// Evaluates a conjunctive predicate one conjunct at a time, narrowing the
+// selection vector after each so later conjuncts only see surviving rows.
+// While running it samples each conjunct's selectivity and per-row cost and
+// periodically reorders them by rank = cost / (1 - selectivity), so cheap,
+// selective conjuncts run first regardless of their order in the query.
+class AdaptiveConjunctFilter {
+private:
+    static constexpr size_t REORDER_INTERVAL = 8;
+
+    struct Conjunct {
+        ExpressionProgram program;
+        std::string description;
+        double rows_in = 0;
+        double rows_out = 0;
+        double nanoseconds = 0;
+
+        double selectivity() const { return rows_in > 0 ? rows_out / rows_in : 1.0; }
+        double cost_per_row() const { return rows_in > 0 ? nanoseconds / rows_in : 0.0; }
+        double rank() const;
+    };
+
+    std::vector<Conjunct> conjuncts;
+    std::vector<size_t> order;
+    std::vector<uint32_t> scratch[2];
+    bool adaptive;
+    size_t batches = 0;
+    size_t reorders = 0;
+
+    void reorder();
+
+public:
+    // Throws if a conjunct cannot be compiled to bytecode.
+    AdaptiveConjunctFilter(const BoundExpression& root, bool adapt_order = true);
+
+    void evaluate_batch(ExpressionVM& vm, const Row* rows, size_t count, std::vector<uint32_t>& selection);
+
+    size_t conjunct_count() const { return conjuncts.size(); }
+    size_t get_reorder_count() const { return reorders; }
+    std::vector<size_t> get_order() const { return order; }
+    std::string describe() const;
+};
@@ -26,6 +26,8 @@ struct Expression {
     
     Expression(ExpressionType t) : type(t) {}
     virtual ~Expression() = default;
+    
+    virtual std::unique_ptr<Expression> clone() const = 0;
 };
 
 struct ColumnExpression : Expression {
@@ -34,6 +36,10 @@ struct ColumnExpression : Expression {
     
     ColumnExpression(const std::string& table, const std::string& column)
         : Expression(ExpressionType::COLUMN), table_name(table), column_name(column) {}
+    
+    std::unique_ptr<Expression> clone() const override {
+        return std::make_unique<ColumnExpression>(table_name, column_name);
+    }
 };
 
 struct LiteralExpression : Expression {
@@ -41,6 +47,10 @@ struct LiteralExpression : Expression {
     
     LiteralExpression(const std::string& val)
         : Expression(ExpressionType::LITERAL), value(val) {}
+    
+    std::unique_ptr<Expression> clone() const override {
+        return std::make_unique<LiteralExpression>(value);
+    }
 };
 
 struct BinaryOpExpression : Expression {
@@ -50,6 +60,10 @@ struct BinaryOpExpression : Expression {
     
     BinaryOpExpression(std::unique_ptr<Expression> l, std::unique_ptr<Expression> r, BinaryOperator operation)
         : Expression(ExpressionType::BINARY_OP), left(std::move(l)), right(std::move(r)), op(operation) {}
+    
+    std::unique_ptr<Expression> clone() const override {
+        return std::make_unique<BinaryOpExpression>(left->clone(), right->clone(), op);
+    }
 };
 
 struct SelectItem {
@@ -2,9 +2,67 @@
 #include "table.h"
 #include "optimizer.h"
 #include "executor.h"
+#include "perf_counters.h"
 #include <chrono>
+#include <cstdint>
 #include <vector>
 #include <string>
+#include <utility>
+
+struct BenchmarkOptions {
+    size_t warmup_runs = 2;     // untimed runs that fault in pages and warm caches
+    size_t repetitions = 10;
+    int pin_cpu = -1;           // pin the benchmarking thread to this CPU; -1 leaves it alone
+};
+
+// Distribution of repeated timings of one query.
+struct TimingStats {
+    size_t samples = 0;
+    double min_ms = 0.0;
+    double median_ms = 0.0;
+    double mean_ms = 0.0;
+    double p95_ms = 0.0;
+    double p99_ms = 0.0;
+    double max_ms = 0.0;
+    double stddev_ms = 0.0;
+    double ci_low_ms = 0.0;     // 95% confidence interval of the mean
+    double ci_high_ms = 0.0;
+    double rows_per_sec = 0.0;  // input rows scanned per second at the median
+    double bytes_per_sec = 0.0;
+
+    static TimingStats from_samples(std::vector<double> samples_ms);
+    void set_throughput(size_t input_rows, size_t input_bytes);
+    std::string to_string() const;
+};
+
+// Two-sided 95% Student-t critical value; 0 degrees of freedom gives 0.
+double student_t_critical_95(size_t degrees_of_freedom);
+
+// Pins the calling thread to one CPU. Returns false where unsupported.
+bool pin_current_thread(int cpu);
+
+// Heap use of one operator during a profiled run.
+struct OperatorMemory {
+    std::string label;          // QueryProfile::operator_label
+    size_t depth = 0;
+    uint64_t allocated_bytes = 0;   // excluding children
+    uint64_t allocations = 0;
+    size_t peak_bytes = 0;      // charged to the query's MemoryContext
+};
+
+// Memory footprint of one query, from a run after the timed ones. Allocator
+// counts stay zero unless src/alloc_counter.cpp is linked in.
+struct MemoryStats {
+    size_t peak_rss_bytes = 0;
+    bool rss_peak_reset = false;    // false: peak_rss_bytes is the process-lifetime peak
+    uint64_t allocated_bytes = 0;
+    uint64_t allocations = 0;
+    uint64_t peak_heap_bytes = 0;   // heap high-water mark above the pre-query heap
+    size_t context_peak_bytes = 0;  // MemoryContext accounting
+    std::vector<OperatorMemory> operators;
+
+    std::string to_string() const;
+};
 
 struct BenchmarkResult {
     std::string query_name;
@@ -12,15 +70,33 @@ struct BenchmarkResult {
     double execution_time_ms;
     double estimated_cost;
     size_t result_size;
+    PerfCounts counters;
+    TimingStats timing;
+    MemoryStats memory;
     
     BenchmarkResult(const std::string& name, const std::string& type, 
-                   double time, double cost, size_t size)
+                   double time, double cost, size_t size, const PerfCounts& perf = PerfCounts())
         : query_name(name), plan_type(type), execution_time_ms(time), 
-          estimated_cost(cost), result_size(size) {}
+          estimated_cost(cost), result_size(size), counters(perf) {}
+
+    BenchmarkResult(const std::string& name, const std::string& type,
+                   const TimingStats& stats, double cost, size_t size, const PerfCounts& perf = PerfCounts(),
+                   const MemoryStats& mem = MemoryStats())
+        : query_name(name), plan_type(type), execution_time_ms(stats.median_ms),
+          estimated_cost(cost), result_size(size), counters(perf), timing(stats), memory(mem) {}
 };
 
 class DataGenerator {
+private:
+    static uint64_t seed;
+
 public:
+    static constexpr uint64_t DEFAULT_SEED = 42;
+
+    // Every generator reseeds from this, so equal seeds give equal tables.
+    static void set_seed(uint64_t value) { seed = value; }
+    static uint64_t get_seed() { return seed; }
+
     static void generate_large_dataset(TableManager& tm, size_t users_count, size_t orders_count);
     static void generate_skewed_dataset(TableManager& tm, size_t users_count, size_t orders_count);
     static void generate_uniform_dataset(TableManager& tm, size_t users_count, size_t orders_count);
@@ -32,12 +108,31 @@ private:
     QueryOptimizer optimizer;
     Executor executor;
     std::vector<BenchmarkResult> results;
+    PerfCounters perf_counters;
+    PerfCounts last_counters;
+    size_t last_result_size = 0;
+    MemoryStats last_memory;
+    BenchmarkOptions options;
+    bool pinned = false;
+    std::vector<std::pair<std::string, std::string>> dataset_parameters;
     
-    double measure_execution_time(const PlanNode& plan);
+    // Runs the plan warmup_runs + repetitions times, then once more under
+    // EXPLAIN ANALYZE for memory. The result size, counters and memory are
+    // left in last_result_size/last_counters/last_memory.
+    TimingStats measure_execution_time(const PlanNode& plan);
+    MemoryStats measure_memory(const PlanNode& plan);
+    void scanned_input(const PlanNode& plan, size_t& rows, size_t& bytes) const;
     std::vector<SelectStatement> generate_test_queries();
     
 public:
-    QueryBenchmark(TableManager* tm);
+    QueryBenchmark(TableManager* tm, const BenchmarkOptions& opts = BenchmarkOptions());
+    
+    void set_options(const BenchmarkOptions& opts) { options = opts; }
+    const BenchmarkOptions& get_options() const { return options; }
+    const std::vector<BenchmarkResult>& get_results() const { return results; }
+    
+    // Recorded in exported metadata so result files can be told apart.
+    void set_dataset_parameter(const std::string& key, const std::string& value);
     
     void run_single_table_benchmarks();
     void run_join_benchmarks();
@@ -46,8 +141,12 @@ public:
     
     void compare_join_algorithms(const SelectStatement& stmt);
     void benchmark_data_distributions();
+    // Generates TPC-H tables at the scale factor and times the 22 query
+    // shapes, checking result checksums at the reference scale.
+    void run_tpch_benchmarks(double scale_factor);
     
     void print_results() const;
     void print_summary() const;
     void export_csv(const std::string& filename) const;
+    void export_json(const std::string& filename) const;
 };
\ No newline at end of file
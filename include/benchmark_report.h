@@ -0,0 +1,65 @@
+#pragma once
+#include "benchmark.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+// Where and how a set of benchmark results was produced.
+struct BenchmarkMetadata {
+    std::string git_revision;
+    std::string compiler;
+    std::string cpu_model;
+    std::string timestamp;      // UTC, ISO 8601
+    std::vector<std::pair<std::string, std::string>> parameters;
+
+    // Fills in everything but the parameters from the build and host.
+    static BenchmarkMetadata collect();
+    std::string get_parameter(const std::string& key) const;
+};
+
+struct BenchmarkEntry {
+    std::string query_name;
+    std::string plan_type;
+    double estimated_cost = 0.0;
+    size_t result_size = 0;
+    TimingStats timing;
+    MemoryStats memory;         // query totals only; operators are not exported
+
+    std::string key() const { return query_name + "/" + plan_type; }
+};
+
+struct BenchmarkComparison {
+    std::string key;
+    double baseline_ms = 0.0;   // medians
+    double current_ms = 0.0;
+    double change = 0.0;        // relative change of the median, +0.10 = 10% slower
+    double t_statistic = 0.0;   // Welch's t on the means
+    bool significant = false;
+    bool regression = false;
+    bool improvement = false;
+    bool missing = false;       // present in only one of the two reports
+};
+
+// Machine-readable benchmark results, saved and loaded as JSON.
+class BenchmarkReport {
+public:
+    static constexpr const char* FORMAT = "query-optimizer-benchmark/1";
+
+    BenchmarkMetadata metadata;
+    std::vector<BenchmarkEntry> entries;
+
+    void add_result(const BenchmarkResult& result);
+
+    std::string to_json() const;
+    static BenchmarkReport from_json(const std::string& text);
+
+    void save(const std::string& filename) const;
+    static BenchmarkReport load(const std::string& filename);
+};
+
+// Matches entries by key (repeated keys pair up in order). A change is a
+// regression when it is significant at 95% and the median is more than
+// min_change slower.
+std::vector<BenchmarkComparison> compare_reports(const BenchmarkReport& baseline,
+                                                 const BenchmarkReport& current,
+                                                 double min_change = 0.05);
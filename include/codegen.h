@@ -0,0 +1,78 @@
+#pragma once
+#include "expression_binder.h"
+#include "table.h"
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#ifndef QO_INCLUDE_DIR
+#define QO_INCLUDE_DIR "include"
+#endif
+
+struct CodegenOptions {
+    std::string compiler = "c++";
+    std::string compile_flags = "-std=c++17 -O2 -shared -fPIC";
+    std::string include_dir = QO_INCLUDE_DIR;
+    // Must be owned by this user and closed to everyone else; libraries are
+    // never loaded from a directory that is not.
+    std::string cache_dir = default_cache_dir();
+    // Pipelines over fewer input rows stay on the interpreter; compiling
+    // costs far more than it saves on short queries.
+    size_t min_input_rows = 100000;
+
+    // /tmp/qo_codegen-<uid>
+    static std::string default_cache_dir();
+};
+
+// Emits specialized C++ for a scan-filter-project pipeline, compiles it
+// into a shared object with the system compiler and loads it with dlopen.
+// Compiled pipelines are cached by a fingerprint of their source, both in
+// memory and as .so files under cache_dir; file names also carry a build id
+// covering the compiler, its flags and the headers in include_dir.
+class PipelineCompiler {
+public:
+    using PipelineFunction = void (*)(const Row* rows, size_t count, std::vector<Row>* out);
+
+private:
+    CodegenOptions options;
+    std::string build_id;
+    // Guards compiled, in_flight and handles only; compilation runs
+    // unlocked so cache hits on other threads never wait for the compiler.
+    std::mutex cache_mutex;
+    std::unordered_map<std::string, PipelineFunction> compiled;
+    std::unordered_set<std::string> in_flight;
+    std::vector<void*> handles;
+    std::atomic<size_t> cache_hits{0};
+    std::atomic<size_t> compilations{0};
+    std::atomic<size_t> failures{0};
+
+    std::string emit_value(const BoundExpression& expr, const TableSchema& schema) const;
+    std::string emit_predicate(const BoundExpression& expr, const TableSchema& schema) const;
+    PipelineFunction load(const std::string& library_path);
+    PipelineFunction build(const std::string& key, const std::string& source);
+
+public:
+    explicit PipelineCompiler(const CodegenOptions& codegen_options = CodegenOptions());
+    ~PipelineCompiler();
+    PipelineCompiler(const PipelineCompiler&) = delete;
+    PipelineCompiler& operator=(const PipelineCompiler&) = delete;
+
+    const CodegenOptions& get_options() const { return options; }
+    const std::string& get_build_id() const { return build_id; }
+
+    std::string generate_source(const BoundPredicate* predicate, const TableSchema& schema,
+                                const std::vector<size_t>* projection) const;
+
+    // Returns nullptr when the pipeline cannot be compiled, or is being
+    // compiled by another thread; callers then fall back to the interpreter.
+    PipelineFunction compile(const std::string& source);
+
+    static std::string fingerprint(const std::string& source);
+
+    size_t get_cache_hits() const { return cache_hits; }
+    size_t get_compilations() const { return compilations; }
+    size_t get_failures() const { return failures; }
+};
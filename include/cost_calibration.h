@@ -0,0 +1,48 @@
+#pragma once
+#include "cost_constants.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct CalibrationOptions {
+    std::vector<size_t> sizes = {20000, 40000, 80000, 160000};
+    size_t repetitions = 3;     // the fastest run of each size is used
+    uint64_t seed = 42;
+};
+
+// One regression of measured milliseconds against a unit of work.
+struct CalibrationFit {
+    std::string constant;
+    double value = 0.0;         // ms per unit; memory_sort_cost is a multiplier
+    double r_squared = 0.0;
+    size_t points = 0;
+};
+
+// Least-squares coefficients for targets ~ features. Throws
+// std::runtime_error when the features are linearly dependent.
+std::vector<double> fit_least_squares(const std::vector<std::vector<double>>& features,
+                                      const std::vector<double>& targets);
+
+// Times the executor's building blocks on synthetic tables (row copies in
+// page order and in random page order, predicate batches, hash table
+// inserts and lookups, row sorts) and fits CostConstants to the timings.
+// The resulting costs are in milliseconds on this machine.
+class CostCalibrator {
+private:
+    static constexpr size_t PAGE_BYTES = 4096;
+
+    CalibrationOptions options;
+    std::vector<CalibrationFit> fits;
+
+    template <typename Fn>
+    double time_ms(Fn&& fn) const;
+    void record(const std::string& constant, double value, const std::vector<double>& predicted,
+                const std::vector<double>& measured);
+
+public:
+    CostCalibrator(const CalibrationOptions& opts = CalibrationOptions());
+
+    CostConstants calibrate();
+    const std::vector<CalibrationFit>& get_fits() const { return fits; }
+    void print_report() const;
+};
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Cost of each unit of work. The defaults are hand-picked; a profile from
+// CostCalibrator replaces them with milliseconds measured on the host, so
+// that estimated costs read as expected runtimes.
+struct CostConstants {
+    static constexpr const char* PROFILE_ENV = "QO_COST_PROFILE";
+    static constexpr const char* DEFAULT_PROFILE = "cost_profile.conf";
+
+    double sequential_io_cost = 1.0;    // per page read in order
+    double random_io_cost = 4.0;        // per page read out of order
+    double cpu_tuple_cost = 0.01;       // per tuple produced by a scan
+    double cpu_operator_cost = 0.0025;  // per predicate evaluation or key comparison
+    double memory_sort_cost = 2.0;      // multiplies cpu_operator_cost per n log2 n sort step
+    double hash_build_cost = 1.0;       // per tuple inserted into a hash table
+    double hash_probe_cost = 0.5;       // per hash table lookup
+    std::string source = "built-in defaults";
+
+    // Formulas shared by CostModel and PlanNode::estimate_cost.
+    double scan_cost(size_t pages, size_t tuples) const;
+    double filter_cost(size_t tuples) const;
+    double nested_loop_io_cost(size_t outer_tuples, size_t inner_pages) const;
+    double nested_loop_cpu_cost(size_t outer_tuples, size_t inner_tuples) const;
+    double hash_join_cost(size_t build_tuples, size_t probe_tuples, size_t build_pages) const;
+    double sort_cost(size_t tuples) const;
+    double sort_merge_cost(size_t left_tuples, size_t right_tuples) const;
+
+    // Constants used by newly created cost models: the profile named by
+    // $QO_COST_PROFILE, else ./cost_profile.conf when it exists, else the
+    // defaults. Read on first use; a broken profile is reported on stderr
+    // and ignored.
+    static const CostConstants& active();
+    static void set_active(const CostConstants& constants);
+
+    // "name = value" lines; # starts a comment. Throws std::runtime_error
+    // on unreadable files, unknown names and malformed values.
+    static CostConstants load(const std::string& filename);
+    void save(const std::string& filename) const;
+    std::string to_string() const;
+};
@@ -1,16 +1,19 @@
 #pragma once
 #include "query_plan.h"
+#include "cost_constants.h"
 #include <unordered_map>
 #include <cmath>
 
-struct CostConstants {
-    static constexpr double SEQUENTIAL_IO_COST = 1.0;
-    static constexpr double RANDOM_IO_COST = 4.0;
-    static constexpr double CPU_TUPLE_COST = 0.01;
-    static constexpr double CPU_OPERATOR_COST = 0.0025;
-    static constexpr double MEMORY_SORT_COST = 2.0;
-    static constexpr double HASH_BUILD_COST = 1.0;
-    static constexpr double HASH_PROBE_COST = 0.5;
+class FeedbackCache;
+class Table;
+
+// Calls into a CostModel since its last reset_stats().
+struct CostModelStats {
+    size_t cost_estimates = 0;          // estimate_plan_cost, children included
+    size_t cardinality_estimates = 0;   // estimate_output_cardinality, children included
+    size_t feedback_hits = 0;
+    size_t feedback_misses = 0;
+    double elapsed_ms = 0.0;            // outermost calls only
 };
 
 struct TableStatistics {
@@ -29,25 +32,38 @@ struct TableStatistics {
     }
 };
 
+// Row count, pages and width measured from the table's rows, with the
+// distinct count of every column. Scans the whole table under its read lock.
+TableStatistics measure_table_statistics(const Table& table);
+
 class CostModel {
 private:
     std::unordered_map<std::string, TableStatistics> table_stats;
+    const FeedbackCache* feedback = nullptr;
+    CostConstants constants;
+    CostModelStats stats;
+    size_t call_depth = 0;
     
-    double estimate_scan_cost(const TableStatistics& stats);
-    double estimate_filter_cost(size_t input_tuples, double selectivity);
-    double estimate_nested_loop_cost(size_t left_tuples, size_t right_tuples, size_t right_pages);
-    double estimate_hash_join_cost(size_t build_tuples, size_t probe_tuples, size_t build_pages);
-    double estimate_sort_merge_cost(size_t left_tuples, size_t right_tuples);
-    double estimate_sort_cost(size_t tuple_count);
-    
-    double log2_safe(double x) {
-        return (x <= 1.0) ? 0.0 : std::log2(x);
-    }
+    class CallTimer;
+    bool lookup_feedback(const PlanNode& node, double& selectivity);
+    bool equality_selectivity(const FilterNode& node, double& selectivity) const;
+    bool equi_join_selectivity(const std::string& condition, double& selectivity) const;
+    size_t estimate_memory(const PlanNode& node, size_t& row_width, size_t& peak_bytes);
+    size_t scan_row_width(const TableScanNode& node) const;
     
 public:
     CostModel();
     
     void set_table_statistics(const std::string& table_name, const TableStatistics& stats);
+    void remove_table_statistics(const std::string& table_name) { table_stats.erase(table_name); }
+    bool has_table_statistics(const std::string& table_name) const { return table_stats.count(table_name) > 0; }
+    
+    // Starts out as CostConstants::active().
+    void set_cost_constants(const CostConstants& values) { constants = values; }
+    const CostConstants& get_cost_constants() const { return constants; }
+    
+    // Learned selectivities take precedence over the built-in guesses. Not owned.
+    void set_feedback_cache(const FeedbackCache* cache) { feedback = cache; }
     CostEstimate estimate_plan_cost(const PlanNode& node);
     
     CostEstimate estimate_table_scan_cost(const TableScanNode& node);
@@ -57,4 +73,10 @@ public:
     
     double estimate_join_selectivity(const std::string& condition);
     size_t estimate_output_cardinality(const PlanNode& node);
+    // Peak bytes of intermediate results and hash tables held at once while
+    // executing the plan, from the annotated row counts and tuple widths.
+    size_t estimate_memory_bytes(const PlanNode& node);
+    
+    const CostModelStats& get_stats() const { return stats; }
+    void reset_stats() { stats = CostModelStats(); }
 };
\ No newline at end of file
@@ -1,20 +1,90 @@
 #pragma once
 #include "query_plan.h"
 #include "table.h"
+#include "memory_context.h"
+#include "adaptive_filter.h"
+#include "feedback_cache.h"
+#include "explain.h"
 #include <vector>
 #include <memory>
 #include <iostream>
+#include <chrono>
+#include <stdexcept>
+#include <string>
 
 class ResultSet {
 private:
+    static constexpr size_t MEMORY_FLUSH_BYTES = 64 * 1024;
+    
     TableSchema schema;
     std::vector<Row> rows;
+    StringHeap strings;
+    MemoryContext* memory;
+    const PlanNode* owner;
+    size_t charged_bytes = 0;
+    size_t pending_bytes = 0;
     
 public:
-    ResultSet(const TableSchema& result_schema) : schema(result_schema) {}
+    ResultSet(const TableSchema& result_schema, MemoryContext* memory_context = nullptr,
+              const PlanNode* owner_node = nullptr)
+        : schema(result_schema), memory(memory_context), owner(owner_node) {}
+    
+    ResultSet(const ResultSet&) = delete;
+    ResultSet& operator=(const ResultSet&) = delete;
+    
+    ~ResultSet() {
+        detach_memory();
+    }
+    
+    void add_row(Row&& row) {
+        size_t width = row.size();
+        rows.push_back(std::move(row));
+        if (memory) {
+            pending_bytes += sizeof(Row) + width * sizeof(Value);
+            if (pending_bytes >= MEMORY_FLUSH_BYTES) {
+                flush_memory();
+            }
+        }
+    }
     
     void add_row(const Row& row) {
         rows.push_back(row);
+        if (memory) {
+            pending_bytes += sizeof(Row) + row.size() * sizeof(Value);
+            if (pending_bytes >= MEMORY_FLUSH_BYTES) {
+                flush_memory();
+            }
+        }
+    }
+    
+    // For operators that produce strings not backed by a base table,
+    // e.g. rows read back from a spill file.
+    Value make_string(std::string_view text) {
+        if (memory) {
+            pending_bytes += text.size();
+        }
+        return Value::string_ref(strings.store(text));
+    }
+    
+    void flush_memory() {
+        if (memory && pending_bytes > 0) {
+            memory->charge(owner, pending_bytes);
+            charged_bytes += pending_bytes;
+            pending_bytes = 0;
+        }
+    }
+    
+    void detach_memory() {
+        if (memory && charged_bytes > 0) {
+            memory->release(owner, charged_bytes);
+        }
+        memory = nullptr;
+        charged_bytes = 0;
+        pending_bytes = 0;
+    }
+    
+    size_t memory_bytes() const {
+        return charged_bytes + pending_bytes;
     }
     
     const std::vector<Row>& get_rows() const {
@@ -41,15 +111,7 @@ public:
         for (size_t i = 0; i < std::min(rows.size(), limit); ++i) {
             const auto& row = rows[i];
             for (size_t j = 0; j < row.size() && j < schema.column_names.size(); ++j) {
-                try {
-                    if (schema.column_types[j] == "int") {
-                        std::cout << row.get<int>(j);
-                    } else {
-                        std::cout << row.get<std::string>(j);
-                    }
-                } catch (...) {
-                    std::cout << "NULL";
-                }
+                std::cout << row.get(j).to_string();
                 if (j < row.size() - 1) std::cout << "\t";
             }
             std::cout << std::endl;
@@ -61,22 +123,153 @@ public:
     }
 };
 
+class PipelineCompiler;
+
+class QueryTimeout : public std::runtime_error {
+public:
+    explicit QueryTimeout(double timeout_ms)
+        : std::runtime_error("Query exceeded its " + std::to_string(timeout_ms) + "ms timeout") {}
+};
+
+enum class JoinStrategy {
+    INDEX_PROBE,
+    HASH,
+    GRACE_HASH
+};
+
+// Runtime algorithm choice made by an adaptive join.
+struct JoinDecision {
+    const PlanNode* node = nullptr;
+    JoinStrategy strategy = JoinStrategy::HASH;
+    size_t estimated_build_rows = 0;
+    size_t actual_build_rows = 0;
+    size_t partitions = 0;
+    size_t spilled_bytes = 0;
+    std::string reason;
+    
+    std::string to_string() const;
+};
+
 class Executor {
 private:
+    static constexpr size_t PIPELINE_BATCH_SIZE = 1024;
+    static constexpr size_t INDEX_PROBE_BUILD_ROWS = 64;
+    static constexpr size_t DEFAULT_JOIN_MEMORY_BUDGET = 256 * 1024 * 1024;
+    static constexpr size_t DEADLINE_CHECK_MASK = 4095;
+    
     TableManager* table_manager;
+    MemoryContext memory;
+    MemoryUsage last_memory_usage;
+    ExpressionVM vm;
+    bool pipeline_fusion = true;
+    bool adaptive_filters = true;
+    PipelineCompiler* pipeline_compiler = nullptr;
+    size_t join_memory_budget = 0;
+    std::vector<JoinDecision> join_decisions;
+    std::unordered_map<const PlanNode*, size_t> actual_rows;
+    FeedbackCache* feedback = nullptr;
+    double timeout_ms = 0.0;
+    bool has_deadline = false;
+    std::chrono::steady_clock::time_point deadline;
+    
+    // Row loops call the counted form so the clock is read once per
+    // DEADLINE_CHECK_MASK + 1 rows.
+    void check_deadline() const {
+        if (has_deadline && std::chrono::steady_clock::now() >= deadline) {
+            throw QueryTimeout(timeout_ms);
+        }
+    }
+    void check_deadline(size_t row) const {
+        if ((row & DEADLINE_CHECK_MASK) == 0) {
+            check_deadline();
+        }
+    }
+    
+    struct OperatorTiming {
+        double wall_ms = 0.0;
+        double cpu_ms = 0.0;
+        PerfCounts counters;
+        AllocationStats allocations;    // deltas over the operator
+    };
+    bool profiling = false;
+    bool hardware_counters = true;
+    std::unique_ptr<PerfCounters> perf_counters;
+    std::unordered_map<const PlanNode*, OperatorTiming> timings;
     
+    std::unique_ptr<ResultSet> execute_node(const PlanNode& node);
+    std::unique_ptr<ResultSet> execute_operator(const PlanNode& node);
+    void fill_profile(const PlanNode& node, std::unordered_map<const PlanNode*, OperatorProfile>& profiles) const;
     std::unique_ptr<ResultSet> execute_table_scan(const TableScanNode& node);
     std::unique_ptr<ResultSet> execute_filter(const FilterNode& node);
     std::unique_ptr<ResultSet> execute_project(const ProjectNode& node);
     std::unique_ptr<ResultSet> execute_nested_loop_join(const NestedLoopJoinNode& node);
     std::unique_ptr<ResultSet> execute_hash_join(const HashJoinNode& node);
     std::unique_ptr<ResultSet> execute_sort_merge_join(const SortMergeJoinNode& node);
+    std::unique_ptr<ResultSet> execute_adaptive_join(const AdaptiveJoinNode& node);
+    void execute_grace_hash_join(const AdaptiveJoinNode& node, std::unique_ptr<ResultSet> build,
+                                 std::unique_ptr<ResultSet> probe, size_t build_key, size_t probe_key,
+                                 ResultSet& result, JoinDecision& decision);
     
-    bool evaluate_condition(const Row& row, const TableSchema& schema, const std::string& condition);
-    std::vector<std::string> parse_projections(const std::vector<std::string>& projections);
+    // Returns false, leaving the historical (0, 1) positions, unless the
+    // condition is an equality between one column from each side.
+    bool resolve_join_keys(const JoinNode& node, const TableSchema& left_schema, const TableSchema& right_schema,
+                           size_t& left_key, size_t& right_key) const;
+    // The table's schema with its columns qualified by the scan's alias or name.
+    TableSchema scan_schema(const TableScanNode& node, const Table& table) const;
+    TableSchema join_schema(const TableSchema& left_schema, const TableSchema& right_schema) const;
+    size_t effective_join_budget() const;
+    
+    std::unique_ptr<ResultSet> execute_scan_pipeline(const PlanNode& root);
+    
+    std::unique_ptr<BoundPredicate> bind_filter(const FilterNode& node, const TableSchema& schema);
+    std::unique_ptr<AdaptiveConjunctFilter> compile_predicate(const BoundPredicate& predicate);
+    void filter_batch(const BoundPredicate& predicate, AdaptiveConjunctFilter* program,
+                      const Row* rows, size_t count, std::vector<uint32_t>& selection);
+    bool resolve_projection(const ProjectNode& node, const TableSchema& input_schema,
+                            TableSchema& output_schema, std::vector<size_t>& column_indices);
     
 public:
     Executor(TableManager* tm) : table_manager(tm) {}
     
     std::unique_ptr<ResultSet> execute(const PlanNode& node);
+    
+    // EXPLAIN ANALYZE: runs the plan with per-operator instrumentation.
+    QueryProfile explain_analyze(const PlanNode& node);
+    
+    // Collect cycles, instructions, cache and branch misses per operator
+    // during EXPLAIN ANALYZE where the platform allows it.
+    void set_hardware_counters(bool enabled) { hardware_counters = enabled; }
+    
+    // 0 disables the limit. Exceeding it aborts the query with MemoryLimitExceeded.
+    void set_memory_limit(size_t bytes) { memory.set_limit(bytes); }
+    size_t get_memory_limit() const { return memory.limit(); }
+    const MemoryUsage& get_last_memory_usage() const { return last_memory_usage; }
+    
+    // Wall-clock limit per execute() call; 0 disables it. Exceeding it aborts
+    // the query with QueryTimeout.
+    void set_timeout(double ms) { timeout_ms = ms; }
+    double get_timeout() const { return timeout_ms; }
+    
+    // Runs Project/Filter/TableScan chains as a single batched loop.
+    void set_pipeline_fusion(bool enabled) { pipeline_fusion = enabled; }
+    
+    // Reorders AND-ed conjuncts at run time by observed selectivity and cost.
+    // When disabled, conjuncts run in the order they were written.
+    void set_adaptive_filters(bool enabled) { adaptive_filters = enabled; }
+    
+    // Build-side bytes above which adaptive joins spill to a Grace hash join.
+    // 0 uses half the memory limit, or 256MB when no limit is set.
+    void set_join_memory_budget(size_t bytes) { join_memory_budget = bytes; }
+    const std::vector<JoinDecision>& get_last_join_decisions() const { return join_decisions; }
+    
+    // Output row count of every operator in the last query. Operators fused
+    // into a pipeline are included.
+    const std::unordered_map<const PlanNode*, size_t>& get_last_cardinalities() const { return actual_rows; }
+    
+    // Completed queries report their true cardinalities here. Not owned.
+    void set_feedback_cache(FeedbackCache* cache) { feedback = cache; }
+    
+    // Optional native code backend for fused pipelines over large tables.
+    // Not owned; may be shared between executors.
+    void set_pipeline_compiler(PipelineCompiler* compiler) { pipeline_compiler = compiler; }
 };
\ No newline at end of file
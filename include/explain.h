@@ -0,0 +1,60 @@
+#pragma once
+#include "query_plan.h"
+#include "perf_counters.h"
+#include "optimizer_stats.h"
+#include <string>
+#include <unordered_map>
+
+struct OperatorProfile {
+    double wall_ms = 0.0;       // inclusive of children
+    double self_ms = 0.0;
+    double cpu_ms = 0.0;        // inclusive of children
+    size_t rows_in = 0;
+    size_t rows_out = 0;
+    size_t estimated_rows = 0;
+    size_t peak_bytes = 0;
+    size_t spill_bytes = 0;
+    bool fused = false;         // ran inside its parent's pipeline; timed there
+    PerfCounts counters;        // inclusive of children; empty if unavailable
+    uint64_t allocated_bytes = 0;   // heap bytes allocated, inclusive of children;
+    uint64_t allocations = 0;       // zero unless AllocationCounter is installed
+
+    double q_error() const;
+};
+
+// Result of EXPLAIN ANALYZE: the executed plan annotated per operator.
+class QueryProfile {
+private:
+    const PlanNode* root = nullptr;
+    std::unordered_map<const PlanNode*, OperatorProfile> operators;
+    size_t result_rows = 0;
+    double total_ms = 0.0;
+    size_t peak_bytes = 0;
+    std::string counters_unavailable;
+    bool has_optimizer_stats = false;
+    OptimizerStats optimizer_stats;
+
+    void text_node(const PlanNode& node, int indent, std::string& out) const;
+    void json_node(const PlanNode& node, int indent, std::string& out) const;
+
+public:
+    QueryProfile() = default;
+    QueryProfile(const PlanNode* plan, std::unordered_map<const PlanNode*, OperatorProfile> profiles,
+                 size_t rows, double elapsed_ms, size_t query_peak_bytes,
+                 const std::string& counters_unavailable_reason = "");
+
+    // Header line of a plan node without its children.
+    static std::string operator_label(const PlanNode& node);
+
+    const OperatorProfile* get(const PlanNode& node) const;
+    size_t get_result_rows() const { return result_rows; }
+    double get_total_ms() const { return total_ms; }
+
+    // The executor does not see the optimizer; callers attach its work here
+    // (QueryOptimizer::get_stats) to have it reported with the plan.
+    void set_optimizer_stats(const OptimizerStats& stats);
+    const OptimizerStats* get_optimizer_stats() const { return has_optimizer_stats ? &optimizer_stats : nullptr; }
+
+    std::string to_text() const;
+    std::string to_json() const;
+};
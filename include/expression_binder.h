@@ -0,0 +1,60 @@
+#pragma once
+#include "ast.h"
+#include "table.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+enum class BoundExpressionKind {
+    COLUMN,
+    CONSTANT,
+    COMPARISON,
+    AND,
+    OR
+};
+
+// Expression with column names resolved to row positions and literals
+// converted to typed Values.
+struct BoundExpression {
+    BoundExpressionKind kind;
+    size_t column_index = 0;
+    Value constant;
+    BinaryOperator op = BinaryOperator::EQUALS;
+    std::unique_ptr<BoundExpression> left;
+    std::unique_ptr<BoundExpression> right;
+
+    BoundExpression(BoundExpressionKind k) : kind(k) {}
+};
+
+class BoundPredicate {
+private:
+    StringHeap constants;
+    std::unique_ptr<BoundExpression> root;
+
+    std::unique_ptr<BoundExpression> bind(const Expression& expr, const TableSchema& schema,
+                                          const std::string& type_hint);
+    Value bind_literal(const std::string& text, const std::string& type_hint);
+    std::string column_type(const Expression& expr, const TableSchema& schema) const;
+
+    static bool evaluate(const BoundExpression& expr, const Row& row);
+    static Value evaluate_value(const BoundExpression& expr, const Row& row);
+
+public:
+    BoundPredicate(const Expression& expr, const TableSchema& schema);
+    BoundPredicate(const BoundPredicate&) = delete;
+    BoundPredicate& operator=(const BoundPredicate&) = delete;
+
+    const BoundExpression& get_root() const { return *root; }
+
+    bool evaluate(const Row& row) const {
+        return evaluate(*root, row);
+    }
+
+    // Appends the positions of qualifying rows in [0, count) to selection.
+    void evaluate_batch(const Row* rows, size_t count, std::vector<uint32_t>& selection) const;
+
+    static std::unique_ptr<Expression> parse_condition(const std::string& condition);
+    // Throws when the column is missing or an unqualified name is ambiguous.
+    static size_t resolve_column(const std::string& name, const TableSchema& schema);
+    static size_t resolve_column(const ColumnExpression& column, const TableSchema& schema);
+};
@@ -0,0 +1,67 @@
+#pragma once
+#include "expression_binder.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class OpCode : uint8_t {
+    LOAD_COLUMN,     // vreg[dst] <- column `operand` of every active row
+    CONST_BOOL,      // breg[dst] <- operand != 0
+    COMPARE,         // breg[dst] <- vreg[left] <cmp> vreg[right]
+    COMPARE_CONST,   // breg[dst] <- vreg[left] <cmp> constants[operand]
+    AND,             // breg[dst] <- breg[left] && breg[right]
+    OR,              // breg[dst] <- breg[left] || breg[right]
+    TRUTH            // breg[dst] <- vreg[left] as bool
+};
+
+struct Instruction {
+    OpCode opcode;
+    BinaryOperator comparison;
+    uint16_t dst;
+    uint16_t left;
+    uint16_t right;
+    uint32_t operand;
+};
+
+// Register bytecode for a bound predicate. Value registers hold one Value
+// per active row, boolean registers one byte per active row. Compilation
+// folds constant subtrees and shares common subexpressions.
+class ExpressionProgram {
+private:
+    std::vector<Instruction> code;
+    std::vector<Value> constants;
+    StringHeap constant_strings;
+    uint16_t value_registers = 0;
+    uint16_t bool_registers = 0;
+    uint16_t result_register = 0;
+    size_t folded_constants = 0;
+    size_t shared_subexpressions = 0;
+
+    friend class ExpressionCompiler;
+    friend class ExpressionVM;
+
+public:
+    static ExpressionProgram compile(const BoundExpression& expr);
+
+    size_t instruction_count() const { return code.size(); }
+    size_t get_folded_constants() const { return folded_constants; }
+    size_t get_shared_subexpressions() const { return shared_subexpressions; }
+    std::string disassemble() const;
+};
+
+// Executes an ExpressionProgram a batch at a time. Register storage is
+// reused across batches; one VM must not be shared between threads.
+class ExpressionVM {
+private:
+    std::vector<std::vector<Value>> value_regs;
+    std::vector<std::vector<uint8_t>> bool_regs;
+
+    void prepare(const ExpressionProgram& program, size_t count);
+
+public:
+    // Evaluates the program over rows[selection[i]] for i < count (or over
+    // rows[0..count) when selection is null) and appends the row positions
+    // that satisfy it to output.
+    void run(const ExpressionProgram& program, const Row* rows, const uint32_t* selection, size_t count,
+             std::vector<uint32_t>& output);
+};
@@ -0,0 +1,47 @@
+#pragma once
+#include "query_plan.h"
+#include <list>
+#include <string>
+#include <unordered_map>
+
+struct CardinalityFeedback {
+    std::string signature;
+    double selectivity = 1.0;
+    size_t observations = 0;
+    size_t last_estimated_rows = 0;
+    size_t last_actual_rows = 0;
+};
+
+// Learns filter and join selectivities from executed plans, keyed by the
+// signature of the predicate and the base tables beneath it. The cost
+// model consults it before falling back to its built-in guesses.
+// Signatures include literals, so the cache keeps at most capacity entries
+// and evicts the one observed least recently.
+class FeedbackCache {
+private:
+    static constexpr double SMOOTHING = 0.5;
+
+    size_t capacity = 1024;
+    std::list<CardinalityFeedback> lru;
+    std::unordered_map<std::string, std::list<CardinalityFeedback>::iterator> entries;
+
+    void observe(const PlanNode& node, size_t actual_rows, double input_rows);
+
+public:
+    // Filter and join nodes only; other nodes have an empty signature.
+    static std::string signature(const PlanNode& node);
+
+    // Records actual/input selectivity for every filter and join in plan
+    // whose own and input cardinalities were all observed.
+    void record_execution(const PlanNode& plan, const std::unordered_map<const PlanNode*, size_t>& actual_rows);
+
+    bool lookup(const PlanNode& node, double& selectivity) const;
+
+    void set_capacity(size_t max_entries);
+    size_t size() const { return entries.size(); }
+    void clear() {
+        entries.clear();
+        lru.clear();
+    }
+    std::string describe() const;
+};
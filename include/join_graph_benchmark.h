@@ -0,0 +1,66 @@
+#pragma once
+#include "benchmark.h"
+#include "benchmark_report.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+enum class JoinGraphShape {
+    CHAIN,
+    STAR,
+    SNOWFLAKE,
+    CYCLE,
+    CLIQUE
+};
+
+struct JoinGraphResult {
+    JoinGraphShape shape;
+    size_t relations = 0;
+    size_t edges = 0;
+    double optimize_ms = 0.0;
+    size_t plans_costed = 0;
+    OptimizerStats optimizer;     // phase timings and cost model calls
+    double chosen_cost = 0.0;
+    bool executed = false;
+    TimingStats execution;
+    size_t result_rows = 0;
+    std::string error;
+};
+
+struct JoinGraphOptions {
+    size_t rows_per_table = 1000;
+    size_t execute_max_relations = 20;   // larger queries are only optimized
+    BenchmarkOptions timing;
+};
+
+// Synthesizes relations jg0..jgN-1 and queries whose join graphs have a
+// given shape. Relation i has a key column jgI_id and, for every edge to a
+// later relation j, a foreign key jgI_refJ drawn from jgJ's keys. Queries
+// join along a spanning tree in breadth-first order from jg0; the remaining
+// edges (cycles, cliques) become WHERE conjuncts.
+class JoinGraphBenchmark {
+private:
+    TableManager* table_manager;
+    JoinGraphOptions options;
+    QueryOptimizer optimizer;
+    Executor executor;
+    std::vector<JoinGraphResult> results;
+    size_t created_tables = 0;
+
+    void create_tables(JoinGraphShape shape, size_t relations);
+
+public:
+    JoinGraphBenchmark(TableManager* tm, const JoinGraphOptions& opts = JoinGraphOptions());
+
+    static const char* shape_name(JoinGraphShape shape);
+    // Undirected edges (i < j) of the join graph.
+    static std::vector<std::pair<size_t, size_t>> edges(JoinGraphShape shape, size_t relations);
+    static SelectStatement build_query(JoinGraphShape shape, size_t relations);
+
+    JoinGraphResult run(JoinGraphShape shape, size_t relations);
+    void run_all(size_t min_relations = 2, size_t max_relations = 20);
+
+    const std::vector<JoinGraphResult>& get_results() const { return results; }
+    void print_results() const;
+    BenchmarkReport report() const;
+};
@@ -0,0 +1,37 @@
+#pragma once
+#include "table.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Bytes one row costs in a given representation.
+struct LayoutFootprint {
+    std::string layout;
+    size_t rows = 0;
+    size_t columns = 0;
+    uint64_t bytes = 0;         // heap bytes retained, or file bytes for spill files
+    uint64_t allocations = 0;
+    double payload_bytes_per_row = 0.0;   // 8 per integer plus string lengths
+
+    double bytes_per_row() const { return rows > 0 ? static_cast<double>(bytes) / rows : 0.0; }
+    double overhead() const { return payload_bytes_per_row > 0.0 ? bytes_per_row() / payload_bytes_per_row : 0.0; }
+};
+
+// Measures the representations a users-like row (id, name, age, city) and
+// a joined users/orders row pass through: base tables, intermediate
+// results, join output, hash join build tables, spill files, and for
+// reference the std::any rows the engine used before Value. Heap figures
+// need AllocationCounter, i.e. src/alloc_counter.cpp linked in.
+class MemoryBenchmark {
+private:
+    size_t row_count;
+    uint64_t seed;
+    std::vector<LayoutFootprint> results;
+
+public:
+    explicit MemoryBenchmark(size_t rows = 100000, uint64_t generator_seed = 42);
+
+    const std::vector<LayoutFootprint>& run();
+    const std::vector<LayoutFootprint>& get_results() const { return results; }
+    void print_results() const;
+};
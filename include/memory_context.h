@@ -0,0 +1,132 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "value.h"
+
+class PlanNode;
+struct Row;
+
+// Bytes per build row of an in-memory hash table: the key, its bucket
+// vector and node overhead. Used both to charge joins and to estimate them.
+constexpr size_t HASH_ENTRY_BYTES = sizeof(Value) + sizeof(std::vector<const Row*>) + 4 * sizeof(void*);
+
+class MemoryLimitExceeded : public std::runtime_error {
+public:
+    MemoryLimitExceeded(size_t requested, size_t in_use, size_t limit)
+        : std::runtime_error("Query memory limit exceeded: requested " + std::to_string(requested) +
+                             " bytes with " + std::to_string(in_use) + " in use (limit " +
+                             std::to_string(limit) + " bytes)") {}
+};
+
+// Process-wide heap counters kept by the counting operator new/delete in
+// src/alloc_counter.cpp. Link that file into a program to enable them;
+// without it installed() is false and every count reads zero.
+struct AllocationStats {
+    uint64_t allocations = 0;
+    uint64_t frees = 0;
+    uint64_t bytes_allocated = 0;
+    uint64_t bytes_freed = 0;
+    uint64_t current_bytes = 0;
+    uint64_t peak_bytes = 0;    // high-water mark of current_bytes since reset_peak()
+};
+
+class AllocationCounter {
+public:
+    static bool installed();
+    static AllocationStats read();
+    // Restarts the high-water mark at the current heap size.
+    static void reset_peak();
+};
+
+// Resident set size from /proc/self/status; 0 where unavailable.
+size_t current_rss_bytes();
+size_t peak_rss_bytes();
+// Restarts the peak RSS at the current RSS (Linux clear_refs). Returns
+// false when the kernel does not allow it, leaving the process-lifetime peak.
+bool reset_peak_rss();
+
+struct MemoryUsage {
+    size_t peak_bytes = 0;
+    size_t arena_bytes = 0;
+    std::unordered_map<const PlanNode*, size_t> operator_peak_bytes;
+};
+
+// Per-query memory context: a bump arena for operator state plus byte
+// accounting per operator. Everything is released in bulk by reset().
+// Not thread-safe; each executing query owns its own context.
+class MemoryContext {
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size;
+        size_t used;
+    };
+
+    struct OperatorMemory {
+        size_t current = 0;
+        size_t peak = 0;
+    };
+
+    std::vector<Block> blocks;
+    size_t block_size;
+    size_t memory_limit;
+    size_t bytes_in_use = 0;
+    size_t peak_bytes = 0;
+    size_t arena_bytes = 0;
+    std::unordered_map<const PlanNode*, OperatorMemory> operators;
+
+public:
+    explicit MemoryContext(size_t limit_bytes = 0, size_t arena_block_size = 64 * 1024);
+    MemoryContext(const MemoryContext&) = delete;
+    MemoryContext& operator=(const MemoryContext&) = delete;
+
+    void set_limit(size_t limit_bytes) { memory_limit = limit_bytes; }
+    size_t limit() const { return memory_limit; }
+
+    void* allocate(size_t bytes, size_t alignment, const PlanNode* owner);
+
+    void charge(const PlanNode* owner, size_t bytes);
+    void release(const PlanNode* owner, size_t bytes);
+    bool would_exceed(size_t bytes) const;
+
+    size_t current_bytes() const { return bytes_in_use; }
+    size_t peak() const { return peak_bytes; }
+    size_t operator_bytes(const PlanNode* owner) const;
+
+    MemoryUsage usage() const;
+    void reset();
+};
+
+// std-compatible allocator that carves memory out of a MemoryContext arena.
+// Deallocation is a no-op; memory is reclaimed when the context is reset.
+template<typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    MemoryContext* context;
+    const PlanNode* owner;
+
+    ArenaAllocator(MemoryContext* memory_context, const PlanNode* owner_node)
+        : context(memory_context), owner(owner_node) {}
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : context(other.context), owner(other.owner) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(context->allocate(n * sizeof(T), alignof(T), owner));
+    }
+
+    void deallocate(T*, size_t) {}
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return context == other.context; }
+
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return context != other.context; }
+};
@@ -2,12 +2,14 @@
 #include "cost_model.h"
 #include "plan_builder.h"
 #include "ast.h"
+#include "optimizer_stats.h"
 #include <vector>
 
 class QueryOptimizer {
 private:
     CostModel cost_model;
     PlanBuilder plan_builder;
+    OptimizerStats stats;
     
     std::vector<std::unique_ptr<PlanNode>> enumerate_join_orders(const SelectStatement& stmt);
     std::unique_ptr<PlanNode> apply_filter_pushdown(std::unique_ptr<PlanNode> plan);
@@ -15,6 +17,8 @@ private:
     
     std::unique_ptr<PlanNode> optimize_single_table(const SelectStatement& stmt);
     std::unique_ptr<PlanNode> optimize_join_query(const SelectStatement& stmt);
+    void annotate_cardinalities(PlanNode& node);
+    CostEstimate cost_candidate(PlanNode& plan);
     
     struct PlanCandidate {
         std::unique_ptr<PlanNode> plan;
@@ -28,10 +32,21 @@ public:
     QueryOptimizer();
     
     void set_table_statistics(const std::string& table_name, const TableStatistics& stats);
+    void remove_table_statistics(const std::string& table_name);
+    bool has_table_statistics(const std::string& table_name) const { return cost_model.has_table_statistics(table_name); }
     std::unique_ptr<PlanNode> optimize(const SelectStatement& stmt);
+    size_t estimate_cardinality(const PlanNode& node) { return cost_model.estimate_output_cardinality(node); }
+    size_t estimate_memory(const PlanNode& node) { return cost_model.estimate_memory_bytes(node); }
+    void set_feedback_cache(const FeedbackCache* cache) { cost_model.set_feedback_cache(cache); }
     
     std::vector<PlanCandidate> generate_all_plans(const SelectStatement& stmt);
     std::unique_ptr<PlanNode> select_best_plan(std::vector<PlanCandidate>& candidates);
     
+    // Phase timings and search-space counters since the last reset.
+    // optimize() resets them first; generate_all_plans and select_best_plan
+    // called directly add to them.
+    OptimizerStats get_stats() const;
+    void reset_stats();
+    
     void print_optimization_report(const std::vector<PlanCandidate>& candidates);
 };
\ No newline at end of file
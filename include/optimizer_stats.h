@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Work done by one QueryOptimizer::optimize() call.
+struct OptimizerStats {
+    // Phase wall times. Binding turns the AST into plan nodes, rewrites
+    // transform a bound plan, and enumeration is the search loop excluding
+    // the binding and costing done inside it. The only rewrite,
+    // apply_filter_pushdown, is currently a no-op, so rewrite_ms is timer
+    // overhead until a real rewrite lands.
+    double binding_ms = 0.0;
+    double rewrite_ms = 0.0;
+    double enumeration_ms = 0.0;
+    double costing_ms = 0.0;
+    double selection_ms = 0.0;
+    double annotation_ms = 0.0;
+    double total_ms = 0.0;
+
+    size_t plans_explored = 0;      // join orders x algorithms attempted
+    size_t plans_costed = 0;
+    size_t plans_rejected = 0;      // fully costed, then beaten by a cheaper plan
+    size_t plans_failed = 0;        // could not be built
+
+    // CostModel calls made on behalf of the optimizer, including the
+    // recursion into each plan's children.
+    size_t cost_estimates = 0;
+    size_t cardinality_estimates = 0;
+    size_t feedback_hits = 0;       // selectivities found in the FeedbackCache
+    size_t feedback_misses = 0;
+    double cost_model_ms = 0.0;
+
+    std::string to_string() const;
+    std::string to_json() const;    // one-line object
+};
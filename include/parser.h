@@ -32,4 +32,5 @@ private:
 public:
     explicit Parser(const std::vector<Token>& token_list);
     std::unique_ptr<SelectStatement> parseSelectStatement();
+    std::unique_ptr<Expression> parseCondition();
 };
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+enum class PerfEvent {
+    CYCLES,
+    INSTRUCTIONS,
+    L1D_MISSES,
+    LLC_MISSES,
+    BRANCH_MISSES
+};
+
+struct PerfCounts {
+    static constexpr size_t EVENT_COUNT = 5;
+
+    uint64_t values[EVENT_COUNT] = {};
+    uint32_t available = 0;     // bit per PerfEvent
+
+    bool has(PerfEvent event) const { return available & (1u << static_cast<int>(event)); }
+    uint64_t get(PerfEvent event) const { return values[static_cast<int>(event)]; }
+    bool empty() const { return available == 0; }
+
+    // Instructions per cycle, or 0 when either counter is missing.
+    double ipc() const;
+
+    PerfCounts operator-(const PerfCounts& earlier) const;
+    std::string to_string() const;
+    std::string to_json() const;
+
+    static const char* event_name(PerfEvent event);
+};
+
+// Per-thread hardware counters (user space only) read through Linux
+// perf_event_open. Counters the kernel, CPU or sandbox refuses are simply
+// missing from every reading; on other platforms nothing is available.
+// Readings are cumulative, so callers subtract a start snapshot.
+class PerfCounters {
+private:
+    int fds[PerfCounts::EVENT_COUNT];
+    std::string reason;
+
+public:
+    PerfCounters();
+    ~PerfCounters();
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available() const;
+    // Why some or all counters could not be opened.
+    const std::string& unavailable_reason() const { return reason; }
+
+    PerfCounts read() const;
+};
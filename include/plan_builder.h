@@ -19,6 +19,7 @@ public:
     PlanBuilder();
     
     void set_table_statistics(const std::string& table_name, const Statistics& stats);
+    void remove_table_statistics(const std::string& table_name) { table_stats.erase(table_name); }
     std::unique_ptr<PlanNode> build_plan(const SelectStatement& stmt);
     
     std::vector<std::unique_ptr<PlanNode>> generate_join_orders(const SelectStatement& stmt);
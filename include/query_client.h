@@ -0,0 +1,50 @@
+#pragma once
+#include "wire_protocol.h"
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// The server reported an error for one query; the connection stays usable
+// unless the error was a protocol error.
+class QueryError : public std::runtime_error {
+public:
+    explicit QueryError(const std::string& message) : std::runtime_error(message) {}
+};
+
+struct ClientResult {
+    TableSchema schema;
+    std::vector<Row> rows;
+    StringHeap strings;         // backs the rows' strings
+    QueryComplete complete;
+    size_t batches = 0;
+};
+
+// Blocking client for QueryServer.
+class QueryClient {
+private:
+    int fd = -1;
+    std::string input;
+    size_t input_offset = 0;
+
+    void send_all(const std::string& bytes);
+    MessageType read_frame(std::string& payload);
+
+public:
+    // Throws std::runtime_error when the server cannot be reached.
+    explicit QueryClient(const std::string& socket_path);
+    ~QueryClient();
+    QueryClient(const QueryClient&) = delete;
+    QueryClient& operator=(const QueryClient&) = delete;
+
+    using BatchCallback = std::function<void(const TableSchema& schema, const ColumnBatch& batch)>;
+
+    // Streams the result: on_batch sees each batch as it arrives.
+    QueryComplete query(const std::string& sql, const BatchCallback& on_batch);
+    ClientResult query(const std::string& sql);
+
+    // Pipelining: send several queries, then read their results in order.
+    void send_query(const std::string& sql);
+    // schema, when given, receives the result's columns even if it has no rows.
+    QueryComplete read_result(const BatchCallback& on_batch, TableSchema* schema = nullptr);
+};
@@ -1,8 +1,12 @@
 #pragma once
+#include "ast.h"
+#include "cost_constants.h"
+#include <algorithm>
 #include <vector>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <cmath>
 
 struct Statistics {
     size_t row_count;
@@ -11,6 +15,16 @@ struct Statistics {
     
     Statistics(size_t rows = 0, size_t pages = 0, double sel = 1.0)
         : row_count(rows), page_count(pages), selectivity(sel) {}
+    
+    // Row estimates are computed in double and clamped here: products of
+    // join inputs overflow size_t after a dozen relations, and the cap
+    // leaves headroom for multiplying by row widths.
+    static constexpr double MAX_ROW_COUNT = 1e15;
+    
+    static size_t clamp_row_count(double rows) {
+        if (!(rows > 0.0)) return 0;
+        return static_cast<size_t>(std::min(rows, MAX_ROW_COUNT));
+    }
 };
 
 struct CostEstimate {
@@ -30,6 +44,7 @@ enum class PlanNodeType {
     NESTED_LOOP_JOIN,
     HASH_JOIN,
     SORT_MERGE_JOIN,
+    ADAPTIVE_JOIN,
     SORT,
     AGGREGATE
 };
@@ -93,17 +108,22 @@ public:
     }
     
     CostEstimate estimate_cost() override {
-        return CostEstimate(stats.page_count, stats.row_count * 0.01);
+        const auto& c = CostConstants::active();
+        return CostEstimate(c.scan_cost(stats.page_count, 0), c.scan_cost(0, stats.row_count));
     }
 };
 
 class FilterNode : public PlanNode {
 public:
     std::string condition;
+    std::unique_ptr<Expression> predicate;
     
     FilterNode(const std::string& filter_condition)
         : PlanNode(PlanNodeType::FILTER), condition(filter_condition) {}
     
+    FilterNode(const std::string& filter_condition, std::unique_ptr<Expression> filter_predicate)
+        : PlanNode(PlanNodeType::FILTER), condition(filter_condition), predicate(std::move(filter_predicate)) {}
+    
     std::string to_string(int indent = 0) const override {
         std::string result = indent_string(indent) + "Filter(" + condition + ")\n";
         if (!children.empty()) {
@@ -115,7 +135,7 @@ public:
     CostEstimate estimate_cost() override {
         if (children.empty()) return CostEstimate();
         auto child_cost = children[0]->estimate_cost();
-        return CostEstimate(child_cost.io_cost, child_cost.cpu_cost + stats.row_count * 0.02);
+        return CostEstimate(child_cost.io_cost, child_cost.cpu_cost + CostConstants::active().filter_cost(stats.row_count));
     }
 };
 
@@ -142,7 +162,7 @@ public:
     CostEstimate estimate_cost() override {
         if (children.empty()) return CostEstimate();
         auto child_cost = children[0]->estimate_cost();
-        return CostEstimate(child_cost.io_cost, child_cost.cpu_cost + stats.row_count * 0.01);
+        return CostEstimate(child_cost.io_cost, child_cost.cpu_cost + CostConstants::active().filter_cost(stats.row_count) * 0.5);
     }
 };
 
@@ -195,9 +215,11 @@ public:
         auto left_cost = children[0]->estimate_cost();
         auto right_cost = children[1]->estimate_cost();
         
-        double io_cost = left_cost.io_cost + (children[0]->stats.row_count * right_cost.io_cost);
+        const auto& c = CostConstants::active();
+        double io_cost = left_cost.io_cost + right_cost.io_cost +
+                         c.nested_loop_io_cost(children[0]->stats.row_count, children[1]->stats.page_count);
         double cpu_cost = left_cost.cpu_cost + right_cost.cpu_cost + 
-                         (children[0]->stats.row_count * children[1]->stats.row_count * 0.01);
+                         c.nested_loop_cpu_cost(children[0]->stats.row_count, children[1]->stats.row_count);
         
         return CostEstimate(io_cost, cpu_cost);
     }
@@ -223,9 +245,12 @@ public:
         auto left_cost = children[0]->estimate_cost();
         auto right_cost = children[1]->estimate_cost();
         
+        // The executor builds on the left input.
         double io_cost = left_cost.io_cost + right_cost.io_cost;
         double cpu_cost = left_cost.cpu_cost + right_cost.cpu_cost + 
-                         (children[0]->stats.row_count + children[1]->stats.row_count) * 0.02;
+                         CostConstants::active().hash_join_cost(children[0]->stats.row_count,
+                                                                children[1]->stats.row_count,
+                                                                children[0]->stats.page_count);
         
         return CostEstimate(io_cost, cpu_cost);
     }
@@ -251,12 +276,62 @@ public:
         auto left_cost = children[0]->estimate_cost();
         auto right_cost = children[1]->estimate_cost();
         
-        double left_sort_cost = children[0]->stats.row_count * std::log2(children[0]->stats.row_count) * 0.01;
-        double right_sort_cost = children[1]->stats.row_count * std::log2(children[1]->stats.row_count) * 0.01;
+        double io_cost = left_cost.io_cost + right_cost.io_cost;
+        double cpu_cost = left_cost.cpu_cost + right_cost.cpu_cost + 
+                         CostConstants::active().sort_merge_cost(children[0]->stats.row_count,
+                                                                 children[1]->stats.row_count);
         
+        return CostEstimate(io_cost, cpu_cost);
+    }
+};
+
+// Picks an index probe, in-memory hash or Grace hash join at run time once
+// the actual build (left) cardinality is known. Costed like a hash join.
+class AdaptiveJoinNode : public JoinNode {
+public:
+    AdaptiveJoinNode(JoinType type, const std::string& condition)
+        : JoinNode(PlanNodeType::ADAPTIVE_JOIN, type, condition) {}
+    
+    std::string to_string(int indent = 0) const override {
+        std::string result = indent_string(indent) + "AdaptiveJoin(" + 
+                           join_type_string() + ", " + join_condition + ")\n";
+        if (children.size() >= 2) {
+            result += children[0]->to_string(indent + 1) + "\n";
+            result += children[1]->to_string(indent + 1);
+        }
+        return result;
+    }
+    
+    CostEstimate estimate_cost() override {
+        if (children.size() < 2) return CostEstimate();
+        auto left_cost = children[0]->estimate_cost();
+        auto right_cost = children[1]->estimate_cost();
+        
+        // The executor builds on the left input.
         double io_cost = left_cost.io_cost + right_cost.io_cost;
-        double cpu_cost = left_cost.cpu_cost + right_cost.cpu_cost + left_sort_cost + right_sort_cost;
+        double cpu_cost = left_cost.cpu_cost + right_cost.cpu_cost + 
+                         CostConstants::active().hash_join_cost(children[0]->stats.row_count,
+                                                                children[1]->stats.row_count,
+                                                                children[0]->stats.page_count);
         
         return CostEstimate(io_cost, cpu_cost);
     }
-};
\ No newline at end of file
+};
+
+// Project(Filter(TableScan)) and its two-operator variants, which the
+// executor runs as one fused loop without materializing the scan or
+// filter output.
+inline bool is_scan_pipeline(const PlanNode& node) {
+    const PlanNode* current = &node;
+    
+    if (current->type == PlanNodeType::PROJECT) {
+        if (current->children.empty()) return false;
+        current = current->children[0].get();
+    }
+    if (current->type == PlanNodeType::FILTER) {
+        if (current->children.empty()) return false;
+        current = current->children[0].get();
+    }
+    
+    return current != &node && current->type == PlanNodeType::TABLE_SCAN;
+}
@@ -0,0 +1,148 @@
+#pragma once
+#include "query_plan.h"
+#include "query_stats.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+class Executor;
+class ResultSet;
+
+enum class QueryClass {
+    POINT,      // join-free, small input and estimated to return a handful of rows
+    NORMAL,
+    HEAVY       // estimated cost or memory over the heavy thresholds
+};
+
+struct SchedulerOptions {
+    size_t max_concurrent = 8;                          // NORMAL and HEAVY queries running at once
+    size_t max_heavy = 2;                               // of which HEAVY
+    double heavy_cost = 1000.0;                         // plan total_cost at or above this is HEAVY
+    size_t heavy_memory_bytes = 64 * 1024 * 1024;       // so is an estimated peak at or above this
+    size_t point_max_rows = 16;
+    // Without indexes a lookup still scans its table, so only plans whose
+    // scans read at most this many rows in total count as POINT.
+    size_t point_max_scanned_rows = 100000;
+    size_t max_point_concurrent = 16;                   // POINT queries running at once
+    size_t memory_budget_bytes = 512 * 1024 * 1024;     // estimated peaks of running queries combined
+    double queue_timeout_ms = 0.0;                      // 0 waits indefinitely
+    double starvation_ms = 1000.0;                      // a waiter this old stops being overtaken
+};
+
+// A query gave up waiting for admission.
+class AdmissionError : public std::runtime_error {
+public:
+    explicit AdmissionError(const std::string& message) : std::runtime_error(message) {}
+};
+
+struct SchedulerClassStats {
+    uint64_t admitted = 0;
+    uint64_t queued = 0;            // admissions that had to wait
+    uint64_t timed_out = 0;
+    size_t running = 0;
+    size_t waiting = 0;
+    double queue_p50_ms = 0.0;      // over every admission, including immediate ones
+    double queue_p99_ms = 0.0;
+    double queue_max_ms = 0.0;
+};
+
+struct SchedulerStats {
+    SchedulerClassStats classes[3];     // indexed by QueryClass
+    size_t reserved_bytes = 0;
+
+    const SchedulerClassStats& of(QueryClass query_class) const { return classes[static_cast<int>(query_class)]; }
+    std::string to_string() const;
+};
+
+// Admission control in front of Executor. Point lookups have their own
+// max_point_concurrent slots and never wait behind other classes. Other
+// queries run while fewer than
+// max_concurrent are running, fewer than max_heavy for HEAVY ones, and
+// their estimated memory fits what the running queries have not reserved;
+// a query larger than the whole budget runs alone. Waiters are admitted in
+// arrival order, except that a later one may start while an earlier one
+// does not fit, until the earlier one has waited starvation_ms.
+// Thread-safe; one scheduler is shared by all sessions.
+class QueryScheduler {
+public:
+    // Held while the query runs; releases its slot and memory when destroyed.
+    class Ticket {
+    private:
+        QueryScheduler* scheduler = nullptr;
+        QueryClass query_class = QueryClass::POINT;
+        size_t memory_bytes = 0;
+        double queue_ms = 0.0;
+
+        friend class QueryScheduler;
+        Ticket(QueryScheduler* owner, QueryClass type, size_t bytes, double waited_ms)
+            : scheduler(owner), query_class(type), memory_bytes(bytes), queue_ms(waited_ms) {}
+
+    public:
+        Ticket() = default;
+        Ticket(Ticket&& other) noexcept;
+        Ticket& operator=(Ticket&& other) noexcept;
+        ~Ticket() { release(); }
+
+        void release();
+        QueryClass get_class() const { return query_class; }
+        size_t get_memory_bytes() const { return memory_bytes; }
+        double get_queue_ms() const { return queue_ms; }
+    };
+
+private:
+    struct Waiter {
+        QueryClass query_class;
+        size_t memory_bytes;
+        std::chrono::steady_clock::time_point arrived;
+        bool admitted = false;
+    };
+
+    struct ClassCounters {
+        std::atomic<uint64_t> admitted{0};
+        std::atomic<uint64_t> queued{0};
+        std::atomic<uint64_t> timed_out{0};
+        LatencyHistogram queue_time;
+    };
+
+    SchedulerOptions options;
+    mutable std::mutex mutex;
+    std::condition_variable changed;
+    std::list<Waiter> waiters;          // arrival order
+    size_t running[3] = {0, 0, 0};
+    size_t reserved_bytes = 0;
+    ClassCounters counters[3];
+
+    bool fits(const Waiter& waiter) const;
+    void admit_waiters();
+    void start(QueryClass query_class, size_t memory_bytes);
+    void finish(QueryClass query_class, size_t memory_bytes);
+    void record_queue_time(QueryClass query_class, double queue_ms);
+
+public:
+    explicit QueryScheduler(const SchedulerOptions& opts = SchedulerOptions());
+    QueryScheduler(const QueryScheduler&) = delete;
+    QueryScheduler& operator=(const QueryScheduler&) = delete;
+
+    const SchedulerOptions& get_options() const { return options; }
+
+    // From the optimizer's annotated plan: its estimated rows, cost and
+    // memory_bytes (QueryOptimizer::estimate_memory).
+    QueryClass classify(const PlanNode& plan, size_t memory_bytes) const;
+    static const char* class_name(QueryClass query_class);
+
+    // Blocks until the query may run. Throws AdmissionError after
+    // queue_timeout_ms.
+    Ticket admit(QueryClass query_class, size_t memory_bytes);
+
+    // Classifies, waits for admission and executes the plan.
+    std::unique_ptr<ResultSet> execute(Executor& executor, const PlanNode& plan, size_t memory_bytes);
+
+    SchedulerStats get_stats() const;
+    void reset_stats();
+};
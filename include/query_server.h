@@ -0,0 +1,128 @@
+#pragma once
+#include "cost_model.h"
+#include "table.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class QueryScheduler;
+
+struct QueryServerOptions {
+    std::string socket_path = "/tmp/query_optimizer.sock";
+    size_t worker_threads = 4;
+    size_t batch_rows = 4096;               // rows per BATCH frame, at most MAX_BATCH_ROWS
+    size_t batch_bytes = 1024 * 1024;       // encoded bytes per BATCH frame, at most MAX_FRAME_BYTES
+    size_t max_connections = 1024;
+    size_t plan_cache_capacity = 256;       // per worker; 0 disables plan caching
+    size_t max_output_bytes = 1024 * 1024;  // per connection; batches are encoded as it drains
+    size_t max_pending_queries = 64;        // per connection; reading pauses while this many wait
+    // Optional admission control shared by the workers. Not owned. Give
+    // the server more workers than the scheduler's max_concurrent so that
+    // point lookups find a free worker while heavy queries wait.
+    QueryScheduler* scheduler = nullptr;
+};
+
+struct QueryServerStats {
+    uint64_t connections_accepted = 0;
+    uint64_t connections_rejected = 0;      // over max_connections
+    uint64_t connections_open = 0;
+    uint64_t queries = 0;
+    uint64_t errors = 0;
+    uint64_t plan_cache_hits = 0;
+    uint64_t batches_sent = 0;
+    uint64_t bytes_sent = 0;
+};
+
+// Long-lived server over a Unix domain socket speaking the framing in
+// wire_protocol.h. One thread runs an epoll loop that accepts connections,
+// reads QUERY frames and writes results; a pool of workers, each with its
+// own QuerySession (and so its own warm plan cache), runs the queries
+// against the shared TableManager. Results are streamed as column batches
+// that the I/O thread encodes only as a connection's socket drains, so a
+// slow reader holds at most max_output_bytes of encoded output. Queries
+// from one connection run one at a time, in the order they were sent;
+// different connections run in parallel up to worker_threads. A client
+// that shuts down its write side still gets the results of every query it
+// sent before the connection closes.
+class QueryServer {
+private:
+    struct Connection;
+    struct Job {
+        uint64_t connection;
+        std::string sql;
+        std::chrono::steady_clock::time_point queued;
+    };
+    struct Completion;
+
+    TableManager* table_manager;
+    QueryServerOptions options;
+    std::vector<std::pair<std::string, TableStatistics>> statistics;
+
+    int listen_fd = -1;
+    int epoll_fd = -1;
+    int wake_fd = -1;               // eventfd: completions ready or stopping
+    std::atomic<bool> running{false};
+    std::thread io_thread;
+    std::vector<std::thread> workers;
+
+    // Owned by the I/O thread.
+    std::unordered_map<uint64_t, std::unique_ptr<Connection>> connections;
+    uint64_t next_connection_id = 2;    // 0 and 1 tag the listening socket and wake_fd
+
+    std::mutex jobs_mutex;
+    std::condition_variable jobs_ready;
+    std::deque<Job> jobs;
+    std::mutex completions_mutex;
+    std::deque<std::unique_ptr<Completion>> completions;
+
+    std::atomic<uint64_t> connections_accepted{0};
+    std::atomic<uint64_t> connections_rejected{0};
+    std::atomic<uint64_t> connections_open{0};
+    std::atomic<uint64_t> queries{0};
+    std::atomic<uint64_t> errors{0};
+    std::atomic<uint64_t> plan_cache_hits{0};
+    std::atomic<uint64_t> batches_sent{0};
+    std::atomic<uint64_t> bytes_sent{0};
+
+    void io_loop();
+    void worker_loop();
+    void wake();
+
+    // The bool-returning steps return false once they have closed conn.
+    void accept_connections();
+    bool read_from(Connection& conn);
+    void parse_frames(Connection& conn);
+    void dispatch(Connection& conn);
+    void drain_completions();
+    bool pump(Connection& conn);
+    bool flush_output(Connection& conn);
+    void update_interest(Connection& conn);
+    void close_connection(uint64_t id);
+
+public:
+    QueryServer(TableManager* tm, const QueryServerOptions& opts = QueryServerOptions());
+    ~QueryServer();
+    QueryServer(const QueryServer&) = delete;
+    QueryServer& operator=(const QueryServer&) = delete;
+
+    // Given to every worker's optimizer when the server starts.
+    void set_table_statistics(const std::string& table_name, const TableStatistics& stats);
+
+    // Binds the socket (replacing a stale one) and starts the threads.
+    // Throws std::runtime_error when the socket cannot be set up.
+    void start();
+    // Closes every connection and joins the threads; queries still running
+    // finish first. Called by the destructor.
+    void stop();
+    bool is_running() const { return running.load(); }
+
+    QueryServerStats get_stats() const;
+};
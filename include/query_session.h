@@ -0,0 +1,77 @@
+#pragma once
+#include "executor.h"
+#include "optimizer.h"
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+class QueryScheduler;
+class QueryStatsRegistry;
+class SlowQueryLog;
+
+// Outcome of one SQL statement with the time spent in each stage.
+struct QueryRun {
+    std::shared_ptr<const PlanNode> plan;   // shared with the session's plan cache
+    std::unique_ptr<ResultSet> result;
+    double parse_ms = 0.0;
+    double optimize_ms = 0.0;
+    double queue_ms = 0.0;      // waiting for the scheduler to admit it
+    double execute_ms = 0.0;
+    double total_ms = 0.0;
+    size_t spill_bytes = 0;
+    bool plan_cached = false;   // parse and optimize were skipped
+};
+
+// One client's path from SQL text to rows: tokenize, parse, optimize and
+// execute against a shared TableManager. A session is used by one thread
+// at a time; concurrent clients each get their own and share the tables
+// and registries.
+class QuerySession {
+private:
+    TableManager* table_manager;
+    QueryOptimizer optimizer;
+    Executor executor;
+    QueryStatsRegistry* query_stats = nullptr;
+    SlowQueryLog* slow_log = nullptr;
+    QueryScheduler* scheduler = nullptr;
+    size_t plan_cache_capacity = 0;
+    // Most recently used plan first; the map points into the list.
+    using CachedPlan = std::pair<std::string, std::shared_ptr<const PlanNode>>;
+    std::list<CachedPlan> plan_lru;
+    std::unordered_map<std::string, std::list<CachedPlan>::iterator> plan_cache;
+    size_t plan_cache_hits = 0;
+    size_t plan_cache_misses = 0;
+
+public:
+    explicit QuerySession(TableManager* tm);
+
+    // Parse errors, missing tables, timeouts, memory limits and admission
+    // timeouts propagate as exceptions after being counted against the query.
+    QueryRun run(const std::string& sql);
+
+    QueryOptimizer& get_optimizer() { return optimizer; }
+    Executor& get_executor() { return executor; }
+
+    // Every statement is recorded here. Not owned; may be shared.
+    void set_query_stats(QueryStatsRegistry* registry) { query_stats = registry; }
+    // Statements over the log's threshold, including failed ones, are
+    // handed to it. Not owned; may be shared.
+    void set_slow_query_log(SlowQueryLog* log) { slow_log = log; }
+    // Optimized plans wait here for admission before executing. Not owned;
+    // shared by every session it should limit.
+    void set_scheduler(QueryScheduler* query_scheduler) { scheduler = query_scheduler; }
+
+    // Keeps up to capacity optimized plans keyed by the exact SQL text and
+    // executes them again instead of re-planning; 0 (the default) disables
+    // the cache. Cached plans do not see later statistics or feedback, so
+    // clear_plan_cache() after changing either.
+    void set_plan_cache_capacity(size_t capacity);
+    void clear_plan_cache() {
+        plan_cache.clear();
+        plan_lru.clear();
+    }
+    size_t get_plan_cache_hits() const { return plan_cache_hits; }
+    size_t get_plan_cache_misses() const { return plan_cache_misses; }
+};
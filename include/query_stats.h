@@ -0,0 +1,109 @@
+#pragma once
+#include "query_plan.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// SQL text with literals replaced by '?' and whitespace and keyword case
+// normalized, so that queries differing only in constants share an entry.
+std::string normalize_query(const std::string& sql);
+uint64_t query_fingerprint(const std::string& normalized_sql);
+// Changes with the join order, join algorithms or scanned tables.
+uint64_t plan_fingerprint(const PlanNode& plan);
+
+// Log-linear latency histogram in microseconds (HDR layout: exact below
+// 128us, then 64 linear sub-buckets per power of two, so quantiles are
+// within about 1.6%). record() is a single relaxed atomic increment.
+class LatencyHistogram {
+public:
+    static constexpr size_t SUB_BUCKETS = 64;
+    static constexpr size_t MAGNITUDES = 30;     // values clamp at 2^37us, about 38 hours
+    static constexpr size_t BUCKETS = SUB_BUCKETS * (MAGNITUDES + 2);
+
+private:
+    std::atomic<uint64_t> counts[BUCKETS];
+
+    static size_t bucket_of(uint64_t value_us);
+    static uint64_t bucket_value(size_t bucket);     // upper bound of the bucket
+
+public:
+    LatencyHistogram();
+
+    void record(uint64_t value_us);
+    uint64_t count() const;
+    // Smallest recorded bucket bound covering the given fraction (0-1).
+    uint64_t value_at_quantile(double quantile) const;
+    void reset();
+};
+
+// Point-in-time copy of one registry entry.
+struct QueryStatsSnapshot {
+    uint64_t fingerprint = 0;
+    std::string query;
+    uint64_t calls = 0;
+    uint64_t errors = 0;
+    double error_ms = 0.0;              // time spent in failed executions
+    double total_ms = 0.0;
+    double mean_ms = 0.0;
+    double p50_ms = 0.0;
+    double p99_ms = 0.0;
+    double max_ms = 0.0;
+    uint64_t rows = 0;
+    uint64_t spill_bytes = 0;
+    uint64_t plan_changes = 0;
+};
+
+// pg_stat_statements-style counters per normalized query. The table has a
+// fixed number of slots claimed with compare-and-swap and entries are never
+// removed, so recording from many threads takes no locks. Queries arriving
+// once the table is full are counted in get_dropped() only.
+class QueryStatsRegistry {
+private:
+    struct Entry {
+        uint64_t fingerprint;
+        std::string query;
+        std::atomic<uint64_t> calls{0};
+        std::atomic<uint64_t> errors{0};
+        std::atomic<uint64_t> error_us{0};
+        std::atomic<uint64_t> total_us{0};
+        std::atomic<uint64_t> max_us{0};
+        std::atomic<uint64_t> rows{0};
+        std::atomic<uint64_t> spill_bytes{0};
+        std::atomic<uint64_t> plan_changes{0};
+        std::atomic<uint64_t> last_plan{0};
+        LatencyHistogram latency;
+
+        Entry(uint64_t key, const std::string& text) : fingerprint(key), query(text) {}
+    };
+
+    size_t capacity;
+    std::unique_ptr<std::atomic<Entry*>[]> slots;
+    std::atomic<uint64_t> dropped{0};
+
+    Entry* find_or_insert(uint64_t fingerprint, const std::string& normalized_sql);
+
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 4096;
+
+    explicit QueryStatsRegistry(size_t max_queries = DEFAULT_CAPACITY);
+    ~QueryStatsRegistry();
+    QueryStatsRegistry(const QueryStatsRegistry&) = delete;
+    QueryStatsRegistry& operator=(const QueryStatsRegistry&) = delete;
+
+    // plan_hash is plan_fingerprint() of the executed plan, 0 if unknown.
+    void record(const std::string& sql, double latency_ms, size_t rows, size_t spill_bytes, uint64_t plan_hash);
+    // Failed executions count as errors and error time, not in the latency
+    // histogram or total, so failures cannot skew the successful profile.
+    void record_error(const std::string& sql, double latency_ms);
+
+    // Entries by descending total time.
+    std::vector<QueryStatsSnapshot> snapshot() const;
+    std::string dump(size_t limit = 20) const;
+    std::string to_json() const;
+
+    // Zeroes the counters; fingerprints keep their slots.
+    void reset();
+    uint64_t get_dropped() const { return dropped.load(std::memory_order_relaxed); }
+};
@@ -0,0 +1,78 @@
+#pragma once
+#include "benchmark.h"
+#include "benchmark_report.h"
+#include <string>
+#include <vector>
+
+struct RegretOptions {
+    double timeout_ms = 1000.0;   // per execution; slower candidates count as the timeout
+    BenchmarkOptions timing = {1, 3, -1};
+    bool include_tpch = true;
+    double tpch_scale_factor = 0.01;
+};
+
+// One plan the optimizer considered for a query, executed.
+struct CandidateRun {
+    std::string plan;             // compact join tree, e.g. HJ(users,orders)
+    double estimated_cost = 0.0;
+    TimingStats timing;
+    size_t result_size = 0;
+    bool timed_out = false;
+    std::string error;
+
+    // Median runtime; the timeout for candidates that did not finish.
+    double runtime_ms(double timeout_ms) const;
+};
+
+struct RegretResult {
+    std::string query_name;
+    std::string distribution;
+    std::vector<CandidateRun> candidates;
+    size_t chosen = 0;            // index of the plan select_best_plan returned
+    size_t fastest = 0;
+    double regret = 1.0;          // chosen runtime / fastest runtime
+    bool regret_lower_bound = false;  // the chosen plan timed out
+    double rank_correlation = 0.0;    // Spearman, estimated cost vs runtime
+    std::string error;
+};
+
+// Spearman rank correlation with ties given their average rank. Returns 0
+// when either side is constant or fewer than two points are given.
+double spearman_correlation(const std::vector<double>& x, const std::vector<double>& y);
+
+// Executes every candidate from QueryOptimizer::generate_all_plans and
+// measures how far the cost model's choice is from the fastest plan. The
+// corpus covers the users/orders joins on uniform and skewed data and the
+// TPC-H query shapes.
+class RegretBenchmark {
+private:
+    TableManager* table_manager;
+    RegretOptions options;
+    QueryOptimizer optimizer;
+    Executor executor;
+    std::vector<RegretResult> results;
+
+    CandidateRun execute_candidate(const PlanNode& plan);
+    void run_users_orders(const std::string& distribution);
+
+public:
+    RegretBenchmark(TableManager* tm, const RegretOptions& opts = RegretOptions());
+
+    QueryOptimizer& get_optimizer() { return optimizer; }
+
+    RegretResult run(const std::string& name, const std::string& distribution, const SelectStatement& stmt);
+    RegretResult run_sql(const std::string& name, const std::string& distribution, const std::string& sql);
+    void run_corpus();
+
+    const std::vector<RegretResult>& get_results() const { return results; }
+    // Summary over queries with at least two candidates.
+    double geometric_mean_regret() const;
+    double max_regret() const;
+    double mean_rank_correlation() const;
+    size_t suboptimal_choices(double tolerance = 1.1) const;
+
+    void print_results() const;
+    // One entry per finished candidate, keyed by its join tree; the chosen
+    // plan's type is prefixed with "Chosen:".
+    BenchmarkReport report() const;
+};
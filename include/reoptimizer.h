@@ -0,0 +1,45 @@
+#pragma once
+#include "executor.h"
+#include "optimizer.h"
+#include <string>
+#include <vector>
+
+struct ReoptimizationOptions {
+    // Re-plan when actual/estimated (or estimated/actual) exceeds this.
+    double misestimate_factor = 4.0;
+    size_t max_reoptimizations = 4;
+};
+
+struct ReoptimizationEvent {
+    std::string relation;
+    size_t estimated_rows;
+    size_t actual_rows;
+    bool replanned;
+    std::string remaining_plan;
+};
+
+// Runs multi-join queries one join at a time. Each finished join is a
+// materialization point: its result is registered as a temporary base
+// relation with its true cardinality, and if the estimate was off by more
+// than the configured factor the remaining joins are re-planned from there.
+class Reoptimizer {
+private:
+    TableManager* table_manager;
+    QueryOptimizer* optimizer;
+    Executor* executor;
+    ReoptimizationOptions options;
+    std::vector<ReoptimizationEvent> events;
+    std::vector<std::string> temp_tables;
+
+    std::string materialize(const ResultSet& result);
+    void drop_temp_tables();
+
+public:
+    Reoptimizer(TableManager* tm, QueryOptimizer* query_optimizer, Executor* query_executor,
+                const ReoptimizationOptions& reoptimization_options = ReoptimizationOptions());
+    ~Reoptimizer();
+
+    std::unique_ptr<ResultSet> execute(const SelectStatement& stmt);
+
+    const std::vector<ReoptimizationEvent>& get_events() const { return events; }
+};
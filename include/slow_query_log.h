@@ -0,0 +1,79 @@
+#pragma once
+#include "optimizer_stats.h"
+#include "query_plan.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+struct QueryRun;
+
+struct SlowQueryLogOptions {
+    std::string path = "slow_queries.log";
+    double threshold_ms = 100.0;        // queries taking at least this long are logged
+    size_t max_file_bytes = 10 * 1024 * 1024;
+    size_t max_files = 5;               // path, path.1 ... path.(max_files - 1)
+    size_t max_queued = 1024;           // entries beyond this are dropped, not waited for
+};
+
+// Appends one JSON line per slow query: the SQL, the chosen plan as text
+// and as a tree of estimated versus actual rows, the parse / optimize /
+// execute breakdown and the optimizer's counters. The query thread only
+// formats the entry and queues it; a background thread writes and rotates
+// the files, so a slow disk never delays a query.
+class SlowQueryLog {
+private:
+    SlowQueryLogOptions options;
+    std::atomic<double> threshold_ms;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable drained;
+    std::deque<std::string> queue;
+    bool stopping = false;
+    uint64_t submitted = 0;
+    uint64_t completed = 0;
+    std::atomic<uint64_t> written{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> write_errors{0};
+
+    std::ofstream file;
+    size_t file_bytes = 0;
+    std::thread writer;
+
+    void writer_loop();
+    void write_entry(const std::string& entry);
+    void rotate();
+
+public:
+    // Throws std::runtime_error when the log file cannot be opened.
+    explicit SlowQueryLog(const SlowQueryLogOptions& opts = SlowQueryLogOptions());
+    // Writes out whatever is still queued.
+    ~SlowQueryLog();
+    SlowQueryLog(const SlowQueryLog&) = delete;
+    SlowQueryLog& operator=(const SlowQueryLog&) = delete;
+
+    void set_threshold(double ms) { threshold_ms.store(ms, std::memory_order_relaxed); }
+    double get_threshold() const { return threshold_ms.load(std::memory_order_relaxed); }
+    bool is_slow(double elapsed_ms) const { return elapsed_ms >= get_threshold(); }
+
+    // run.plan may be null when the query failed before planning finished;
+    // error is empty for queries that succeeded.
+    static std::string format_entry(const std::string& sql, const QueryRun& run,
+                                    const std::unordered_map<const PlanNode*, size_t>& actual_rows,
+                                    const OptimizerStats& optimizer, const std::string& error = "");
+
+    // Queues a formatted entry without waiting for I/O.
+    void submit(std::string entry);
+    // Blocks until every entry submitted so far is written or dropped.
+    void flush();
+
+    uint64_t get_written() const { return written.load(std::memory_order_relaxed); }
+    uint64_t get_dropped() const { return dropped.load(std::memory_order_relaxed); }
+    uint64_t get_write_errors() const { return write_errors.load(std::memory_order_relaxed); }
+};
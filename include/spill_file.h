@@ -0,0 +1,28 @@
+#pragma once
+#include "table.h"
+#include <cstdio>
+
+// Anonymous temporary file holding serialized rows. String values are
+// written out in full; read_row() copies them into the caller's heap.
+// The file is removed automatically when the SpillFile is destroyed.
+class SpillFile {
+private:
+    std::FILE* file;
+    size_t bytes_written = 0;
+    size_t rows_written = 0;
+
+public:
+    SpillFile();
+    ~SpillFile();
+    SpillFile(const SpillFile&) = delete;
+    SpillFile& operator=(const SpillFile&) = delete;
+
+    void write_row(const Row& row);
+
+    // Rewinds to the first row; call once all rows have been written.
+    void rewind();
+    bool read_row(Row& row, StringHeap& strings);
+
+    size_t get_bytes_written() const { return bytes_written; }
+    size_t get_rows_written() const { return rows_written; }
+};
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+constexpr uint64_t FNV1A_OFFSET_BASIS = 14695981039346656037ULL;
+
+// 64-bit FNV-1a. Pass an earlier result as hash to continue over more bytes.
+inline uint64_t fnv1a(std::string_view data, uint64_t hash = FNV1A_OFFSET_BASIS) {
+    for (unsigned char c : data) {
+        hash = (hash ^ c) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Escapes text for the inside of a JSON string literal.
+inline std::string json_escape(const std::string& text) {
+    std::string out;
+    out.reserve(text.size());
+    for (char c : text) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                    out += buffer;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out;
+}
+
+// The text as a quoted JSON string.
+inline std::string json_string(const std::string& text) {
+    return "\"" + json_escape(text) + "\"";
+}
+
+// printf-style formatting of a single double, e.g. format_double("%.3f", ms).
+inline std::string format_double(const char* fmt, double value) {
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), fmt, value);
+    return buffer;
+}
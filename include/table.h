@@ -2,29 +2,29 @@
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <iterator>
 #include <memory>
-#include <any>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include "value.h"
 
 struct Row {
-    std::vector<std::any> values;
+    std::vector<Value> values;
     
-    template<typename T>
-    T get(size_t index) const {
-        if (index >= values.size()) {
-            throw std::out_of_range("Column index out of range");
-        }
-        return std::any_cast<T>(values[index]);
+    const Value& get(size_t index) const noexcept {
+        static const Value null_value;
+        return (index < values.size()) ? values[index] : null_value;
     }
     
-    template<typename T>
-    void set(size_t index, const T& value) {
+    void set(size_t index, const Value& value) {
         if (index >= values.size()) {
             values.resize(index + 1);
         }
         values[index] = value;
     }
     
-    void add_value(const std::any& value) {
+    void add_value(const Value& value) {
         values.push_back(value);
     }
     
@@ -36,10 +36,29 @@ struct Row {
 struct TableSchema {
     std::vector<std::string> column_names;
     std::vector<std::string> column_types;
+    // Relation (alias or table name) each column came from, empty when
+    // unknown. Keeps users.id and orders.id apart in a joined schema.
+    std::vector<std::string> column_tables;
     
-    void add_column(const std::string& name, const std::string& type) {
+    void add_column(const std::string& name, const std::string& type, const std::string& table = "") {
         column_names.push_back(name);
         column_types.push_back(type);
+        column_tables.push_back(table);
+    }
+    
+    const std::string& column_table(size_t index) const {
+        static const std::string unknown;
+        return index < column_tables.size() ? column_tables[index] : unknown;
+    }
+    
+    // Gives columns without a qualifier the given one.
+    void qualify(const std::string& table) {
+        column_tables.resize(column_names.size());
+        for (auto& qualifier : column_tables) {
+            if (qualifier.empty()) {
+                qualifier = table;
+            }
+        }
     }
     
     size_t get_column_index(const std::string& name) const {
@@ -51,16 +70,51 @@ struct TableSchema {
         throw std::runtime_error("Column not found: " + name);
     }
     
+    // Resolves table.column, or an unqualified column that only one relation
+    // has. A qualified name also matches a column of unknown origin.
+    size_t resolve_column(const std::string& table, const std::string& column) const {
+        size_t found = column_names.size();
+        for (size_t i = 0; i < column_names.size(); ++i) {
+            if (column_names[i] != column) {
+                continue;
+            }
+            if (!table.empty() && !column_table(i).empty() && column_table(i) != table) {
+                continue;
+            }
+            if (found != column_names.size()) {
+                throw std::runtime_error("Ambiguous column: " + (table.empty() ? column : table + "." + column));
+            }
+            found = i;
+        }
+        if (found == column_names.size()) {
+            throw std::runtime_error("Column not found: " + (table.empty() ? column : table + "." + column));
+        }
+        return found;
+    }
+    
+    size_t resolve_column(const std::string& name) const {
+        size_t dot_pos = name.find('.');
+        if (dot_pos == std::string::npos) {
+            return resolve_column("", name);
+        }
+        return resolve_column(name.substr(0, dot_pos), name.substr(dot_pos + 1));
+    }
+    
     size_t column_count() const {
         return column_names.size();
     }
 };
 
+// Tables do no locking of their own. When a table is written while other
+// threads read it, readers hold read_lock() for as long as they use
+// get_rows() and writers hold write_lock() around make_string and add_row.
 class Table {
 private:
     std::string name;
     TableSchema schema;
     std::vector<Row> rows;
+    StringHeap string_heap;
+    mutable std::shared_mutex latch;
     
 public:
     Table(const std::string& table_name) : name(table_name) {}
@@ -73,6 +127,20 @@ public:
         rows.push_back(row);
     }
     
+    void add_row(Row&& row) {
+        rows.push_back(std::move(row));
+    }
+    
+    void reserve(size_t count) {
+        rows.reserve(count);
+    }
+    
+    // Appends rows whose strings live in `strings`, which the table takes over.
+    void append_rows(std::vector<Row>&& batch, StringHeap&& strings) {
+        rows.insert(rows.end(), std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+        string_heap.absorb(std::move(strings));
+    }
+    
     const std::vector<Row>& get_rows() const {
         return rows;
     }
@@ -89,8 +157,25 @@ public:
         return rows.size();
     }
     
+    Value make_string(std::string_view str) {
+        return Value::string_ref(string_heap.store(str));
+    }
+    
+    size_t string_bytes() const {
+        return string_heap.bytes_used();
+    }
+    
     void clear() {
         rows.clear();
+        string_heap.clear();
+    }
+    
+    std::shared_lock<std::shared_mutex> read_lock() const {
+        return std::shared_lock<std::shared_mutex>(latch);
+    }
+    
+    std::unique_lock<std::shared_mutex> write_lock() {
+        return std::unique_lock<std::shared_mutex>(latch);
     }
 };
 
@@ -110,6 +195,10 @@ public:
         return (it != tables.end()) ? it->second.get() : nullptr;
     }
     
+    void drop_table(const std::string& name) {
+        tables.erase(name);
+    }
+    
     void populate_sample_data() {
         {
             TableSchema users_schema;
@@ -124,9 +213,9 @@ public:
             for (int i = 1; i <= 1000; ++i) {
                 Row row;
                 row.add_value(i);
-                row.add_value(std::string("User") + std::to_string(i));
+                row.add_value(users->make_string("User" + std::to_string(i)));
                 row.add_value(20 + (i % 50));
-                row.add_value(std::string("City") + std::to_string((i % 10) + 1));
+                row.add_value(users->make_string("City" + std::to_string((i % 10) + 1)));
                 users->add_row(row);
             }
         }
@@ -145,7 +234,7 @@ public:
                 Row row;
                 row.add_value(i);
                 row.add_value((i % 1000) + 1);
-                row.add_value(std::string("Product") + std::to_string((i % 100) + 1));
+                row.add_value(orders->make_string("Product" + std::to_string((i % 100) + 1)));
                 row.add_value(10 + (i % 500));
                 orders->add_row(row);
             }
@@ -0,0 +1,67 @@
+#pragma once
+#include "benchmark.h"
+#include "benchmark_report.h"
+#include <string>
+#include <vector>
+
+enum class WorkloadQuery {
+    POINT_LOOKUP,   // one user by id
+    FILTERED_SCAN,  // ~10% of orders by amount
+    JOIN            // users with their orders, filtered on age
+};
+
+// Relative weights of the query kinds each client draws from.
+struct WorkloadMix {
+    double point_lookups = 0.70;
+    double filtered_scans = 0.25;
+    double joins = 0.05;
+};
+
+struct ThroughputOptions {
+    size_t users = 10000;
+    size_t orders = 50000;
+    WorkloadMix mix;
+    double duration_ms = 1000.0;        // measured time per client count
+    size_t warmup_queries = 5;          // untimed queries per client before the clock starts
+    double inserts_per_sec = 0.0;       // one writer appending to orders; 0 disables it
+};
+
+struct ThroughputResult {
+    size_t clients = 0;
+    size_t queries = 0;
+    size_t errors = 0;
+    size_t inserts = 0;
+    double elapsed_ms = 0.0;
+    double qps = 0.0;
+    TimingStats latency;                // every query
+    TimingStats point_lookups;
+    TimingStats filtered_scans;
+    TimingStats joins;
+};
+
+// Closed-loop load generator: N client threads, each with its own
+// QuerySession, issue a weighted mix of queries against one shared
+// TableManager for a fixed time, optionally while a writer thread appends
+// orders. Reports throughput and latency percentiles per client count.
+// Inserted rows stay in the table, so later runs scan slightly more.
+class ThroughputBenchmark {
+private:
+    TableManager* table_manager;
+    ThroughputOptions options;
+    std::vector<ThroughputResult> results;
+
+public:
+    // Generates users and orders into tm with DataGenerator.
+    ThroughputBenchmark(TableManager* tm, const ThroughputOptions& opts = ThroughputOptions());
+
+    static const char* query_name(WorkloadQuery query);
+    // SQL for one query of the given kind; value picks the id or threshold.
+    std::string build_query(WorkloadQuery query, uint64_t value) const;
+
+    ThroughputResult run(size_t clients);
+    void run_all(const std::vector<size_t>& client_counts = {1, 2, 4, 8, 16});
+
+    const std::vector<ThroughputResult>& get_results() const { return results; }
+    void print_results() const;
+    BenchmarkReport report() const;
+};
@@ -0,0 +1,7 @@
+#pragma once
+#include <chrono>
+
+// Milliseconds on the steady clock since start.
+inline double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "table.h"
+#include "optimizer.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Order-independent fingerprint of a query result.
+struct ResultChecksum {
+    size_t rows = 0;
+    uint64_t hash = 0;
+
+    bool operator==(const ResultChecksum& other) const { return rows == other.rows && hash == other.hash; }
+    bool operator!=(const ResultChecksum& other) const { return !(*this == other); }
+    std::string to_string() const;
+};
+
+ResultChecksum checksum_rows(const std::vector<Row>& rows);
+
+// One of the 22 TPC-H query shapes, rewritten into the SQL subset the
+// parser accepts (no aggregates, subqueries, LIKE or IN). The join graph and
+// the filters that shape intermediate results are kept; `changes` says what
+// was dropped. The reference checksum holds for REFERENCE_SCALE_FACTOR and
+// DEFAULT_SEED.
+struct TpchQuery {
+    int number;
+    std::string changes;
+    std::string sql;
+    ResultChecksum reference;
+};
+
+// Deterministic generator for the eight TPC-H tables with the spec's key
+// correlations (partsupp suppliers, lineitem parts and suppliers, order
+// status and total price derived from its lines). Rows are produced in
+// fixed-size chunks, each from its own seeded stream, so the output does not
+// depend on the number of threads.
+class TpchGenerator {
+private:
+    double scale_factor;
+    uint64_t seed;
+    size_t threads;
+
+    size_t scaled(size_t rows_at_sf1) const;
+
+public:
+    static constexpr uint64_t DEFAULT_SEED = 42;
+    static constexpr double REFERENCE_SCALE_FACTOR = 0.01;
+
+    // threads = 0 uses every hardware thread.
+    TpchGenerator(double sf, uint64_t generator_seed = DEFAULT_SEED, size_t thread_count = 0);
+
+    // Creates (or replaces) region, nation, supplier, customer, part,
+    // partsupp, orders and lineitem.
+    void generate(TableManager& tm) const;
+
+    static const std::vector<std::string>& table_names();
+    // Feeds the generated table sizes to the optimizer's cost model.
+    static void register_statistics(TableManager& tm, QueryOptimizer& optimizer);
+    static const std::vector<TpchQuery>& queries();
+};
@@ -0,0 +1,76 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One event in the Chrome trace-event format: a complete span ('X') or an
+// instant ('i'). Times are microseconds since the process started tracing.
+struct TraceEvent {
+    std::string name;
+    const char* category = "";
+    char phase = 'X';
+    double timestamp_us = 0.0;
+    double duration_us = 0.0;
+    uint32_t thread_id = 0;
+    std::string args;           // body of the JSON "args" object
+};
+
+// Process-wide timeline of parsing, optimization, operators, pipeline
+// batches, spill I/O and worker threads, written as JSON that
+// chrome://tracing and ui.perfetto.dev open directly.
+//
+// Recording is off by default; a TraceSpan then costs one relaxed atomic
+// load. Each thread appends to its own buffer, so start(), clear() and the
+// readers must not overlap with traced work.
+class Tracer {
+private:
+    static std::atomic<bool> recording;
+
+public:
+    static bool enabled() { return recording.load(std::memory_order_relaxed); }
+
+    // Discards earlier events and starts recording.
+    static void start();
+    static void stop();
+    static void clear();
+
+    // Shown as the track name in the viewer. Threads default to "thread N".
+    static void set_thread_name(const std::string& name);
+
+    static double now_us();
+    static void record(TraceEvent event);
+    static void instant(const char* category, const std::string& name);
+
+    // All recorded events, ordered by start time.
+    static std::vector<TraceEvent> events();
+    static std::string to_json();
+    // Throws std::runtime_error when the file cannot be written.
+    static void write_json(const std::string& filename);
+};
+
+// Records the lifetime of a scope as one span when the tracer is enabled.
+class TraceSpan {
+private:
+    bool active;
+    TraceEvent event;
+
+public:
+    TraceSpan(const char* category, const char* name) : active(Tracer::enabled()) {
+        if (active) {
+            event.category = category;
+            event.name = name;
+            event.timestamp_us = Tracer::now_us();
+        }
+    }
+    ~TraceSpan();
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    // Callers building names or arguments should check this first.
+    bool is_active() const { return active; }
+    void set_name(const std::string& name);
+    void add_arg(const char* key, double value);
+    void add_arg(const char* key, const std::string& value);
+};
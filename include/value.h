@@ -0,0 +1,322 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum class ValueType : uint8_t {
+    NULL_VALUE,
+    INT,
+    DOUBLE,
+    BOOL,
+    DATE,
+    STRING
+};
+
+// 16-byte tagged scalar. Strings are not owned: they reference bytes kept
+// alive by a StringHeap (normally the one owned by the source Table).
+class Value {
+private:
+    union {
+        int64_t int_value;
+        double double_value;
+        bool bool_value;
+        int32_t date_value;
+        const char* string_data;
+    };
+    uint32_t string_length;
+    ValueType value_type;
+
+    // NaN sorts after every number and equal to itself, keeping the order
+    // strict weak for std::sort.
+    static int compare_numbers(double a, double b) noexcept {
+        if (std::isnan(a) || std::isnan(b)) {
+            return static_cast<int>(std::isnan(a)) - static_cast<int>(std::isnan(b));
+        }
+        return (a < b) ? -1 : (a > b) ? 1 : 0;
+    }
+
+    // True when the double converts to int64_t without undefined behavior.
+    static bool fits_int64(double d) noexcept {
+        return d >= -9223372036854775808.0 && d < 9223372036854775808.0;
+    }
+
+    // Out-of-range doubles saturate; NaN converts to 0.
+    static int64_t double_to_int64(double d) noexcept {
+        if (fits_int64(d)) return static_cast<int64_t>(d);
+        if (std::isnan(d)) return 0;
+        return d < 0 ? INT64_MIN : INT64_MAX;
+    }
+
+    bool is_numeric() const noexcept {
+        return value_type == ValueType::INT || value_type == ValueType::DOUBLE;
+    }
+
+public:
+    Value() noexcept : int_value(0), string_length(0), value_type(ValueType::NULL_VALUE) {}
+    Value(int value) noexcept : int_value(value), string_length(0), value_type(ValueType::INT) {}
+    Value(int64_t value) noexcept : int_value(value), string_length(0), value_type(ValueType::INT) {}
+    Value(double value) noexcept : double_value(value), string_length(0), value_type(ValueType::DOUBLE) {}
+    Value(bool value) noexcept : int_value(0), string_length(0), value_type(ValueType::BOOL) {
+        bool_value = value;
+    }
+
+    // Strings must be interned first (Table::make_string / StringHeap::store).
+    Value(const std::string&) = delete;
+    Value(const char*) = delete;
+
+    static Value null() noexcept {
+        return Value();
+    }
+
+    static Value date(int32_t days_since_epoch) noexcept {
+        Value v;
+        v.int_value = 0;
+        v.date_value = days_since_epoch;
+        v.value_type = ValueType::DATE;
+        return v;
+    }
+
+    static Value string_ref(std::string_view str) noexcept {
+        Value v;
+        v.string_data = str.data();
+        v.string_length = static_cast<uint32_t>(str.size());
+        v.value_type = ValueType::STRING;
+        return v;
+    }
+
+    ValueType type() const noexcept {
+        return value_type;
+    }
+
+    bool is_null() const noexcept {
+        return value_type == ValueType::NULL_VALUE;
+    }
+
+    int64_t as_int() const noexcept {
+        switch (value_type) {
+            case ValueType::INT: return int_value;
+            case ValueType::DOUBLE: return double_to_int64(double_value);
+            case ValueType::BOOL: return bool_value ? 1 : 0;
+            case ValueType::DATE: return date_value;
+            default: return 0;
+        }
+    }
+
+    double as_double() const noexcept {
+        switch (value_type) {
+            case ValueType::DOUBLE: return double_value;
+            case ValueType::INT: return static_cast<double>(int_value);
+            case ValueType::BOOL: return bool_value ? 1.0 : 0.0;
+            case ValueType::DATE: return date_value;
+            default: return 0.0;
+        }
+    }
+
+    bool as_bool() const noexcept {
+        switch (value_type) {
+            case ValueType::BOOL: return bool_value;
+            case ValueType::INT: return int_value != 0;
+            case ValueType::DOUBLE: return double_value != 0.0;
+            default: return false;
+        }
+    }
+
+    int32_t as_date() const noexcept {
+        return (value_type == ValueType::DATE) ? date_value : 0;
+    }
+
+    std::string_view as_string() const noexcept {
+        return (value_type == ValueType::STRING) ? std::string_view(string_data, string_length)
+                                                 : std::string_view();
+    }
+
+    // Total order: NULL first, INT/DOUBLE compared numerically (NaN last),
+    // otherwise by type tag and then by value.
+    int compare(const Value& other) const noexcept {
+        if (is_numeric() && other.is_numeric()) {
+            if (value_type == ValueType::INT && other.value_type == ValueType::INT) {
+                return (int_value < other.int_value) ? -1 : (int_value > other.int_value) ? 1 : 0;
+            }
+            return compare_numbers(as_double(), other.as_double());
+        }
+        if (value_type != other.value_type) {
+            return (value_type < other.value_type) ? -1 : 1;
+        }
+        switch (value_type) {
+            case ValueType::NULL_VALUE: return 0;
+            case ValueType::BOOL: return static_cast<int>(bool_value) - static_cast<int>(other.bool_value);
+            case ValueType::DATE: return (date_value < other.date_value) ? -1 : (date_value > other.date_value) ? 1 : 0;
+            case ValueType::STRING: {
+                int c = as_string().compare(other.as_string());
+                return (c < 0) ? -1 : (c > 0) ? 1 : 0;
+            }
+            default: return 0;
+        }
+    }
+
+    size_t hash() const noexcept {
+        switch (value_type) {
+            case ValueType::INT: return std::hash<int64_t>()(int_value);
+            case ValueType::DOUBLE: {
+                // Integral doubles hash like the equal INT; the rest by their
+                // bits, with every NaN collapsed to one pattern.
+                if (fits_int64(double_value)) {
+                    auto as_integer = static_cast<int64_t>(double_value);
+                    if (static_cast<double>(as_integer) == double_value) {
+                        return std::hash<int64_t>()(as_integer);
+                    }
+                }
+                double canonical = std::isnan(double_value) ? std::nan("") : double_value;
+                uint64_t bits;
+                std::memcpy(&bits, &canonical, sizeof(bits));
+                return std::hash<uint64_t>()(bits);
+            }
+            case ValueType::BOOL: return bool_value ? 1 : 0;
+            case ValueType::DATE: return std::hash<int32_t>()(date_value) ^ 0x9e3779b9;
+            case ValueType::STRING: return std::hash<std::string_view>()(as_string());
+            default: return 0;
+        }
+    }
+
+    bool operator==(const Value& other) const noexcept { return compare(other) == 0; }
+    bool operator!=(const Value& other) const noexcept { return compare(other) != 0; }
+    bool operator<(const Value& other) const noexcept { return compare(other) < 0; }
+    bool operator>(const Value& other) const noexcept { return compare(other) > 0; }
+    bool operator<=(const Value& other) const noexcept { return compare(other) <= 0; }
+    bool operator>=(const Value& other) const noexcept { return compare(other) >= 0; }
+
+    // Days since 1970-01-01 <-> proleptic Gregorian calendar date.
+    static int32_t days_from_civil(int year, unsigned month, unsigned day) noexcept {
+        year -= month <= 2;
+        const int era = (year >= 0 ? year : year - 399) / 400;
+        const unsigned yoe = static_cast<unsigned>(year - era * 400);
+        const unsigned doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+        const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return era * 146097 + static_cast<int>(doe) - 719468;
+    }
+
+    static bool parse_date(std::string_view text, int32_t& days) noexcept {
+        int year = 0;
+        unsigned month = 0, day = 0;
+        if (text.size() != 10 || text[4] != '-' || text[7] != '-') return false;
+        for (size_t i : {0, 1, 2, 3}) {
+            if (text[i] < '0' || text[i] > '9') return false;
+            year = year * 10 + (text[i] - '0');
+        }
+        for (size_t i : {5, 6}) {
+            if (text[i] < '0' || text[i] > '9') return false;
+            month = month * 10 + (text[i] - '0');
+        }
+        for (size_t i : {8, 9}) {
+            if (text[i] < '0' || text[i] > '9') return false;
+            day = day * 10 + (text[i] - '0');
+        }
+        if (month < 1 || month > 12 || day < 1 || day > 31) return false;
+        days = days_from_civil(year, month, day);
+        return true;
+    }
+
+    static std::string format_date(int32_t days) {
+        int z = days + 719468;
+        const int era = (z >= 0 ? z : z - 146096) / 146097;
+        const unsigned doe = static_cast<unsigned>(z - era * 146097);
+        const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        const unsigned mp = (5 * doy + 2) / 153;
+        const unsigned day = doy - (153 * mp + 2) / 5 + 1;
+        const unsigned month = mp < 10 ? mp + 3 : mp - 9;
+        const int year = static_cast<int>(yoe) + era * 400 + (month <= 2);
+
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%04d-%02u-%02u", year, month, day);
+        return buffer;
+    }
+
+    std::string to_string() const {
+        switch (value_type) {
+            case ValueType::INT: return std::to_string(int_value);
+            case ValueType::DOUBLE: {
+                char buffer[32];
+                std::snprintf(buffer, sizeof(buffer), "%.2f", double_value);
+                return buffer;
+            }
+            case ValueType::BOOL: return bool_value ? "true" : "false";
+            case ValueType::DATE: return format_date(date_value);
+            case ValueType::STRING: return std::string(as_string());
+            default: return "NULL";
+        }
+    }
+};
+
+static_assert(sizeof(Value) == 16, "Value must stay 16 bytes");
+
+struct ValueHash {
+    size_t operator()(const Value& value) const noexcept {
+        return value.hash();
+    }
+};
+
+// Append-only arena for string payloads. Returned views stay valid until
+// clear() or destruction; chunks are never reallocated.
+class StringHeap {
+private:
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> chunks;
+    size_t chunk_used = CHUNK_SIZE;
+    size_t total_bytes = 0;
+
+public:
+    StringHeap() = default;
+    StringHeap(const StringHeap&) = delete;
+    StringHeap& operator=(const StringHeap&) = delete;
+    StringHeap(StringHeap&&) = default;
+    StringHeap& operator=(StringHeap&&) = default;
+
+    std::string_view store(std::string_view str) {
+        if (str.empty()) {
+            return std::string_view();
+        }
+        if (str.size() > CHUNK_SIZE / 4) {
+            chunks.insert(chunks.begin(), std::make_unique<char[]>(str.size()));
+            std::memcpy(chunks.front().get(), str.data(), str.size());
+            total_bytes += str.size();
+            return std::string_view(chunks.front().get(), str.size());
+        }
+        if (chunk_used + str.size() > CHUNK_SIZE) {
+            chunks.push_back(std::make_unique<char[]>(CHUNK_SIZE));
+            chunk_used = 0;
+        }
+        char* dest = chunks.back().get() + chunk_used;
+        std::memcpy(dest, str.data(), str.size());
+        chunk_used += str.size();
+        total_bytes += str.size();
+        return std::string_view(dest, str.size());
+    }
+
+    // Takes over another heap's chunks; views into them stay valid.
+    void absorb(StringHeap&& other) {
+        auto position = chunks.empty() ? chunks.end() : chunks.end() - 1;
+        chunks.insert(position, std::make_move_iterator(other.chunks.begin()),
+                      std::make_move_iterator(other.chunks.end()));
+        total_bytes += other.total_bytes;
+        other.clear();
+    }
+
+    void clear() {
+        chunks.clear();
+        chunk_used = CHUNK_SIZE;
+        total_bytes = 0;
+    }
+
+    size_t bytes_used() const {
+        return total_bytes;
+    }
+};
@@ -0,0 +1,113 @@
+#pragma once
+#include "table.h"
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Framing used by QueryServer and QueryClient. Every message is
+//   u32 payload length | u8 MessageType | payload
+// Integers and doubles are little-endian; strings are a u32 length and the
+// bytes. A query is answered by SCHEMA, zero or more BATCH frames and
+// COMPLETE, or by ERROR at any point.
+enum class MessageType : uint8_t {
+    QUERY = 1,      // SQL text
+    SCHEMA = 2,     // u32 columns, then name and declared type per column
+    BATCH = 3,      // u32 rows, u32 columns, then each column (see encode_batch)
+    COMPLETE = 4,   // QueryComplete
+    ERROR = 5       // message
+};
+
+constexpr size_t FRAME_HEADER_BYTES = 5;
+constexpr uint32_t MAX_FRAME_BYTES = 64 * 1024 * 1024;
+constexpr uint32_t MAX_BATCH_ROWS = 64 * 1024;
+
+class ProtocolError : public std::runtime_error {
+public:
+    explicit ProtocolError(const std::string& message) : std::runtime_error(message) {}
+};
+
+struct QueryComplete {
+    uint64_t rows = 0;
+    double parse_ms = 0.0;
+    double optimize_ms = 0.0;
+    double execute_ms = 0.0;
+    double queue_ms = 0.0;      // waiting for a worker and for admission
+    bool plan_cached = false;
+};
+
+// One decoded BATCH: values are column-major, strings point into `strings`.
+struct ColumnBatch {
+    size_t rows = 0;
+    std::vector<std::vector<Value>> columns;
+    StringHeap strings;
+
+    // Appends the batch's rows to out, interning strings into heap.
+    void append_rows(std::vector<Row>& out, StringHeap& heap) const;
+};
+
+class WireWriter {
+private:
+    std::string& out;
+
+public:
+    explicit WireWriter(std::string& buffer) : out(buffer) {}
+
+    void put_u8(uint8_t value) { out.push_back(static_cast<char>(value)); }
+    void put_u32(uint32_t value);
+    void put_u64(uint64_t value);
+    void put_f64(double value);
+    void put_string(std::string_view value);
+    void put_bytes(const void* data, size_t size) { out.append(static_cast<const char*>(data), size); }
+};
+
+// Throws ProtocolError when the payload ends early.
+class WireReader {
+private:
+    std::string_view data;
+    size_t pos = 0;
+
+    void need(size_t bytes) const;
+
+public:
+    explicit WireReader(std::string_view payload) : data(payload) {}
+
+    uint8_t get_u8();
+    uint32_t get_u32();
+    uint64_t get_u64();
+    double get_f64();
+    std::string_view get_string();
+    std::string_view get_bytes(size_t size);
+    bool at_end() const { return pos == data.size(); }
+};
+
+// Appends a frame header and returns its offset for end_frame.
+size_t begin_frame(std::string& out, MessageType type);
+// Fills in the length of the frame started at offset. A payload over
+// MAX_FRAME_BYTES is removed from out and reported as a ProtocolError.
+void end_frame(std::string& out, size_t offset);
+
+// Finds the frame at the start of [data, data + size). Returns false until
+// the whole frame has arrived; throws ProtocolError on oversized frames.
+bool next_frame(const char* data, size_t size, MessageType& type, std::string_view& payload, size_t& frame_bytes);
+
+void encode_query(std::string& out, std::string_view sql);
+void encode_schema(std::string& out, const TableSchema& schema);
+void encode_error(std::string& out, std::string_view message);
+void encode_complete(std::string& out, const QueryComplete& complete);
+// Rows [begin, end) as one BATCH. Each column is a u8 ValueType followed by
+// a null bitmap and the non-null values (8-byte ints and doubles, 4-byte
+// dates, 1-byte bools, length-prefixed strings). A column of only NULLs has
+// no further data; a column whose values have different types is tagged
+// 0xFF and stores a type byte before each value.
+void encode_batch(std::string& out, const std::vector<Row>& rows, size_t begin, size_t end, size_t columns);
+// End of the next batch from begin: at most max_rows rows whose encoding
+// stays within max_bytes, but always at least one row.
+size_t batch_end(const std::vector<Row>& rows, size_t begin, size_t max_rows, size_t columns, size_t max_bytes);
+
+std::string decode_query(std::string_view payload);
+TableSchema decode_schema(std::string_view payload);
+std::string decode_error(std::string_view payload);
+QueryComplete decode_complete(std::string_view payload);
+void decode_batch(std::string_view payload, ColumnBatch& batch);
@@ -0,0 +1,94 @@
+#include <csignal>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "benchmark.h"
+#include "query_scheduler.h"
+#include "query_server.h"
+#include "tpch.h"
+
+// Loads a dataset once and serves queries over a Unix domain socket until
+// SIGINT or SIGTERM. Query it with sql_client.
+// Exit status: 0 stopped by a signal, 1 startup error, 2 usage error.
+int main(int argc, char* argv[]) {
+    QueryServerOptions options;
+    SchedulerOptions admission;
+    bool schedule = false;
+    size_t users = 10000;
+    size_t orders = 50000;
+    double tpch_scale = 0.0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--socket" && i + 1 < argc) {
+            options.socket_path = argv[++i];
+        } else if (arg == "--workers" && i + 1 < argc) {
+            options.worker_threads = std::stoul(argv[++i]);
+        } else if (arg == "--max-concurrent" && i + 1 < argc) {
+            admission.max_concurrent = std::stoul(argv[++i]);
+            schedule = true;
+        } else if (arg == "--max-heavy" && i + 1 < argc) {
+            admission.max_heavy = std::stoul(argv[++i]);
+            schedule = true;
+        } else if (arg == "--users" && i + 1 < argc) {
+            users = std::stoul(argv[++i]);
+        } else if (arg == "--orders" && i + 1 < argc) {
+            orders = std::stoul(argv[++i]);
+        } else if (arg == "--tpch" && i + 1 < argc) {
+            tpch_scale = std::stod(argv[++i]);
+        } else {
+            std::cerr << "usage: " << argv[0]
+                      << " [--socket path] [--workers n] [--max-concurrent n] [--max-heavy n] [--users n] [--orders n]"
+                      << " [--tpch scale_factor]" << std::endl;
+            return 2;
+        }
+    }
+
+    // Signals are taken synchronously below; block them before any thread starts.
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    TableManager tm;
+    std::vector<std::string> tables;
+    if (tpch_scale > 0.0) {
+        TpchGenerator(tpch_scale).generate(tm);
+        tables = TpchGenerator::table_names();
+    } else {
+        DataGenerator::generate_large_dataset(tm, users, orders);
+        tables = {"users", "orders"};
+    }
+
+    std::unique_ptr<QueryScheduler> scheduler;
+    if (schedule) {
+        scheduler = std::make_unique<QueryScheduler>(admission);
+        options.scheduler = scheduler.get();
+    }
+
+    try {
+        QueryServer server(&tm, options);
+        for (const auto& name : tables) {
+            TableStatistics stats = measure_table_statistics(*tm.get_table(name));
+            server.set_table_statistics(name, stats);
+            std::cout << name << ": " << stats.tuple_count << " rows" << std::endl;
+        }
+        server.start();
+        std::cout << "Listening on " << options.socket_path << " with " << options.worker_threads << " workers"
+                  << std::endl;
+
+        int received = 0;
+        sigwait(&signals, &received);
+        QueryServerStats stats = server.get_stats();
+        server.stop();
+        std::cout << "\nServed " << stats.queries << " queries (" << stats.errors << " errors) on "
+                  << stats.connections_accepted << " connections" << std::endl;
+        if (scheduler) {
+            std::cout << scheduler->get_stats().to_string();
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include "query_client.h"
+
+static void run(QueryClient& client, const std::string& sql) {
+    try {
+        bool header = false;
+        QueryComplete complete = client.query(sql, [&header](const TableSchema& schema, const ColumnBatch& batch) {
+            if (!header) {
+                for (size_t c = 0; c < schema.column_count(); ++c) {
+                    std::cout << (c ? "\t" : "") << schema.column_names[c];
+                }
+                std::cout << "\n";
+                header = true;
+            }
+            for (size_t r = 0; r < batch.rows; ++r) {
+                for (size_t c = 0; c < batch.columns.size(); ++c) {
+                    std::cout << (c ? "\t" : "") << batch.columns[c][r].to_string();
+                }
+                std::cout << "\n";
+            }
+        });
+        std::cerr << "(" << complete.rows << " rows; parse " << complete.parse_ms << "ms, optimize "
+                  << complete.optimize_ms << "ms, execute " << complete.execute_ms << "ms"
+                  << (complete.plan_cached ? ", cached plan" : "") << ")" << std::endl;
+    } catch (const QueryError& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+    }
+}
+
+// Sends each argument, or each line of standard input, to a running serve
+// and prints the rows tab-separated.
+// Exit status: 0 done, 1 connection error, 2 usage error.
+int main(int argc, char* argv[]) {
+    std::string socket_path = "/tmp/query_optimizer.sock";
+    std::vector<std::string> queries;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--socket" && i + 1 < argc) {
+            socket_path = argv[++i];
+        } else if (!arg.empty() && arg[0] != '-') {
+            queries.push_back(arg);
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--socket path] [sql ...]" << std::endl;
+            return 2;
+        }
+    }
+
+    try {
+        QueryClient client(socket_path);
+        if (!queries.empty()) {
+            for (const auto& sql : queries) {
+                run(client, sql);
+            }
+        } else {
+            std::string line;
+            while (std::getline(std::cin, line)) {
+                if (!line.empty()) {
+                    run(client, line);
+                }
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,130 @@
+#include "adaptive_filter.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <sstream>
+
+static void collect_conjuncts(const BoundExpression& expr, std::vector<const BoundExpression*>& out) {
+    if (expr.kind == BoundExpressionKind::AND) {
+        collect_conjuncts(*expr.left, out);
+        collect_conjuncts(*expr.right, out);
+    } else {
+        out.push_back(&expr);
+    }
+}
+
+static std::string describe_expression(const BoundExpression& expr) {
+    switch (expr.kind) {
+        case BoundExpressionKind::COLUMN:
+            return "$" + std::to_string(expr.column_index);
+        case BoundExpressionKind::CONSTANT:
+            return expr.constant.to_string();
+        case BoundExpressionKind::AND:
+            return "(" + describe_expression(*expr.left) + " AND " + describe_expression(*expr.right) + ")";
+        case BoundExpressionKind::OR:
+            return "(" + describe_expression(*expr.left) + " OR " + describe_expression(*expr.right) + ")";
+        case BoundExpressionKind::COMPARISON: {
+            const char* op = "=";
+            switch (expr.op) {
+                case BinaryOperator::NOT_EQUALS: op = "<>"; break;
+                case BinaryOperator::GREATER: op = ">"; break;
+                case BinaryOperator::LESS: op = "<"; break;
+                case BinaryOperator::GREATER_EQUAL: op = ">="; break;
+                case BinaryOperator::LESS_EQUAL: op = "<="; break;
+                default: break;
+            }
+            return describe_expression(*expr.left) + " " + op + " " + describe_expression(*expr.right);
+        }
+    }
+    return "?";
+}
+
+double AdaptiveConjunctFilter::Conjunct::rank() const {
+    double pass_rate = selectivity();
+    if (pass_rate >= 1.0) {
+        return std::numeric_limits<double>::max();
+    }
+    return cost_per_row() / (1.0 - pass_rate);
+}
+
+AdaptiveConjunctFilter::AdaptiveConjunctFilter(const BoundExpression& root, bool adapt_order)
+    : adaptive(adapt_order) {
+    std::vector<const BoundExpression*> parts;
+    collect_conjuncts(root, parts);
+
+    for (size_t i = 0; i < parts.size(); ++i) {
+        conjuncts.push_back(Conjunct{ExpressionProgram::compile(*parts[i]), describe_expression(*parts[i])});
+        order.push_back(i);
+    }
+}
+
+void AdaptiveConjunctFilter::evaluate_batch(ExpressionVM& vm, const Row* rows, size_t count,
+                                            std::vector<uint32_t>& selection) {
+    bool sample = adaptive && conjuncts.size() > 1;
+    const uint32_t* input = nullptr;
+    size_t input_count = count;
+
+    for (size_t position = 0; position < order.size(); ++position) {
+        auto& conjunct = conjuncts[order[position]];
+        bool last = position + 1 == order.size();
+
+        // Intermediate selections alternate between two buffers because the
+        // VM reads its input selection while appending to the output.
+        std::vector<uint32_t>& target = last ? selection : (input == scratch[0].data() ? scratch[1] : scratch[0]);
+        if (!last) {
+            target.clear();
+        }
+        size_t before = target.size();
+
+        auto start = sample ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+        vm.run(conjunct.program, rows, input, input_count, target);
+        size_t produced = target.size() - before;
+
+        if (sample) {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            conjunct.nanoseconds += std::chrono::duration<double, std::nano>(elapsed).count();
+            conjunct.rows_in += input_count;
+            conjunct.rows_out += produced;
+        }
+
+        if (produced == 0) {
+            break;
+        }
+        input = target.data();
+        input_count = produced;
+    }
+
+    if (sample && ++batches % REORDER_INTERVAL == 0) {
+        reorder();
+    }
+}
+
+void AdaptiveConjunctFilter::reorder() {
+    std::vector<size_t> ranked = order;
+    std::stable_sort(ranked.begin(), ranked.end(), [this](size_t a, size_t b) {
+        return conjuncts[a].rank() < conjuncts[b].rank();
+    });
+
+    if (ranked != order) {
+        order = ranked;
+        reorders++;
+    }
+
+    // Decay the samples so the order can follow drifting data.
+    for (auto& conjunct : conjuncts) {
+        conjunct.rows_in /= 2;
+        conjunct.rows_out /= 2;
+        conjunct.nanoseconds /= 2;
+    }
+}
+
+std::string AdaptiveConjunctFilter::describe() const {
+    std::ostringstream out;
+    for (size_t position = 0; position < order.size(); ++position) {
+        const auto& conjunct = conjuncts[order[position]];
+        out << position + 1 << ". " << conjunct.description
+            << " (selectivity " << conjunct.selectivity()
+            << ", " << conjunct.cost_per_row() << " ns/row)\n";
+    }
+    return out.str();
+}
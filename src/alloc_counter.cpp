@@ -0,0 +1,123 @@
+// Counting replacements for the global operator new and delete. Link this
+// file into a program to make AllocationCounter report heap traffic; every
+// allocation then pays for a few relaxed atomic updates.
+#include "memory_context.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <malloc.h>
+
+namespace {
+
+std::atomic<uint64_t> allocations{0};
+std::atomic<uint64_t> frees{0};
+std::atomic<uint64_t> bytes_allocated{0};
+std::atomic<uint64_t> bytes_freed{0};
+std::atomic<uint64_t> current_bytes{0};
+std::atomic<uint64_t> peak_bytes{0};
+
+// Usable sizes are counted on both sides so a free always matches its
+// allocation, whatever size the caller passes to delete.
+void count_allocation(void* ptr) {
+    uint64_t size = malloc_usable_size(ptr);
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    bytes_allocated.fetch_add(size, std::memory_order_relaxed);
+    uint64_t now = current_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+    uint64_t peak = peak_bytes.load(std::memory_order_relaxed);
+    while (now > peak && !peak_bytes.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {
+    }
+}
+
+void count_free(void* ptr) {
+    uint64_t size = malloc_usable_size(ptr);
+    frees.fetch_add(1, std::memory_order_relaxed);
+    bytes_freed.fetch_add(size, std::memory_order_relaxed);
+    current_bytes.fetch_sub(size, std::memory_order_relaxed);
+}
+
+void* counted_malloc(std::size_t size) {
+    void* ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr) count_allocation(ptr);
+    return ptr;
+}
+
+void* counted_aligned(std::size_t size, std::size_t alignment) {
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, std::max(alignment, sizeof(void*)), size == 0 ? 1 : size) != 0) {
+        return nullptr;
+    }
+    count_allocation(ptr);
+    return ptr;
+}
+
+void counted_free(void* ptr) {
+    if (ptr) {
+        count_free(ptr);
+        std::free(ptr);
+    }
+}
+
+}  // namespace
+
+extern "C" void qo_alloc_counter_read(AllocationStats* stats) {
+    stats->allocations = allocations.load(std::memory_order_relaxed);
+    stats->frees = frees.load(std::memory_order_relaxed);
+    stats->bytes_allocated = bytes_allocated.load(std::memory_order_relaxed);
+    stats->bytes_freed = bytes_freed.load(std::memory_order_relaxed);
+    stats->current_bytes = current_bytes.load(std::memory_order_relaxed);
+    stats->peak_bytes = peak_bytes.load(std::memory_order_relaxed);
+}
+
+extern "C" void qo_alloc_counter_reset_peak() {
+    peak_bytes.store(current_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+void* operator new(std::size_t size) {
+    if (void* ptr = counted_malloc(size)) return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    if (void* ptr = counted_malloc(size)) return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return counted_malloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return counted_malloc(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    if (void* ptr = counted_aligned(size, static_cast<std::size_t>(alignment))) return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    if (void* ptr = counted_aligned(size, static_cast<std::size_t>(alignment))) return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return counted_aligned(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return counted_aligned(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* ptr) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr) noexcept { counted_free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { counted_free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { counted_free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { counted_free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { counted_free(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { counted_free(ptr); }
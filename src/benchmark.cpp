@@ -1,8 +1,107 @@
 #include "benchmark.h"
+#include "benchmark_report.h"
+#include "tpch.h"
+#include "tokenizer.h"
+#include "parser.h"
 #include <iostream>
 #include <fstream>
 #include <random>
 #include <iomanip>
+#include <sstream>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+uint64_t DataGenerator::seed = DataGenerator::DEFAULT_SEED;
+
+// Two-sided 95% Student-t critical values for 1..30 degrees of freedom.
+static const double T_CRITICAL_95[30] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+};
+
+double student_t_critical_95(size_t degrees_of_freedom) {
+    if (degrees_of_freedom == 0) {
+        return 0.0;
+    }
+    return degrees_of_freedom <= 30 ? T_CRITICAL_95[degrees_of_freedom - 1] : 1.96;
+}
+
+static double percentile(const std::vector<double>& sorted, double fraction) {
+    // Nearest-rank: the smallest sample with at least this fraction at or below it.
+    size_t rank = static_cast<size_t>(std::ceil(fraction * sorted.size()));
+    return sorted[std::min(std::max<size_t>(rank, 1), sorted.size()) - 1];
+}
+
+TimingStats TimingStats::from_samples(std::vector<double> samples_ms) {
+    TimingStats stats;
+    stats.samples = samples_ms.size();
+    if (samples_ms.empty()) {
+        return stats;
+    }
+
+    std::sort(samples_ms.begin(), samples_ms.end());
+    size_t n = samples_ms.size();
+    stats.min_ms = samples_ms.front();
+    stats.max_ms = samples_ms.back();
+    stats.median_ms = n % 2 ? samples_ms[n / 2] : (samples_ms[n / 2 - 1] + samples_ms[n / 2]) / 2.0;
+    stats.p95_ms = percentile(samples_ms, 0.95);
+    stats.p99_ms = percentile(samples_ms, 0.99);
+
+    double sum = 0.0;
+    for (double sample : samples_ms) {
+        sum += sample;
+    }
+    stats.mean_ms = sum / n;
+
+    double squares = 0.0;
+    for (double sample : samples_ms) {
+        squares += (sample - stats.mean_ms) * (sample - stats.mean_ms);
+    }
+    stats.stddev_ms = n > 1 ? std::sqrt(squares / (n - 1)) : 0.0;
+
+    double half_width = student_t_critical_95(n - 1) * stats.stddev_ms / std::sqrt(static_cast<double>(n));
+    stats.ci_low_ms = stats.mean_ms - half_width;
+    stats.ci_high_ms = stats.mean_ms + half_width;
+    return stats;
+}
+
+void TimingStats::set_throughput(size_t input_rows, size_t input_bytes) {
+    if (median_ms <= 0.0) {
+        return;
+    }
+    rows_per_sec = input_rows * 1000.0 / median_ms;
+    bytes_per_sec = input_bytes * 1000.0 / median_ms;
+}
+
+std::string TimingStats::to_string() const {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3)
+        << "n=" << samples << " min=" << min_ms << " median=" << median_ms
+        << " p95=" << p95_ms << " p99=" << p99_ms << " max=" << max_ms
+        << " mean=" << mean_ms << " [" << ci_low_ms << ", " << ci_high_ms << "]ms"
+        << std::setprecision(0) << " " << rows_per_sec << " rows/s "
+        << bytes_per_sec / (1024.0 * 1024.0) << " MB/s";
+    return out.str();
+}
+
+bool pin_current_thread(int cpu) {
+#ifdef __linux__
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
 
 void DataGenerator::generate_large_dataset(TableManager& tm, size_t users_count, size_t orders_count) {
     TableSchema users_schema;
@@ -14,17 +113,16 @@ void DataGenerator::generate_large_dataset(TableManager& tm, size_t users_count,
     tm.create_table("users", users_schema);
     auto users = tm.get_table("users");
     
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    std::mt19937 gen(static_cast<std::mt19937::result_type>(seed));
     std::uniform_int_distribution<> age_dist(18, 65);
     std::uniform_int_distribution<> city_dist(1, 20);
     
     for (size_t i = 1; i <= users_count; ++i) {
         Row row;
         row.add_value(static_cast<int>(i));
-        row.add_value(std::string("User") + std::to_string(i));
+        row.add_value(users->make_string("User" + std::to_string(i)));
         row.add_value(age_dist(gen));
-        row.add_value(std::string("City") + std::to_string(city_dist(gen)));
+        row.add_value(users->make_string("City" + std::to_string(city_dist(gen))));
         users->add_row(row);
     }
     
@@ -45,7 +143,7 @@ void DataGenerator::generate_large_dataset(TableManager& tm, size_t users_count,
         Row row;
         row.add_value(static_cast<int>(i));
         row.add_value(user_dist(gen));
-        row.add_value(std::string("Product") + std::to_string(product_dist(gen)));
+        row.add_value(orders->make_string("Product" + std::to_string(product_dist(gen))));
         row.add_value(amount_dist(gen));
         orders->add_row(row);
     }
@@ -57,8 +155,8 @@ void DataGenerator::generate_skewed_dataset(TableManager& tm, size_t users_count
     auto orders = tm.get_table("orders");
     orders->clear();
     
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    // Distinct stream from the base dataset so the two do not correlate.
+    std::mt19937 gen(static_cast<std::mt19937::result_type>(seed + 1));
     std::uniform_int_distribution<> product_dist(1, 200);
     std::uniform_int_distribution<> amount_dist(10, 1000);
     
@@ -75,7 +173,7 @@ void DataGenerator::generate_skewed_dataset(TableManager& tm, size_t users_count
         }
         
         row.add_value(user_id);
-        row.add_value(std::string("Product") + std::to_string(product_dist(gen)));
+        row.add_value(orders->make_string("Product" + std::to_string(product_dist(gen))));
         row.add_value(amount_dist(gen));
         orders->add_row(row);
     }
@@ -85,18 +183,107 @@ void DataGenerator::generate_uniform_dataset(TableManager& tm, size_t users_coun
     generate_large_dataset(tm, users_count, orders_count);
 }
 
-QueryBenchmark::QueryBenchmark(TableManager* tm) 
-    : table_manager(tm), executor(tm) {}
+QueryBenchmark::QueryBenchmark(TableManager* tm, const BenchmarkOptions& opts) 
+    : table_manager(tm), executor(tm), options(opts) {
+    // Timed runs read perf_counters; the memory run does not need its own.
+    executor.set_hardware_counters(false);
+}
 
-double QueryBenchmark::measure_execution_time(const PlanNode& plan) {
-    auto start = std::chrono::high_resolution_clock::now();
-    
-    auto result = executor.execute(plan);
+void QueryBenchmark::scanned_input(const PlanNode& plan, size_t& rows, size_t& bytes) const {
+    if (plan.type == PlanNodeType::TABLE_SCAN) {
+        const auto& scan = static_cast<const TableScanNode&>(plan);
+        if (Table* table = table_manager->get_table(scan.table_name)) {
+            rows += table->row_count();
+            bytes += table->row_count() * table->get_schema().column_names.size() * sizeof(Value) +
+                     table->string_bytes();
+        }
+    }
+    for (const auto& child : plan.children) {
+        scanned_input(*child, rows, bytes);
+    }
+}
+
+TimingStats QueryBenchmark::measure_execution_time(const PlanNode& plan) {
+    if (options.pin_cpu >= 0 && !pinned) {
+        pinned = pin_current_thread(options.pin_cpu);
+    }
+
+    for (size_t i = 0; i < options.warmup_runs; ++i) {
+        executor.execute(plan);
+    }
+
+    std::vector<double> samples;
+    size_t repetitions = std::max<size_t>(options.repetitions, 1);
+    for (size_t i = 0; i < repetitions; ++i) {
+        PerfCounts counters_start = perf_counters.read();
+        auto start = std::chrono::steady_clock::now();
+        
+        auto result = executor.execute(plan);
+        
+        auto end = std::chrono::steady_clock::now();
+        last_counters = perf_counters.read() - counters_start;
+        last_result_size = result->size();
+        samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+
+    TimingStats stats = TimingStats::from_samples(std::move(samples));
+    size_t input_rows = 0;
+    size_t input_bytes = 0;
+    scanned_input(plan, input_rows, input_bytes);
+    stats.set_throughput(input_rows, input_bytes);
+    last_memory = measure_memory(plan);
+    return stats;
+}
+
+static void collect_operator_memory(const PlanNode& node, const QueryProfile& profile, size_t depth,
+                                    std::vector<OperatorMemory>& out) {
+    if (const OperatorProfile* op = profile.get(node)) {
+        OperatorMemory entry;
+        entry.label = QueryProfile::operator_label(node);
+        entry.depth = depth;
+        entry.allocated_bytes = op->allocated_bytes;
+        entry.allocations = op->allocations;
+        entry.peak_bytes = op->peak_bytes;
+        for (const auto& child : node.children) {
+            if (const OperatorProfile* child_op = profile.get(*child)) {
+                entry.allocated_bytes -= std::min(entry.allocated_bytes, child_op->allocated_bytes);
+                entry.allocations -= std::min(entry.allocations, child_op->allocations);
+            }
+        }
+        out.push_back(entry);
+    }
+    for (const auto& child : node.children) {
+        collect_operator_memory(*child, profile, depth + 1, out);
+    }
+}
+
+MemoryStats QueryBenchmark::measure_memory(const PlanNode& plan) {
+    MemoryStats stats;
+    stats.rss_peak_reset = reset_peak_rss();
+    AllocationCounter::reset_peak();
+    AllocationStats before = AllocationCounter::read();
     
-    auto end = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    QueryProfile profile = executor.explain_analyze(plan);
     
-    return duration.count() / 1000.0;
+    AllocationStats after = AllocationCounter::read();
+    stats.peak_rss_bytes = peak_rss_bytes();
+    stats.allocated_bytes = after.bytes_allocated - before.bytes_allocated;
+    stats.allocations = after.allocations - before.allocations;
+    stats.peak_heap_bytes = after.peak_bytes - std::min(after.peak_bytes, before.current_bytes);
+    stats.context_peak_bytes = executor.get_last_memory_usage().peak_bytes;
+    collect_operator_memory(plan, profile, 0, stats.operators);
+    return stats;
+}
+
+std::string MemoryStats::to_string() const {
+    std::ostringstream out;
+    out << "rss_peak=" << peak_rss_bytes / 1024 << "KB" << (rss_peak_reset ? "" : " (process)")
+        << " context_peak=" << context_peak_bytes << "B";
+    if (allocations > 0) {
+        out << " heap_peak=" << peak_heap_bytes << "B allocated=" << allocated_bytes << "B in "
+            << allocations << " allocations";
+    }
+    return out.str();
 }
 
 void QueryBenchmark::run_single_table_benchmarks() {
@@ -130,16 +317,14 @@ void QueryBenchmark::run_single_table_benchmarks() {
         }
         
         auto plan = optimizer.optimize(filter_stmt);
-        double exec_time = measure_execution_time(*plan);
-        
-        auto result = executor.execute(*plan);
+        TimingStats timing = measure_execution_time(*plan);
         
         results.emplace_back("SingleTable_" + condition, "Optimized", 
-                           exec_time, plan->cost.total_cost, result->size());
+                           timing, plan->cost.total_cost, last_result_size, last_counters, last_memory);
         
         std::cout << "Query: " << condition 
-                  << " | Time: " << std::fixed << std::setprecision(2) << exec_time << "ms"
-                  << " | Results: " << result->size() << std::endl;
+                  << " | Time: " << std::fixed << std::setprecision(2) << timing.median_ms << "ms"
+                  << " | Results: " << last_result_size << std::endl;
     }
 }
 
@@ -149,7 +334,8 @@ void QueryBenchmark::compare_join_algorithms(const SelectStatement& stmt) {
     std::vector<std::pair<PlanNodeType, std::string>> algorithms = {
         {PlanNodeType::NESTED_LOOP_JOIN, "NestedLoop"},
         {PlanNodeType::HASH_JOIN, "HashJoin"},
-        {PlanNodeType::SORT_MERGE_JOIN, "SortMerge"}
+        {PlanNodeType::SORT_MERGE_JOIN, "SortMerge"},
+        {PlanNodeType::ADAPTIVE_JOIN, "Adaptive"}
     };
     
     for (const auto& [algo_type, algo_name] : algorithms) {
@@ -171,15 +357,15 @@ void QueryBenchmark::compare_join_algorithms(const SelectStatement& stmt) {
             auto cost = cost_model.estimate_plan_cost(*plan);
             plan->cost = cost;
             
-            double exec_time = measure_execution_time(*plan);
-            auto result = executor.execute(*plan);
+            TimingStats timing = measure_execution_time(*plan);
             
-            results.emplace_back("Join", algo_name, exec_time, cost.total_cost, result->size());
+            results.emplace_back("Join", algo_name, timing, cost.total_cost, last_result_size, last_counters,
+                                 last_memory);
             
             std::cout << algo_name 
-                      << " | Time: " << std::fixed << std::setprecision(2) << exec_time << "ms"
+                      << " | Time: " << std::fixed << std::setprecision(2) << timing.median_ms << "ms"
                       << " | Cost: " << cost.total_cost
-                      << " | Results: " << result->size() << std::endl;
+                      << " | Results: " << last_result_size << std::endl;
                       
         } catch (const std::exception& e) {
             std::cout << algo_name << " | ERROR: " << e.what() << std::endl;
@@ -236,15 +422,14 @@ void QueryBenchmark::run_scalability_benchmarks() {
         join_stmt.select_list.push_back(std::move(all_item));
         
         auto best_plan = optimizer.optimize(join_stmt);
-        double exec_time = measure_execution_time(*best_plan);
-        auto result = executor.execute(*best_plan);
+        TimingStats timing = measure_execution_time(*best_plan);
         
         results.emplace_back("Scalability_" + std::to_string(users) + "_" + std::to_string(orders), 
-                           "Optimized", exec_time, best_plan->cost.total_cost, result->size());
+                           "Optimized", timing, best_plan->cost.total_cost, last_result_size, last_counters, last_memory);
         
         std::cout << "Dataset: " << users << " users, " << orders << " orders"
-                  << " | Time: " << std::fixed << std::setprecision(2) << exec_time << "ms"
-                  << " | Results: " << result->size() << std::endl;
+                  << " | Time: " << std::fixed << std::setprecision(2) << timing.median_ms << "ms"
+                  << " | Results: " << last_result_size << std::endl;
     }
 }
 
@@ -277,15 +462,58 @@ void QueryBenchmark::benchmark_data_distributions() {
         join_stmt.select_list.push_back(std::move(all_item));
         
         auto best_plan = optimizer.optimize(join_stmt);
-        double exec_time = measure_execution_time(*best_plan);
-        auto result = executor.execute(*best_plan);
+        TimingStats timing = measure_execution_time(*best_plan);
         
         results.emplace_back("Distribution_" + dist_name, "Optimized", 
-                           exec_time, best_plan->cost.total_cost, result->size());
+                           timing, best_plan->cost.total_cost, last_result_size, last_counters, last_memory);
         
         std::cout << dist_name << " distribution"
-                  << " | Time: " << std::fixed << std::setprecision(2) << exec_time << "ms"
-                  << " | Results: " << result->size() << std::endl;
+                  << " | Time: " << std::fixed << std::setprecision(2) << timing.median_ms << "ms"
+                  << " | Results: " << last_result_size << std::endl;
+    }
+}
+
+void QueryBenchmark::run_tpch_benchmarks(double scale_factor) {
+    std::cout << "\n=== TPC-H Benchmarks (SF " << scale_factor << ") ===" << std::endl;
+    
+    TpchGenerator generator(scale_factor, DataGenerator::get_seed());
+    generator.generate(*table_manager);
+    TpchGenerator::register_statistics(*table_manager, optimizer);
+    set_dataset_parameter("tpch_scale_factor", std::to_string(scale_factor));
+    
+    bool check_reference = scale_factor == TpchGenerator::REFERENCE_SCALE_FACTOR &&
+                           DataGenerator::get_seed() == TpchGenerator::DEFAULT_SEED;
+    
+    for (const auto& query : TpchGenerator::queries()) {
+        std::string name = std::string("TPCH_Q") + (query.number < 10 ? "0" : "") + std::to_string(query.number);
+        try {
+            Tokenizer tokenizer(query.sql);
+            Parser parser(tokenizer.tokenize());
+            auto stmt = parser.parseSelectStatement();
+            auto plan = optimizer.optimize(*stmt);
+            
+            // The checksum run doubles as the first warmup run.
+            ResultChecksum checksum = checksum_rows(executor.execute(*plan)->get_rows());
+            BenchmarkOptions saved = options;
+            if (options.warmup_runs > 0) {
+                options.warmup_runs--;
+            }
+            TimingStats timing = measure_execution_time(*plan);
+            options = saved;
+            
+            results.emplace_back(name, "Optimized", timing, plan->cost.total_cost, last_result_size, last_counters,
+                                 last_memory);
+            
+            std::cout << name
+                      << " | Time: " << std::fixed << std::setprecision(2) << timing.median_ms << "ms"
+                      << " | Results: " << last_result_size;
+            if (check_reference) {
+                std::cout << " | Checksum: " << (checksum == query.reference ? "ok" : "MISMATCH");
+            }
+            std::cout << std::endl;
+        } catch (const std::exception& e) {
+            std::cout << name << " | ERROR: " << e.what() << std::endl;
+        }
     }
 }
 
@@ -304,6 +532,27 @@ void QueryBenchmark::print_results() const {
                   << std::fixed << std::setprecision(2) << std::setw(12) << result.execution_time_ms
                   << std::setw(15) << result.estimated_cost
                   << std::setw(12) << result.result_size << std::endl;
+        if (result.timing.samples > 0) {
+            std::cout << "    " << result.timing.to_string() << std::endl;
+        }
+        if (!result.counters.empty()) {
+            std::cout << "    " << result.counters.to_string() << std::endl;
+        }
+        if (result.memory.peak_rss_bytes > 0 || result.memory.allocations > 0) {
+            std::cout << "    " << result.memory.to_string() << std::endl;
+            for (const auto& op : result.memory.operators) {
+                if (op.allocations == 0 && op.peak_bytes == 0) {
+                    continue;
+                }
+                std::cout << "      " << std::string(op.depth * 2, ' ') << op.label
+                          << ": allocated=" << op.allocated_bytes << "B/" << op.allocations
+                          << " peak=" << op.peak_bytes << "B" << std::endl;
+            }
+        }
+    }
+    
+    if (!perf_counters.available()) {
+        std::cout << "Hardware counters unavailable (" << perf_counters.unavailable_reason() << ")" << std::endl;
     }
 }
 
@@ -329,4 +578,48 @@ void QueryBenchmark::print_summary() const {
     if (join_count > 0) {
         std::cout << "Average join time: " << std::fixed << std::setprecision(2) << (join_time / join_count) << "ms" << std::endl;
     }
-}
\ No newline at end of file
+}
+void QueryBenchmark::set_dataset_parameter(const std::string& key, const std::string& value) {
+    for (auto& parameter : dataset_parameters) {
+        if (parameter.first == key) {
+            parameter.second = value;
+            return;
+        }
+    }
+    dataset_parameters.emplace_back(key, value);
+}
+
+void QueryBenchmark::export_csv(const std::string& filename) const {
+    std::ofstream out(filename);
+    if (!out) {
+        throw std::runtime_error("Cannot write benchmark results to " + filename);
+    }
+    
+    out << "query,plan,estimated_cost,result_size,samples,min_ms,median_ms,mean_ms,p95_ms,p99_ms,max_ms,"
+        << "ci_low_ms,ci_high_ms,rows_per_sec,bytes_per_sec" << std::endl;
+    for (const auto& result : results) {
+        const TimingStats& t = result.timing;
+        out << '"' << result.query_name << "\",\"" << result.plan_type << "\","
+            << result.estimated_cost << "," << result.result_size << "," << t.samples << ","
+            << t.min_ms << "," << t.median_ms << "," << t.mean_ms << "," << t.p95_ms << ","
+            << t.p99_ms << "," << t.max_ms << "," << t.ci_low_ms << "," << t.ci_high_ms << ","
+            << t.rows_per_sec << "," << t.bytes_per_sec << std::endl;
+    }
+}
+
+void QueryBenchmark::export_json(const std::string& filename) const {
+    BenchmarkReport report;
+    report.metadata = BenchmarkMetadata::collect();
+    report.metadata.parameters.emplace_back("seed", std::to_string(DataGenerator::get_seed()));
+    report.metadata.parameters.emplace_back("warmup_runs", std::to_string(options.warmup_runs));
+    report.metadata.parameters.emplace_back("repetitions", std::to_string(options.repetitions));
+    report.metadata.parameters.emplace_back("pin_cpu", std::to_string(options.pin_cpu));
+    for (const auto& parameter : dataset_parameters) {
+        report.metadata.parameters.push_back(parameter);
+    }
+    
+    for (const auto& result : results) {
+        report.add_result(result);
+    }
+    report.save(filename);
+}
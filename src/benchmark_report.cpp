@@ -0,0 +1,467 @@
+#include "benchmark_report.h"
+#include "string_util.h"
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+static std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    size_t end = text.find_last_not_of(" \t\r\n");
+    return begin == std::string::npos ? "" : text.substr(begin, end - begin + 1);
+}
+
+static std::string read_git_revision() {
+#ifdef QO_GIT_REVISION
+    return QO_GIT_REVISION;
+#else
+    std::string revision;
+    if (FILE* pipe = popen("git rev-parse HEAD 2>/dev/null", "r")) {
+        char buffer[128];
+        while (fgets(buffer, sizeof(buffer), pipe)) {
+            revision += buffer;
+        }
+        pclose(pipe);
+    }
+    revision = trim(revision);
+    return revision.empty() ? "unknown" : revision;
+#endif
+}
+
+static std::string compiler_description() {
+    std::string name;
+#if defined(__clang__)
+    name = "clang " __clang_version__;
+#elif defined(__GNUC__)
+    name = "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+    name = "msvc " + std::to_string(_MSC_VER);
+#else
+    name = "unknown";
+#endif
+#ifdef __OPTIMIZE__
+    name += " (optimized)";
+#else
+    name += " (unoptimized)";
+#endif
+    return name;
+}
+
+static std::string read_cpu_model() {
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.compare(0, 10, "model name") == 0) {
+            size_t colon = line.find(':');
+            if (colon != std::string::npos) {
+                return trim(line.substr(colon + 1));
+            }
+        }
+    }
+    return "unknown";
+}
+
+BenchmarkMetadata BenchmarkMetadata::collect() {
+    BenchmarkMetadata metadata;
+    metadata.git_revision = read_git_revision();
+    metadata.compiler = compiler_description();
+    metadata.cpu_model = read_cpu_model();
+
+    std::time_t now = std::time(nullptr);
+    std::tm utc = *std::gmtime(&now);
+    char buffer[32];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &utc);
+    metadata.timestamp = buffer;
+    return metadata;
+}
+
+std::string BenchmarkMetadata::get_parameter(const std::string& key) const {
+    for (const auto& parameter : parameters) {
+        if (parameter.first == key) {
+            return parameter.second;
+        }
+    }
+    return "";
+}
+
+void BenchmarkReport::add_result(const BenchmarkResult& result) {
+    BenchmarkEntry entry;
+    entry.query_name = result.query_name;
+    entry.plan_type = result.plan_type;
+    entry.estimated_cost = result.estimated_cost;
+    entry.result_size = result.result_size;
+    entry.timing = result.timing;
+    entry.memory = result.memory;
+    entry.memory.operators.clear();
+    if (entry.timing.samples == 0) {
+        // Single timing recorded without the harness.
+        entry.timing = TimingStats::from_samples({result.execution_time_ms});
+    }
+    entries.push_back(entry);
+}
+
+static std::string json_number(double value) {
+    if (!std::isfinite(value)) {
+        return "0";
+    }
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+    return buffer;
+}
+
+std::string BenchmarkReport::to_json() const {
+    std::string out = "{\n";
+    out += "  \"format\": " + json_string(FORMAT) + ",\n";
+    out += "  \"metadata\": {\n";
+    out += "    \"git_revision\": " + json_string(metadata.git_revision) + ",\n";
+    out += "    \"compiler\": " + json_string(metadata.compiler) + ",\n";
+    out += "    \"cpu_model\": " + json_string(metadata.cpu_model) + ",\n";
+    out += "    \"timestamp\": " + json_string(metadata.timestamp) + ",\n";
+    out += "    \"parameters\": {";
+    for (size_t i = 0; i < metadata.parameters.size(); ++i) {
+        out += i == 0 ? "\n" : ",\n";
+        out += "      " + json_string(metadata.parameters[i].first) + ": " +
+               json_string(metadata.parameters[i].second);
+    }
+    out += metadata.parameters.empty() ? "}\n" : "\n    }\n";
+    out += "  },\n";
+
+    out += "  \"results\": [";
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const BenchmarkEntry& entry = entries[i];
+        const TimingStats& t = entry.timing;
+        out += i == 0 ? "\n" : ",\n";
+        out += "    {\"query\": " + json_string(entry.query_name) +
+               ", \"plan\": " + json_string(entry.plan_type) +
+               ", \"estimated_cost\": " + json_number(entry.estimated_cost) +
+               ", \"result_size\": " + std::to_string(entry.result_size) +
+               ", \"samples\": " + std::to_string(t.samples) +
+               ", \"min_ms\": " + json_number(t.min_ms) +
+               ", \"median_ms\": " + json_number(t.median_ms) +
+               ", \"mean_ms\": " + json_number(t.mean_ms) +
+               ", \"p95_ms\": " + json_number(t.p95_ms) +
+               ", \"p99_ms\": " + json_number(t.p99_ms) +
+               ", \"max_ms\": " + json_number(t.max_ms) +
+               ", \"stddev_ms\": " + json_number(t.stddev_ms) +
+               ", \"ci_low_ms\": " + json_number(t.ci_low_ms) +
+               ", \"ci_high_ms\": " + json_number(t.ci_high_ms) +
+               ", \"rows_per_sec\": " + json_number(t.rows_per_sec) +
+               ", \"bytes_per_sec\": " + json_number(t.bytes_per_sec) +
+               ", \"peak_rss_bytes\": " + std::to_string(entry.memory.peak_rss_bytes) +
+               ", \"peak_heap_bytes\": " + std::to_string(entry.memory.peak_heap_bytes) +
+               ", \"allocated_bytes\": " + std::to_string(entry.memory.allocated_bytes) +
+               ", \"allocations\": " + std::to_string(entry.memory.allocations) + "}";
+    }
+    out += entries.empty() ? "]\n" : "\n  ]\n";
+    out += "}\n";
+    return out;
+}
+
+namespace {
+
+// Just enough JSON to read back what to_json writes.
+struct JsonValue {
+    enum Kind { NULL_VALUE, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT } kind = NULL_VALUE;
+    bool boolean = false;
+    double number = 0.0;
+    std::string text;
+    std::vector<JsonValue> items;
+    std::vector<std::pair<std::string, JsonValue>> fields;
+
+    const JsonValue* find(const std::string& name) const {
+        for (const auto& field : fields) {
+            if (field.first == name) {
+                return &field.second;
+            }
+        }
+        return nullptr;
+    }
+
+    double number_field(const std::string& name) const {
+        const JsonValue* value = find(name);
+        return value && value->kind == NUMBER ? value->number : 0.0;
+    }
+
+    std::string string_field(const std::string& name) const {
+        const JsonValue* value = find(name);
+        return value && value->kind == STRING ? value->text : "";
+    }
+};
+
+class JsonReader {
+private:
+    const std::string& input;
+    size_t pos = 0;
+
+    [[noreturn]] void fail(const std::string& message) const {
+        throw std::runtime_error("Invalid benchmark JSON at offset " + std::to_string(pos) + ": " + message);
+    }
+
+    void skip_whitespace() {
+        while (pos < input.size() && std::isspace(static_cast<unsigned char>(input[pos]))) {
+            ++pos;
+        }
+    }
+
+    void expect(char c) {
+        skip_whitespace();
+        if (pos >= input.size() || input[pos] != c) {
+            fail(std::string("expected '") + c + "'");
+        }
+        ++pos;
+    }
+
+    bool consume(const char* word) {
+        size_t length = std::char_traits<char>::length(word);
+        if (input.compare(pos, length, word) == 0) {
+            pos += length;
+            return true;
+        }
+        return false;
+    }
+
+    std::string parse_string() {
+        expect('"');
+        std::string out;
+        while (pos < input.size() && input[pos] != '"') {
+            char c = input[pos++];
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos >= input.size()) {
+                fail("unterminated escape");
+            }
+            char escaped = input[pos++];
+            switch (escaped) {
+                case 'n': out += '\n'; break;
+                case 't': out += '\t'; break;
+                case 'r': out += '\r'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'u':
+                    if (pos + 4 > input.size()) {
+                        fail("short unicode escape");
+                    }
+                    // Only the control characters to_json escapes are expected here.
+                    out += static_cast<char>(std::stoi(input.substr(pos, 4), nullptr, 16));
+                    pos += 4;
+                    break;
+                default: out += escaped;
+            }
+        }
+        if (pos >= input.size()) {
+            fail("unterminated string");
+        }
+        ++pos;
+        return out;
+    }
+
+public:
+    explicit JsonReader(const std::string& text) : input(text) {}
+
+    JsonValue parse_value() {
+        skip_whitespace();
+        if (pos >= input.size()) {
+            fail("unexpected end of input");
+        }
+
+        JsonValue value;
+        char c = input[pos];
+        if (c == '{') {
+            value.kind = JsonValue::OBJECT;
+            ++pos;
+            skip_whitespace();
+            if (pos < input.size() && input[pos] == '}') {
+                ++pos;
+                return value;
+            }
+            do {
+                std::string name = parse_string();
+                expect(':');
+                value.fields.emplace_back(name, parse_value());
+                skip_whitespace();
+            } while (pos < input.size() && input[pos] == ',' && ++pos);
+            expect('}');
+        } else if (c == '[') {
+            value.kind = JsonValue::ARRAY;
+            ++pos;
+            skip_whitespace();
+            if (pos < input.size() && input[pos] == ']') {
+                ++pos;
+                return value;
+            }
+            do {
+                value.items.push_back(parse_value());
+                skip_whitespace();
+            } while (pos < input.size() && input[pos] == ',' && ++pos);
+            expect(']');
+        } else if (c == '"') {
+            value.kind = JsonValue::STRING;
+            value.text = parse_string();
+        } else if (consume("true")) {
+            value.kind = JsonValue::BOOLEAN;
+            value.boolean = true;
+        } else if (consume("false")) {
+            value.kind = JsonValue::BOOLEAN;
+        } else if (consume("null")) {
+            value.kind = JsonValue::NULL_VALUE;
+        } else {
+            size_t used = 0;
+            try {
+                value.number = std::stod(input.substr(pos, 32), &used);
+            } catch (const std::exception&) {
+                fail("expected a value");
+            }
+            value.kind = JsonValue::NUMBER;
+            pos += used;
+        }
+        return value;
+    }
+
+    void finish() {
+        skip_whitespace();
+        if (pos != input.size()) {
+            fail("trailing characters");
+        }
+    }
+};
+
+}
+
+BenchmarkReport BenchmarkReport::from_json(const std::string& text) {
+    JsonReader reader(text);
+    JsonValue root = reader.parse_value();
+    reader.finish();
+
+    if (root.kind != JsonValue::OBJECT || root.string_field("format") != FORMAT) {
+        throw std::runtime_error("Not a benchmark result file (expected format " + std::string(FORMAT) + ")");
+    }
+
+    BenchmarkReport report;
+    if (const JsonValue* metadata = root.find("metadata")) {
+        report.metadata.git_revision = metadata->string_field("git_revision");
+        report.metadata.compiler = metadata->string_field("compiler");
+        report.metadata.cpu_model = metadata->string_field("cpu_model");
+        report.metadata.timestamp = metadata->string_field("timestamp");
+        if (const JsonValue* parameters = metadata->find("parameters")) {
+            for (const auto& field : parameters->fields) {
+                report.metadata.parameters.emplace_back(field.first, field.second.text);
+            }
+        }
+    }
+
+    if (const JsonValue* results = root.find("results")) {
+        for (const JsonValue& item : results->items) {
+            BenchmarkEntry entry;
+            entry.query_name = item.string_field("query");
+            entry.plan_type = item.string_field("plan");
+            entry.estimated_cost = item.number_field("estimated_cost");
+            entry.result_size = static_cast<size_t>(item.number_field("result_size"));
+            TimingStats& t = entry.timing;
+            t.samples = static_cast<size_t>(item.number_field("samples"));
+            t.min_ms = item.number_field("min_ms");
+            t.median_ms = item.number_field("median_ms");
+            t.mean_ms = item.number_field("mean_ms");
+            t.p95_ms = item.number_field("p95_ms");
+            t.p99_ms = item.number_field("p99_ms");
+            t.max_ms = item.number_field("max_ms");
+            t.stddev_ms = item.number_field("stddev_ms");
+            t.ci_low_ms = item.number_field("ci_low_ms");
+            t.ci_high_ms = item.number_field("ci_high_ms");
+            t.rows_per_sec = item.number_field("rows_per_sec");
+            t.bytes_per_sec = item.number_field("bytes_per_sec");
+            entry.memory.peak_rss_bytes = static_cast<size_t>(item.number_field("peak_rss_bytes"));
+            entry.memory.peak_heap_bytes = static_cast<uint64_t>(item.number_field("peak_heap_bytes"));
+            entry.memory.allocated_bytes = static_cast<uint64_t>(item.number_field("allocated_bytes"));
+            entry.memory.allocations = static_cast<uint64_t>(item.number_field("allocations"));
+            report.entries.push_back(entry);
+        }
+    }
+    return report;
+}
+
+void BenchmarkReport::save(const std::string& filename) const {
+    std::ofstream out(filename);
+    if (!out) {
+        throw std::runtime_error("Cannot write benchmark results to " + filename);
+    }
+    out << to_json();
+}
+
+BenchmarkReport BenchmarkReport::load(const std::string& filename) {
+    std::ifstream in(filename);
+    if (!in) {
+        throw std::runtime_error("Cannot read benchmark results from " + filename);
+    }
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    return from_json(buffer.str());
+}
+
+static void welch_test(const TimingStats& a, const TimingStats& b, double& t, bool& significant) {
+    double va = a.samples > 1 ? a.stddev_ms * a.stddev_ms / a.samples : 0.0;
+    double vb = b.samples > 1 ? b.stddev_ms * b.stddev_ms / b.samples : 0.0;
+    double se = std::sqrt(va + vb);
+    if (se == 0.0) {
+        // No spread to judge against; only a single run on either side.
+        t = 0.0;
+        significant = a.samples > 1 && b.samples > 1 && a.mean_ms != b.mean_ms;
+        return;
+    }
+
+    t = (b.mean_ms - a.mean_ms) / se;
+    double df_denominator = 0.0;
+    if (a.samples > 1) df_denominator += va * va / (a.samples - 1);
+    if (b.samples > 1) df_denominator += vb * vb / (b.samples - 1);
+    double df = df_denominator > 0.0 ? (va + vb) * (va + vb) / df_denominator : 1.0;
+    significant = std::fabs(t) > student_t_critical_95(static_cast<size_t>(std::max(1.0, std::floor(df))));
+}
+
+std::vector<BenchmarkComparison> compare_reports(const BenchmarkReport& baseline,
+                                                 const BenchmarkReport& current,
+                                                 double min_change) {
+    std::map<std::string, std::vector<const BenchmarkEntry*>> pending;
+    for (const auto& entry : baseline.entries) {
+        pending[entry.key()].push_back(&entry);
+    }
+
+    std::vector<BenchmarkComparison> comparisons;
+    for (const auto& entry : current.entries) {
+        BenchmarkComparison comparison;
+        comparison.key = entry.key();
+        comparison.current_ms = entry.timing.median_ms;
+
+        auto& candidates = pending[comparison.key];
+        if (candidates.empty()) {
+            comparison.missing = true;
+            comparisons.push_back(comparison);
+            continue;
+        }
+        const BenchmarkEntry* before = candidates.front();
+        candidates.erase(candidates.begin());
+
+        comparison.baseline_ms = before->timing.median_ms;
+        comparison.change = comparison.baseline_ms > 0.0
+            ? comparison.current_ms / comparison.baseline_ms - 1.0 : 0.0;
+        welch_test(before->timing, entry.timing, comparison.t_statistic, comparison.significant);
+        comparison.regression = comparison.significant && comparison.change > min_change;
+        comparison.improvement = comparison.significant && comparison.change < -min_change;
+        comparisons.push_back(comparison);
+    }
+
+    for (const auto& [key, left] : pending) {
+        for (const BenchmarkEntry* entry : left) {
+            BenchmarkComparison comparison;
+            comparison.key = key;
+            comparison.baseline_ms = entry->timing.median_ms;
+            comparison.missing = true;
+            comparisons.push_back(comparison);
+        }
+    }
+    return comparisons;
+}
@@ -0,0 +1,298 @@
+#include "codegen.h"
+#include "string_util.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <dlfcn.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+std::string CodegenOptions::default_cache_dir() {
+    return "/tmp/qo_codegen-" + std::to_string(geteuid());
+}
+
+// Another user able to write the cache directory or a library in it could
+// plant code for dlopen to run, so both must belong to us and be writable
+// by no one else. lstat keeps a planted symlink from passing the check.
+static bool private_directory(const std::string& path) {
+    if (mkdir(path.c_str(), 0700) != 0 && errno != EEXIST) {
+        return false;
+    }
+    struct stat info;
+    return lstat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode) && info.st_uid == geteuid() &&
+           (info.st_mode & 077) == 0;
+}
+
+static bool trusted_file(const std::string& path) {
+    struct stat info;
+    return lstat(path.c_str(), &info) == 0 && S_ISREG(info.st_mode) && info.st_uid == geteuid() &&
+           (info.st_mode & 022) == 0;
+}
+
+// Libraries on disk outlive the process that built them. Folding the
+// compiler, its flags and every header the generated code can include into
+// their names keeps a rebuild with a different Value or Row layout from
+// loading code compiled against the old one.
+static std::string compute_build_id(const CodegenOptions& options) {
+    uint64_t hash = fnv1a(options.compiler);
+    hash = fnv1a("\n" + options.compile_flags, hash);
+    hash = fnv1a("\n" __VERSION__, hash);
+
+    std::vector<std::filesystem::path> headers;
+    std::error_code ec;
+    for (std::filesystem::directory_iterator it(options.include_dir, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->path().extension() == ".h") {
+            headers.push_back(it->path());
+        }
+    }
+    std::sort(headers.begin(), headers.end());
+    for (const auto& header : headers) {
+        std::ifstream file(header, std::ios::binary);
+        std::ostringstream contents;
+        contents << file.rdbuf();
+        hash = fnv1a("\n" + header.filename().string() + "\n", hash);
+        hash = fnv1a(contents.str(), hash);
+    }
+
+    char buffer[17];
+    std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(hash));
+    return buffer;
+}
+
+PipelineCompiler::PipelineCompiler(const CodegenOptions& codegen_options)
+    : options(codegen_options), build_id(compute_build_id(codegen_options)) {}
+
+PipelineCompiler::~PipelineCompiler() {
+    for (void* handle : handles) {
+        dlclose(handle);
+    }
+}
+
+std::string PipelineCompiler::fingerprint(const std::string& source) {
+    uint64_t hash = fnv1a(source);
+    char buffer[17];
+    std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(hash));
+    return buffer;
+}
+
+static std::string escape_string_literal(std::string_view str) {
+    std::string result = "\"";
+    for (unsigned char c : str) {
+        if (c == '"' || c == '\\' || c < 0x20 || c >= 0x7f) {
+            char buffer[8];
+            std::snprintf(buffer, sizeof(buffer), "\\%03o", c);
+            result += buffer;
+        } else {
+            result += static_cast<char>(c);
+        }
+    }
+    return result + "\"";
+}
+
+static const char* comparison_operator(BinaryOperator op) {
+    switch (op) {
+        case BinaryOperator::EQUALS: return "==";
+        case BinaryOperator::NOT_EQUALS: return "!=";
+        case BinaryOperator::GREATER: return ">";
+        case BinaryOperator::LESS: return "<";
+        case BinaryOperator::GREATER_EQUAL: return ">=";
+        case BinaryOperator::LESS_EQUAL: return "<=";
+        default: return "==";
+    }
+}
+
+std::string PipelineCompiler::emit_value(const BoundExpression& expr, const TableSchema& schema) const {
+    if (expr.kind == BoundExpressionKind::COLUMN) {
+        return "row.get(" + std::to_string(expr.column_index) + ")";
+    }
+    if (expr.kind != BoundExpressionKind::CONSTANT) {
+        return "Value(static_cast<bool>(" + emit_predicate(expr, schema) + "))";
+    }
+
+    const Value& v = expr.constant;
+    switch (v.type()) {
+        case ValueType::INT:
+            return "Value(static_cast<int64_t>(" + std::to_string(v.as_int()) + "LL))";
+        case ValueType::DOUBLE: {
+            char buffer[40];
+            std::snprintf(buffer, sizeof(buffer), "%.17g", v.as_double());
+            return std::string("Value(") + buffer + ")";
+        }
+        case ValueType::BOOL:
+            return v.as_bool() ? "Value(true)" : "Value(false)";
+        case ValueType::DATE:
+            return "Value::date(" + std::to_string(v.as_date()) + ")";
+        case ValueType::STRING:
+            return "Value::string_ref(std::string_view(" + escape_string_literal(v.as_string()) + ", " +
+                   std::to_string(v.as_string().size()) + "))";
+        default:
+            return "Value()";
+    }
+}
+
+std::string PipelineCompiler::emit_predicate(const BoundExpression& expr, const TableSchema& schema) const {
+    switch (expr.kind) {
+        case BoundExpressionKind::AND:
+            return "(" + emit_predicate(*expr.left, schema) + " && " + emit_predicate(*expr.right, schema) + ")";
+        case BoundExpressionKind::OR:
+            return "(" + emit_predicate(*expr.left, schema) + " || " + emit_predicate(*expr.right, schema) + ")";
+        case BoundExpressionKind::COMPARISON: {
+            const auto& left = *expr.left;
+            const auto& right = *expr.right;
+            const char* op = comparison_operator(expr.op);
+
+            std::string left_code = emit_value(left, schema);
+            std::string right_code = emit_value(right, schema);
+            std::string generic = "(!" + left_code + ".is_null() && !" + right_code + ".is_null() && " +
+                                  left_code + ".compare(" + right_code + ") " + op + " 0)";
+
+            // Column-versus-constant comparisons on matching types compile to
+            // a raw integer or string_view comparison.
+            if (left.kind == BoundExpressionKind::COLUMN && right.kind == BoundExpressionKind::CONSTANT &&
+                left.column_index < schema.column_types.size()) {
+                const std::string& column_type = schema.column_types[left.column_index];
+                if (column_type == "int" && right.constant.type() == ValueType::INT) {
+                    return "(" + left_code + ".type() == ValueType::INT ? " + left_code + ".as_int() " + op +
+                           " " + std::to_string(right.constant.as_int()) + "LL : " + generic + ")";
+                }
+                if (column_type == "string" && right.constant.type() == ValueType::STRING) {
+                    auto str = right.constant.as_string();
+                    return "(" + left_code + ".type() == ValueType::STRING ? " + left_code + ".as_string() " + op +
+                           " std::string_view(" + escape_string_literal(str) + ", " +
+                           std::to_string(str.size()) + ") : " + generic + ")";
+                }
+            }
+            return generic;
+        }
+        default:
+            return emit_value(expr, schema) + ".as_bool()";
+    }
+}
+
+std::string PipelineCompiler::generate_source(const BoundPredicate* predicate, const TableSchema& schema,
+                                              const std::vector<size_t>* projection) const {
+    std::ostringstream out;
+    out << "// Generated by PipelineCompiler\n";
+    out << "#include \"table.h\"\n";
+    out << "#include <string_view>\n";
+    out << "#include <vector>\n\n";
+    out << "extern \"C\" void qo_pipeline(const Row* rows, size_t count, std::vector<Row>* out) {\n";
+    out << "    for (size_t i = 0; i < count; ++i) {\n";
+    out << "        const Row& row = rows[i];\n";
+
+    if (predicate) {
+        out << "        if (!" << emit_predicate(predicate->get_root(), schema) << ") continue;\n";
+    }
+
+    if (projection) {
+        out << "        Row projected;\n";
+        out << "        projected.values.reserve(" << projection->size() << ");\n";
+        for (size_t idx : *projection) {
+            out << "        projected.values.push_back(row.get(" << idx << "));\n";
+        }
+        out << "        out->push_back(std::move(projected));\n";
+    } else {
+        out << "        out->push_back(row);\n";
+    }
+
+    out << "    }\n";
+    out << "}\n";
+    return out.str();
+}
+
+PipelineCompiler::PipelineFunction PipelineCompiler::load(const std::string& library_path) {
+    if (!trusted_file(library_path)) {
+        return nullptr;
+    }
+
+    void* handle = dlopen(library_path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+        return nullptr;
+    }
+
+    auto function = reinterpret_cast<PipelineFunction>(dlsym(handle, "qo_pipeline"));
+    if (!function) {
+        dlclose(handle);
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    handles.push_back(handle);
+    return function;
+}
+
+PipelineCompiler::PipelineFunction PipelineCompiler::compile(const std::string& source) {
+    std::string key = fingerprint(source);
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        auto it = compiled.find(key);
+        if (it != compiled.end()) {
+            cache_hits++;
+            return it->second;
+        }
+        if (!in_flight.insert(key).second) {
+            return nullptr;
+        }
+    }
+
+    PipelineFunction function = build(key, source);
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    in_flight.erase(key);
+    compiled[key] = function;
+    return function;
+}
+
+PipelineCompiler::PipelineFunction PipelineCompiler::build(const std::string& key, const std::string& source) {
+    std::error_code ec;
+    std::filesystem::path cache_path(options.cache_dir);
+    if (cache_path.has_parent_path()) {
+        std::filesystem::create_directories(cache_path.parent_path(), ec);
+    }
+    if (!private_directory(options.cache_dir)) {
+        failures++;
+        return nullptr;
+    }
+
+    std::string base = options.cache_dir + "/qo_pipeline_" + build_id + "_" + key;
+    std::string library_path = base + ".so";
+
+    if (std::filesystem::exists(library_path, ec)) {
+        if (auto function = load(library_path)) {
+            cache_hits++;
+            return function;
+        }
+    }
+
+    std::string source_path = base + ".cpp";
+    {
+        std::ofstream file(source_path);
+        file << source;
+    }
+
+    // Compile to a private name and rename so concurrent processes never
+    // dlopen a half-written library.
+    std::string temp_path = base + ".tmp" + std::to_string(getpid()) + ".so";
+    std::string command = options.compiler + " " + options.compile_flags + " -I" + options.include_dir +
+                          " -o " + temp_path + " " + source_path + " > " + base + ".log 2>&1";
+
+    compilations++;
+    PipelineFunction function = nullptr;
+    if (std::system(command.c_str()) == 0) {
+        std::filesystem::rename(temp_path, library_path, ec);
+        if (!ec) {
+            function = load(library_path);
+        }
+    }
+
+    if (!function) {
+        failures++;
+        std::filesystem::remove(temp_path, ec);
+    }
+
+    return function;
+}
@@ -0,0 +1,283 @@
+#include "cost_calibration.h"
+#include "benchmark_report.h"
+#include "expression_binder.h"
+#include "table.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+
+// Keeps the optimizer from discarding the work being timed.
+static volatile size_t sink;
+
+std::vector<double> fit_least_squares(const std::vector<std::vector<double>>& features,
+                                      const std::vector<double>& targets) {
+    if (features.empty() || features.size() != targets.size()) {
+        throw std::runtime_error("Regression needs one target per feature row");
+    }
+    size_t k = features[0].size();
+
+    // Normal equations [X'X | X'y], solved with partial pivoting.
+    std::vector<std::vector<double>> system(k, std::vector<double>(k + 1, 0.0));
+    for (size_t r = 0; r < features.size(); ++r) {
+        for (size_t i = 0; i < k; ++i) {
+            for (size_t j = 0; j < k; ++j) {
+                system[i][j] += features[r][i] * features[r][j];
+            }
+            system[i][k] += features[r][i] * targets[r];
+        }
+    }
+
+    for (size_t col = 0; col < k; ++col) {
+        size_t pivot = col;
+        for (size_t row = col + 1; row < k; ++row) {
+            if (std::abs(system[row][col]) > std::abs(system[pivot][col])) {
+                pivot = row;
+            }
+        }
+        if (std::abs(system[pivot][col]) < 1e-12 * (1.0 + std::abs(system[col][col]))) {
+            throw std::runtime_error("Regression features are linearly dependent");
+        }
+        std::swap(system[col], system[pivot]);
+        for (size_t row = 0; row < k; ++row) {
+            if (row == col) continue;
+            double factor = system[row][col] / system[col][col];
+            for (size_t j = col; j <= k; ++j) {
+                system[row][j] -= factor * system[col][j];
+            }
+        }
+    }
+
+    std::vector<double> coefficients(k);
+    for (size_t i = 0; i < k; ++i) {
+        coefficients[i] = system[i][k] / system[i][i];
+    }
+    return coefficients;
+}
+
+static std::vector<Row> make_rows(size_t count, size_t columns, std::mt19937_64& gen) {
+    std::uniform_int_distribution<int64_t> dist(0, static_cast<int64_t>(count) - 1);
+    std::vector<Row> rows(count);
+    for (auto& row : rows) {
+        row.values.reserve(columns);
+        for (size_t c = 0; c < columns; ++c) {
+            row.add_value(dist(gen));
+        }
+    }
+    return rows;
+}
+
+static TableSchema make_schema(size_t columns) {
+    TableSchema schema;
+    for (size_t c = 0; c < columns; ++c) {
+        schema.add_column("c" + std::to_string(c), "int");
+    }
+    return schema;
+}
+
+CostCalibrator::CostCalibrator(const CalibrationOptions& opts) : options(opts) {
+    if (options.sizes.size() < 2) {
+        throw std::runtime_error("Calibration needs at least two input sizes");
+    }
+}
+
+template <typename Fn>
+double CostCalibrator::time_ms(Fn&& fn) const {
+    double best = 0.0;
+    for (size_t i = 0; i < std::max<size_t>(1, options.repetitions); ++i) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        best = i == 0 ? elapsed : std::min(best, elapsed);
+    }
+    return best;
+}
+
+void CostCalibrator::record(const std::string& constant, double value, const std::vector<double>& predicted,
+                            const std::vector<double>& measured) {
+    CalibrationFit fit;
+    fit.constant = constant;
+    fit.value = value;
+    fit.points = measured.size();
+
+    double mean = std::accumulate(measured.begin(), measured.end(), 0.0) / measured.size();
+    double residual = 0.0, total = 0.0;
+    for (size_t i = 0; i < measured.size(); ++i) {
+        residual += (measured[i] - predicted[i]) * (measured[i] - predicted[i]);
+        total += (measured[i] - mean) * (measured[i] - mean);
+    }
+    fit.r_squared = total > 0.0 ? 1.0 - residual / total : 1.0;
+    fits.push_back(fit);
+}
+
+// Slope of a regression through the origin.
+static double fit_slope(const std::vector<double>& x, const std::vector<double>& y) {
+    double xy = 0.0, xx = 0.0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        xy += x[i] * y[i];
+        xx += x[i] * x[i];
+    }
+    return xx > 0.0 ? std::max(0.0, xy / xx) : 0.0;
+}
+
+static std::vector<double> scaled(const std::vector<double>& x, double factor) {
+    std::vector<double> out;
+    for (double v : x) out.push_back(v * factor);
+    return out;
+}
+
+CostConstants CostCalibrator::calibrate() {
+    fits.clear();
+    std::mt19937_64 gen(options.seed);
+    CostConstants constants;
+
+    // Scans copy rows out of the table, so time depends on both the row
+    // count and the bytes moved. Several widths separate the two.
+    std::vector<std::vector<double>> scan_features;
+    std::vector<double> scan_ms;
+    for (size_t columns : {2, 8, 24}) {
+        for (size_t n : options.sizes) {
+            auto rows = make_rows(n, columns, gen);
+            double pages = std::ceil(static_cast<double>(n * columns * sizeof(Value)) / PAGE_BYTES);
+            scan_ms.push_back(time_ms([&] {
+                std::vector<Row> out;
+                out.reserve(rows.size());
+                for (const auto& row : rows) out.push_back(row);
+                sink = out.size();
+            }));
+            scan_features.push_back({pages, static_cast<double>(n)});
+        }
+    }
+    auto scan = fit_least_squares(scan_features, scan_ms);
+    if (scan[0] < 0.0 || scan[1] < 0.0) {
+        // Width made no measurable difference; charge everything per tuple.
+        std::vector<double> tuples;
+        for (const auto& f : scan_features) tuples.push_back(f[1]);
+        scan = {0.0, fit_slope(tuples, scan_ms)};
+    }
+    constants.sequential_io_cost = scan[0];
+    constants.cpu_tuple_cost = scan[1];
+    std::vector<double> scan_predicted;
+    for (const auto& f : scan_features) scan_predicted.push_back(f[0] * scan[0] + f[1] * scan[1]);
+    record("sequential_io_cost", scan[0], scan_predicted, scan_ms);
+    record("cpu_tuple_cost", scan[1], scan_predicted, scan_ms);
+
+    // Random reads: the same copies in shuffled row order, so every row is
+    // a fresh page. What the per-tuple cost does not explain is charged per
+    // page.
+    std::vector<double> random_pages, random_excess_ms, random_ms;
+    for (size_t n : options.sizes) {
+        auto rows = make_rows(n, 8, gen);
+        std::vector<size_t> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), gen);
+        double ms = time_ms([&] {
+            std::vector<Row> out;
+            out.reserve(rows.size());
+            for (size_t r : order) out.push_back(rows[r]);
+            sink = out.size();
+        });
+        random_pages.push_back(static_cast<double>(n));
+        random_ms.push_back(ms);
+        random_excess_ms.push_back(std::max(0.0, ms - n * constants.cpu_tuple_cost));
+    }
+    constants.random_io_cost = fit_slope(random_pages, random_excess_ms);
+    std::vector<double> random_predicted;
+    for (size_t i = 0; i < options.sizes.size(); ++i) {
+        random_predicted.push_back(options.sizes[i] * constants.cpu_tuple_cost + random_pages[i] * constants.random_io_cost);
+    }
+    record("random_io_cost", constants.random_io_cost, random_predicted, random_ms);
+
+    // Predicates run batch-wise through the binder, as in Executor::execute_filter.
+    TableSchema schema = make_schema(4);
+    std::vector<double> tuples, predicate_ms;
+    for (size_t n : options.sizes) {
+        auto rows = make_rows(n, 4, gen);
+        auto condition = BoundPredicate::parse_condition("c0 < " + std::to_string(n / 2));
+        BoundPredicate predicate(*condition, schema);
+        std::vector<uint32_t> selection;
+        selection.reserve(1024);
+        predicate_ms.push_back(time_ms([&] {
+            size_t selected = 0;
+            for (size_t start = 0; start < rows.size(); start += 1024) {
+                selection.clear();
+                predicate.evaluate_batch(rows.data() + start, std::min<size_t>(1024, rows.size() - start), selection);
+                selected += selection.size();
+            }
+            sink = selected;
+        }));
+        tuples.push_back(static_cast<double>(n));
+    }
+    constants.cpu_operator_cost = fit_slope(tuples, predicate_ms);
+    record("cpu_operator_cost", constants.cpu_operator_cost, scaled(tuples, constants.cpu_operator_cost), predicate_ms);
+
+    // Hash build and probe over the join executor's table layout.
+    using HashTable = std::unordered_map<Value, std::vector<const Row*>, ValueHash>;
+    std::vector<double> build_ms, probe_ms;
+    for (size_t n : options.sizes) {
+        auto build_rows = make_rows(n, 2, gen);
+        auto probe_rows = make_rows(n, 2, gen);
+        build_ms.push_back(time_ms([&] {
+            HashTable table(build_rows.size());
+            for (const auto& row : build_rows) table[row.get(0)].push_back(&row);
+            sink = table.size();
+        }));
+
+        HashTable table(build_rows.size());
+        for (const auto& row : build_rows) table[row.get(0)].push_back(&row);
+        probe_ms.push_back(time_ms([&] {
+            size_t matches = 0;
+            for (const auto& row : probe_rows) {
+                auto it = table.find(row.get(0));
+                if (it != table.end()) matches += it->second.size();
+            }
+            sink = matches;
+        }));
+    }
+    constants.hash_build_cost = fit_slope(tuples, build_ms);
+    record("hash_build_cost", constants.hash_build_cost, scaled(tuples, constants.hash_build_cost), build_ms);
+    constants.hash_probe_cost = fit_slope(tuples, probe_ms);
+    record("hash_probe_cost", constants.hash_probe_cost, scaled(tuples, constants.hash_probe_cost), probe_ms);
+
+    // Sorting row pointers by key, as the sort-merge join does. The model
+    // charges cpu_operator_cost * memory_sort_cost per n log2 n step.
+    std::vector<double> sort_steps, sort_ms;
+    for (size_t n : options.sizes) {
+        auto rows = make_rows(n, 2, gen);
+        std::vector<const Row*> pointers;
+        sort_ms.push_back(time_ms([&] {
+            pointers.clear();
+            for (const auto& row : rows) pointers.push_back(&row);
+            std::sort(pointers.begin(), pointers.end(),
+                      [](const Row* a, const Row* b) { return a->get(0) < b->get(0); });
+            sink = pointers.size();
+        }));
+        sort_steps.push_back(n * std::log2(static_cast<double>(n)));
+    }
+    double sort_step_ms = fit_slope(sort_steps, sort_ms);
+    constants.memory_sort_cost = constants.cpu_operator_cost > 0.0 ? sort_step_ms / constants.cpu_operator_cost : 0.0;
+    record("memory_sort_cost", constants.memory_sort_cost, scaled(sort_steps, sort_step_ms), sort_ms);
+
+    BenchmarkMetadata host = BenchmarkMetadata::collect();
+    constants.source = "calibrated " + host.timestamp + " on " + host.cpu_model;
+    return constants;
+}
+
+void CostCalibrator::print_report() const {
+    std::cout << std::left << std::setw(38) << "Constant"
+              << std::right << std::setw(16) << "Value"
+              << std::setw(8) << "R^2"
+              << std::setw(8) << "Points" << std::endl;
+    std::cout << std::string(70, '-') << std::endl;
+    for (const auto& fit : fits) {
+        std::cout << std::left << std::setw(38) << fit.constant
+                  << std::right << std::scientific << std::setprecision(3) << std::setw(16) << fit.value
+                  << std::fixed << std::setprecision(3) << std::setw(8) << fit.r_squared
+                  << std::setw(8) << fit.points << std::endl;
+    }
+}
@@ -1,8 +1,178 @@
 #include "cost_model.h"
+#include "feedback_cache.h"
+#include "memory_context.h"
+#include "table.h"
 #include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_set>
 
-CostModel::CostModel() {
+double CostConstants::scan_cost(size_t pages, size_t tuples) const {
+    return pages * sequential_io_cost + tuples * cpu_tuple_cost;
+}
+
+double CostConstants::filter_cost(size_t tuples) const {
+    return tuples * cpu_operator_cost;
+}
+
+double CostConstants::nested_loop_io_cost(size_t outer_tuples, size_t inner_pages) const {
+    return static_cast<double>(outer_tuples) * inner_pages * random_io_cost;
+}
+
+double CostConstants::nested_loop_cpu_cost(size_t outer_tuples, size_t inner_tuples) const {
+    return static_cast<double>(outer_tuples) * inner_tuples * cpu_operator_cost;
+}
+
+double CostConstants::hash_join_cost(size_t build_tuples, size_t probe_tuples, size_t build_pages) const {
+    return build_tuples * hash_build_cost + probe_tuples * hash_probe_cost + build_pages * sequential_io_cost;
+}
+
+double CostConstants::sort_cost(size_t tuples) const {
+    if (tuples <= 1) return 0.0;
+    return tuples * std::log2(static_cast<double>(tuples)) * cpu_operator_cost * memory_sort_cost;
+}
+
+double CostConstants::sort_merge_cost(size_t left_tuples, size_t right_tuples) const {
+    return sort_cost(left_tuples) + sort_cost(right_tuples) + (left_tuples + right_tuples) * cpu_operator_cost;
+}
+
+static CostConstants& active_constants() {
+    static CostConstants constants = [] {
+        const char* env = std::getenv(CostConstants::PROFILE_ENV);
+        bool explicit_path = env && *env;
+        std::string path = explicit_path ? env : CostConstants::DEFAULT_PROFILE;
+        if (!explicit_path && !std::ifstream(path)) {
+            return CostConstants();
+        }
+        try {
+            return CostConstants::load(path);
+        } catch (const std::exception& e) {
+            std::cerr << "Ignoring cost profile: " << e.what() << std::endl;
+            return CostConstants();
+        }
+    }();
+    return constants;
+}
+
+const CostConstants& CostConstants::active() {
+    return active_constants();
+}
+
+void CostConstants::set_active(const CostConstants& constants) {
+    active_constants() = constants;
+}
+
+static std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) return "";
+    size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+}
+
+CostConstants CostConstants::load(const std::string& filename) {
+    std::ifstream in(filename);
+    if (!in) {
+        throw std::runtime_error("Cannot open cost profile: " + filename);
+    }
+    
+    CostConstants constants;
+    constants.source = filename;
+    std::pair<const char*, double*> fields[] = {
+        {"sequential_io_cost", &constants.sequential_io_cost},
+        {"random_io_cost", &constants.random_io_cost},
+        {"cpu_tuple_cost", &constants.cpu_tuple_cost},
+        {"cpu_operator_cost", &constants.cpu_operator_cost},
+        {"memory_sort_cost", &constants.memory_sort_cost},
+        {"hash_build_cost", &constants.hash_build_cost},
+        {"hash_probe_cost", &constants.hash_probe_cost},
+    };
+    
+    std::string line;
+    size_t line_number = 0;
+    while (std::getline(in, line)) {
+        line_number++;
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) continue;
+        
+        std::string where = filename + ":" + std::to_string(line_number);
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) {
+            throw std::runtime_error("Expected name = value at " + where);
+        }
+        std::string name = trim(line.substr(0, eq));
+        std::string text = trim(line.substr(eq + 1));
+        if (name == "source") {
+            constants.source = text;
+            continue;
+        }
+        
+        auto field = std::find_if(std::begin(fields), std::end(fields),
+                                  [&name](const auto& f) { return name == f.first; });
+        if (field == std::end(fields)) {
+            throw std::runtime_error("Unknown cost constant '" + name + "' at " + where);
+        }
+        size_t used = 0;
+        double value = 0.0;
+        try {
+            value = std::stod(text, &used);
+        } catch (const std::exception&) {
+            used = 0;
+        }
+        if (used == 0 || used != text.size() || !(value >= 0.0)) {
+            throw std::runtime_error("Bad value for " + name + " at " + where);
+        }
+        *field->second = value;
+    }
+    return constants;
+}
+
+void CostConstants::save(const std::string& filename) const {
+    std::ofstream out(filename);
+    if (!out) {
+        throw std::runtime_error("Cannot write cost profile: " + filename);
+    }
+    out << "# Query optimizer cost profile\n" << to_string();
+    if (!out) {
+        throw std::runtime_error("Failed writing cost profile: " + filename);
+    }
+}
+
+std::string CostConstants::to_string() const {
+    std::ostringstream out;
+    out.precision(17);
+    out << "source = " << source << "\n"
+        << "sequential_io_cost = " << sequential_io_cost << "\n"
+        << "random_io_cost = " << random_io_cost << "\n"
+        << "cpu_tuple_cost = " << cpu_tuple_cost << "\n"
+        << "cpu_operator_cost = " << cpu_operator_cost << "\n"
+        << "memory_sort_cost = " << memory_sort_cost << "\n"
+        << "hash_build_cost = " << hash_build_cost << "\n"
+        << "hash_probe_cost = " << hash_probe_cost << "\n";
+    return out.str();
+}
+
+TableStatistics measure_table_statistics(const Table& table) {
+    auto lock = table.read_lock();
+    const TableSchema& schema = table.get_schema();
+    size_t rows = table.row_count();
+    size_t width = schema.column_count() * sizeof(Value) + (rows > 0 ? table.string_bytes() / rows : 0);
+    TableStatistics stats(rows, std::max<size_t>(1, rows * width / 4096), width);
+    for (size_t c = 0; c < schema.column_count(); ++c) {
+        std::unordered_set<Value, ValueHash> distinct;
+        for (const auto& row : table.get_rows()) {
+            distinct.insert(row.get(c));
+        }
+        stats.distinct_values[schema.column_names[c]] = distinct.size();
+    }
+    return stats;
+}
+
+CostModel::CostModel() : constants(CostConstants::active()) {
     TableStatistics users_stats(1000, 10, 120);
     users_stats.column_selectivity["age > 25"] = 0.88;
     users_stats.column_selectivity["age < 30"] = 0.20;
@@ -23,38 +193,106 @@ void CostModel::set_table_statistics(const std::string& table_name, const TableS
     table_stats[table_name] = stats;
 }
 
-double CostModel::estimate_scan_cost(const TableStatistics& stats) {
-    return stats.page_count * CostConstants::SEQUENTIAL_IO_COST + 
-           stats.tuple_count * CostConstants::CPU_TUPLE_COST;
-}
+// Estimates recurse into children; only the outermost call is timed.
+class CostModel::CallTimer {
+private:
+    CostModel& model;
+    std::chrono::steady_clock::time_point start;
 
-double CostModel::estimate_filter_cost(size_t input_tuples, double selectivity) {
-    return input_tuples * CostConstants::CPU_OPERATOR_COST;
-}
+public:
+    explicit CallTimer(CostModel& cost_model) : model(cost_model) {
+        if (model.call_depth++ == 0) {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+    ~CallTimer() {
+        if (--model.call_depth == 0) {
+            model.stats.elapsed_ms +=
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+    }
+};
 
-double CostModel::estimate_nested_loop_cost(size_t left_tuples, size_t right_tuples, size_t right_pages) {
-    double io_cost = left_tuples * right_pages * CostConstants::RANDOM_IO_COST;
-    double cpu_cost = left_tuples * right_tuples * CostConstants::CPU_OPERATOR_COST;
-    return io_cost + cpu_cost;
+bool CostModel::lookup_feedback(const PlanNode& node, double& selectivity) {
+    if (!feedback) {
+        return false;
+    }
+    bool found = feedback->lookup(node, selectivity);
+    ++(found ? stats.feedback_hits : stats.feedback_misses);
+    return found;
 }
 
-double CostModel::estimate_hash_join_cost(size_t build_tuples, size_t probe_tuples, size_t build_pages) {
-    double build_cost = build_tuples * CostConstants::HASH_BUILD_COST;
-    double probe_cost = probe_tuples * CostConstants::HASH_PROBE_COST;
-    double io_cost = build_pages * CostConstants::SEQUENTIAL_IO_COST;
-    return build_cost + probe_cost + io_cost;
-}
+// A single "column = literal" over a scan matches 1/distinct of the rows
+// when the table's statistics know the column's distinct count.
+bool CostModel::equality_selectivity(const FilterNode& node, double& selectivity) const {
+    std::string condition = node.condition;
+    while (condition.size() > 2 && condition.front() == '(' && condition.back() == ')') {
+        condition = condition.substr(1, condition.size() - 2);
+    }
+    size_t eq = condition.find(" = ");
+    if (eq == std::string::npos || condition.find(" AND ") != std::string::npos ||
+        condition.find(" OR ") != std::string::npos) {
+        return false;
+    }
+    std::string column = condition.substr(0, eq);
+    std::string literal = condition.substr(eq + 3);
+    if (literal.empty() || !(std::isdigit(static_cast<unsigned char>(literal[0])) || literal[0] == '-' ||
+                             literal[0] == '\'')) {
+        return false;
+    }
 
-double CostModel::estimate_sort_cost(size_t tuple_count) {
-    if (tuple_count <= 1) return 0.0;
-    return tuple_count * log2_safe(tuple_count) * CostConstants::CPU_OPERATOR_COST * CostConstants::MEMORY_SORT_COST;
+    const PlanNode* input = &node;
+    while (input->type != PlanNodeType::TABLE_SCAN && input->children.size() == 1) {
+        input = input->children[0].get();
+    }
+    if (input->type != PlanNodeType::TABLE_SCAN) {
+        return false;
+    }
+    const auto& table = static_cast<const TableScanNode*>(input)->table_name;
+    if (column.compare(0, table.size() + 1, table + ".") == 0) {
+        column = column.substr(table.size() + 1);
+    }
+    auto stats_it = table_stats.find(table);
+    if (stats_it == table_stats.end()) {
+        return false;
+    }
+    auto distinct = stats_it->second.distinct_values.find(column);
+    if (distinct == stats_it->second.distinct_values.end() || distinct->second == 0) {
+        return false;
+    }
+    selectivity = 1.0 / static_cast<double>(distinct->second);
+    return true;
 }
 
-double CostModel::estimate_sort_merge_cost(size_t left_tuples, size_t right_tuples) {
-    double left_sort = estimate_sort_cost(left_tuples);
-    double right_sort = estimate_sort_cost(right_tuples);
-    double merge_cost = (left_tuples + right_tuples) * CostConstants::CPU_OPERATOR_COST;
-    return left_sort + right_sort + merge_cost;
+// "a.x = b.y" matches 1/max(distinct x, distinct y) of the cross product
+// when both columns' distinct counts are known.
+bool CostModel::equi_join_selectivity(const std::string& condition, double& selectivity) const {
+    std::string text = condition;
+    while (text.size() > 2 && text.front() == '(' && text.back() == ')') {
+        text = text.substr(1, text.size() - 2);
+    }
+    size_t eq = text.find(" = ");
+    if (eq == std::string::npos || text.find(" AND ") != std::string::npos || text.find(" OR ") != std::string::npos) {
+        return false;
+    }
+    size_t distinct = 0;
+    for (const std::string& side : {text.substr(0, eq), text.substr(eq + 3)}) {
+        size_t dot = side.find('.');
+        if (dot == std::string::npos) {
+            return false;
+        }
+        auto stats_it = table_stats.find(side.substr(0, dot));
+        if (stats_it == table_stats.end()) {
+            return false;
+        }
+        auto column = stats_it->second.distinct_values.find(side.substr(dot + 1));
+        if (column == stats_it->second.distinct_values.end() || column->second == 0) {
+            return false;
+        }
+        distinct = std::max(distinct, column->second);
+    }
+    selectivity = 1.0 / static_cast<double>(distinct);
+    return true;
 }
 
 CostEstimate CostModel::estimate_table_scan_cost(const TableScanNode& node) {
@@ -64,10 +302,7 @@ CostEstimate CostModel::estimate_table_scan_cost(const TableScanNode& node) {
     }
     
     const auto& stats = it->second;
-    double total_cost = estimate_scan_cost(stats);
-    
-    return CostEstimate(stats.page_count * CostConstants::SEQUENTIAL_IO_COST, 
-                       stats.tuple_count * CostConstants::CPU_TUPLE_COST);
+    return CostEstimate(constants.scan_cost(stats.page_count, 0), constants.scan_cost(0, stats.tuple_count));
 }
 
 CostEstimate CostModel::estimate_filter_cost(const FilterNode& node) {
@@ -78,7 +313,7 @@ CostEstimate CostModel::estimate_filter_cost(const FilterNode& node) {
     auto child_cost = estimate_plan_cost(*node.children[0]);
     size_t input_tuples = estimate_output_cardinality(*node.children[0]);
     
-    double filter_cpu_cost = estimate_filter_cost(input_tuples, 0.1);
+    double filter_cpu_cost = constants.filter_cost(input_tuples);
     
     return CostEstimate(child_cost.io_cost, child_cost.cpu_cost + filter_cpu_cost);
 }
@@ -91,7 +326,7 @@ CostEstimate CostModel::estimate_project_cost(const ProjectNode& node) {
     auto child_cost = estimate_plan_cost(*node.children[0]);
     size_t input_tuples = estimate_output_cardinality(*node.children[0]);
     
-    double project_cpu_cost = input_tuples * CostConstants::CPU_OPERATOR_COST * 0.5;
+    double project_cpu_cost = constants.filter_cost(input_tuples) * 0.5;
     
     return CostEstimate(child_cost.io_cost, child_cost.cpu_cost + project_cpu_cost);
 }
@@ -122,21 +357,20 @@ CostEstimate CostModel::estimate_join_cost(const JoinNode& node) {
     switch (node.type) {
         case PlanNodeType::NESTED_LOOP_JOIN: {
             size_t right_pages = std::max(1UL, right_tuples / 100);
-            double join_cost = estimate_nested_loop_cost(left_tuples, right_tuples, right_pages);
-            return CostEstimate(total_io + left_tuples * right_pages * CostConstants::RANDOM_IO_COST, 
-                              total_cpu + join_cost);
+            return CostEstimate(total_io + constants.nested_loop_io_cost(left_tuples, right_pages),
+                              total_cpu + constants.nested_loop_cpu_cost(left_tuples, right_tuples));
         }
         
-        case PlanNodeType::HASH_JOIN: {
-            size_t build_tuples = std::min(left_tuples, right_tuples);
-            size_t probe_tuples = std::max(left_tuples, right_tuples);
-            size_t build_pages = std::max(1UL, build_tuples / 100);
-            double join_cost = estimate_hash_join_cost(build_tuples, probe_tuples, build_pages);
+        case PlanNodeType::HASH_JOIN:
+        case PlanNodeType::ADAPTIVE_JOIN: {
+            // The executor builds on the left input, as HashJoinNode::estimate_cost assumes.
+            size_t build_pages = std::max(1UL, left_tuples / 100);
+            double join_cost = constants.hash_join_cost(left_tuples, right_tuples, build_pages);
             return CostEstimate(total_io, total_cpu + join_cost);
         }
         
         case PlanNodeType::SORT_MERGE_JOIN: {
-            double join_cost = estimate_sort_merge_cost(left_tuples, right_tuples);
+            double join_cost = constants.sort_merge_cost(left_tuples, right_tuples);
             return CostEstimate(total_io, total_cpu + join_cost);
         }
         
@@ -146,6 +380,8 @@ CostEstimate CostModel::estimate_join_cost(const JoinNode& node) {
 }
 
 size_t CostModel::estimate_output_cardinality(const PlanNode& node) {
+    CallTimer timer(*this);
+    ++stats.cardinality_estimates;
     switch (node.type) {
         case PlanNodeType::TABLE_SCAN: {
             const auto& scan_node = static_cast<const TableScanNode&>(node);
@@ -159,13 +395,17 @@ size_t CostModel::estimate_output_cardinality(const PlanNode& node) {
             size_t input_cardinality = estimate_output_cardinality(*node.children[0]);
             
             double selectivity = 0.1;
-            if (filter_node.condition.find("age > 25") != std::string::npos) {
+            if (lookup_feedback(node, selectivity)) {
+                // learned from earlier executions
+            } else if (equality_selectivity(filter_node, selectivity)) {
+                // column = literal with a known distinct count
+            } else if (filter_node.condition.find("age > 25") != std::string::npos) {
                 selectivity = 0.88;
             } else if (filter_node.condition.find("age < 30") != std::string::npos) {
                 selectivity = 0.20;
             }
             
-            return static_cast<size_t>(input_cardinality * selectivity);
+            return Statistics::clamp_row_count(static_cast<double>(input_cardinality) * selectivity);
         }
         
         case PlanNodeType::PROJECT: {
@@ -175,15 +415,20 @@ size_t CostModel::estimate_output_cardinality(const PlanNode& node) {
         
         case PlanNodeType::NESTED_LOOP_JOIN:
         case PlanNodeType::HASH_JOIN:
-        case PlanNodeType::SORT_MERGE_JOIN: {
+        case PlanNodeType::SORT_MERGE_JOIN:
+        case PlanNodeType::ADAPTIVE_JOIN: {
             if (node.children.size() < 2) return 0;
             const auto& join_node = static_cast<const JoinNode&>(node);
             
             size_t left_cardinality = estimate_output_cardinality(*node.children[0]);
             size_t right_cardinality = estimate_output_cardinality(*node.children[1]);
             
-            double selectivity = estimate_join_selectivity(join_node.join_condition);
-            return static_cast<size_t>(left_cardinality * right_cardinality * selectivity);
+            double selectivity = 0.0;
+            if (!lookup_feedback(node, selectivity) && !equi_join_selectivity(join_node.join_condition, selectivity)) {
+                selectivity = estimate_join_selectivity(join_node.join_condition);
+            }
+            return Statistics::clamp_row_count(static_cast<double>(left_cardinality) *
+                                               static_cast<double>(right_cardinality) * selectivity);
         }
         
         default:
@@ -191,7 +436,57 @@ size_t CostModel::estimate_output_cardinality(const PlanNode& node) {
     }
 }
 
+size_t CostModel::scan_row_width(const TableScanNode& node) const {
+    auto it = table_stats.find(node.table_name);
+    return (it != table_stats.end()) ? it->second.tuple_width : 100;
+}
+
+// Returns the bytes of the node's own output; peak_bytes is the most held
+// at once below and including it. A child's output stays alive until its
+// parent finishes, so a join holds both inputs, its hash table and its
+// output together. A fused scan pipeline holds only its own output.
+size_t CostModel::estimate_memory(const PlanNode& node, size_t& row_width, size_t& peak_bytes) {
+    row_width = 0;
+    peak_bytes = 0;
+    if (is_scan_pipeline(node)) {
+        const PlanNode* scan = &node;
+        while (scan->type != PlanNodeType::TABLE_SCAN) {
+            scan = scan->children[0].get();
+        }
+        row_width = scan_row_width(static_cast<const TableScanNode&>(*scan));
+        peak_bytes = node.stats.row_count * (sizeof(Row) + row_width);
+        return peak_bytes;
+    }
+    size_t held = 0;
+    for (const auto& child : node.children) {
+        size_t child_width = 0, child_peak = 0;
+        size_t child_bytes = estimate_memory(*child, child_width, child_peak);
+        peak_bytes = std::max(peak_bytes, held + child_peak);
+        held += child_bytes;
+        row_width += child_width;
+    }
+    if (node.type == PlanNodeType::TABLE_SCAN) {
+        row_width = scan_row_width(static_cast<const TableScanNode&>(node));
+    }
+
+    size_t output_bytes = node.stats.row_count * (sizeof(Row) + row_width);
+    size_t hash_bytes = 0;
+    if ((node.type == PlanNodeType::HASH_JOIN || node.type == PlanNodeType::ADAPTIVE_JOIN) && !node.children.empty()) {
+        hash_bytes = node.children[0]->stats.row_count * HASH_ENTRY_BYTES;
+    }
+    peak_bytes = std::max(peak_bytes, held + hash_bytes + output_bytes);
+    return output_bytes;
+}
+
+size_t CostModel::estimate_memory_bytes(const PlanNode& node) {
+    size_t row_width = 0, peak_bytes = 0;
+    estimate_memory(node, row_width, peak_bytes);
+    return peak_bytes;
+}
+
 CostEstimate CostModel::estimate_plan_cost(const PlanNode& node) {
+    CallTimer timer(*this);
+    ++stats.cost_estimates;
     switch (node.type) {
         case PlanNodeType::TABLE_SCAN:
             return estimate_table_scan_cost(static_cast<const TableScanNode&>(node));
@@ -202,6 +497,7 @@ CostEstimate CostModel::estimate_plan_cost(const PlanNode& node) {
         case PlanNodeType::NESTED_LOOP_JOIN:
         case PlanNodeType::HASH_JOIN:
         case PlanNodeType::SORT_MERGE_JOIN:
+        case PlanNodeType::ADAPTIVE_JOIN:
             return estimate_join_cost(static_cast<const JoinNode&>(node));
         default:
             return CostEstimate();
@@ -1,25 +1,224 @@
 #include "executor.h"
+#include "expression_binder.h"
+#include "codegen.h"
+#include "spill_file.h"
+#include "trace.h"
 #include <algorithm>
+#include <chrono>
+#include <ctime>
 #include <unordered_map>
 #include <sstream>
 
 std::unique_ptr<ResultSet> Executor::execute(const PlanNode& node) {
+    TraceSpan span("executor", "execute");
+    memory.reset();
+    join_decisions.clear();
+    actual_rows.clear();
+    has_deadline = timeout_ms > 0.0;
+    if (has_deadline) {
+        deadline = std::chrono::steady_clock::now() +
+                   std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                       std::chrono::duration<double, std::milli>(timeout_ms));
+    }
+    
+    std::unique_ptr<ResultSet> result;
+    try {
+        result = execute_node(node);
+    } catch (...) {
+        has_deadline = false;
+        last_memory_usage = memory.usage();
+        memory.reset();
+        throw;
+    }
+    has_deadline = false;
+    
+    // The caller owns the final result; query-scoped memory goes away in bulk.
+    last_memory_usage = memory.usage();
+    result->detach_memory();
+    memory.reset();
+    
+    if (feedback) {
+        feedback->record_execution(node, actual_rows);
+    }
+    
+    return result;
+}
+
+static double thread_cpu_ms() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+QueryProfile Executor::explain_analyze(const PlanNode& node) {
+    if (hardware_counters && !perf_counters) {
+        perf_counters = std::make_unique<PerfCounters>();
+    }
+    
+    profiling = true;
+    timings.clear();
+    
+    auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<ResultSet> result;
+    try {
+        result = execute(node);
+    } catch (...) {
+        profiling = false;
+        throw;
+    }
+    double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    profiling = false;
+    
+    std::unordered_map<const PlanNode*, OperatorProfile> profiles;
+    fill_profile(node, profiles);
+    std::string counter_status;
+    if (hardware_counters && !perf_counters->available()) {
+        counter_status = perf_counters->unavailable_reason();
+    }
+    return QueryProfile(&node, std::move(profiles), result->size(), elapsed_ms, last_memory_usage.peak_bytes,
+                        counter_status);
+}
+
+void Executor::fill_profile(const PlanNode& node, std::unordered_map<const PlanNode*, OperatorProfile>& profiles) const {
+    for (const auto& child : node.children) {
+        fill_profile(*child, profiles);
+    }
+    
+    auto rows_it = actual_rows.find(&node);
+    if (rows_it == actual_rows.end()) {
+        return;
+    }
+    
+    OperatorProfile profile;
+    profile.rows_out = rows_it->second;
+    profile.estimated_rows = node.stats.row_count;
+    
+    if (node.children.empty()) {
+        profile.rows_in = profile.rows_out;
+    }
+    for (const auto& child : node.children) {
+        auto child_rows = actual_rows.find(child.get());
+        if (child_rows != actual_rows.end()) {
+            profile.rows_in += child_rows->second;
+        }
+    }
+    
+    auto timing = timings.find(&node);
+    if (timing != timings.end()) {
+        profile.wall_ms = timing->second.wall_ms;
+        profile.cpu_ms = timing->second.cpu_ms;
+        profile.counters = timing->second.counters;
+        profile.allocated_bytes = timing->second.allocations.bytes_allocated;
+        profile.allocations = timing->second.allocations.allocations;
+        profile.self_ms = profile.wall_ms;
+        for (const auto& child : node.children) {
+            auto child_timing = timings.find(child.get());
+            if (child_timing != timings.end()) {
+                profile.self_ms -= child_timing->second.wall_ms;
+            }
+        }
+        profile.self_ms = std::max(0.0, profile.self_ms);
+    } else {
+        profile.fused = true;
+    }
+    
+    auto peak = last_memory_usage.operator_peak_bytes.find(&node);
+    if (peak != last_memory_usage.operator_peak_bytes.end()) {
+        profile.peak_bytes = peak->second;
+    }
+    for (const auto& decision : join_decisions) {
+        if (decision.node == &node) {
+            profile.spill_bytes += decision.spilled_bytes;
+        }
+    }
+    
+    profiles[&node] = profile;
+}
+
+std::unique_ptr<ResultSet> Executor::execute_node(const PlanNode& node) {
+    TraceSpan span("operator", "operator");
+    if (span.is_active()) {
+        span.set_name(QueryProfile::operator_label(node));
+    }
+    if (!profiling) {
+        auto result = execute_operator(node);
+        span.add_arg("rows", static_cast<double>(result->size()));
+        return result;
+    }
+    
+    bool counting = hardware_counters && perf_counters;
+    PerfCounts counters_start = counting ? perf_counters->read() : PerfCounts();
+    AllocationStats heap_start = AllocationCounter::read();
+    auto wall_start = std::chrono::steady_clock::now();
+    double cpu_start = thread_cpu_ms();
+    auto result = execute_operator(node);
+    
+    auto& timing = timings[&node];
+    timing.wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wall_start).count();
+    timing.cpu_ms = thread_cpu_ms() - cpu_start;
+    AllocationStats heap_end = AllocationCounter::read();
+    timing.allocations.allocations = heap_end.allocations - heap_start.allocations;
+    timing.allocations.bytes_allocated = heap_end.bytes_allocated - heap_start.bytes_allocated;
+    if (counting) {
+        timing.counters = perf_counters->read() - counters_start;
+    }
+    span.add_arg("rows", static_cast<double>(result->size()));
+    return result;
+}
+
+std::unique_ptr<ResultSet> Executor::execute_operator(const PlanNode& node) {
+    check_deadline();
+    std::unique_ptr<ResultSet> result;
+    
+    if (pipeline_fusion && is_scan_pipeline(node)) {
+        TraceSpan span("pipeline", "pipeline");
+        result = execute_scan_pipeline(node);
+        result->flush_memory();
+        
+        // Fused operators: the scan reads the whole table and every
+        // operator above it emits the pipeline's output rows.
+        for (const PlanNode* inner = &node;; inner = inner->children[0].get()) {
+            if (inner->type == PlanNodeType::TABLE_SCAN) {
+                const auto& scan = static_cast<const TableScanNode&>(*inner);
+                Table* table = table_manager->get_table(scan.table_name);
+                auto lock = table->read_lock();
+                actual_rows[inner] = table->row_count();
+                break;
+            }
+            actual_rows[inner] = result->size();
+        }
+        return result;
+    }
+    
     switch (node.type) {
         case PlanNodeType::TABLE_SCAN:
-            return execute_table_scan(static_cast<const TableScanNode&>(node));
+            result = execute_table_scan(static_cast<const TableScanNode&>(node));
+            break;
         case PlanNodeType::FILTER:
-            return execute_filter(static_cast<const FilterNode&>(node));
+            result = execute_filter(static_cast<const FilterNode&>(node));
+            break;
         case PlanNodeType::PROJECT:
-            return execute_project(static_cast<const ProjectNode&>(node));
+            result = execute_project(static_cast<const ProjectNode&>(node));
+            break;
         case PlanNodeType::NESTED_LOOP_JOIN:
-            return execute_nested_loop_join(static_cast<const NestedLoopJoinNode&>(node));
+            result = execute_nested_loop_join(static_cast<const NestedLoopJoinNode&>(node));
+            break;
         case PlanNodeType::HASH_JOIN:
-            return execute_hash_join(static_cast<const HashJoinNode&>(node));
+            result = execute_hash_join(static_cast<const HashJoinNode&>(node));
+            break;
         case PlanNodeType::SORT_MERGE_JOIN:
-            return execute_sort_merge_join(static_cast<const SortMergeJoinNode&>(node));
+            result = execute_sort_merge_join(static_cast<const SortMergeJoinNode&>(node));
+            break;
+        case PlanNodeType::ADAPTIVE_JOIN:
+            result = execute_adaptive_join(static_cast<const AdaptiveJoinNode&>(node));
+            break;
         default:
             throw std::runtime_error("Unsupported plan node type");
     }
+    
+    result->flush_memory();
+    actual_rows[&node] = result->size();
+    return result;
 }
 
 std::unique_ptr<ResultSet> Executor::execute_table_scan(const TableScanNode& node) {
@@ -28,8 +227,9 @@ std::unique_ptr<ResultSet> Executor::execute_table_scan(const TableScanNode& nod
         throw std::runtime_error("Table not found: " + node.table_name);
     }
     
-    auto result = std::make_unique<ResultSet>(table->get_schema());
+    auto result = std::make_unique<ResultSet>(scan_schema(node, *table), &memory, &node);
     
+    auto lock = table->read_lock();
     for (const auto& row : table->get_rows()) {
         result->add_row(row);
     }
@@ -37,40 +237,13 @@ std::unique_ptr<ResultSet> Executor::execute_table_scan(const TableScanNode& nod
     return result;
 }
 
-bool Executor::evaluate_condition(const Row& row, const TableSchema& schema, const std::string& condition) {
-    if (condition.find("age > 25") != std::string::npos) {
-        try {
-            size_t age_idx = schema.get_column_index("age");
-            int age = row.get<int>(age_idx);
-            return age > 25;
-        } catch (...) {
-            return false;
-        }
-    }
-    
-    if (condition.find("age < 30") != std::string::npos) {
-        try {
-            size_t age_idx = schema.get_column_index("age");
-            int age = row.get<int>(age_idx);
-            return age < 30;
-        } catch (...) {
-            return false;
-        }
-    }
-    
-    if (condition.find("id = ") != std::string::npos) {
-        std::string id_str = condition.substr(condition.find("= ") + 2);
-        try {
-            size_t id_idx = schema.get_column_index("id");
-            int id = row.get<int>(id_idx);
-            int target_id = std::stoi(id_str);
-            return id == target_id;
-        } catch (...) {
-            return false;
-        }
+std::unique_ptr<BoundPredicate> Executor::bind_filter(const FilterNode& node, const TableSchema& schema) {
+    if (node.predicate) {
+        return std::make_unique<BoundPredicate>(*node.predicate, schema);
     }
     
-    return true;
+    auto parsed = BoundPredicate::parse_condition(node.condition);
+    return std::make_unique<BoundPredicate>(*parsed, schema);
 }
 
 std::unique_ptr<ResultSet> Executor::execute_filter(const FilterNode& node) {
@@ -78,32 +251,73 @@ std::unique_ptr<ResultSet> Executor::execute_filter(const FilterNode& node) {
         throw std::runtime_error("Filter node has no children");
     }
     
-    auto child_result = execute(*node.children[0]);
-    auto result = std::make_unique<ResultSet>(child_result->get_schema());
-    
-    for (const auto& row : child_result->get_rows()) {
-        if (evaluate_condition(row, child_result->get_schema(), node.condition)) {
-            result->add_row(row);
+    auto child_result = execute_node(*node.children[0]);
+    auto result = std::make_unique<ResultSet>(child_result->get_schema(), &memory, &node);
+    auto predicate = bind_filter(node, child_result->get_schema());
+    auto program = compile_predicate(*predicate);
+    
+    const auto& rows = child_result->get_rows();
+    std::vector<uint32_t> selection;
+    selection.reserve(PIPELINE_BATCH_SIZE);
+    
+    for (size_t batch_start = 0; batch_start < rows.size(); batch_start += PIPELINE_BATCH_SIZE) {
+        size_t batch_size = std::min(PIPELINE_BATCH_SIZE, rows.size() - batch_start);
+        const Row* batch = rows.data() + batch_start;
+        TraceSpan batch_span("morsel", "batch");
+        batch_span.add_arg("start", static_cast<double>(batch_start));
+        check_deadline();
+        
+        selection.clear();
+        filter_batch(*predicate, program.get(), batch, batch_size, selection);
+        for (uint32_t pos : selection) {
+            result->add_row(batch[pos]);
         }
     }
     
     return result;
 }
 
-std::vector<std::string> Executor::parse_projections(const std::vector<std::string>& projections) {
-    std::vector<std::string> columns;
-    for (const auto& proj : projections) {
+std::unique_ptr<AdaptiveConjunctFilter> Executor::compile_predicate(const BoundPredicate& predicate) {
+    try {
+        return std::make_unique<AdaptiveConjunctFilter>(predicate.get_root(), adaptive_filters);
+    } catch (const std::exception&) {
+        return nullptr;
+    }
+}
+
+void Executor::filter_batch(const BoundPredicate& predicate, AdaptiveConjunctFilter* program,
+                            const Row* rows, size_t count, std::vector<uint32_t>& selection) {
+    if (program) {
+        program->evaluate_batch(vm, rows, count, selection);
+    } else {
+        predicate.evaluate_batch(rows, count, selection);
+    }
+}
+
+bool Executor::resolve_projection(const ProjectNode& node, const TableSchema& input_schema,
+                                  TableSchema& output_schema, std::vector<size_t>& column_indices) {
+    if (node.projection_list.size() == 1 && node.projection_list[0] == "*") {
+        return false;
+    }
+    
+    for (const auto& proj : node.projection_list) {
         if (proj == "*") {
             continue;
         }
         size_t dot_pos = proj.find('.');
-        if (dot_pos != std::string::npos) {
-            columns.push_back(proj.substr(dot_pos + 1));
-        } else {
-            columns.push_back(proj);
+        std::string col = dot_pos == std::string::npos ? proj : proj.substr(dot_pos + 1);
+        const auto& names = input_schema.column_names;
+        if (std::find(names.begin(), names.end(), col) == names.end()) {
+            continue;
         }
+        // Present but ambiguous or from another relation: an error, not a
+        // column to silently drop.
+        size_t idx = input_schema.resolve_column(proj);
+        column_indices.push_back(idx);
+        output_schema.add_column(col, input_schema.column_types[idx], input_schema.column_table(idx));
     }
-    return columns;
+    
+    return true;
 }
 
 std::unique_ptr<ResultSet> Executor::execute_project(const ProjectNode& node) {
@@ -111,31 +325,19 @@ std::unique_ptr<ResultSet> Executor::execute_project(const ProjectNode& node) {
         throw std::runtime_error("Project node has no children");
     }
     
-    auto child_result = execute(*node.children[0]);
-    
-    if (node.projection_list.size() == 1 && node.projection_list[0] == "*") {
-        return child_result;
-    }
-    
-    auto columns = parse_projections(node.projection_list);
+    auto child_result = execute_node(*node.children[0]);
     
     TableSchema result_schema;
     std::vector<size_t> column_indices;
-    
-    for (const auto& col : columns) {
-        try {
-            size_t idx = child_result->get_schema().get_column_index(col);
-            column_indices.push_back(idx);
-            result_schema.add_column(col, child_result->get_schema().column_types[idx]);
-        } catch (...) {
-            continue;
-        }
+    if (!resolve_projection(node, child_result->get_schema(), result_schema, column_indices)) {
+        return child_result;
     }
     
-    auto result = std::make_unique<ResultSet>(result_schema);
+    auto result = std::make_unique<ResultSet>(result_schema, &memory, &node);
     
     for (const auto& row : child_result->get_rows()) {
         Row new_row;
+        new_row.values.reserve(column_indices.size());
         for (size_t idx : column_indices) {
             if (idx < row.size()) {
                 new_row.add_value(row.values[idx]);
@@ -147,26 +349,148 @@ std::unique_ptr<ResultSet> Executor::execute_project(const ProjectNode& node) {
     return result;
 }
 
+// A pipeline is [Project] -> [Filter] -> TableScan with at least one of the
+// optional operators present. None of them block, so they run as one loop.
+std::unique_ptr<ResultSet> Executor::execute_scan_pipeline(const PlanNode& root) {
+    const ProjectNode* project = nullptr;
+    const FilterNode* filter = nullptr;
+    const PlanNode* current = &root;
+    
+    if (current->type == PlanNodeType::PROJECT) {
+        project = static_cast<const ProjectNode*>(current);
+        current = current->children[0].get();
+    }
+    if (current->type == PlanNodeType::FILTER) {
+        filter = static_cast<const FilterNode*>(current);
+        current = current->children[0].get();
+    }
+    const auto& scan = static_cast<const TableScanNode&>(*current);
+    
+    auto table = table_manager->get_table(scan.table_name);
+    if (!table) {
+        throw std::runtime_error("Table not found: " + scan.table_name);
+    }
+    const TableSchema table_schema = scan_schema(scan, *table);
+    
+    std::unique_ptr<BoundPredicate> predicate;
+    std::unique_ptr<AdaptiveConjunctFilter> program;
+    if (filter) {
+        predicate = bind_filter(*filter, table_schema);
+        program = compile_predicate(*predicate);
+    }
+    
+    TableSchema result_schema;
+    std::vector<size_t> column_indices;
+    bool projecting = project && resolve_projection(*project, table_schema, result_schema, column_indices);
+    if (!projecting) {
+        result_schema = table_schema;
+    }
+    
+    auto result = std::make_unique<ResultSet>(result_schema, &memory, &root);
+    
+    // Compile before taking the read lock: running the system compiler
+    // under it would stall every writer to the table.
+    PipelineCompiler::PipelineFunction compiled = nullptr;
+    if (pipeline_compiler) {
+        size_t input_rows = 0;
+        {
+            auto size_lock = table->read_lock();
+            input_rows = table->row_count();
+        }
+        if (input_rows >= pipeline_compiler->get_options().min_input_rows) {
+            auto source = pipeline_compiler->generate_source(predicate.get(), table_schema,
+                                                             projecting ? &column_indices : nullptr);
+            compiled = pipeline_compiler->compile(source);
+        }
+    }
+    
+    auto lock = table->read_lock();
+    const auto& rows = table->get_rows();
+    
+    if (compiled) {
+        std::vector<Row> batch_output;
+        batch_output.reserve(PIPELINE_BATCH_SIZE);
+        for (size_t batch_start = 0; batch_start < rows.size(); batch_start += PIPELINE_BATCH_SIZE) {
+            size_t batch_size = std::min(PIPELINE_BATCH_SIZE, rows.size() - batch_start);
+            TraceSpan batch_span("morsel", "compiled batch");
+            batch_span.add_arg("start", static_cast<double>(batch_start));
+            batch_output.clear();
+            check_deadline();
+            compiled(rows.data() + batch_start, batch_size, &batch_output);
+            for (auto& row : batch_output) {
+                result->add_row(std::move(row));
+            }
+        }
+        return result;
+    }
+    
+    std::vector<uint32_t> selection;
+    selection.reserve(PIPELINE_BATCH_SIZE);
+    
+    for (size_t batch_start = 0; batch_start < rows.size(); batch_start += PIPELINE_BATCH_SIZE) {
+        size_t batch_size = std::min(PIPELINE_BATCH_SIZE, rows.size() - batch_start);
+        const Row* batch = rows.data() + batch_start;
+        TraceSpan batch_span("morsel", "batch");
+        batch_span.add_arg("start", static_cast<double>(batch_start));
+        check_deadline();
+        
+        selection.clear();
+        if (predicate) {
+            filter_batch(*predicate, program.get(), batch, batch_size, selection);
+        } else {
+            for (size_t i = 0; i < batch_size; ++i) {
+                selection.push_back(static_cast<uint32_t>(i));
+            }
+        }
+        
+        for (uint32_t pos : selection) {
+            const Row& row = batch[pos];
+            if (!projecting) {
+                result->add_row(row);
+                continue;
+            }
+            
+            Row new_row;
+            new_row.values.reserve(column_indices.size());
+            for (size_t idx : column_indices) {
+                if (idx < row.size()) {
+                    new_row.add_value(row.values[idx]);
+                }
+            }
+            result->add_row(new_row);
+        }
+    }
+    
+    return result;
+}
+
 std::unique_ptr<ResultSet> Executor::execute_nested_loop_join(const NestedLoopJoinNode& node) {
     if (node.children.size() < 2) {
         throw std::runtime_error("Join node needs two children");
     }
     
-    auto left_result = execute(*node.children[0]);
-    auto right_result = execute(*node.children[1]);
+    auto left_result = execute_node(*node.children[0]);
+    auto right_result = execute_node(*node.children[1]);
     
-    TableSchema result_schema = left_result->get_schema();
-    for (size_t i = 0; i < right_result->get_schema().column_count(); ++i) {
-        result_schema.add_column(
-            right_result->get_schema().column_names[i],
-            right_result->get_schema().column_types[i]
-        );
-    }
+    auto result = std::make_unique<ResultSet>(
+        join_schema(left_result->get_schema(), right_result->get_schema()), &memory, &node);
     
-    auto result = std::make_unique<ResultSet>(result_schema);
+    // Column equalities are checked per pair; other conditions are not
+    // evaluated and the join degrades to a cross product.
+    size_t left_key = 0, right_key = 1;
+    bool equi_join = resolve_join_keys(node, left_result->get_schema(), right_result->get_schema(),
+                                       left_key, right_key);
     
     for (const auto& left_row : left_result->get_rows()) {
+        check_deadline();
+        const Value& key = left_row.get(left_key);
+        if (equi_join && key.is_null()) {
+            continue;
+        }
         for (const auto& right_row : right_result->get_rows()) {
+            if (equi_join && key.compare(right_row.get(right_key)) != 0) {
+                continue;
+            }
             Row joined_row = left_row;
             for (const auto& value : right_row.values) {
                 joined_row.add_value(value);
@@ -183,45 +507,46 @@ std::unique_ptr<ResultSet> Executor::execute_hash_join(const HashJoinNode& node)
         throw std::runtime_error("Join node needs two children");
     }
     
-    auto left_result = execute(*node.children[0]);
-    auto right_result = execute(*node.children[1]);
+    auto left_result = execute_node(*node.children[0]);
+    auto right_result = execute_node(*node.children[1]);
+    
+    using RowList = std::vector<const Row*, ArenaAllocator<const Row*>>;
+    using HashTable = std::unordered_map<Value, RowList, ValueHash, std::equal_to<Value>,
+                                         ArenaAllocator<std::pair<const Value, RowList>>>;
     
-    std::unordered_map<int, std::vector<Row>> hash_table;
+    ArenaAllocator<const Row*> allocator(&memory, &node);
+    HashTable hash_table(left_result->size(), ValueHash(), std::equal_to<Value>(), allocator);
     
+    size_t left_key = 0, right_key = 1;
+    resolve_join_keys(node, left_result->get_schema(), right_result->get_schema(), left_key, right_key);
+    
+    size_t rows_seen = 0;
     for (const auto& row : left_result->get_rows()) {
-        try {
-            int key = row.get<int>(0);
-            hash_table[key].push_back(row);
-        } catch (...) {
-            continue;
+        check_deadline(rows_seen++);
+        const Value& key = row.get(left_key);
+        if (!key.is_null()) {
+            hash_table.try_emplace(key, allocator).first->second.push_back(&row);
         }
     }
     
-    TableSchema result_schema = left_result->get_schema();
-    for (size_t i = 0; i < right_result->get_schema().column_count(); ++i) {
-        result_schema.add_column(
-            right_result->get_schema().column_names[i],
-            right_result->get_schema().column_types[i]
-        );
-    }
-    
-    auto result = std::make_unique<ResultSet>(result_schema);
+    auto result = std::make_unique<ResultSet>(
+        join_schema(left_result->get_schema(), right_result->get_schema()), &memory, &node);
     
     for (const auto& right_row : right_result->get_rows()) {
-        try {
-            int key = right_row.get<int>(1);
-            auto it = hash_table.find(key);
-            if (it != hash_table.end()) {
-                for (const auto& left_row : it->second) {
-                    Row joined_row = left_row;
-                    for (const auto& value : right_row.values) {
-                        joined_row.add_value(value);
-                    }
-                    result->add_row(joined_row);
+        check_deadline(rows_seen++);
+        const Value& key = right_row.get(right_key);
+        if (key.is_null()) {
+            continue;
+        }
+        auto it = hash_table.find(key);
+        if (it != hash_table.end()) {
+            for (const Row* left_row : it->second) {
+                Row joined_row = *left_row;
+                for (const auto& value : right_row.values) {
+                    joined_row.add_value(value);
                 }
+                result->add_row(joined_row);
             }
-        } catch (...) {
-            continue;
         }
     }
     
@@ -233,63 +558,400 @@ std::unique_ptr<ResultSet> Executor::execute_sort_merge_join(const SortMergeJoin
         throw std::runtime_error("Join node needs two children");
     }
     
-    auto left_result = execute(*node.children[0]);
-    auto right_result = execute(*node.children[1]);
+    auto left_result = execute_node(*node.children[0]);
+    auto right_result = execute_node(*node.children[1]);
     
-    auto left_rows = left_result->get_rows();
-    auto right_rows = right_result->get_rows();
+    using RowRefs = std::vector<const Row*, ArenaAllocator<const Row*>>;
+    ArenaAllocator<const Row*> allocator(&memory, &node);
+    
+    RowRefs left_rows(allocator);
+    RowRefs right_rows(allocator);
+    left_rows.reserve(left_result->size());
+    right_rows.reserve(right_result->size());
+    for (const auto& row : left_result->get_rows()) left_rows.push_back(&row);
+    for (const auto& row : right_result->get_rows()) right_rows.push_back(&row);
+    
+    size_t left_column = 0, right_column = 1;
+    resolve_join_keys(node, left_result->get_schema(), right_result->get_schema(), left_column, right_column);
     
     std::sort(left_rows.begin(), left_rows.end(), 
-              [](const Row& a, const Row& b) {
-                  try {
-                      return a.get<int>(0) < b.get<int>(0);
-                  } catch (...) {
-                      return false;
-                  }
+              [left_column](const Row* a, const Row* b) {
+                  return a->get(left_column) < b->get(left_column);
               });
     
     std::sort(right_rows.begin(), right_rows.end(), 
-              [](const Row& a, const Row& b) {
-                  try {
-                      return a.get<int>(1) < b.get<int>(1);
-                  } catch (...) {
-                      return false;
-                  }
+              [right_column](const Row* a, const Row* b) {
+                  return a->get(right_column) < b->get(right_column);
               });
     
-    TableSchema result_schema = left_result->get_schema();
-    for (size_t i = 0; i < right_result->get_schema().column_count(); ++i) {
-        result_schema.add_column(
-            right_result->get_schema().column_names[i],
-            right_result->get_schema().column_types[i]
-        );
+    auto result = std::make_unique<ResultSet>(
+        join_schema(left_result->get_schema(), right_result->get_schema()), &memory, &node);
+    
+    size_t left_idx = 0, right_idx = 0, steps = 0;
+    
+    while (left_idx < left_rows.size() && right_idx < right_rows.size()) {
+        check_deadline(steps++);
+        const Value& left_key = left_rows[left_idx]->get(left_column);
+        const Value& right_key = right_rows[right_idx]->get(right_column);
+        
+        if (left_key.is_null()) {
+            left_idx++;
+            continue;
+        }
+        if (right_key.is_null()) {
+            right_idx++;
+            continue;
+        }
+        
+        int cmp = left_key.compare(right_key);
+        if (cmp == 0) {
+            // Join the full runs of equal keys on both sides.
+            size_t left_end = left_idx + 1;
+            while (left_end < left_rows.size() && left_rows[left_end]->get(left_column).compare(left_key) == 0) {
+                left_end++;
+            }
+            size_t right_end = right_idx + 1;
+            while (right_end < right_rows.size() && right_rows[right_end]->get(right_column).compare(right_key) == 0) {
+                right_end++;
+            }
+            for (size_t l = left_idx; l < left_end; ++l) {
+                for (size_t r = right_idx; r < right_end; ++r) {
+                    Row joined_row = *left_rows[l];
+                    for (const auto& value : right_rows[r]->values) {
+                        joined_row.add_value(value);
+                    }
+                    result->add_row(std::move(joined_row));
+                }
+            }
+            left_idx = left_end;
+            right_idx = right_end;
+        } else if (cmp < 0) {
+            left_idx++;
+        } else {
+            right_idx++;
+        }
     }
     
-    auto result = std::make_unique<ResultSet>(result_schema);
+    return result;
+}
+
+static constexpr size_t HASH_CHARGE_BYTES = 64 * 1024;
+static constexpr size_t MAX_SPILL_PARTITIONS = 256;
+
+static void append_joined_row(ResultSet& result, const Row& left, const Row& right) {
+    Row joined_row = left;
+    for (const auto& value : right.values) {
+        joined_row.add_value(value);
+    }
+    result.add_row(std::move(joined_row));
+}
+
+// Rows read back from a spill file reference a per-partition heap, so
+// strings are copied into the result before the heap goes away.
+static void append_owned_row(ResultSet& result, const Row& left, const Row& right) {
+    Row joined_row;
+    joined_row.values.reserve(left.size() + right.size());
+    for (const Row* side : {&left, &right}) {
+        for (const auto& value : side->values) {
+            joined_row.add_value(value.type() == ValueType::STRING ? result.make_string(value.as_string()) : value);
+        }
+    }
+    result.add_row(std::move(joined_row));
+}
+
+std::string JoinDecision::to_string() const {
+    const char* name = "HashJoin";
+    switch (strategy) {
+        case JoinStrategy::INDEX_PROBE: name = "IndexProbe"; break;
+        case JoinStrategy::HASH: name = "HashJoin"; break;
+        case JoinStrategy::GRACE_HASH: name = "GraceHashJoin"; break;
+    }
     
-    size_t left_idx = 0, right_idx = 0;
+    std::ostringstream out;
+    out << name << ": build rows " << actual_build_rows << " (estimated " << estimated_build_rows << ")";
+    if (partitions > 0) {
+        out << ", " << partitions << " partitions, " << spilled_bytes << " bytes spilled";
+    }
+    out << " - " << reason;
+    return out.str();
+}
+
+TableSchema Executor::scan_schema(const TableScanNode& node, const Table& table) const {
+    TableSchema schema = table.get_schema();
+    schema.qualify(node.alias.empty() ? node.table_name : node.alias);
+    return schema;
+}
+
+TableSchema Executor::join_schema(const TableSchema& left_schema, const TableSchema& right_schema) const {
+    TableSchema result_schema = left_schema;
+    result_schema.column_tables.resize(result_schema.column_count());
+    for (size_t i = 0; i < right_schema.column_count(); ++i) {
+        result_schema.add_column(right_schema.column_names[i], right_schema.column_types[i],
+                                 right_schema.column_table(i));
+    }
+    return result_schema;
+}
+
+bool Executor::resolve_join_keys(const JoinNode& node, const TableSchema& left_schema, const TableSchema& right_schema,
+                                 size_t& left_key, size_t& right_key) const {
+    left_key = 0;
+    right_key = 1;
+    
+    std::unique_ptr<Expression> expr;
+    try {
+        expr = BoundPredicate::parse_condition(node.join_condition);
+    } catch (const std::exception&) {
+        return false;
+    }
+    if (expr->type != ExpressionType::BINARY_OP) {
+        return false;
+    }
+    const auto& equality = static_cast<const BinaryOpExpression&>(*expr);
+    if (equality.op != BinaryOperator::EQUALS ||
+        equality.left->type != ExpressionType::COLUMN || equality.right->type != ExpressionType::COLUMN) {
+        return false;
+    }
+    const auto& first = static_cast<const ColumnExpression&>(*equality.left);
+    const auto& second = static_cast<const ColumnExpression&>(*equality.right);
     
-    while (left_idx < left_rows.size() && right_idx < right_rows.size()) {
+    auto resolve = [](const ColumnExpression& column, const TableSchema& schema, size_t& index) {
         try {
-            int left_key = left_rows[left_idx].get<int>(0);
-            int right_key = right_rows[right_idx].get<int>(1);
+            index = BoundPredicate::resolve_column(column, schema);
+            return true;
+        } catch (const std::runtime_error&) {
+            return false;
+        }
+    };
+    
+    size_t left_index = 0, right_index = 0;
+    if ((resolve(first, left_schema, left_index) && resolve(second, right_schema, right_index)) ||
+        (resolve(second, left_schema, left_index) && resolve(first, right_schema, right_index))) {
+        left_key = left_index;
+        right_key = right_index;
+        return true;
+    }
+    return false;
+}
+
+size_t Executor::effective_join_budget() const {
+    if (join_memory_budget > 0) {
+        return join_memory_budget;
+    }
+    if (memory.limit() > 0) {
+        return memory.limit() / 2;
+    }
+    return DEFAULT_JOIN_MEMORY_BUDGET;
+}
+
+std::unique_ptr<ResultSet> Executor::execute_adaptive_join(const AdaptiveJoinNode& node) {
+    if (node.children.size() < 2) {
+        throw std::runtime_error("Join node needs two children");
+    }
+    
+    auto build = execute_node(*node.children[0]);
+    auto probe = execute_node(*node.children[1]);
+    
+    size_t build_key = 0, probe_key = 1;
+    resolve_join_keys(node, build->get_schema(), probe->get_schema(), build_key, probe_key);
+    
+    auto result = std::make_unique<ResultSet>(join_schema(build->get_schema(), probe->get_schema()), &memory, &node);
+    
+    JoinDecision decision;
+    decision.node = &node;
+    decision.estimated_build_rows = node.children[0]->stats.row_count;
+    decision.actual_build_rows = build->size();
+    
+    const auto& build_rows = build->get_rows();
+    
+    if (build_rows.size() <= INDEX_PROBE_BUILD_ROWS) {
+        // A sorted array of a few keys is cheaper to build and probe than
+        // a hash table.
+        decision.strategy = JoinStrategy::INDEX_PROBE;
+        decision.reason = "build side too small for a hash table to pay off";
+        
+        std::vector<std::pair<Value, const Row*>> index;
+        for (const auto& row : build_rows) {
+            if (!row.get(build_key).is_null()) {
+                index.emplace_back(row.get(build_key), &row);
+            }
+        }
+        auto key_less = [](const std::pair<Value, const Row*>& entry, const Value& key) { return entry.first < key; };
+        std::sort(index.begin(), index.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        
+        size_t probed = 0;
+        for (const auto& probe_row : probe->get_rows()) {
+            check_deadline(probed++);
+            const Value& key = probe_row.get(probe_key);
+            if (key.is_null()) {
+                continue;
+            }
+            for (auto it = std::lower_bound(index.begin(), index.end(), key, key_less);
+                 it != index.end() && it->first == key; ++it) {
+                append_joined_row(*result, *it->second, probe_row);
+            }
+        }
+        
+        join_decisions.push_back(decision);
+        return result;
+    }
+    
+    // The table uses the heap rather than the query arena so it can be
+    // given back if it outgrows the budget and the join has to spill.
+    size_t budget = effective_join_budget();
+    bool spill = build->memory_bytes() > budget;
+    size_t table_bytes = 0, charged_bytes = 0, rows_built = 0;
+    std::unordered_map<Value, std::vector<const Row*>, ValueHash> hash_table;
+    
+    if (!spill) {
+        for (const auto& row : build_rows) {
+            const Value& key = row.get(build_key);
+            if (key.is_null()) {
+                continue;
+            }
+            auto& matches = hash_table[key];
+            table_bytes += (matches.empty() ? HASH_ENTRY_BYTES : 0) + sizeof(const Row*);
+            matches.push_back(&row);
+            rows_built++;
             
-            if (left_key == right_key) {
-                Row joined_row = left_rows[left_idx];
-                for (const auto& value : right_rows[right_idx].values) {
-                    joined_row.add_value(value);
+            if (table_bytes - charged_bytes >= HASH_CHARGE_BYTES) {
+                if (build->memory_bytes() + table_bytes > budget || memory.would_exceed(table_bytes - charged_bytes)) {
+                    spill = true;
+                    break;
                 }
-                result->add_row(joined_row);
-                right_idx++;
-            } else if (left_key < right_key) {
-                left_idx++;
-            } else {
-                right_idx++;
+                memory.charge(&node, table_bytes - charged_bytes);
+                charged_bytes = table_bytes;
+            }
+        }
+    }
+    
+    if (spill) {
+        hash_table = {};
+        memory.release(&node, charged_bytes);
+        
+        decision.strategy = JoinStrategy::GRACE_HASH;
+        decision.reason = "build side exceeded the " + std::to_string(budget) + " byte budget after " +
+                          std::to_string(rows_built) + " rows";
+        execute_grace_hash_join(node, std::move(build), std::move(probe), build_key, probe_key, *result, decision);
+        
+        join_decisions.push_back(decision);
+        return result;
+    }
+    
+    decision.strategy = JoinStrategy::HASH;
+    decision.reason = "build side fits the " + std::to_string(budget) + " byte budget";
+    
+    size_t probed = 0;
+    for (const auto& probe_row : probe->get_rows()) {
+        check_deadline(probed++);
+        const Value& key = probe_row.get(probe_key);
+        if (key.is_null()) {
+            continue;
+        }
+        auto it = hash_table.find(key);
+        if (it != hash_table.end()) {
+            for (const Row* build_row : it->second) {
+                append_joined_row(*result, *build_row, probe_row);
             }
-        } catch (...) {
-            left_idx++;
         }
     }
     
+    memory.release(&node, charged_bytes);
+    join_decisions.push_back(decision);
     return result;
-}
\ No newline at end of file
+}
+
+void Executor::execute_grace_hash_join(const AdaptiveJoinNode& node, std::unique_ptr<ResultSet> build,
+                                       std::unique_ptr<ResultSet> probe, size_t build_key, size_t probe_key,
+                                       ResultSet& result, JoinDecision& decision) {
+    // Aim for partitions of about half the budget each. A partition that
+    // still does not fit is not split further; it fails the memory limit.
+    size_t budget = effective_join_budget();
+    size_t partitions = 2;
+    while (partitions < MAX_SPILL_PARTITIONS && partitions * budget < 2 * build->memory_bytes()) {
+        partitions *= 2;
+    }
+    
+    // Remix the hash so the partition is independent of the bucket a key
+    // lands in within its partition's table.
+    auto partition_of = [partitions](const Value& key) {
+        uint64_t mixed = static_cast<uint64_t>(ValueHash()(key)) * 0x9E3779B97F4A7C15ULL;
+        return static_cast<size_t>(mixed >> 32) & (partitions - 1);
+    };
+    
+    std::vector<std::unique_ptr<SpillFile>> build_files, probe_files;
+    for (size_t p = 0; p < partitions; ++p) {
+        build_files.push_back(std::make_unique<SpillFile>());
+        probe_files.push_back(std::make_unique<SpillFile>());
+    }
+    
+    {
+        TraceSpan span("spill", "spill build side");
+        span.add_arg("partitions", static_cast<double>(partitions));
+        span.add_arg("rows", static_cast<double>(build->size()));
+        for (const auto& row : build->get_rows()) {
+            const Value& key = row.get(build_key);
+            if (!key.is_null()) {
+                build_files[partition_of(key)]->write_row(row);
+            }
+        }
+        build.reset();
+    }
+    
+    {
+        TraceSpan span("spill", "spill probe side");
+        span.add_arg("partitions", static_cast<double>(partitions));
+        span.add_arg("rows", static_cast<double>(probe->size()));
+        for (const auto& row : probe->get_rows()) {
+            const Value& key = row.get(probe_key);
+            if (!key.is_null()) {
+                probe_files[partition_of(key)]->write_row(row);
+            }
+        }
+        probe.reset();
+    }
+    
+    for (size_t p = 0; p < partitions; ++p) {
+        TraceSpan span("spill", "join spilled partition");
+        span.add_arg("partition", static_cast<double>(p));
+        span.add_arg("bytes", static_cast<double>(build_files[p]->get_bytes_written() +
+                                                  probe_files[p]->get_bytes_written()));
+        check_deadline();
+        decision.spilled_bytes += build_files[p]->get_bytes_written() + probe_files[p]->get_bytes_written();
+        
+        size_t partition_bytes = build_files[p]->get_bytes_written() +
+                                 build_files[p]->get_rows_written() * (sizeof(Row) + HASH_ENTRY_BYTES);
+        memory.charge(&node, partition_bytes);
+        
+        StringHeap build_strings;
+        std::vector<Row> rows;
+        rows.reserve(build_files[p]->get_rows_written());
+        Row row;
+        build_files[p]->rewind();
+        while (build_files[p]->read_row(row, build_strings)) {
+            rows.push_back(std::move(row));
+        }
+        build_files[p].reset();
+        
+        std::unordered_map<Value, std::vector<const Row*>, ValueHash> hash_table(rows.size());
+        for (const auto& build_row : rows) {
+            hash_table[build_row.get(build_key)].push_back(&build_row);
+        }
+        
+        StringHeap probe_strings;
+        Row probe_row;
+        probe_files[p]->rewind();
+        while (probe_files[p]->read_row(probe_row, probe_strings)) {
+            auto it = hash_table.find(probe_row.get(probe_key));
+            if (it != hash_table.end()) {
+                for (const Row* build_row : it->second) {
+                    append_owned_row(result, *build_row, probe_row);
+                }
+            }
+        }
+        probe_files[p].reset();
+        
+        memory.release(&node, partition_bytes);
+    }
+    
+    decision.partitions = partitions;
+}
@@ -0,0 +1,138 @@
+#include "explain.h"
+#include "string_util.h"
+#include <algorithm>
+#include <cstdio>
+
+double OperatorProfile::q_error() const {
+    double estimated = static_cast<double>(std::max<size_t>(estimated_rows, 1));
+    double actual = static_cast<double>(std::max<size_t>(rows_out, 1));
+    return std::max(estimated / actual, actual / estimated);
+}
+
+QueryProfile::QueryProfile(const PlanNode* plan, std::unordered_map<const PlanNode*, OperatorProfile> profiles,
+                           size_t rows, double elapsed_ms, size_t query_peak_bytes,
+                           const std::string& counters_unavailable_reason)
+    : root(plan), operators(std::move(profiles)), result_rows(rows), total_ms(elapsed_ms),
+      peak_bytes(query_peak_bytes), counters_unavailable(counters_unavailable_reason) {}
+
+std::string QueryProfile::operator_label(const PlanNode& node) {
+    std::string text = node.to_string(0);
+    size_t end = text.find('\n');
+    return end == std::string::npos ? text : text.substr(0, end);
+}
+
+void QueryProfile::set_optimizer_stats(const OptimizerStats& stats) {
+    optimizer_stats = stats;
+    has_optimizer_stats = true;
+}
+
+const OperatorProfile* QueryProfile::get(const PlanNode& node) const {
+    auto it = operators.find(&node);
+    return it != operators.end() ? &it->second : nullptr;
+}
+
+void QueryProfile::text_node(const PlanNode& node, int indent, std::string& out) const {
+    out += std::string(indent * 2, ' ') + operator_label(node);
+
+    if (const OperatorProfile* profile = get(node)) {
+        out += "  (rows=" + std::to_string(profile->rows_out) +
+               " estimated=" + std::to_string(profile->estimated_rows) +
+               " q-error=" + format_double("%.2f", profile->q_error()) +
+               " in=" + std::to_string(profile->rows_in);
+        if (profile->fused) {
+            out += " fused";
+        } else {
+            out += " time=" + format_double("%.3f", profile->wall_ms) + "ms" +
+                   " self=" + format_double("%.3f", profile->self_ms) + "ms" +
+                   " cpu=" + format_double("%.3f", profile->cpu_ms) + "ms";
+        }
+        if (profile->peak_bytes > 0) {
+            out += " peak=" + std::to_string(profile->peak_bytes) + "B";
+        }
+        if (profile->spill_bytes > 0) {
+            out += " spilled=" + std::to_string(profile->spill_bytes) + "B";
+        }
+        if (profile->allocations > 0) {
+            out += " alloc=" + std::to_string(profile->allocated_bytes) + "B/" +
+                   std::to_string(profile->allocations);
+        }
+        if (!profile->counters.empty()) {
+            out += " " + profile->counters.to_string();
+        }
+        out += ")";
+    } else {
+        out += "  (never executed)";
+    }
+    out += "\n";
+
+    for (const auto& child : node.children) {
+        text_node(*child, indent + 1, out);
+    }
+}
+
+std::string QueryProfile::to_text() const {
+    std::string out;
+    if (root) {
+        text_node(*root, 0, out);
+    }
+    out += "Result: " + std::to_string(result_rows) + " rows in " + format_double("%.3f", total_ms) +
+           "ms, peak memory " + std::to_string(peak_bytes) + " bytes\n";
+    if (!counters_unavailable.empty()) {
+        out += "Hardware counters unavailable (" + counters_unavailable + ")\n";
+    }
+    if (has_optimizer_stats) {
+        out += optimizer_stats.to_string() + "\n";
+    }
+    return out;
+}
+
+void QueryProfile::json_node(const PlanNode& node, int indent, std::string& out) const {
+    std::string pad(indent * 2, ' ');
+    std::string field = pad + "  ";
+    out += pad + "{\n";
+    out += field + "\"operator\": \"" + json_escape(operator_label(node)) + "\",\n";
+
+    if (const OperatorProfile* profile = get(node)) {
+        out += field + "\"actual_rows\": " + std::to_string(profile->rows_out) + ",\n";
+        out += field + "\"estimated_rows\": " + std::to_string(profile->estimated_rows) + ",\n";
+        out += field + "\"q_error\": " + format_double("%.4f", profile->q_error()) + ",\n";
+        out += field + "\"rows_in\": " + std::to_string(profile->rows_in) + ",\n";
+        out += field + "\"fused\": " + (profile->fused ? "true" : "false") + ",\n";
+        out += field + "\"wall_ms\": " + format_double("%.4f", profile->wall_ms) + ",\n";
+        out += field + "\"self_ms\": " + format_double("%.4f", profile->self_ms) + ",\n";
+        out += field + "\"cpu_ms\": " + format_double("%.4f", profile->cpu_ms) + ",\n";
+        out += field + "\"peak_bytes\": " + std::to_string(profile->peak_bytes) + ",\n";
+        out += field + "\"spill_bytes\": " + std::to_string(profile->spill_bytes) + ",\n";
+        out += field + "\"allocated_bytes\": " + std::to_string(profile->allocated_bytes) + ",\n";
+        out += field + "\"allocations\": " + std::to_string(profile->allocations) + ",\n";
+        out += field + "\"counters\": " + profile->counters.to_json() + ",\n";
+    }
+
+    out += field + "\"children\": [";
+    for (size_t i = 0; i < node.children.size(); ++i) {
+        out += i == 0 ? "\n" : ",\n";
+        json_node(*node.children[i], indent + 2, out);
+    }
+    out += node.children.empty() ? "]\n" : "\n" + field + "]\n";
+    out += pad + "}";
+}
+
+std::string QueryProfile::to_json() const {
+    std::string out = "{\n";
+    out += "  \"result_rows\": " + std::to_string(result_rows) + ",\n";
+    out += "  \"total_ms\": " + format_double("%.4f", total_ms) + ",\n";
+    out += "  \"peak_bytes\": " + std::to_string(peak_bytes) + ",\n";
+    if (has_optimizer_stats) {
+        out += "  \"optimizer\": " + optimizer_stats.to_json() + ",\n";
+    }
+    out += "  \"plan\": ";
+    if (root) {
+        std::string plan;
+        json_node(*root, 1, plan);
+        out += plan.substr(2);
+    } else {
+        out += "null";
+    }
+    out += "\n}\n";
+    return out;
+}
@@ -0,0 +1,157 @@
+#include "expression_binder.h"
+#include "parser.h"
+#include <stdexcept>
+
+BoundPredicate::BoundPredicate(const Expression& expr, const TableSchema& schema) {
+    root = bind(expr, schema, "");
+}
+
+std::unique_ptr<Expression> BoundPredicate::parse_condition(const std::string& condition) {
+    Tokenizer tokenizer(condition);
+    Parser parser(tokenizer.tokenize());
+    return parser.parseCondition();
+}
+
+size_t BoundPredicate::resolve_column(const std::string& name, const TableSchema& schema) {
+    return schema.resolve_column(name);
+}
+
+size_t BoundPredicate::resolve_column(const ColumnExpression& column, const TableSchema& schema) {
+    if (column.table_name.empty()) {
+        return schema.resolve_column(column.column_name);
+    }
+    return schema.resolve_column(column.table_name, column.column_name);
+}
+
+std::string BoundPredicate::column_type(const Expression& expr, const TableSchema& schema) const {
+    if (expr.type != ExpressionType::COLUMN) {
+        return "";
+    }
+    const auto& col = static_cast<const ColumnExpression&>(expr);
+    return schema.column_types[resolve_column(col, schema)];
+}
+
+Value BoundPredicate::bind_literal(const std::string& text, const std::string& type_hint) {
+    if (type_hint == "string") {
+        return Value::string_ref(constants.store(text));
+    }
+
+    if (type_hint == "date") {
+        int32_t days = 0;
+        if (Value::parse_date(text, days)) {
+            return Value::date(days);
+        }
+    }
+
+    if (type_hint == "bool") {
+        if (text == "true" || text == "TRUE") return Value(true);
+        if (text == "false" || text == "FALSE") return Value(false);
+    }
+
+    size_t consumed = 0;
+    try {
+        if (text.find('.') == std::string::npos) {
+            int64_t number = std::stoll(text, &consumed);
+            if (consumed == text.size()) {
+                return Value(number);
+            }
+        } else {
+            double number = std::stod(text, &consumed);
+            if (consumed == text.size()) {
+                return Value(number);
+            }
+        }
+    } catch (...) {
+    }
+
+    return Value::string_ref(constants.store(text));
+}
+
+std::unique_ptr<BoundExpression> BoundPredicate::bind(const Expression& expr, const TableSchema& schema,
+                                                      const std::string& type_hint) {
+    switch (expr.type) {
+        case ExpressionType::COLUMN: {
+            const auto& col = static_cast<const ColumnExpression&>(expr);
+            auto bound = std::make_unique<BoundExpression>(BoundExpressionKind::COLUMN);
+            bound->column_index = resolve_column(col, schema);
+            return bound;
+        }
+
+        case ExpressionType::LITERAL: {
+            const auto& lit = static_cast<const LiteralExpression&>(expr);
+            auto bound = std::make_unique<BoundExpression>(BoundExpressionKind::CONSTANT);
+            bound->constant = bind_literal(lit.value, type_hint);
+            return bound;
+        }
+
+        case ExpressionType::BINARY_OP: {
+            const auto& binop = static_cast<const BinaryOpExpression&>(expr);
+
+            if (binop.op == BinaryOperator::AND || binop.op == BinaryOperator::OR) {
+                auto bound = std::make_unique<BoundExpression>(
+                    binop.op == BinaryOperator::AND ? BoundExpressionKind::AND : BoundExpressionKind::OR);
+                bound->op = binop.op;
+                bound->left = bind(*binop.left, schema, "bool");
+                bound->right = bind(*binop.right, schema, "bool");
+                return bound;
+            }
+
+            auto bound = std::make_unique<BoundExpression>(BoundExpressionKind::COMPARISON);
+            bound->op = binop.op;
+            bound->left = bind(*binop.left, schema, column_type(*binop.right, schema));
+            bound->right = bind(*binop.right, schema, column_type(*binop.left, schema));
+            return bound;
+        }
+
+        default:
+            throw std::runtime_error("Unsupported expression in predicate");
+    }
+}
+
+Value BoundPredicate::evaluate_value(const BoundExpression& expr, const Row& row) {
+    switch (expr.kind) {
+        case BoundExpressionKind::COLUMN:
+            return row.get(expr.column_index);
+        case BoundExpressionKind::CONSTANT:
+            return expr.constant;
+        default:
+            return Value(evaluate(expr, row));
+    }
+}
+
+bool BoundPredicate::evaluate(const BoundExpression& expr, const Row& row) {
+    switch (expr.kind) {
+        case BoundExpressionKind::AND:
+            return evaluate(*expr.left, row) && evaluate(*expr.right, row);
+        case BoundExpressionKind::OR:
+            return evaluate(*expr.left, row) || evaluate(*expr.right, row);
+        case BoundExpressionKind::COMPARISON: {
+            Value left = evaluate_value(*expr.left, row);
+            Value right = evaluate_value(*expr.right, row);
+            if (left.is_null() || right.is_null()) {
+                return false;
+            }
+
+            int cmp = left.compare(right);
+            switch (expr.op) {
+                case BinaryOperator::EQUALS: return cmp == 0;
+                case BinaryOperator::NOT_EQUALS: return cmp != 0;
+                case BinaryOperator::GREATER: return cmp > 0;
+                case BinaryOperator::LESS: return cmp < 0;
+                case BinaryOperator::GREATER_EQUAL: return cmp >= 0;
+                case BinaryOperator::LESS_EQUAL: return cmp <= 0;
+                default: return false;
+            }
+        }
+        default:
+            return evaluate_value(expr, row).as_bool();
+    }
+}
+
+void BoundPredicate::evaluate_batch(const Row* rows, size_t count, std::vector<uint32_t>& selection) const {
+    for (size_t i = 0; i < count; ++i) {
+        if (evaluate(*root, rows[i])) {
+            selection.push_back(static_cast<uint32_t>(i));
+        }
+    }
+}
@@ -0,0 +1,432 @@
+#include "expression_vm.h"
+#include "string_util.h"
+#include <algorithm>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+
+template<typename Fn>
+void with_comparator(BinaryOperator op, Fn&& fn) {
+    switch (op) {
+        case BinaryOperator::EQUALS: fn(std::equal_to<>()); break;
+        case BinaryOperator::NOT_EQUALS: fn(std::not_equal_to<>()); break;
+        case BinaryOperator::GREATER: fn(std::greater<>()); break;
+        case BinaryOperator::LESS: fn(std::less<>()); break;
+        case BinaryOperator::GREATER_EQUAL: fn(std::greater_equal<>()); break;
+        case BinaryOperator::LESS_EQUAL: fn(std::less_equal<>()); break;
+        default: throw std::runtime_error("Not a comparison operator");
+    }
+}
+
+BinaryOperator flip(BinaryOperator op) {
+    switch (op) {
+        case BinaryOperator::GREATER: return BinaryOperator::LESS;
+        case BinaryOperator::LESS: return BinaryOperator::GREATER;
+        case BinaryOperator::GREATER_EQUAL: return BinaryOperator::LESS_EQUAL;
+        case BinaryOperator::LESS_EQUAL: return BinaryOperator::GREATER_EQUAL;
+        default: return op;
+    }
+}
+
+const char* comparison_name(BinaryOperator op) {
+    switch (op) {
+        case BinaryOperator::EQUALS: return "EQ";
+        case BinaryOperator::NOT_EQUALS: return "NE";
+        case BinaryOperator::GREATER: return "GT";
+        case BinaryOperator::LESS: return "LT";
+        case BinaryOperator::GREATER_EQUAL: return "GE";
+        case BinaryOperator::LESS_EQUAL: return "LE";
+        default: return "??";
+    }
+}
+
+bool compare_constants(const Value& left, const Value& right, BinaryOperator op) {
+    if (left.is_null() || right.is_null()) {
+        return false;
+    }
+    bool result = false;
+    with_comparator(op, [&](auto cmp) { result = cmp(left.compare(right), 0); });
+    return result;
+}
+
+// Memo key text for a constant. Doubles use hexfloat so distinct values never
+// share a key; strings are length-prefixed so their text cannot be read as
+// part of the surrounding "op(left,right)" key.
+std::string constant_key(const Value& value) {
+    std::string key = "k" + std::to_string(static_cast<int>(value.type())) + ":";
+    switch (value.type()) {
+        case ValueType::DOUBLE:
+            return key + format_double("%a", value.as_double());
+        case ValueType::STRING: {
+            std::string_view text = value.as_string();
+            return key + std::to_string(text.size()) + ":" + std::string(text);
+        }
+        default:
+            return key + value.to_string();
+    }
+}
+
+}  // namespace
+
+// Lowers a BoundExpression to bytecode. Each subexpression is keyed by a
+// canonical string so repeated subtrees reuse the register computed first.
+class ExpressionCompiler {
+private:
+    struct Operand {
+        enum Kind { CONSTANT, VALUE_REG, BOOL_REG } kind;
+        Value constant;
+        uint16_t reg = 0;
+        std::string key;
+    };
+
+    ExpressionProgram& program;
+    std::unordered_map<std::string, Operand> memo;
+
+    Operand make_constant(const Value& value) {
+        Operand op{Operand::CONSTANT, value, 0, ""};
+        if (value.type() == ValueType::STRING) {
+            op.constant = Value::string_ref(program.constant_strings.store(value.as_string()));
+        }
+        op.key = constant_key(value);
+        return op;
+    }
+
+    bool lookup(const std::string& key, Operand& result) {
+        auto it = memo.find(key);
+        if (it == memo.end()) {
+            return false;
+        }
+        program.shared_subexpressions++;
+        result = it->second;
+        return true;
+    }
+
+    Operand remember(Operand::Kind kind, uint16_t reg, const std::string& key) {
+        Operand op{kind, Value(), reg, key};
+        memo[key] = op;
+        return op;
+    }
+
+    void emit(OpCode opcode, uint16_t dst, uint16_t left = 0, uint16_t right = 0, uint32_t operand = 0,
+              BinaryOperator comparison = BinaryOperator::EQUALS) {
+        program.code.push_back(Instruction{opcode, comparison, dst, left, right, operand});
+    }
+
+    Operand to_bool(const Operand& op) {
+        if (op.kind != Operand::VALUE_REG) {
+            return op;
+        }
+        std::string key = "truth(" + op.key + ")";
+        Operand cached;
+        if (lookup(key, cached)) {
+            return cached;
+        }
+        uint16_t dst = program.bool_registers++;
+        emit(OpCode::TRUTH, dst, op.reg);
+        return remember(Operand::BOOL_REG, dst, key);
+    }
+
+    Operand compile_comparison(const BoundExpression& expr) {
+        Operand left = compile_node(*expr.left);
+        Operand right = compile_node(*expr.right);
+        BinaryOperator op = expr.op;
+
+        if (left.kind == Operand::BOOL_REG || right.kind == Operand::BOOL_REG) {
+            throw std::runtime_error("Comparisons of boolean subexpressions are not supported by the VM");
+        }
+
+        if (left.kind == Operand::CONSTANT && right.kind == Operand::CONSTANT) {
+            program.folded_constants++;
+            return make_constant(Value(compare_constants(left.constant, right.constant, op)));
+        }
+
+        if (left.kind == Operand::CONSTANT) {
+            std::swap(left, right);
+            op = flip(op);
+        }
+
+        std::string key = std::string(comparison_name(op)) + "(" + left.key + "," + right.key + ")";
+        Operand cached;
+        if (lookup(key, cached)) {
+            return cached;
+        }
+
+        uint16_t dst = program.bool_registers++;
+        if (right.kind == Operand::CONSTANT) {
+            program.constants.push_back(right.constant);
+            emit(OpCode::COMPARE_CONST, dst, left.reg, 0, static_cast<uint32_t>(program.constants.size() - 1), op);
+        } else {
+            emit(OpCode::COMPARE, dst, left.reg, right.reg, 0, op);
+        }
+        return remember(Operand::BOOL_REG, dst, key);
+    }
+
+    Operand compile_logical(const BoundExpression& expr) {
+        bool is_and = expr.kind == BoundExpressionKind::AND;
+        Operand left = to_bool(compile_node(*expr.left));
+        Operand right = to_bool(compile_node(*expr.right));
+
+        for (int pass = 0; pass < 2; ++pass) {
+            const Operand& constant = pass == 0 ? left : right;
+            const Operand& other = pass == 0 ? right : left;
+            if (constant.kind != Operand::CONSTANT) {
+                continue;
+            }
+            program.folded_constants++;
+            bool value = constant.constant.as_bool();
+            if (is_and != value) {
+                // false AND x -> false, true OR x -> true
+                return make_constant(Value(value));
+            }
+            return other;
+        }
+
+        std::string left_key = left.key, right_key = right.key;
+        if (right_key < left_key) {
+            std::swap(left_key, right_key);
+        }
+        std::string key = std::string(is_and ? "and(" : "or(") + left_key + "," + right_key + ")";
+        Operand cached;
+        if (lookup(key, cached)) {
+            return cached;
+        }
+
+        uint16_t dst = program.bool_registers++;
+        emit(is_and ? OpCode::AND : OpCode::OR, dst, left.reg, right.reg);
+        return remember(Operand::BOOL_REG, dst, key);
+    }
+
+public:
+    explicit ExpressionCompiler(ExpressionProgram& target) : program(target) {}
+
+    Operand compile_node(const BoundExpression& expr) {
+        switch (expr.kind) {
+            case BoundExpressionKind::CONSTANT:
+                return make_constant(expr.constant);
+
+            case BoundExpressionKind::COLUMN: {
+                std::string key = "c" + std::to_string(expr.column_index);
+                Operand cached;
+                if (lookup(key, cached)) {
+                    return cached;
+                }
+                uint16_t dst = program.value_registers++;
+                emit(OpCode::LOAD_COLUMN, dst, 0, 0, static_cast<uint32_t>(expr.column_index));
+                return remember(Operand::VALUE_REG, dst, key);
+            }
+
+            case BoundExpressionKind::COMPARISON:
+                return compile_comparison(expr);
+
+            case BoundExpressionKind::AND:
+            case BoundExpressionKind::OR:
+                return compile_logical(expr);
+        }
+        throw std::runtime_error("Unknown bound expression kind");
+    }
+
+    void compile_root(const BoundExpression& expr) {
+        Operand result = to_bool(compile_node(expr));
+        if (result.kind == Operand::CONSTANT) {
+            result.reg = program.bool_registers++;
+            emit(OpCode::CONST_BOOL, result.reg, 0, 0, result.constant.as_bool() ? 1 : 0);
+        }
+        program.result_register = result.reg;
+    }
+};
+
+ExpressionProgram ExpressionProgram::compile(const BoundExpression& expr) {
+    ExpressionProgram program;
+    ExpressionCompiler compiler(program);
+    compiler.compile_root(expr);
+    
+    // Folding can orphan instructions emitted for a subtree before the
+    // constant sibling was seen; drop everything the result does not use.
+    std::vector<bool> live_values(program.value_registers, false);
+    std::vector<bool> live_bools(program.bool_registers, false);
+    live_bools[program.result_register] = true;
+    
+    std::vector<Instruction> kept;
+    for (auto it = program.code.rbegin(); it != program.code.rend(); ++it) {
+        bool writes_value = it->opcode == OpCode::LOAD_COLUMN;
+        bool live = writes_value ? live_values[it->dst] : live_bools[it->dst];
+        if (!live) {
+            continue;
+        }
+        switch (it->opcode) {
+            case OpCode::COMPARE:
+                live_values[it->right] = true;
+                live_values[it->left] = true;
+                break;
+            case OpCode::COMPARE_CONST:
+            case OpCode::TRUTH:
+                live_values[it->left] = true;
+                break;
+            case OpCode::AND:
+            case OpCode::OR:
+                live_bools[it->left] = true;
+                live_bools[it->right] = true;
+                break;
+            default:
+                break;
+        }
+        kept.push_back(*it);
+    }
+    program.code.assign(kept.rbegin(), kept.rend());
+    
+    return program;
+}
+
+std::string ExpressionProgram::disassemble() const {
+    std::ostringstream out;
+    for (size_t pc = 0; pc < code.size(); ++pc) {
+        const auto& ins = code[pc];
+        out << pc << ": ";
+        switch (ins.opcode) {
+            case OpCode::LOAD_COLUMN:
+                out << "LOAD_COLUMN   v" << ins.dst << " <- col " << ins.operand;
+                break;
+            case OpCode::CONST_BOOL:
+                out << "CONST_BOOL    b" << ins.dst << " <- " << (ins.operand ? "true" : "false");
+                break;
+            case OpCode::COMPARE:
+                out << "COMPARE_" << comparison_name(ins.comparison) << "    b" << ins.dst
+                    << " <- v" << ins.left << ", v" << ins.right;
+                break;
+            case OpCode::COMPARE_CONST:
+                out << "COMPARE_" << comparison_name(ins.comparison) << "_K  b" << ins.dst
+                    << " <- v" << ins.left << ", "
+                    << (constants[ins.operand].type() == ValueType::DOUBLE
+                            ? format_double("%.15g", constants[ins.operand].as_double())
+                            : constants[ins.operand].to_string());
+                break;
+            case OpCode::AND:
+                out << "AND           b" << ins.dst << " <- b" << ins.left << ", b" << ins.right;
+                break;
+            case OpCode::OR:
+                out << "OR            b" << ins.dst << " <- b" << ins.left << ", b" << ins.right;
+                break;
+            case OpCode::TRUTH:
+                out << "TRUTH         b" << ins.dst << " <- v" << ins.left;
+                break;
+        }
+        out << "\n";
+    }
+    out << "result: b" << result_register << "\n";
+    return out.str();
+}
+
+void ExpressionVM::prepare(const ExpressionProgram& program, size_t count) {
+    if (value_regs.size() < program.value_registers) {
+        value_regs.resize(program.value_registers);
+    }
+    if (bool_regs.size() < program.bool_registers) {
+        bool_regs.resize(program.bool_registers);
+    }
+    for (size_t r = 0; r < program.value_registers; ++r) {
+        if (value_regs[r].size() < count) value_regs[r].resize(count);
+    }
+    for (size_t r = 0; r < program.bool_registers; ++r) {
+        if (bool_regs[r].size() < count) bool_regs[r].resize(count);
+    }
+}
+
+void ExpressionVM::run(const ExpressionProgram& program, const Row* rows, const uint32_t* selection,
+                       size_t count, std::vector<uint32_t>& output) {
+    prepare(program, count);
+
+    for (const auto& ins : program.code) {
+        switch (ins.opcode) {
+            case OpCode::LOAD_COLUMN: {
+                Value* dst = value_regs[ins.dst].data();
+                size_t column = ins.operand;
+                if (selection) {
+                    for (size_t i = 0; i < count; ++i) dst[i] = rows[selection[i]].get(column);
+                } else {
+                    for (size_t i = 0; i < count; ++i) dst[i] = rows[i].get(column);
+                }
+                break;
+            }
+
+            case OpCode::CONST_BOOL:
+                std::fill_n(bool_regs[ins.dst].begin(), count, static_cast<uint8_t>(ins.operand != 0));
+                break;
+
+            case OpCode::COMPARE_CONST: {
+                const Value* in = value_regs[ins.left].data();
+                uint8_t* out = bool_regs[ins.dst].data();
+                const Value& constant = program.constants[ins.operand];
+
+                with_comparator(ins.comparison, [&](auto cmp) {
+                    if (constant.is_null()) {
+                        std::fill_n(out, count, 0);
+                    } else if (constant.type() == ValueType::INT) {
+                        int64_t k = constant.as_int();
+                        for (size_t i = 0; i < count; ++i) {
+                            const Value& v = in[i];
+                            out[i] = (v.type() == ValueType::INT) ? cmp(v.as_int(), k)
+                                                                  : (!v.is_null() && cmp(v.compare(constant), 0));
+                        }
+                    } else if (constant.type() == ValueType::STRING) {
+                        std::string_view k = constant.as_string();
+                        for (size_t i = 0; i < count; ++i) {
+                            const Value& v = in[i];
+                            out[i] = (v.type() == ValueType::STRING) ? cmp(v.as_string(), k)
+                                                                     : (!v.is_null() && cmp(v.compare(constant), 0));
+                        }
+                    } else {
+                        for (size_t i = 0; i < count; ++i) {
+                            out[i] = !in[i].is_null() && cmp(in[i].compare(constant), 0);
+                        }
+                    }
+                });
+                break;
+            }
+
+            case OpCode::COMPARE: {
+                const Value* left = value_regs[ins.left].data();
+                const Value* right = value_regs[ins.right].data();
+                uint8_t* out = bool_regs[ins.dst].data();
+                with_comparator(ins.comparison, [&](auto cmp) {
+                    for (size_t i = 0; i < count; ++i) {
+                        out[i] = !left[i].is_null() && !right[i].is_null() && cmp(left[i].compare(right[i]), 0);
+                    }
+                });
+                break;
+            }
+
+            case OpCode::AND: {
+                const uint8_t* a = bool_regs[ins.left].data();
+                const uint8_t* b = bool_regs[ins.right].data();
+                uint8_t* out = bool_regs[ins.dst].data();
+                for (size_t i = 0; i < count; ++i) out[i] = a[i] & b[i];
+                break;
+            }
+
+            case OpCode::OR: {
+                const uint8_t* a = bool_regs[ins.left].data();
+                const uint8_t* b = bool_regs[ins.right].data();
+                uint8_t* out = bool_regs[ins.dst].data();
+                for (size_t i = 0; i < count; ++i) out[i] = a[i] | b[i];
+                break;
+            }
+
+            case OpCode::TRUTH: {
+                const Value* in = value_regs[ins.left].data();
+                uint8_t* out = bool_regs[ins.dst].data();
+                for (size_t i = 0; i < count; ++i) out[i] = in[i].as_bool();
+                break;
+            }
+        }
+    }
+
+    const uint8_t* result = bool_regs[program.result_register].data();
+    for (size_t i = 0; i < count; ++i) {
+        if (result[i]) {
+            output.push_back(selection ? selection[i] : static_cast<uint32_t>(i));
+        }
+    }
+}
@@ -0,0 +1,128 @@
+#include "feedback_cache.h"
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+static void collect_tables(const PlanNode& node, std::vector<std::string>& tables) {
+    if (node.type == PlanNodeType::TABLE_SCAN) {
+        tables.push_back(static_cast<const TableScanNode&>(node).table_name);
+    }
+    for (const auto& child : node.children) {
+        collect_tables(*child, tables);
+    }
+}
+
+std::string FeedbackCache::signature(const PlanNode& node) {
+    std::string predicate;
+    switch (node.type) {
+        case PlanNodeType::FILTER:
+            predicate = "filter:" + static_cast<const FilterNode&>(node).condition;
+            break;
+        case PlanNodeType::NESTED_LOOP_JOIN:
+        case PlanNodeType::HASH_JOIN:
+        case PlanNodeType::SORT_MERGE_JOIN:
+        case PlanNodeType::ADAPTIVE_JOIN:
+            predicate = "join:" + static_cast<const JoinNode&>(node).join_condition;
+            break;
+        default:
+            return "";
+    }
+
+    // Sorted so the same join reached in a different order or with a
+    // different algorithm shares its feedback.
+    std::vector<std::string> tables;
+    collect_tables(node, tables);
+    std::sort(tables.begin(), tables.end());
+
+    std::string result = predicate + " on ";
+    for (size_t i = 0; i < tables.size(); ++i) {
+        if (i > 0) result += ",";
+        result += tables[i];
+    }
+    return result;
+}
+
+void FeedbackCache::set_capacity(size_t max_entries) {
+    capacity = max_entries;
+    while (lru.size() > capacity) {
+        entries.erase(lru.back().signature);
+        lru.pop_back();
+    }
+}
+
+void FeedbackCache::observe(const PlanNode& node, size_t actual_rows, double input_rows) {
+    std::string key = signature(node);
+    if (key.empty() || input_rows <= 0) {
+        return;
+    }
+
+    double selectivity = std::min(1.0, actual_rows / input_rows);
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+        lru.splice(lru.begin(), lru, it->second);
+        lru.front().selectivity = SMOOTHING * selectivity + (1.0 - SMOOTHING) * lru.front().selectivity;
+    } else {
+        if (capacity == 0) {
+            return;
+        }
+        if (lru.size() >= capacity) {
+            entries.erase(lru.back().signature);
+            lru.pop_back();
+        }
+        lru.emplace_front();
+        lru.front().signature = key;
+        lru.front().selectivity = selectivity;
+        entries.emplace(key, lru.begin());
+    }
+
+    CardinalityFeedback& entry = lru.front();
+    entry.observations++;
+    entry.last_estimated_rows = node.stats.row_count;
+    entry.last_actual_rows = actual_rows;
+}
+
+void FeedbackCache::record_execution(const PlanNode& plan,
+                                     const std::unordered_map<const PlanNode*, size_t>& actual_rows) {
+    for (const auto& child : plan.children) {
+        record_execution(*child, actual_rows);
+    }
+
+    auto it = actual_rows.find(&plan);
+    if (it == actual_rows.end() || plan.children.empty()) {
+        return;
+    }
+
+    double input_rows = 1.0;
+    for (const auto& child : plan.children) {
+        auto child_it = actual_rows.find(child.get());
+        if (child_it == actual_rows.end()) {
+            return;
+        }
+        input_rows *= static_cast<double>(child_it->second);
+    }
+
+    observe(plan, it->second, input_rows);
+}
+
+bool FeedbackCache::lookup(const PlanNode& node, double& selectivity) const {
+    std::string key = signature(node);
+    if (key.empty()) {
+        return false;
+    }
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        return false;
+    }
+    selectivity = it->second->selectivity;
+    return true;
+}
+
+std::string FeedbackCache::describe() const {
+    std::ostringstream out;
+    for (const auto& entry : lru) {
+        out << entry.signature << ": selectivity " << entry.selectivity
+            << " after " << entry.observations << " runs (last estimated "
+            << entry.last_estimated_rows << ", actual " << entry.last_actual_rows << ")\n";
+    }
+    return out.str();
+}
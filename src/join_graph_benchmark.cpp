@@ -0,0 +1,287 @@
+#include "join_graph_benchmark.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <queue>
+#include <random>
+
+static std::string relation_name(size_t i) {
+    return "jg" + std::to_string(i);
+}
+
+static std::string key_column(size_t i) {
+    return relation_name(i) + "_id";
+}
+
+static std::string reference_column(size_t from, size_t to) {
+    return relation_name(from) + "_ref" + std::to_string(to);
+}
+
+// a.ref_b = b.id for an edge a < b.
+static std::unique_ptr<Expression> edge_condition(size_t a, size_t b) {
+    return std::make_unique<BinaryOpExpression>(
+        std::make_unique<ColumnExpression>(relation_name(a), reference_column(a, b)),
+        std::make_unique<ColumnExpression>(relation_name(b), key_column(b)),
+        BinaryOperator::EQUALS);
+}
+
+JoinGraphBenchmark::JoinGraphBenchmark(TableManager* tm, const JoinGraphOptions& opts)
+    : table_manager(tm), options(opts), executor(tm) {}
+
+const char* JoinGraphBenchmark::shape_name(JoinGraphShape shape) {
+    switch (shape) {
+        case JoinGraphShape::CHAIN: return "chain";
+        case JoinGraphShape::STAR: return "star";
+        case JoinGraphShape::SNOWFLAKE: return "snowflake";
+        case JoinGraphShape::CYCLE: return "cycle";
+        case JoinGraphShape::CLIQUE: return "clique";
+    }
+    return "unknown";
+}
+
+std::vector<std::pair<size_t, size_t>> JoinGraphBenchmark::edges(JoinGraphShape shape, size_t relations) {
+    std::vector<std::pair<size_t, size_t>> result;
+    switch (shape) {
+        case JoinGraphShape::CHAIN:
+            for (size_t i = 0; i + 1 < relations; ++i) {
+                result.emplace_back(i, i + 1);
+            }
+            break;
+        case JoinGraphShape::STAR:
+            for (size_t i = 1; i < relations; ++i) {
+                result.emplace_back(0, i);
+            }
+            break;
+        case JoinGraphShape::SNOWFLAKE: {
+            // Half the relations are dimensions of jg0, the rest hang off them.
+            size_t dimensions = relations / 2;
+            for (size_t i = 1; i < relations; ++i) {
+                result.emplace_back(i <= dimensions ? 0 : i - dimensions, i);
+            }
+            break;
+        }
+        case JoinGraphShape::CYCLE:
+            for (size_t i = 0; i + 1 < relations; ++i) {
+                result.emplace_back(i, i + 1);
+            }
+            if (relations > 2) {
+                result.emplace_back(0, relations - 1);
+            }
+            break;
+        case JoinGraphShape::CLIQUE:
+            for (size_t i = 0; i < relations; ++i) {
+                for (size_t j = i + 1; j < relations; ++j) {
+                    result.emplace_back(i, j);
+                }
+            }
+            break;
+    }
+    return result;
+}
+
+SelectStatement JoinGraphBenchmark::build_query(JoinGraphShape shape, size_t relations) {
+    if (relations < 2) {
+        throw std::runtime_error("Join graph needs at least two relations");
+    }
+    auto graph = edges(shape, relations);
+
+    std::vector<std::vector<size_t>> adjacent(relations);
+    for (const auto& [a, b] : graph) {
+        adjacent[a].push_back(b);
+        adjacent[b].push_back(a);
+    }
+
+    SelectStatement stmt;
+    stmt.from_table = TableReference(relation_name(0));
+    for (size_t i = 0; i < relations; ++i) {
+        stmt.select_list.emplace_back(std::make_unique<ColumnExpression>(relation_name(i), key_column(i)));
+    }
+
+    // Breadth-first spanning tree: each newly reached relation joins on the
+    // edge that reached it.
+    std::vector<bool> joined(relations, false);
+    std::vector<std::pair<size_t, size_t>> tree_edges;
+    std::queue<size_t> frontier;
+    joined[0] = true;
+    frontier.push(0);
+    while (!frontier.empty()) {
+        size_t from = frontier.front();
+        frontier.pop();
+        for (size_t to : adjacent[from]) {
+            if (joined[to]) {
+                continue;
+            }
+            joined[to] = true;
+            frontier.push(to);
+            size_t a = std::min(from, to), b = std::max(from, to);
+            tree_edges.emplace_back(a, b);
+            stmt.joins.emplace_back(JoinClause::INNER, TableReference(relation_name(to)), edge_condition(a, b));
+        }
+    }
+
+    for (const auto& edge : graph) {
+        if (std::find(tree_edges.begin(), tree_edges.end(), edge) != tree_edges.end()) {
+            continue;
+        }
+        auto condition = edge_condition(edge.first, edge.second);
+        stmt.where_clause = stmt.where_clause
+            ? std::make_unique<BinaryOpExpression>(std::move(stmt.where_clause), std::move(condition), BinaryOperator::AND)
+            : std::move(condition);
+    }
+    return stmt;
+}
+
+void JoinGraphBenchmark::create_tables(JoinGraphShape shape, size_t relations) {
+    for (size_t i = 0; i < created_tables; ++i) {
+        table_manager->drop_table(relation_name(i));
+    }
+    created_tables = relations;
+
+    auto graph = edges(shape, relations);
+    std::mt19937 gen(static_cast<std::mt19937::result_type>(DataGenerator::get_seed()));
+    size_t rows = std::max<size_t>(1, options.rows_per_table);
+
+    for (size_t i = 0; i < relations; ++i) {
+        TableSchema schema;
+        schema.add_column(key_column(i), "int");
+        std::vector<size_t> references;
+        for (const auto& [a, b] : graph) {
+            if (a == i) {
+                schema.add_column(reference_column(a, b), "int");
+                references.push_back(b);
+            }
+        }
+        table_manager->create_table(relation_name(i), schema);
+        Table* table = table_manager->get_table(relation_name(i));
+        table->reserve(rows);
+
+        for (size_t r = 0; r < rows; ++r) {
+            Row row;
+            row.add_value(static_cast<int64_t>(r));
+            for (size_t ref = 0; ref < references.size(); ++ref) {
+                row.add_value(static_cast<int64_t>(gen() % rows));
+            }
+            table->add_row(std::move(row));
+        }
+
+        size_t width = schema.column_count() * sizeof(Value);
+        optimizer.set_table_statistics(relation_name(i),
+                                       TableStatistics(rows, std::max<size_t>(1, rows * width / 4096), width));
+    }
+}
+
+JoinGraphResult JoinGraphBenchmark::run(JoinGraphShape shape, size_t relations) {
+    JoinGraphResult result;
+    result.shape = shape;
+    result.relations = relations;
+    result.edges = edges(shape, relations).size();
+
+    try {
+        create_tables(shape, relations);
+        SelectStatement stmt = build_query(shape, relations);
+
+        optimizer.reset_stats();
+        auto start = std::chrono::steady_clock::now();
+        auto candidates = optimizer.generate_all_plans(stmt);
+        auto plan = optimizer.select_best_plan(candidates);
+        result.optimize_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        result.optimizer = optimizer.get_stats();
+        result.plans_costed = result.optimizer.plans_costed;
+        if (!plan) {
+            throw std::runtime_error("optimizer produced no plan");
+        }
+        result.chosen_cost = plan->cost.total_cost;
+
+        if (relations <= options.execute_max_relations) {
+            for (size_t i = 0; i < options.timing.warmup_runs; ++i) {
+                executor.execute(*plan);
+            }
+            std::vector<double> samples;
+            for (size_t i = 0; i < std::max<size_t>(1, options.timing.repetitions); ++i) {
+                auto run_start = std::chrono::steady_clock::now();
+                auto rows = executor.execute(*plan);
+                samples.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - run_start).count());
+                result.result_rows = rows->size();
+            }
+            result.execution = TimingStats::from_samples(std::move(samples));
+            result.execution.set_throughput(relations * options.rows_per_table,
+                                            relations * options.rows_per_table * sizeof(Value));
+            result.executed = true;
+        }
+    } catch (const std::exception& e) {
+        result.error = e.what();
+    }
+
+    results.push_back(result);
+    return result;
+}
+
+void JoinGraphBenchmark::run_all(size_t min_relations, size_t max_relations) {
+    if (options.timing.pin_cpu >= 0) {
+        pin_current_thread(options.timing.pin_cpu);
+    }
+    for (auto shape : {JoinGraphShape::CHAIN, JoinGraphShape::STAR, JoinGraphShape::SNOWFLAKE,
+                       JoinGraphShape::CYCLE, JoinGraphShape::CLIQUE}) {
+        for (size_t n = std::max<size_t>(2, min_relations); n <= max_relations; ++n) {
+            run(shape, n);
+        }
+    }
+}
+
+void JoinGraphBenchmark::print_results() const {
+    std::cout << "\n=== Join Graph Benchmark (" << options.rows_per_table << " rows per relation) ===" << std::endl;
+    std::cout << std::left << std::setw(11) << "Shape"
+              << std::right << std::setw(5) << "N"
+              << std::setw(7) << "Edges"
+              << std::setw(12) << "Opt (ms)"
+              << std::setw(12) << "Cost (ms)"
+              << std::setw(8) << "Plans"
+              << std::setw(16) << "Chosen cost"
+              << std::setw(12) << "Exec (ms)"
+              << std::setw(10) << "Rows" << std::endl;
+    std::cout << std::string(93, '-') << std::endl;
+
+    for (const auto& result : results) {
+        std::cout << std::left << std::setw(11) << shape_name(result.shape)
+                  << std::right << std::setw(5) << result.relations
+                  << std::setw(7) << result.edges;
+        if (!result.error.empty()) {
+            std::cout << "  ERROR: " << result.error << std::endl;
+            continue;
+        }
+        std::cout << std::fixed << std::setprecision(3) << std::setw(12) << result.optimize_ms
+                  << std::setw(12) << result.optimizer.cost_model_ms
+                  << std::setw(8) << result.plans_costed
+                  << std::scientific << std::setprecision(3) << std::setw(16) << result.chosen_cost
+                  << std::fixed;
+        if (result.executed) {
+            std::cout << std::setprecision(2) << std::setw(12) << result.execution.median_ms
+                      << std::setw(10) << result.result_rows;
+        } else {
+            std::cout << std::setw(12) << "-" << std::setw(10) << "-";
+        }
+        std::cout << std::endl;
+    }
+}
+
+BenchmarkReport JoinGraphBenchmark::report() const {
+    BenchmarkReport out;
+    out.metadata = BenchmarkMetadata::collect();
+    out.metadata.parameters.emplace_back("seed", std::to_string(DataGenerator::get_seed()));
+    out.metadata.parameters.emplace_back("rows_per_table", std::to_string(options.rows_per_table));
+    out.metadata.parameters.emplace_back("repetitions", std::to_string(options.timing.repetitions));
+
+    for (const auto& result : results) {
+        if (!result.executed) {
+            continue;
+        }
+        BenchmarkEntry entry;
+        entry.query_name = std::string("JoinGraph_") + shape_name(result.shape) + "_" + std::to_string(result.relations);
+        entry.plan_type = "Optimized";
+        entry.estimated_cost = result.chosen_cost;
+        entry.result_size = result.result_rows;
+        entry.timing = result.execution;
+        out.entries.push_back(entry);
+    }
+    return out;
+}
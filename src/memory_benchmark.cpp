@@ -0,0 +1,203 @@
+#include "memory_benchmark.h"
+#include "executor.h"
+#include "memory_context.h"
+#include "spill_file.h"
+#include <any>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+
+namespace {
+
+// Heap bytes and allocations retained between construction and finish().
+class HeapDelta {
+private:
+    AllocationStats start;
+
+public:
+    HeapDelta() : start(AllocationCounter::read()) {}
+
+    void finish(LayoutFootprint& footprint) const {
+        AllocationStats end = AllocationCounter::read();
+        footprint.bytes = end.current_bytes - std::min(end.current_bytes, start.current_bytes);
+        footprint.allocations = (end.allocations - start.allocations) - (end.frees - start.frees);
+    }
+};
+
+void fill_users(Table& users, size_t rows, std::mt19937& gen) {
+    TableSchema schema;
+    schema.add_column("id", "int");
+    schema.add_column("name", "string");
+    schema.add_column("age", "int");
+    schema.add_column("city", "string");
+    users.set_schema(schema);
+    users.reserve(rows);
+
+    std::uniform_int_distribution<> age_dist(18, 65);
+    std::uniform_int_distribution<> city_dist(1, 20);
+    for (size_t i = 1; i <= rows; ++i) {
+        Row row;
+        row.add_value(static_cast<int>(i));
+        row.add_value(users.make_string("User" + std::to_string(i)));
+        row.add_value(age_dist(gen));
+        row.add_value(users.make_string("City" + std::to_string(city_dist(gen))));
+        users.add_row(std::move(row));
+    }
+}
+
+void fill_orders(Table& orders, size_t rows, size_t users, std::mt19937& gen) {
+    TableSchema schema;
+    schema.add_column("order_id", "int");
+    schema.add_column("user_id", "int");
+    schema.add_column("product", "string");
+    schema.add_column("amount", "int");
+    orders.set_schema(schema);
+    orders.reserve(rows);
+
+    std::uniform_int_distribution<> user_dist(1, static_cast<int>(users));
+    std::uniform_int_distribution<> product_dist(1, 200);
+    std::uniform_int_distribution<> amount_dist(10, 1000);
+    for (size_t i = 1; i <= rows; ++i) {
+        Row row;
+        row.add_value(static_cast<int>(i));
+        row.add_value(user_dist(gen));
+        row.add_value(orders.make_string("Product" + std::to_string(product_dist(gen))));
+        row.add_value(amount_dist(gen));
+        orders.add_row(std::move(row));
+    }
+}
+
+double payload_per_row(const std::vector<Row>& rows) {
+    size_t bytes = 0;
+    for (const auto& row : rows) {
+        for (const auto& value : row.values) {
+            bytes += value.type() == ValueType::STRING ? value.as_string().size() : sizeof(int64_t);
+        }
+    }
+    return rows.empty() ? 0.0 : static_cast<double>(bytes) / rows.size();
+}
+
+}  // namespace
+
+MemoryBenchmark::MemoryBenchmark(size_t rows, uint64_t generator_seed)
+    : row_count(std::max<size_t>(1, rows)), seed(generator_seed) {}
+
+const std::vector<LayoutFootprint>& MemoryBenchmark::run() {
+    results.clear();
+    std::mt19937 gen(static_cast<std::mt19937::result_type>(seed));
+    size_t user_rows = std::max<size_t>(1, row_count / 5);
+
+    auto add = [this](const std::string& layout, size_t rows, size_t columns, double payload) -> LayoutFootprint& {
+        LayoutFootprint footprint;
+        footprint.layout = layout;
+        footprint.rows = rows;
+        footprint.columns = columns;
+        footprint.payload_bytes_per_row = payload;
+        results.push_back(footprint);
+        return results.back();
+    };
+
+    TableManager tm;
+    tm.create_table("users", TableSchema());
+    tm.create_table("orders", TableSchema());
+    Table* users = tm.get_table("users");
+    Table* orders = tm.get_table("orders");
+
+    {
+        HeapDelta delta;
+        fill_orders(*orders, row_count, user_rows, gen);
+        delta.finish(add("Table (Row of Value + string heap)", row_count, 4, payload_per_row(orders->get_rows())));
+    }
+    fill_users(*users, user_rows, gen);
+    double order_payload = payload_per_row(orders->get_rows());
+
+    // The representation Row used before Value: every field boxed in
+    // std::any, strings owned per field.
+    {
+        HeapDelta delta;
+        std::vector<std::vector<std::any>> boxed;
+        boxed.reserve(row_count);
+        for (const auto& row : orders->get_rows()) {
+            std::vector<std::any> fields;
+            fields.reserve(row.size());
+            for (const auto& value : row.values) {
+                if (value.type() == ValueType::STRING) {
+                    fields.emplace_back(std::string(value.as_string()));
+                } else {
+                    fields.emplace_back(static_cast<int>(value.as_int()));
+                }
+            }
+            boxed.push_back(std::move(fields));
+        }
+        delta.finish(add("std::any rows (before Value)", row_count, 4, order_payload));
+    }
+
+    Executor executor(&tm);
+    {
+        TableScanNode scan("orders");
+        HeapDelta delta;
+        auto result = executor.execute(scan);
+        delta.finish(add("Intermediate result (scan copy)", result->size(), 4, order_payload));
+    }
+
+    {
+        HashJoinNode join(JoinType::INNER, "users.id = orders.user_id");
+        join.children.push_back(std::make_unique<TableScanNode>("users"));
+        join.children.push_back(std::make_unique<TableScanNode>("orders"));
+        HeapDelta delta;
+        auto result = executor.execute(join);
+        double payload = payload_per_row(result->get_rows());
+        delta.finish(add("Join output (8 values)", result->size(), 8, payload));
+    }
+
+    {
+        HeapDelta delta;
+        std::unordered_map<Value, std::vector<const Row*>, ValueHash> build(orders->row_count());
+        for (const auto& row : orders->get_rows()) {
+            build[row.get(0)].push_back(&row);
+        }
+        delta.finish(add("Hash join build table (per build row)", row_count, 4, sizeof(int64_t)));
+    }
+
+    {
+        SpillFile spill;
+        for (const auto& row : orders->get_rows()) {
+            spill.write_row(row);
+        }
+        LayoutFootprint& footprint = add("Spill file (on disk)", spill.get_rows_written(), 4, order_payload);
+        footprint.bytes = spill.get_bytes_written();
+    }
+
+    return results;
+}
+
+void MemoryBenchmark::print_results() const {
+    std::cout << "\n=== Bytes per Row by Storage Layout ===" << std::endl;
+    if (!AllocationCounter::installed()) {
+        std::cout << "Heap counts need src/alloc_counter.cpp linked in; only file sizes are shown." << std::endl;
+    }
+    std::cout << std::left << std::setw(40) << "Layout"
+              << std::right << std::setw(10) << "Rows"
+              << std::setw(14) << "Bytes/row"
+              << std::setw(14) << "Payload/row"
+              << std::setw(10) << "Overhead"
+              << std::setw(12) << "Allocs/row" << std::endl;
+    std::cout << std::string(100, '-') << std::endl;
+
+    for (const auto& r : results) {
+        bool heap = r.layout.find("on disk") == std::string::npos;
+        std::cout << std::left << std::setw(40) << r.layout
+                  << std::right << std::setw(10) << r.rows << std::fixed << std::setprecision(1);
+        if (heap && !AllocationCounter::installed()) {
+            std::cout << std::setw(14) << "-" << std::setw(14) << r.payload_bytes_per_row
+                      << std::setw(10) << "-" << std::setw(12) << "-" << std::endl;
+            continue;
+        }
+        std::cout << std::setw(14) << r.bytes_per_row()
+                  << std::setw(14) << r.payload_bytes_per_row
+                  << std::setw(9) << r.overhead() << "x"
+                  << std::setw(12) << std::setprecision(2)
+                  << (r.rows > 0 ? static_cast<double>(r.allocations) / r.rows : 0.0) << std::endl;
+    }
+}
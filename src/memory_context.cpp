@@ -0,0 +1,123 @@
+#include "memory_context.h"
+#include <algorithm>
+#include <fstream>
+#include <string>
+
+// Defined by src/alloc_counter.cpp when it is linked in.
+extern "C" void qo_alloc_counter_read(AllocationStats* stats) __attribute__((weak));
+extern "C" void qo_alloc_counter_reset_peak() __attribute__((weak));
+
+bool AllocationCounter::installed() {
+    return qo_alloc_counter_read != nullptr;
+}
+
+AllocationStats AllocationCounter::read() {
+    AllocationStats stats;
+    if (qo_alloc_counter_read) {
+        qo_alloc_counter_read(&stats);
+    }
+    return stats;
+}
+
+void AllocationCounter::reset_peak() {
+    if (qo_alloc_counter_reset_peak) {
+        qo_alloc_counter_reset_peak();
+    }
+}
+
+static size_t proc_status_bytes(const std::string& field) {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, field.size(), field) == 0 && line.size() > field.size() && line[field.size()] == ':') {
+            return std::stoull(line.substr(field.size() + 1)) * 1024;   // reported in kB
+        }
+    }
+    return 0;
+}
+
+size_t current_rss_bytes() {
+    return proc_status_bytes("VmRSS");
+}
+
+size_t peak_rss_bytes() {
+    return proc_status_bytes("VmHWM");
+}
+
+bool reset_peak_rss() {
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5" << std::flush;
+    return static_cast<bool>(clear_refs);
+}
+
+MemoryContext::MemoryContext(size_t limit_bytes, size_t arena_block_size)
+    : block_size(arena_block_size), memory_limit(limit_bytes) {}
+
+bool MemoryContext::would_exceed(size_t bytes) const {
+    return memory_limit > 0 && bytes_in_use + bytes > memory_limit;
+}
+
+void MemoryContext::charge(const PlanNode* owner, size_t bytes) {
+    if (would_exceed(bytes)) {
+        throw MemoryLimitExceeded(bytes, bytes_in_use, memory_limit);
+    }
+
+    bytes_in_use += bytes;
+    peak_bytes = std::max(peak_bytes, bytes_in_use);
+
+    auto& op = operators[owner];
+    op.current += bytes;
+    op.peak = std::max(op.peak, op.current);
+}
+
+void MemoryContext::release(const PlanNode* owner, size_t bytes) {
+    bytes_in_use -= std::min(bytes_in_use, bytes);
+
+    auto it = operators.find(owner);
+    if (it != operators.end()) {
+        it->second.current -= std::min(it->second.current, bytes);
+    }
+}
+
+void* MemoryContext::allocate(size_t bytes, size_t alignment, const PlanNode* owner) {
+    if (!blocks.empty()) {
+        auto& block = blocks.back();
+        size_t offset = (block.used + alignment - 1) & ~(alignment - 1);
+        if (offset + bytes <= block.size) {
+            block.used = offset + bytes;
+            return block.data.get() + offset;
+        }
+    }
+
+    // Fresh blocks come from operator new[] and are max-aligned, so offsets
+    // only need to be aligned relative to the block start.
+    size_t size = std::max(block_size, bytes);
+    charge(owner, size);
+    arena_bytes += size;
+
+    blocks.push_back(Block{std::make_unique<char[]>(size), size, bytes});
+    return blocks.back().data.get();
+}
+
+size_t MemoryContext::operator_bytes(const PlanNode* owner) const {
+    auto it = operators.find(owner);
+    return (it != operators.end()) ? it->second.current : 0;
+}
+
+MemoryUsage MemoryContext::usage() const {
+    MemoryUsage result;
+    result.peak_bytes = peak_bytes;
+    result.arena_bytes = arena_bytes;
+    for (const auto& [owner, op] : operators) {
+        result.operator_peak_bytes[owner] = op.peak;
+    }
+    return result;
+}
+
+void MemoryContext::reset() {
+    blocks.clear();
+    operators.clear();
+    bytes_in_use = 0;
+    peak_bytes = 0;
+    arena_bytes = 0;
+}
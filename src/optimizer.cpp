@@ -1,7 +1,56 @@
 #include "optimizer.h"
+#include "trace.h"
 #include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <iostream>
 
+namespace {
+
+// Adds a scope's wall time to one OptimizerStats timer and traces it.
+class PhaseTimer {
+private:
+    double& total_ms;
+    TraceSpan span;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    PhaseTimer(double& phase_ms, const char* name)
+        : total_ms(phase_ms), span("optimizer", name), start(std::chrono::steady_clock::now()) {}
+    ~PhaseTimer() {
+        total_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+}
+
+std::string OptimizerStats::to_string() const {
+    char buffer[512];
+    std::snprintf(buffer, sizeof(buffer),
+                  "Optimizer: %.3fms (binding %.3fms, rewrites %.3fms, enumeration %.3fms, costing %.3fms, "
+                  "selection %.3fms, annotation %.3fms)\n"
+                  "  plans: %zu explored, %zu costed, %zu rejected, %zu failed\n"
+                  "  cost model: %.3fms, %zu cost estimates, %zu cardinality estimates, feedback %zu hits / %zu misses",
+                  total_ms, binding_ms, rewrite_ms, enumeration_ms, costing_ms, selection_ms, annotation_ms,
+                  plans_explored, plans_costed, plans_rejected, plans_failed,
+                  cost_model_ms, cost_estimates, cardinality_estimates, feedback_hits, feedback_misses);
+    return buffer;
+}
+
+std::string OptimizerStats::to_json() const {
+    char buffer[768];
+    std::snprintf(buffer, sizeof(buffer),
+                  "{\"total_ms\": %.4f, \"binding_ms\": %.4f, \"rewrite_ms\": %.4f, \"enumeration_ms\": %.4f, "
+                  "\"costing_ms\": %.4f, \"selection_ms\": %.4f, \"annotation_ms\": %.4f, "
+                  "\"plans_explored\": %zu, \"plans_costed\": %zu, \"plans_rejected\": %zu, \"plans_failed\": %zu, "
+                  "\"cost_model_ms\": %.4f, \"cost_estimates\": %zu, \"cardinality_estimates\": %zu, "
+                  "\"feedback_hits\": %zu, \"feedback_misses\": %zu}",
+                  total_ms, binding_ms, rewrite_ms, enumeration_ms, costing_ms, selection_ms, annotation_ms,
+                  plans_explored, plans_costed, plans_rejected, plans_failed,
+                  cost_model_ms, cost_estimates, cardinality_estimates, feedback_hits, feedback_misses);
+    return buffer;
+}
+
 QueryOptimizer::QueryOptimizer() {
     cost_model.set_table_statistics("users", TableStatistics(1000, 10, 120));
     cost_model.set_table_statistics("orders", TableStatistics(5000, 50, 80));
@@ -12,14 +61,46 @@ void QueryOptimizer::set_table_statistics(const std::string& table_name, const T
     plan_builder.set_table_statistics(table_name, Statistics(stats.tuple_count, stats.page_count, 1.0));
 }
 
+void QueryOptimizer::remove_table_statistics(const std::string& table_name) {
+    cost_model.remove_table_statistics(table_name);
+    plan_builder.remove_table_statistics(table_name);
+}
+
+OptimizerStats QueryOptimizer::get_stats() const {
+    OptimizerStats result = stats;
+    const CostModelStats& model = cost_model.get_stats();
+    result.cost_estimates = model.cost_estimates;
+    result.cardinality_estimates = model.cardinality_estimates;
+    result.feedback_hits = model.feedback_hits;
+    result.feedback_misses = model.feedback_misses;
+    result.cost_model_ms = model.elapsed_ms;
+    return result;
+}
+
+void QueryOptimizer::reset_stats() {
+    stats = OptimizerStats();
+    cost_model.reset_stats();
+}
+
+CostEstimate QueryOptimizer::cost_candidate(PlanNode& plan) {
+    PhaseTimer timer(stats.costing_ms, "cost plan");
+    plan.cost = cost_model.estimate_plan_cost(plan);
+    ++stats.plans_costed;
+    return plan.cost;
+}
+
 std::unique_ptr<PlanNode> QueryOptimizer::optimize_single_table(const SelectStatement& stmt) {
-    auto plan = plan_builder.build_plan(stmt);
-    
-    plan = apply_filter_pushdown(std::move(plan));
-    
-    auto cost = cost_model.estimate_plan_cost(*plan);
-    plan->cost = cost;
-    
+    ++stats.plans_explored;
+    std::unique_ptr<PlanNode> plan;
+    {
+        PhaseTimer timer(stats.binding_ms, "bind");
+        plan = plan_builder.build_plan(stmt);
+    }
+    {
+        PhaseTimer timer(stats.rewrite_ms, "rewrite");
+        plan = apply_filter_pushdown(std::move(plan));
+    }
+    cost_candidate(*plan);
     return plan;
 }
 
@@ -34,14 +115,35 @@ std::unique_ptr<PlanNode> QueryOptimizer::optimize_join_query(const SelectStatem
 }
 
 std::unique_ptr<PlanNode> QueryOptimizer::optimize(const SelectStatement& stmt) {
+    reset_stats();
+    PhaseTimer timer(stats.total_ms, "optimize");
+    std::unique_ptr<PlanNode> plan;
     if (stmt.joins.empty()) {
-        return optimize_single_table(stmt);
+        plan = optimize_single_table(stmt);
     } else {
-        return optimize_join_query(stmt);
+        plan = optimize_join_query(stmt);
     }
+    
+    if (plan) {
+        PhaseTimer annotate_timer(stats.annotation_ms, "annotate cardinalities");
+        annotate_cardinalities(*plan);
+    }
+    return plan;
+}
+
+// Stamps the cost model's cardinality estimates onto the chosen plan so
+// the executor and feedback loop compare against what was actually assumed.
+void QueryOptimizer::annotate_cardinalities(PlanNode& node) {
+    for (auto& child : node.children) {
+        annotate_cardinalities(*child);
+    }
+    node.stats.row_count = cost_model.estimate_output_cardinality(node);
 }
 
 std::vector<QueryOptimizer::PlanCandidate> QueryOptimizer::generate_all_plans(const SelectStatement& stmt) {
+    TraceSpan span("optimizer", "enumerate plans");
+    auto start = std::chrono::steady_clock::now();
+    double nested_ms = stats.binding_ms + stats.costing_ms;
     std::vector<PlanCandidate> candidates;
     
     std::vector<PlanNodeType> join_algorithms = {
@@ -51,26 +153,30 @@ std::vector<QueryOptimizer::PlanCandidate> QueryOptimizer::generate_all_plans(co
     };
     
     for (auto algorithm : join_algorithms) {
+        ++stats.plans_explored;
         try {
-            auto plan = plan_builder.build_scan_node(stmt.from_table);
-            
-            for (const auto& join : stmt.joins) {
-                auto right_plan = plan_builder.build_scan_node(join.table);
-                plan = plan_builder.build_join_node(std::move(plan), std::move(right_plan), join, algorithm);
-            }
-            
-            if (stmt.where_clause) {
-                plan = plan_builder.build_filter_node(std::move(plan), *stmt.where_clause);
+            std::unique_ptr<PlanNode> plan;
+            {
+                PhaseTimer timer(stats.binding_ms, "bind");
+                plan = plan_builder.build_scan_node(stmt.from_table);
+                
+                for (const auto& join : stmt.joins) {
+                    auto right_plan = plan_builder.build_scan_node(join.table);
+                    plan = plan_builder.build_join_node(std::move(plan), std::move(right_plan), join, algorithm);
+                }
+                
+                if (stmt.where_clause) {
+                    plan = plan_builder.build_filter_node(std::move(plan), *stmt.where_clause);
+                }
+                
+                plan = plan_builder.build_project_node(std::move(plan), stmt.select_list);
             }
             
-            plan = plan_builder.build_project_node(std::move(plan), stmt.select_list);
-            
-            auto cost = cost_model.estimate_plan_cost(*plan);
-            plan->cost = cost;
-            
+            auto cost = cost_candidate(*plan);
             candidates.emplace_back(std::move(plan), cost);
             
         } catch (const std::exception& e) {
+            ++stats.plans_failed;
             std::cerr << "Error generating plan with algorithm " << static_cast<int>(algorithm) 
                       << ": " << e.what() << std::endl;
         }
@@ -78,32 +184,34 @@ std::vector<QueryOptimizer::PlanCandidate> QueryOptimizer::generate_all_plans(co
     
     if (stmt.joins.size() == 1) {
         try {
-            auto right_first = plan_builder.build_scan_node(stmt.joins[0].table);
-            auto left_second = plan_builder.build_scan_node(stmt.from_table);
-            
             for (auto algorithm : join_algorithms) {
-                auto plan = plan_builder.build_join_node(std::move(right_first), std::move(left_second), 
-                                                       stmt.joins[0], algorithm);
-                
-                if (stmt.where_clause) {
-                    plan = plan_builder.build_filter_node(std::move(plan), *stmt.where_clause);
+                ++stats.plans_explored;
+                std::unique_ptr<PlanNode> plan;
+                {
+                    PhaseTimer timer(stats.binding_ms, "bind");
+                    auto right_first = plan_builder.build_scan_node(stmt.joins[0].table);
+                    auto left_second = plan_builder.build_scan_node(stmt.from_table);
+                    plan = plan_builder.build_join_node(std::move(right_first), std::move(left_second),
+                                                        stmt.joins[0], algorithm);
+                    
+                    if (stmt.where_clause) {
+                        plan = plan_builder.build_filter_node(std::move(plan), *stmt.where_clause);
+                    }
+                    
+                    plan = plan_builder.build_project_node(std::move(plan), stmt.select_list);
                 }
                 
-                plan = plan_builder.build_project_node(std::move(plan), stmt.select_list);
-                
-                auto cost = cost_model.estimate_plan_cost(*plan);
-                plan->cost = cost;
-                
+                auto cost = cost_candidate(*plan);
                 candidates.emplace_back(std::move(plan), cost);
-                
-                right_first = plan_builder.build_scan_node(stmt.joins[0].table);
-                left_second = plan_builder.build_scan_node(stmt.from_table);
             }
         } catch (const std::exception& e) {
+            ++stats.plans_failed;
             std::cerr << "Error generating reversed join plan: " << e.what() << std::endl;
         }
     }
     
+    double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    stats.enumeration_ms += std::max(0.0, elapsed_ms - (stats.binding_ms + stats.costing_ms - nested_ms));
     return candidates;
 }
 
@@ -112,10 +220,12 @@ std::unique_ptr<PlanNode> QueryOptimizer::select_best_plan(std::vector<PlanCandi
         return nullptr;
     }
     
+    PhaseTimer timer(stats.selection_ms, "select plan");
     auto best_it = std::min_element(candidates.begin(), candidates.end(),
         [](const PlanCandidate& a, const PlanCandidate& b) {
             return a.cost.total_cost < b.cost.total_cost;
         });
+    stats.plans_rejected += candidates.size() - 1;
     
     return std::move(best_it->plan);
 }
@@ -150,4 +260,6 @@ void QueryOptimizer::print_optimization_report(const std::vector<PlanCandidate>&
         std::cout << "\n*** SELECTED PLAN " << (best_index + 1) 
                   << " (Lowest Cost: " << best_it->cost.total_cost << ") ***" << std::endl;
     }
+    
+    std::cout << "\n" << get_stats().to_string() << std::endl;
 }
\ No newline at end of file
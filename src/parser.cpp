@@ -1,11 +1,12 @@
 #include "parser.h"
+#include "trace.h"
 #include <stdexcept>
 #include <iostream>
 
 Parser::Parser(const std::vector<Token>& token_list) : tokens(token_list), current(0) {}
 
 Token Parser::peek() const {
-    if (isAtEnd()) return Token(TokenType::END_OF_FILE, "", tokens.size());
+    if (current >= tokens.size()) return Token(TokenType::END_OF_FILE, "", tokens.size());
     return tokens[current];
 }
 
@@ -168,6 +169,7 @@ JoinClause Parser::parseJoinClause() {
 }
 
 std::unique_ptr<SelectStatement> Parser::parseSelectStatement() {
+    TraceSpan span("parse", "parse");
     auto stmt = std::make_unique<SelectStatement>();
     
     consume(TokenType::SELECT, "Expected SELECT keyword");
@@ -191,4 +193,14 @@ std::unique_ptr<SelectStatement> Parser::parseSelectStatement() {
     }
     
     return stmt;
+}
+
+std::unique_ptr<Expression> Parser::parseCondition() {
+    auto expr = parseExpression();
+    
+    if (!isAtEnd()) {
+        throw std::runtime_error("Parse error: Unexpected token after condition: " + peek().value);
+    }
+    
+    return expr;
 }
\ No newline at end of file
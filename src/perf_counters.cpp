@@ -0,0 +1,156 @@
+#include "perf_counters.h"
+#include <cstring>
+#include <cstdio>
+
+#ifdef __linux__
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static const char* EVENT_NAMES[PerfCounts::EVENT_COUNT] = {
+    "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses"
+};
+
+const char* PerfCounts::event_name(PerfEvent event) {
+    return EVENT_NAMES[static_cast<int>(event)];
+}
+
+double PerfCounts::ipc() const {
+    if (!has(PerfEvent::CYCLES) || !has(PerfEvent::INSTRUCTIONS) || get(PerfEvent::CYCLES) == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(get(PerfEvent::INSTRUCTIONS)) / get(PerfEvent::CYCLES);
+}
+
+PerfCounts PerfCounts::operator-(const PerfCounts& earlier) const {
+    PerfCounts delta;
+    delta.available = available & earlier.available;
+    for (size_t i = 0; i < EVENT_COUNT; ++i) {
+        delta.values[i] = values[i] >= earlier.values[i] ? values[i] - earlier.values[i] : 0;
+    }
+    return delta;
+}
+
+std::string PerfCounts::to_string() const {
+    std::string out;
+    for (size_t i = 0; i < EVENT_COUNT; ++i) {
+        if (available & (1u << i)) {
+            if (!out.empty()) out += " ";
+            out += std::string(EVENT_NAMES[i]) + "=" + std::to_string(values[i]);
+        }
+    }
+    if (ipc() > 0) {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), " ipc=%.2f", ipc());
+        out += buffer;
+    }
+    return out;
+}
+
+std::string PerfCounts::to_json() const {
+    std::string out = "{";
+    bool first = true;
+    for (size_t i = 0; i < EVENT_COUNT; ++i) {
+        if (available & (1u << i)) {
+            out += std::string(first ? "" : ", ") + "\"" + EVENT_NAMES[i] + "\": " + std::to_string(values[i]);
+            first = false;
+        }
+    }
+    return out + "}";
+}
+
+#ifdef __linux__
+
+static int open_counter(uint32_t type, uint64_t config) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+PerfCounters::PerfCounters() {
+    const uint64_t cache_miss = PERF_COUNT_HW_CACHE_OP_READ << 8 | PERF_COUNT_HW_CACHE_RESULT_MISS << 16;
+    const struct {
+        uint32_t type;
+        uint64_t config;
+    } events[PerfCounts::EVENT_COUNT] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | cache_miss},
+        {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | cache_miss},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    };
+
+    for (size_t i = 0; i < PerfCounts::EVENT_COUNT; ++i) {
+        fds[i] = open_counter(events[i].type, events[i].config);
+        if (fds[i] < 0 && reason.empty()) {
+            reason = std::string(EVENT_NAMES[i]) + ": " + std::strerror(errno);
+        }
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    for (int fd : fds) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+}
+
+bool PerfCounters::available() const {
+    for (int fd : fds) {
+        if (fd >= 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+PerfCounts PerfCounters::read() const {
+    PerfCounts counts;
+    for (size_t i = 0; i < PerfCounts::EVENT_COUNT; ++i) {
+        if (fds[i] < 0) {
+            continue;
+        }
+        uint64_t data[3];
+        if (::read(fds[i], data, sizeof(data)) != sizeof(data)) {
+            continue;
+        }
+        // Scale up if the kernel multiplexed this counter with others.
+        uint64_t value = data[0];
+        if (data[2] > 0 && data[2] < data[1]) {
+            value = static_cast<uint64_t>(static_cast<double>(value) * data[1] / data[2]);
+        }
+        counts.values[i] = value;
+        counts.available |= 1u << i;
+    }
+    return counts;
+}
+
+#else
+
+PerfCounters::PerfCounters() : reason("hardware counters need Linux perf_event_open") {
+    for (int& fd : fds) {
+        fd = -1;
+    }
+}
+
+PerfCounters::~PerfCounters() {}
+
+bool PerfCounters::available() const {
+    return false;
+}
+
+PerfCounts PerfCounters::read() const {
+    return PerfCounts();
+}
+
+#endif
@@ -64,11 +64,12 @@ std::unique_ptr<PlanNode> PlanBuilder::build_scan_node(const TableReference& tab
 }
 
 std::unique_ptr<PlanNode> PlanBuilder::build_filter_node(std::unique_ptr<PlanNode> child, const Expression& condition) {
-    auto filter = std::make_unique<FilterNode>(expression_to_string(condition));
+    auto filter = std::make_unique<FilterNode>(expression_to_string(condition), condition.clone());
     
     filter->stats = child->stats;
     filter->stats.selectivity = 0.1;
-    filter->stats.row_count = static_cast<size_t>(child->stats.row_count * filter->stats.selectivity);
+    filter->stats.row_count =
+        Statistics::clamp_row_count(static_cast<double>(child->stats.row_count) * filter->stats.selectivity);
     
     filter->output_schema = child->output_schema;
     filter->children.push_back(std::move(child));
@@ -106,11 +107,15 @@ std::unique_ptr<PlanNode> PlanBuilder::build_join_node(std::unique_ptr<PlanNode>
         case PlanNodeType::SORT_MERGE_JOIN:
             join_node = std::make_unique<SortMergeJoinNode>(join_type, condition);
             break;
+        case PlanNodeType::ADAPTIVE_JOIN:
+            join_node = std::make_unique<AdaptiveJoinNode>(join_type, condition);
+            break;
         default:
             join_node = std::make_unique<NestedLoopJoinNode>(join_type, condition);
     }
     
-    join_node->stats.row_count = left->stats.row_count * right->stats.row_count / 10;
+    join_node->stats.row_count = Statistics::clamp_row_count(
+        static_cast<double>(left->stats.row_count) * static_cast<double>(right->stats.row_count) / 10);
     join_node->stats.page_count = join_node->stats.row_count / 100;
     join_node->stats.selectivity = 0.1;
     
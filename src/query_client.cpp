@@ -0,0 +1,122 @@
+#include "query_client.h"
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+QueryClient::QueryClient(const std::string& socket_path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("Socket path too long: " + socket_path);
+    }
+    std::memcpy(addr.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        std::string message = "Cannot connect to " + socket_path + ": " + std::strerror(errno);
+        if (fd >= 0) {
+            close(fd);
+        }
+        throw std::runtime_error(message);
+    }
+}
+
+QueryClient::~QueryClient() {
+    close(fd);
+}
+
+void QueryClient::send_all(const std::string& bytes) {
+    size_t offset = 0;
+    while (offset < bytes.size()) {
+        ssize_t sent = send(fd, bytes.data() + offset, bytes.size() - offset, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(std::string("send: ") + std::strerror(errno));
+        }
+        offset += static_cast<size_t>(sent);
+    }
+}
+
+MessageType QueryClient::read_frame(std::string& payload) {
+    for (;;) {
+        MessageType type;
+        std::string_view frame;
+        size_t frame_bytes;
+        if (next_frame(input.data() + input_offset, input.size() - input_offset, type, frame, frame_bytes)) {
+            payload.assign(frame.data(), frame.size());
+            input_offset += frame_bytes;
+            if (input_offset == input.size()) {
+                input.clear();
+                input_offset = 0;
+            }
+            return type;
+        }
+
+        if (input_offset > 0) {
+            input.erase(0, input_offset);
+            input_offset = 0;
+        }
+        char buffer[64 * 1024];
+        ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            throw std::runtime_error("Connection closed by server");
+        }
+        input.append(buffer, static_cast<size_t>(received));
+    }
+}
+
+void QueryClient::send_query(const std::string& sql) {
+    std::string frame;
+    encode_query(frame, sql);
+    send_all(frame);
+}
+
+QueryComplete QueryClient::read_result(const BatchCallback& on_batch, TableSchema* schema_out) {
+    std::string payload;
+    TableSchema schema;
+    ColumnBatch batch;
+    for (;;) {
+        switch (read_frame(payload)) {
+            case MessageType::SCHEMA:
+                schema = decode_schema(payload);
+                if (schema_out) {
+                    *schema_out = schema;
+                }
+                break;
+            case MessageType::BATCH:
+                decode_batch(payload, batch);
+                on_batch(schema, batch);
+                break;
+            case MessageType::COMPLETE:
+                return decode_complete(payload);
+            case MessageType::ERROR:
+                throw QueryError(decode_error(payload));
+            default:
+                throw ProtocolError("Unexpected message from server");
+        }
+    }
+}
+
+QueryComplete QueryClient::query(const std::string& sql, const BatchCallback& on_batch) {
+    send_query(sql);
+    return read_result(on_batch);
+}
+
+ClientResult QueryClient::query(const std::string& sql) {
+    ClientResult result;
+    send_query(sql);
+    result.complete = read_result(
+        [&result](const TableSchema&, const ColumnBatch& batch) {
+            ++result.batches;
+            batch.append_rows(result.rows, result.strings);
+        },
+        &result.schema);
+    return result;
+}
@@ -0,0 +1,222 @@
+#include "query_scheduler.h"
+#include "executor.h"
+#include "time_util.h"
+#include <sstream>
+
+static bool has_join(const PlanNode& node) {
+    switch (node.type) {
+        case PlanNodeType::NESTED_LOOP_JOIN:
+        case PlanNodeType::HASH_JOIN:
+        case PlanNodeType::SORT_MERGE_JOIN:
+        case PlanNodeType::ADAPTIVE_JOIN:
+            return true;
+        default:
+            break;
+    }
+    for (const auto& child : node.children) {
+        if (has_join(*child)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static size_t scanned_rows(const PlanNode& node) {
+    size_t rows = node.type == PlanNodeType::TABLE_SCAN ? node.stats.row_count : 0;
+    for (const auto& child : node.children) {
+        rows += scanned_rows(*child);
+    }
+    return rows;
+}
+
+QueryScheduler::Ticket::Ticket(Ticket&& other) noexcept
+    : scheduler(other.scheduler), query_class(other.query_class), memory_bytes(other.memory_bytes),
+      queue_ms(other.queue_ms) {
+    other.scheduler = nullptr;
+}
+
+QueryScheduler::Ticket& QueryScheduler::Ticket::operator=(Ticket&& other) noexcept {
+    if (this != &other) {
+        release();
+        scheduler = other.scheduler;
+        query_class = other.query_class;
+        memory_bytes = other.memory_bytes;
+        queue_ms = other.queue_ms;
+        other.scheduler = nullptr;
+    }
+    return *this;
+}
+
+void QueryScheduler::Ticket::release() {
+    if (scheduler) {
+        scheduler->finish(query_class, memory_bytes);
+        scheduler = nullptr;
+    }
+}
+
+QueryScheduler::QueryScheduler(const SchedulerOptions& opts) : options(opts) {}
+
+const char* QueryScheduler::class_name(QueryClass query_class) {
+    switch (query_class) {
+        case QueryClass::POINT: return "point";
+        case QueryClass::NORMAL: return "normal";
+        case QueryClass::HEAVY: return "heavy";
+    }
+    return "unknown";
+}
+
+QueryClass QueryScheduler::classify(const PlanNode& plan, size_t memory_bytes) const {
+    if (plan.stats.row_count <= options.point_max_rows && !has_join(plan) &&
+        scanned_rows(plan) <= options.point_max_scanned_rows) {
+        return QueryClass::POINT;
+    }
+    if (plan.cost.total_cost >= options.heavy_cost || memory_bytes >= options.heavy_memory_bytes) {
+        return QueryClass::HEAVY;
+    }
+    return QueryClass::NORMAL;
+}
+
+// Caller holds the mutex.
+bool QueryScheduler::fits(const Waiter& waiter) const {
+    if (waiter.query_class == QueryClass::POINT) {
+        return running[static_cast<int>(QueryClass::POINT)] < options.max_point_concurrent;
+    }
+    size_t active = running[static_cast<int>(QueryClass::NORMAL)] + running[static_cast<int>(QueryClass::HEAVY)];
+    if (active >= options.max_concurrent) {
+        return false;
+    }
+    if (waiter.query_class == QueryClass::HEAVY && running[static_cast<int>(QueryClass::HEAVY)] >= options.max_heavy) {
+        return false;
+    }
+    return reserved_bytes + waiter.memory_bytes <= options.memory_budget_bytes || active == 0;
+}
+
+// Caller holds the mutex.
+void QueryScheduler::admit_waiters() {
+    bool admitted_any = false;
+    bool starving = false;
+    for (auto& waiter : waiters) {
+        // A starving waiter holds back later ones of the classes it shares
+        // slots with; point lookups have slots of their own.
+        if (waiter.admitted || (starving && waiter.query_class != QueryClass::POINT)) {
+            continue;
+        }
+        if (fits(waiter)) {
+            waiter.admitted = true;
+            start(waiter.query_class, waiter.memory_bytes);
+            admitted_any = true;
+        } else if (waiter.query_class != QueryClass::POINT && elapsed_ms(waiter.arrived) >= options.starvation_ms) {
+            starving = true;
+        }
+    }
+    if (admitted_any) {
+        changed.notify_all();
+    }
+}
+
+void QueryScheduler::start(QueryClass query_class, size_t memory_bytes) {
+    ++running[static_cast<int>(query_class)];
+    if (query_class != QueryClass::POINT) {
+        reserved_bytes += memory_bytes;
+    }
+}
+
+void QueryScheduler::finish(QueryClass query_class, size_t memory_bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    --running[static_cast<int>(query_class)];
+    if (query_class != QueryClass::POINT) {
+        reserved_bytes -= memory_bytes;
+    }
+    admit_waiters();
+}
+
+void QueryScheduler::record_queue_time(QueryClass query_class, double queue_ms) {
+    ClassCounters& counter = counters[static_cast<int>(query_class)];
+    counter.admitted.fetch_add(1, std::memory_order_relaxed);
+    counter.queue_time.record(static_cast<uint64_t>(queue_ms * 1000.0));
+}
+
+QueryScheduler::Ticket QueryScheduler::admit(QueryClass query_class, size_t memory_bytes) {
+    auto arrived = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(mutex);
+    ClassCounters& counter = counters[static_cast<int>(query_class)];
+    auto self = waiters.insert(waiters.end(), Waiter{query_class, memory_bytes, arrived});
+    admit_waiters();
+    if (!self->admitted) {
+        counter.queued.fetch_add(1, std::memory_order_relaxed);
+    }
+    auto deadline = arrived + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                  std::chrono::duration<double, std::milli>(options.queue_timeout_ms));
+    while (!self->admitted) {
+        if (options.queue_timeout_ms <= 0.0) {
+            changed.wait(lock);
+        } else if (changed.wait_until(lock, deadline) == std::cv_status::timeout && !self->admitted) {
+            waiters.erase(self);
+            admit_waiters();
+            lock.unlock();
+            counter.timed_out.fetch_add(1, std::memory_order_relaxed);
+            throw AdmissionError(std::string("Query not admitted within ") +
+                                 std::to_string(static_cast<long long>(options.queue_timeout_ms)) + "ms (" +
+                                 class_name(query_class) + " query)");
+        }
+    }
+    waiters.erase(self);
+    lock.unlock();
+
+    double queue_ms = elapsed_ms(arrived);
+    record_queue_time(query_class, queue_ms);
+    return Ticket(this, query_class, memory_bytes, queue_ms);
+}
+
+std::unique_ptr<ResultSet> QueryScheduler::execute(Executor& executor, const PlanNode& plan, size_t memory_bytes) {
+    Ticket ticket = admit(classify(plan, memory_bytes), memory_bytes);
+    return executor.execute(plan);
+}
+
+SchedulerStats QueryScheduler::get_stats() const {
+    SchedulerStats out;
+    std::lock_guard<std::mutex> lock(mutex);
+    for (int c = 0; c < 3; ++c) {
+        const ClassCounters& counter = counters[c];
+        SchedulerClassStats& stats = out.classes[c];
+        stats.admitted = counter.admitted.load(std::memory_order_relaxed);
+        stats.queued = counter.queued.load(std::memory_order_relaxed);
+        stats.timed_out = counter.timed_out.load(std::memory_order_relaxed);
+        stats.running = running[c];
+        stats.queue_p50_ms = counter.queue_time.value_at_quantile(0.50) / 1000.0;
+        stats.queue_p99_ms = counter.queue_time.value_at_quantile(0.99) / 1000.0;
+        stats.queue_max_ms = counter.queue_time.value_at_quantile(1.0) / 1000.0;
+    }
+    for (const auto& waiter : waiters) {
+        if (!waiter.admitted) {
+            ++out.classes[static_cast<int>(waiter.query_class)].waiting;
+        }
+    }
+    out.reserved_bytes = reserved_bytes;
+    return out;
+}
+
+void QueryScheduler::reset_stats() {
+    for (auto& counter : counters) {
+        counter.admitted.store(0, std::memory_order_relaxed);
+        counter.queued.store(0, std::memory_order_relaxed);
+        counter.timed_out.store(0, std::memory_order_relaxed);
+        counter.queue_time.reset();
+    }
+}
+
+std::string SchedulerStats::to_string() const {
+    std::ostringstream out;
+    out << "class     admitted   queued  timeout  running  waiting   p50 ms   p99 ms   max ms\n";
+    for (QueryClass query_class : {QueryClass::POINT, QueryClass::NORMAL, QueryClass::HEAVY}) {
+        const SchedulerClassStats& stats = of(query_class);
+        char line[160];
+        std::snprintf(line, sizeof(line), "%-8s %9llu %8llu %8llu %8zu %8zu %8.3f %8.3f %8.3f\n",
+                      QueryScheduler::class_name(query_class), static_cast<unsigned long long>(stats.admitted),
+                      static_cast<unsigned long long>(stats.queued), static_cast<unsigned long long>(stats.timed_out),
+                      stats.running, stats.waiting, stats.queue_p50_ms, stats.queue_p99_ms, stats.queue_max_ms);
+        out << line;
+    }
+    out << "reserved memory: " << reserved_bytes << " bytes\n";
+    return out.str();
+}
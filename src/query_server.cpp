@@ -0,0 +1,487 @@
+#include "query_server.h"
+#include "query_session.h"
+#include "time_util.h"
+#include "wire_protocol.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static constexpr uint64_t LISTEN_TAG = 0;
+static constexpr uint64_t WAKE_TAG = 1;
+
+struct QueryServer::Connection {
+    uint64_t id = 0;
+    int fd = -1;
+    std::string input;
+    std::string output;
+    size_t output_offset = 0;
+    std::deque<std::string> pending;        // queries behind the one running
+    bool busy = false;                      // a query is queued, running or streaming
+    bool closing = false;                   // close once output is flushed
+    bool peer_closed = false;               // client shut down its write side
+    uint32_t interest = EPOLLIN;            // events registered with epoll
+
+    // The result being streamed.
+    std::unique_ptr<ResultSet> result;
+    size_t next_row = 0;
+    QueryComplete complete;
+};
+
+struct QueryServer::Completion {
+    uint64_t connection = 0;
+    std::unique_ptr<ResultSet> result;
+    QueryComplete complete;
+    bool failed = false;
+    std::string error;
+};
+
+QueryServer::QueryServer(TableManager* tm, const QueryServerOptions& opts) : table_manager(tm), options(opts) {
+    options.batch_rows = std::max<size_t>(1, std::min<size_t>(options.batch_rows, MAX_BATCH_ROWS));
+    options.batch_bytes = std::max<size_t>(1, std::min<size_t>(options.batch_bytes, MAX_FRAME_BYTES));
+    options.worker_threads = std::max<size_t>(1, options.worker_threads);
+}
+
+QueryServer::~QueryServer() {
+    stop();
+}
+
+void QueryServer::set_table_statistics(const std::string& table_name, const TableStatistics& stats) {
+    statistics.emplace_back(table_name, stats);
+}
+
+void QueryServer::start() {
+    if (running.load()) {
+        return;
+    }
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (options.socket_path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("Socket path too long: " + options.socket_path);
+    }
+    std::memcpy(addr.sun_path, options.socket_path.c_str(), options.socket_path.size() + 1);
+
+    auto fail = [this](const std::string& what) {
+        std::string message = what + ": " + std::strerror(errno);
+        for (int* fd : {&listen_fd, &epoll_fd, &wake_fd}) {
+            if (*fd >= 0) {
+                close(*fd);
+                *fd = -1;
+            }
+        }
+        throw std::runtime_error(message);
+    };
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0) {
+        fail("socket");
+    }
+    unlink(options.socket_path.c_str());
+    if (bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        fail("Cannot bind " + options.socket_path);
+    }
+    if (listen(listen_fd, SOMAXCONN) < 0) {
+        fail("listen");
+    }
+
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd < 0 || wake_fd < 0) {
+        fail("epoll");
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = LISTEN_TAG;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &event) < 0) {
+        fail("epoll_ctl");
+    }
+    event.data.u64 = WAKE_TAG;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &event) < 0) {
+        fail("epoll_ctl");
+    }
+
+    running.store(true);
+    for (size_t i = 0; i < options.worker_threads; ++i) {
+        workers.emplace_back(&QueryServer::worker_loop, this);
+    }
+    io_thread = std::thread(&QueryServer::io_loop, this);
+}
+
+void QueryServer::stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex);
+        jobs.clear();
+    }
+    jobs_ready.notify_all();
+    wake();
+
+    io_thread.join();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+    completions.clear();
+
+    close(listen_fd);
+    close(epoll_fd);
+    close(wake_fd);
+    listen_fd = epoll_fd = wake_fd = -1;
+    unlink(options.socket_path.c_str());
+}
+
+QueryServerStats QueryServer::get_stats() const {
+    QueryServerStats stats;
+    stats.connections_accepted = connections_accepted.load();
+    stats.connections_rejected = connections_rejected.load();
+    stats.connections_open = connections_open.load();
+    stats.queries = queries.load();
+    stats.errors = errors.load();
+    stats.plan_cache_hits = plan_cache_hits.load();
+    stats.batches_sent = batches_sent.load();
+    stats.bytes_sent = bytes_sent.load();
+    return stats;
+}
+
+void QueryServer::wake() {
+    uint64_t one = 1;
+    ssize_t written = write(wake_fd, &one, sizeof(one));
+    (void)written;
+}
+
+void QueryServer::worker_loop() {
+    QuerySession session(table_manager);
+    for (const auto& [table_name, stats] : statistics) {
+        session.get_optimizer().set_table_statistics(table_name, stats);
+    }
+    session.set_plan_cache_capacity(options.plan_cache_capacity);
+    session.set_scheduler(options.scheduler);
+
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(jobs_mutex);
+            jobs_ready.wait(lock, [this] { return !running.load() || !jobs.empty(); });
+            if (jobs.empty()) {
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        auto completion = std::make_unique<Completion>();
+        completion->connection = job.connection;
+        completion->complete.queue_ms = elapsed_ms(job.queued);
+        try {
+            QueryRun run = session.run(job.sql);
+            completion->complete.rows = run.result->size();
+            completion->complete.parse_ms = run.parse_ms;
+            completion->complete.optimize_ms = run.optimize_ms;
+            completion->complete.execute_ms = run.execute_ms;
+            completion->complete.plan_cached = run.plan_cached;
+            completion->complete.queue_ms += run.queue_ms;
+            completion->result = std::move(run.result);
+        } catch (const std::exception& e) {
+            completion->failed = true;
+            completion->error = e.what();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(completions_mutex);
+            completions.push_back(std::move(completion));
+        }
+        wake();
+    }
+}
+
+void QueryServer::io_loop() {
+    epoll_event events[64];
+    while (running.load()) {
+        int ready = epoll_wait(epoll_fd, events, 64, -1);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        for (int i = 0; i < ready; ++i) {
+            uint64_t tag = events[i].data.u64;
+            if (tag == LISTEN_TAG) {
+                accept_connections();
+                continue;
+            }
+            if (tag == WAKE_TAG) {
+                uint64_t count;
+                ssize_t got = read(wake_fd, &count, sizeof(count));
+                (void)got;
+                drain_completions();
+                continue;
+            }
+
+            auto it = connections.find(tag);
+            if (it == connections.end()) {
+                continue;
+            }
+            Connection& conn = *it->second;
+            if (events[i].events & EPOLLERR) {
+                close_connection(tag);
+                continue;
+            }
+            if ((events[i].events & EPOLLIN) && !read_from(conn)) {
+                continue;
+            }
+            if ((events[i].events & EPOLLHUP) && !(conn.interest & EPOLLIN)) {
+                // Both directions are gone, so nothing sent can be read.
+                close_connection(tag);
+                continue;
+            }
+            if (events[i].events & EPOLLOUT) {
+                pump(conn);
+            }
+        }
+    }
+
+    while (!connections.empty()) {
+        close_connection(connections.begin()->first);
+    }
+}
+
+void QueryServer::accept_connections() {
+    for (;;) {
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        if (connections.size() >= options.max_connections) {
+            close(fd);
+            connections_rejected.fetch_add(1);
+            continue;
+        }
+
+        auto conn = std::make_unique<Connection>();
+        conn->id = next_connection_id++;
+        conn->fd = fd;
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = conn->id;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            close(fd);
+            continue;
+        }
+        connections.emplace(conn->id, std::move(conn));
+        connections_accepted.fetch_add(1);
+        connections_open.fetch_add(1);
+    }
+}
+
+bool QueryServer::read_from(Connection& conn) {
+    char buffer[64 * 1024];
+    while (!conn.peer_closed && !conn.closing && conn.pending.size() < options.max_pending_queries) {
+        ssize_t received = recv(conn.fd, buffer, sizeof(buffer), 0);
+        if (received > 0) {
+            conn.input.append(buffer, static_cast<size_t>(received));
+            parse_frames(conn);
+            continue;
+        }
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        if (received < 0) {
+            // The socket failed; anything still running for it is dropped
+            // when it completes.
+            close_connection(conn.id);
+            return false;
+        }
+        // Orderly shutdown of the client's write side: answer what it has
+        // sent, then close once the output is flushed.
+        conn.peer_closed = true;
+    }
+
+    dispatch(conn);
+    return flush_output(conn);
+}
+
+// Moves complete QUERY frames from the input buffer to pending, stopping at
+// max_pending_queries so that a client cannot queue without limit.
+void QueryServer::parse_frames(Connection& conn) {
+    size_t consumed = 0;
+    try {
+        MessageType type;
+        std::string_view payload;
+        size_t frame_bytes;
+        while (!conn.closing && conn.pending.size() < options.max_pending_queries &&
+               next_frame(conn.input.data() + consumed, conn.input.size() - consumed, type, payload, frame_bytes)) {
+            consumed += frame_bytes;
+            if (type != MessageType::QUERY) {
+                throw ProtocolError("Unexpected message from client");
+            }
+            conn.pending.push_back(decode_query(payload));
+        }
+    } catch (const ProtocolError& e) {
+        // The stream cannot be resynchronized: report and hang up.
+        conn.pending.clear();
+        conn.result.reset();
+        encode_error(conn.output, e.what());
+        conn.closing = true;
+        consumed = conn.input.size();
+    }
+    conn.input.erase(0, consumed);
+}
+
+void QueryServer::dispatch(Connection& conn) {
+    if (conn.busy || conn.closing || conn.pending.empty()) {
+        return;
+    }
+    conn.busy = true;
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex);
+        jobs.push_back(Job{conn.id, std::move(conn.pending.front()), std::chrono::steady_clock::now()});
+    }
+    conn.pending.pop_front();
+    jobs_ready.notify_one();
+    parse_frames(conn);
+}
+
+void QueryServer::drain_completions() {
+    std::deque<std::unique_ptr<Completion>> ready;
+    {
+        std::lock_guard<std::mutex> lock(completions_mutex);
+        ready.swap(completions);
+    }
+
+    for (auto& completion : ready) {
+        queries.fetch_add(1);
+        auto it = connections.find(completion->connection);
+        if (it == connections.end() || it->second->closing) {
+            continue;
+        }
+        Connection& conn = *it->second;
+
+        if (completion->failed) {
+            errors.fetch_add(1);
+            encode_error(conn.output, completion->error);
+            conn.busy = false;
+            dispatch(conn);
+            flush_output(conn);
+            continue;
+        }
+
+        if (completion->complete.plan_cached) {
+            plan_cache_hits.fetch_add(1);
+        }
+        encode_schema(conn.output, completion->result->get_schema());
+        conn.result = std::move(completion->result);
+        conn.next_row = 0;
+        conn.complete = completion->complete;
+        pump(conn);
+    }
+}
+
+bool QueryServer::pump(Connection& conn) {
+    while (conn.result && conn.output.size() - conn.output_offset < options.max_output_bytes) {
+        const auto& rows = conn.result->get_rows();
+        if (conn.next_row < rows.size()) {
+            size_t columns = conn.result->get_schema().column_count();
+            size_t end = batch_end(rows, conn.next_row, options.batch_rows, columns, options.batch_bytes);
+            try {
+                encode_batch(conn.output, rows, conn.next_row, end, columns);
+            } catch (const ProtocolError& e) {
+                // A single row too large for a frame; the client sees the
+                // error in place of the rest of the result.
+                errors.fetch_add(1);
+                encode_error(conn.output, e.what());
+                conn.result.reset();
+                conn.busy = false;
+                dispatch(conn);
+                continue;
+            }
+            conn.next_row = end;
+            batches_sent.fetch_add(1);
+        } else {
+            encode_complete(conn.output, conn.complete);
+            conn.result.reset();
+            conn.busy = false;
+            dispatch(conn);
+        }
+    }
+    return flush_output(conn);
+}
+
+bool QueryServer::flush_output(Connection& conn) {
+    while (conn.output_offset < conn.output.size()) {
+        ssize_t sent = send(conn.fd, conn.output.data() + conn.output_offset, conn.output.size() - conn.output_offset,
+                            MSG_NOSIGNAL);
+        if (sent > 0) {
+            conn.output_offset += static_cast<size_t>(sent);
+            bytes_sent.fetch_add(static_cast<uint64_t>(sent));
+            continue;
+        }
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        close_connection(conn.id);
+        return false;
+    }
+
+    if (conn.output_offset == conn.output.size()) {
+        conn.output.clear();
+        conn.output_offset = 0;
+    } else if (conn.output_offset > conn.output.size() / 2) {
+        conn.output.erase(0, conn.output_offset);
+        conn.output_offset = 0;
+    }
+
+    bool finished = conn.peer_closed && !conn.busy && conn.pending.empty();
+    if ((conn.closing || finished) && conn.output.empty()) {
+        close_connection(conn.id);
+        return false;
+    }
+    update_interest(conn);
+    return true;
+}
+
+// EPOLLOUT stays registered while there is output or a result left to
+// encode, so streaming connections take turns in the event loop. EPOLLIN
+// is dropped while the pending queue is full or the client has stopped
+// sending, which pushes back on clients that pipeline faster than we run.
+void QueryServer::update_interest(Connection& conn) {
+    bool want_read = !conn.peer_closed && !conn.closing && conn.pending.size() < options.max_pending_queries;
+    bool want_write = !conn.output.empty() || conn.result != nullptr;
+    uint32_t interest = (want_read ? EPOLLIN : 0u) | (want_write ? EPOLLOUT : 0u);
+    if (interest == conn.interest) {
+        return;
+    }
+    epoll_event event{};
+    event.events = interest;
+    event.data.u64 = conn.id;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, conn.fd, &event) == 0) {
+        conn.interest = interest;
+    }
+}
+
+void QueryServer::close_connection(uint64_t id) {
+    auto it = connections.find(id);
+    if (it == connections.end()) {
+        return;
+    }
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, it->second->fd, nullptr);
+    close(it->second->fd);
+    connections.erase(it);
+    connections_open.fetch_sub(1);
+}
@@ -0,0 +1,91 @@
+#include "query_session.h"
+#include "parser.h"
+#include "query_scheduler.h"
+#include "query_stats.h"
+#include "slow_query_log.h"
+#include "time_util.h"
+#include "trace.h"
+#include <chrono>
+
+QuerySession::QuerySession(TableManager* tm) : table_manager(tm), executor(tm) {}
+
+void QuerySession::set_plan_cache_capacity(size_t capacity) {
+    plan_cache_capacity = capacity;
+    while (plan_lru.size() > capacity) {
+        plan_cache.erase(plan_lru.back().first);
+        plan_lru.pop_back();
+    }
+}
+
+QueryRun QuerySession::run(const std::string& sql) {
+    TraceSpan span("session", "query");
+    QueryRun run;
+    auto start = std::chrono::steady_clock::now();
+
+    try {
+        auto stage = start;
+        auto cached = plan_cache_capacity > 0 ? plan_cache.find(sql) : plan_cache.end();
+        if (cached != plan_cache.end()) {
+            plan_lru.splice(plan_lru.begin(), plan_lru, cached->second);
+            run.plan = cached->second->second;
+            run.plan_cached = true;
+            optimizer.reset_stats();
+            ++plan_cache_hits;
+        } else {
+            Tokenizer tokenizer(sql);
+            Parser parser(tokenizer.tokenize());
+            auto stmt = parser.parseSelectStatement();
+            run.parse_ms = elapsed_ms(stage);
+
+            stage = std::chrono::steady_clock::now();
+            run.plan = optimizer.optimize(*stmt);
+            if (!run.plan) {
+                throw std::runtime_error("No plan for query: " + sql);
+            }
+            run.optimize_ms = elapsed_ms(stage);
+
+            if (plan_cache_capacity > 0) {
+                ++plan_cache_misses;
+                if (plan_lru.size() >= plan_cache_capacity) {
+                    plan_cache.erase(plan_lru.back().first);
+                    plan_lru.pop_back();
+                }
+                plan_lru.emplace_front(sql, run.plan);
+                plan_cache.emplace(sql, plan_lru.begin());
+            }
+        }
+
+        QueryScheduler::Ticket ticket;
+        if (scheduler) {
+            size_t memory_bytes = optimizer.estimate_memory(*run.plan);
+            ticket = scheduler->admit(scheduler->classify(*run.plan, memory_bytes), memory_bytes);
+            run.queue_ms = ticket.get_queue_ms();
+        }
+
+        stage = std::chrono::steady_clock::now();
+        run.result = executor.execute(*run.plan);
+        run.execute_ms = elapsed_ms(stage);
+    } catch (const std::exception& e) {
+        run.total_ms = elapsed_ms(start);
+        if (query_stats) {
+            query_stats->record_error(sql, run.total_ms);
+        }
+        if (slow_log && slow_log->is_slow(run.total_ms)) {
+            slow_log->submit(SlowQueryLog::format_entry(sql, run, {}, optimizer.get_stats(), e.what()));
+        }
+        throw;
+    }
+
+    for (const auto& decision : executor.get_last_join_decisions()) {
+        run.spill_bytes += decision.spilled_bytes;
+    }
+    run.total_ms = elapsed_ms(start);
+
+    if (query_stats) {
+        query_stats->record(sql, run.total_ms, run.result->size(), run.spill_bytes, plan_fingerprint(*run.plan));
+    }
+    if (slow_log && slow_log->is_slow(run.total_ms)) {
+        slow_log->submit(SlowQueryLog::format_entry(sql, run, executor.get_last_cardinalities(), optimizer.get_stats()));
+    }
+    return run;
+}
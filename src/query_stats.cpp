@@ -0,0 +1,324 @@
+#include "query_stats.h"
+#include "string_util.h"
+#include "tokenizer.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+
+std::string normalize_query(const std::string& sql) {
+    Tokenizer tokenizer(sql);
+    std::vector<Token> tokens = tokenizer.tokenize();
+
+    std::string out;
+    TokenType previous = TokenType::END_OF_FILE;
+    for (const auto& token : tokens) {
+        if (token.type == TokenType::END_OF_FILE || token.type == TokenType::SEMICOLON) {
+            continue;
+        }
+        bool glued = token.type == TokenType::DOT || token.type == TokenType::COMMA ||
+                     token.type == TokenType::RIGHT_PAREN || previous == TokenType::DOT ||
+                     previous == TokenType::LEFT_PAREN;
+        if (!out.empty() && !glued) {
+            out += ' ';
+        }
+
+        if (token.type == TokenType::NUMBER || token.type == TokenType::STRING) {
+            out += '?';
+        } else if (token.type == TokenType::IDENTIFIER) {
+            out += token.value;
+        } else {
+            for (char c : token.value) {
+                out += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+            }
+        }
+        previous = token.type;
+    }
+    return out;
+}
+
+uint64_t query_fingerprint(const std::string& normalized_sql) {
+    return fnv1a(normalized_sql);
+}
+
+// Operator types, scanned tables and join conditions in pre-order. Filter
+// and projection text comes from the query itself, and leaving it out
+// keeps rebound constants from counting as a new plan.
+static void plan_shape(const PlanNode& node, std::string& out) {
+    out += std::to_string(static_cast<int>(node.type));
+    if (node.type == PlanNodeType::TABLE_SCAN) {
+        out += ":" + static_cast<const TableScanNode&>(node).table_name;
+    } else if (const auto* join = dynamic_cast<const JoinNode*>(&node)) {
+        out += ":" + join->join_condition;
+    }
+    out += "/" + std::to_string(node.children.size()) + ";";
+    for (const auto& child : node.children) {
+        plan_shape(*child, out);
+    }
+}
+
+uint64_t plan_fingerprint(const PlanNode& plan) {
+    std::string shape;
+    plan_shape(plan, shape);
+    return fnv1a(shape);
+}
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+// Values below 2 * SUB_BUCKETS are exact. Above that, a value with
+// highest bit 6 + k lands in sub-bucket value >> k of magnitude k.
+size_t LatencyHistogram::bucket_of(uint64_t value_us) {
+    const uint64_t max_value = (uint64_t(2 * SUB_BUCKETS) << MAGNITUDES) - 1;
+    value_us = std::min(value_us, max_value);
+    if (value_us < 2 * SUB_BUCKETS) {
+        return static_cast<size_t>(value_us);
+    }
+    size_t highest_bit = 63 - __builtin_clzll(value_us);
+    size_t magnitude = highest_bit - 6;
+    return SUB_BUCKETS * magnitude + static_cast<size_t>(value_us >> magnitude);
+}
+
+uint64_t LatencyHistogram::bucket_value(size_t bucket) {
+    if (bucket < 2 * SUB_BUCKETS) {
+        return bucket;
+    }
+    size_t magnitude = bucket / SUB_BUCKETS - 1;
+    uint64_t sub = bucket - SUB_BUCKETS * magnitude;
+    return ((sub + 1) << magnitude) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value_us) {
+    counts[bucket_of(value_us)].fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::count() const {
+    uint64_t total = 0;
+    for (const auto& bucket : counts) {
+        total += bucket.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t LatencyHistogram::value_at_quantile(double quantile) const {
+    uint64_t total = count();
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(std::ceil(std::clamp(quantile, 0.0, 1.0) * total));
+    rank = std::max<uint64_t>(rank, 1);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        seen += counts[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return bucket_value(i);
+        }
+    }
+    return bucket_value(BUCKETS - 1);
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : counts) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+QueryStatsRegistry::QueryStatsRegistry(size_t max_queries)
+    : capacity(std::max<size_t>(1, max_queries)), slots(new std::atomic<Entry*>[capacity]) {
+    for (size_t i = 0; i < capacity; ++i) {
+        slots[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+QueryStatsRegistry::~QueryStatsRegistry() {
+    for (size_t i = 0; i < capacity; ++i) {
+        delete slots[i].load(std::memory_order_relaxed);
+    }
+}
+
+// Open addressing with linear probing. A thread that loses the race for a
+// slot frees its entry and keeps probing from the winner.
+QueryStatsRegistry::Entry* QueryStatsRegistry::find_or_insert(uint64_t fingerprint, const std::string& normalized_sql) {
+    std::unique_ptr<Entry> fresh;
+    size_t start = static_cast<size_t>(fingerprint % capacity);
+    for (size_t probe = 0; probe < capacity; ++probe) {
+        std::atomic<Entry*>& slot = slots[(start + probe) % capacity];
+        Entry* current = slot.load(std::memory_order_acquire);
+        if (!current) {
+            if (!fresh) {
+                fresh = std::make_unique<Entry>(fingerprint, normalized_sql);
+            }
+            if (slot.compare_exchange_strong(current, fresh.get(), std::memory_order_acq_rel,
+                                             std::memory_order_acquire)) {
+                return fresh.release();
+            }
+        }
+        if (current->fingerprint == fingerprint) {
+            return current;
+        }
+    }
+    dropped.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+}
+
+void QueryStatsRegistry::record(const std::string& sql, double latency_ms, size_t rows, size_t spill_bytes,
+                                uint64_t plan_hash) {
+    std::string normalized = normalize_query(sql);
+    Entry* entry = find_or_insert(query_fingerprint(normalized), normalized);
+    if (!entry) {
+        return;
+    }
+
+    uint64_t latency_us = static_cast<uint64_t>(std::llround(std::max(0.0, latency_ms) * 1000.0));
+    entry->calls.fetch_add(1, std::memory_order_relaxed);
+    entry->total_us.fetch_add(latency_us, std::memory_order_relaxed);
+    entry->rows.fetch_add(rows, std::memory_order_relaxed);
+    entry->spill_bytes.fetch_add(spill_bytes, std::memory_order_relaxed);
+    entry->latency.record(latency_us);
+
+    uint64_t max_us = entry->max_us.load(std::memory_order_relaxed);
+    while (latency_us > max_us &&
+           !entry->max_us.compare_exchange_weak(max_us, latency_us, std::memory_order_relaxed)) {
+    }
+
+    if (plan_hash != 0) {
+        uint64_t previous = entry->last_plan.exchange(plan_hash, std::memory_order_relaxed);
+        if (previous != 0 && previous != plan_hash) {
+            entry->plan_changes.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void QueryStatsRegistry::record_error(const std::string& sql, double latency_ms) {
+    std::string normalized;
+    try {
+        normalized = normalize_query(sql);
+    } catch (const std::exception&) {
+        normalized = sql;
+    }
+    if (Entry* entry = find_or_insert(query_fingerprint(normalized), normalized)) {
+        entry->errors.fetch_add(1, std::memory_order_relaxed);
+        entry->error_us.fetch_add(static_cast<uint64_t>(std::llround(std::max(0.0, latency_ms) * 1000.0)),
+                                  std::memory_order_relaxed);
+    }
+}
+
+std::vector<QueryStatsSnapshot> QueryStatsRegistry::snapshot() const {
+    std::vector<QueryStatsSnapshot> out;
+    for (size_t i = 0; i < capacity; ++i) {
+        const Entry* entry = slots[i].load(std::memory_order_acquire);
+        if (!entry) {
+            continue;
+        }
+        QueryStatsSnapshot snap;
+        snap.fingerprint = entry->fingerprint;
+        snap.query = entry->query;
+        snap.calls = entry->calls.load(std::memory_order_relaxed);
+        snap.errors = entry->errors.load(std::memory_order_relaxed);
+        snap.error_ms = entry->error_us.load(std::memory_order_relaxed) / 1000.0;
+        snap.total_ms = entry->total_us.load(std::memory_order_relaxed) / 1000.0;
+        snap.mean_ms = snap.calls > 0 ? snap.total_ms / snap.calls : 0.0;
+        // Quantiles are bucket upper bounds; the exact maximum caps them.
+        snap.max_ms = entry->max_us.load(std::memory_order_relaxed) / 1000.0;
+        snap.p50_ms = std::min(snap.max_ms, entry->latency.value_at_quantile(0.50) / 1000.0);
+        snap.p99_ms = std::min(snap.max_ms, entry->latency.value_at_quantile(0.99) / 1000.0);
+        snap.rows = entry->rows.load(std::memory_order_relaxed);
+        snap.spill_bytes = entry->spill_bytes.load(std::memory_order_relaxed);
+        snap.plan_changes = entry->plan_changes.load(std::memory_order_relaxed);
+        out.push_back(std::move(snap));
+    }
+    std::sort(out.begin(), out.end(), [](const QueryStatsSnapshot& a, const QueryStatsSnapshot& b) {
+        return a.total_ms > b.total_ms;
+    });
+    return out;
+}
+
+std::string QueryStatsRegistry::dump(size_t limit) const {
+    auto entries = snapshot();
+    std::ostringstream out;
+    out << std::left << std::setw(18) << "Fingerprint"
+        << std::right << std::setw(8) << "Calls"
+        << std::setw(12) << "Total (ms)"
+        << std::setw(10) << "Mean"
+        << std::setw(10) << "p99"
+        << std::setw(10) << "Rows"
+        << std::setw(12) << "Spill (B)"
+        << std::setw(7) << "Plans"
+        << "  Query" << std::endl;
+    out << std::string(120, '-') << std::endl;
+
+    for (size_t i = 0; i < std::min(limit, entries.size()); ++i) {
+        const auto& e = entries[i];
+        char fingerprint[24];
+        std::snprintf(fingerprint, sizeof(fingerprint), "%016llx", static_cast<unsigned long long>(e.fingerprint));
+        std::string query = e.query.size() > 60 ? e.query.substr(0, 57) + "..." : e.query;
+        out << std::left << std::setw(18) << fingerprint
+            << std::right << std::setw(8) << e.calls
+            << std::fixed << std::setprecision(2) << std::setw(12) << e.total_ms
+            << std::setprecision(3) << std::setw(10) << e.mean_ms
+            << std::setw(10) << e.p99_ms
+            << std::setw(10) << e.rows
+            << std::setw(12) << e.spill_bytes
+            << std::setw(7) << e.plan_changes
+            << "  " << query;
+        if (e.errors > 0) {
+            out << " [" << e.errors << " errors, " << std::setprecision(2) << e.error_ms << " ms]";
+        }
+        out << std::endl;
+    }
+    if (entries.size() > limit) {
+        out << "... " << (entries.size() - limit) << " more" << std::endl;
+    }
+    if (get_dropped() > 0) {
+        out << get_dropped() << " executions not recorded: registry full" << std::endl;
+    }
+    return out.str();
+}
+
+std::string QueryStatsRegistry::to_json() const {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3);
+    out << "[";
+    bool first = true;
+    for (const auto& e : snapshot()) {
+        out << (first ? "\n" : ",\n");
+        first = false;
+        out << "  {\"fingerprint\": \"" << std::hex << e.fingerprint << std::dec << "\""
+            << ", \"query\": " << json_string(e.query)
+            << ", \"calls\": " << e.calls
+            << ", \"errors\": " << e.errors
+            << ", \"error_ms\": " << e.error_ms
+            << ", \"total_ms\": " << e.total_ms
+            << ", \"mean_ms\": " << e.mean_ms
+            << ", \"p50_ms\": " << e.p50_ms
+            << ", \"p99_ms\": " << e.p99_ms
+            << ", \"max_ms\": " << e.max_ms
+            << ", \"rows\": " << e.rows
+            << ", \"spill_bytes\": " << e.spill_bytes
+            << ", \"plan_changes\": " << e.plan_changes << "}";
+    }
+    out << (first ? "]\n" : "\n]\n");
+    return out.str();
+}
+
+void QueryStatsRegistry::reset() {
+    for (size_t i = 0; i < capacity; ++i) {
+        Entry* entry = slots[i].load(std::memory_order_acquire);
+        if (!entry) {
+            continue;
+        }
+        entry->calls.store(0, std::memory_order_relaxed);
+        entry->errors.store(0, std::memory_order_relaxed);
+        entry->total_us.store(0, std::memory_order_relaxed);
+        entry->max_us.store(0, std::memory_order_relaxed);
+        entry->rows.store(0, std::memory_order_relaxed);
+        entry->spill_bytes.store(0, std::memory_order_relaxed);
+        entry->plan_changes.store(0, std::memory_order_relaxed);
+        entry->last_plan.store(0, std::memory_order_relaxed);
+        entry->latency.reset();
+    }
+    dropped.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,345 @@
+#include "regret_benchmark.h"
+#include "tokenizer.h"
+#include "parser.h"
+#include "tpch.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+
+// Join tree without the operators above the joins, e.g. HJ(NLJ(a,b),c).
+static std::string describe_plan(const PlanNode& node) {
+    switch (node.type) {
+        case PlanNodeType::TABLE_SCAN:
+            return static_cast<const TableScanNode&>(node).table_name;
+        case PlanNodeType::NESTED_LOOP_JOIN:
+        case PlanNodeType::HASH_JOIN:
+        case PlanNodeType::SORT_MERGE_JOIN:
+        case PlanNodeType::ADAPTIVE_JOIN: {
+            const char* name = node.type == PlanNodeType::NESTED_LOOP_JOIN ? "NLJ"
+                             : node.type == PlanNodeType::HASH_JOIN ? "HJ"
+                             : node.type == PlanNodeType::SORT_MERGE_JOIN ? "SMJ" : "AJ";
+            std::string result = std::string(name) + "(";
+            for (size_t i = 0; i < node.children.size(); ++i) {
+                result += (i > 0 ? "," : "") + describe_plan(*node.children[i]);
+            }
+            return result + ")";
+        }
+        default:
+            return node.children.empty() ? "?" : describe_plan(*node.children[0]);
+    }
+}
+
+static std::vector<double> average_ranks(const std::vector<double>& values) {
+    std::vector<size_t> order(values.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&values](size_t a, size_t b) { return values[a] < values[b]; });
+
+    std::vector<double> ranks(values.size());
+    for (size_t i = 0; i < order.size();) {
+        size_t j = i + 1;
+        while (j < order.size() && values[order[j]] == values[order[i]]) {
+            j++;
+        }
+        double rank = (i + j + 1) / 2.0;   // mean of the 1-based ranks i+1..j
+        for (size_t k = i; k < j; ++k) {
+            ranks[order[k]] = rank;
+        }
+        i = j;
+    }
+    return ranks;
+}
+
+double spearman_correlation(const std::vector<double>& x, const std::vector<double>& y) {
+    size_t n = std::min(x.size(), y.size());
+    if (n < 2) {
+        return 0.0;
+    }
+    auto rx = average_ranks(std::vector<double>(x.begin(), x.begin() + n));
+    auto ry = average_ranks(std::vector<double>(y.begin(), y.begin() + n));
+
+    // Pearson correlation of the ranks, which stays exact with ties.
+    double mean = (n + 1) / 2.0;
+    double sxy = 0.0, sxx = 0.0, syy = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        sxy += (rx[i] - mean) * (ry[i] - mean);
+        sxx += (rx[i] - mean) * (rx[i] - mean);
+        syy += (ry[i] - mean) * (ry[i] - mean);
+    }
+    if (sxx == 0.0 || syy == 0.0) {
+        return 0.0;
+    }
+    return sxy / std::sqrt(sxx * syy);
+}
+
+double CandidateRun::runtime_ms(double timeout_ms) const {
+    return timed_out ? timeout_ms : timing.median_ms;
+}
+
+RegretBenchmark::RegretBenchmark(TableManager* tm, const RegretOptions& opts)
+    : table_manager(tm), options(opts), executor(tm) {
+    executor.set_timeout(options.timeout_ms);
+}
+
+CandidateRun RegretBenchmark::execute_candidate(const PlanNode& plan) {
+    CandidateRun run;
+    run.plan = describe_plan(plan);
+    run.estimated_cost = plan.cost.total_cost;
+
+    // A candidate that times out once is not run again.
+    try {
+        for (size_t i = 0; i < options.timing.warmup_runs; ++i) {
+            run.result_size = executor.execute(plan)->size();
+        }
+        std::vector<double> samples;
+        for (size_t i = 0; i < std::max<size_t>(1, options.timing.repetitions); ++i) {
+            auto start = std::chrono::steady_clock::now();
+            auto rows = executor.execute(plan);
+            samples.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            run.result_size = rows->size();
+        }
+        run.timing = TimingStats::from_samples(std::move(samples));
+    } catch (const QueryTimeout&) {
+        run.timed_out = true;
+    } catch (const std::exception& e) {
+        run.error = e.what();
+    }
+    return run;
+}
+
+RegretResult RegretBenchmark::run(const std::string& name, const std::string& distribution,
+                                  const SelectStatement& stmt) {
+    RegretResult result;
+    result.query_name = name;
+    result.distribution = distribution;
+
+    try {
+        auto candidates = optimizer.generate_all_plans(stmt);
+        if (candidates.empty()) {
+            throw std::runtime_error("optimizer produced no plan");
+        }
+
+        // select_best_plan moves the winner out; its slot is how we find it.
+        auto chosen_plan = optimizer.select_best_plan(candidates);
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            if (!candidates[i].plan) {
+                result.chosen = i;
+                candidates[i].plan = std::move(chosen_plan);
+                break;
+            }
+        }
+
+        // Without joins every algorithm yields the same plan; run it once.
+        size_t chosen_index = result.chosen;
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            std::string tree = describe_plan(*candidates[i].plan);
+            bool duplicate = std::any_of(result.candidates.begin(), result.candidates.end(),
+                                         [&tree](const CandidateRun& run) { return run.plan == tree; });
+            if (duplicate && i != chosen_index) {
+                continue;
+            }
+            if (i == chosen_index) {
+                result.chosen = result.candidates.size();
+            }
+            result.candidates.push_back(execute_candidate(*candidates[i].plan));
+        }
+
+        // Plans that disagree with the chosen plan's row count would make any
+        // speedup meaningless, so they are reported but not compared.
+        const CandidateRun& chosen = result.candidates[result.chosen];
+        std::vector<double> costs, runtimes;
+        for (size_t i = 0; i < result.candidates.size(); ++i) {
+            auto& run = result.candidates[i];
+            if (run.error.empty() && !run.timed_out && !chosen.timed_out && run.result_size != chosen.result_size) {
+                run.error = "returned " + std::to_string(run.result_size) + " rows, chosen plan " +
+                            std::to_string(chosen.result_size);
+            }
+            if (!run.error.empty()) {
+                continue;
+            }
+            costs.push_back(run.estimated_cost);
+            runtimes.push_back(run.runtime_ms(options.timeout_ms));
+            if (run.runtime_ms(options.timeout_ms) <
+                result.candidates[result.fastest].runtime_ms(options.timeout_ms) ||
+                !result.candidates[result.fastest].error.empty()) {
+                result.fastest = i;
+            }
+        }
+
+        if (!chosen.error.empty()) {
+            throw std::runtime_error("chosen plan failed: " + chosen.error);
+        }
+        double best_ms = result.candidates[result.fastest].runtime_ms(options.timeout_ms);
+        result.regret = best_ms > 0.0 ? chosen.runtime_ms(options.timeout_ms) / best_ms : 1.0;
+        result.regret_lower_bound = chosen.timed_out;
+        result.rank_correlation = spearman_correlation(costs, runtimes);
+    } catch (const std::exception& e) {
+        result.error = e.what();
+    }
+
+    results.push_back(result);
+    return result;
+}
+
+RegretResult RegretBenchmark::run_sql(const std::string& name, const std::string& distribution,
+                                      const std::string& sql) {
+    Tokenizer tokenizer(sql);
+    Parser parser(tokenizer.tokenize());
+    auto stmt = parser.parseSelectStatement();
+    return run(name, distribution, *stmt);
+}
+
+void RegretBenchmark::run_users_orders(const std::string& distribution) {
+    if (distribution == "skewed") {
+        DataGenerator::generate_skewed_dataset(*table_manager, 1000, 5000);
+    } else {
+        DataGenerator::generate_uniform_dataset(*table_manager, 1000, 5000);
+    }
+    optimizer.set_table_statistics("users", TableStatistics(1000, 10, 120));
+    optimizer.set_table_statistics("orders", TableStatistics(5000, 50, 80));
+
+    run_sql("UsersOrders", distribution,
+            "SELECT * FROM users JOIN orders ON users.id = orders.user_id");
+    run_sql("UsersOrders_Age", distribution,
+            "SELECT name, amount FROM users JOIN orders ON users.id = orders.user_id WHERE age > 60");
+    run_sql("UsersOrders_Amount", distribution,
+            "SELECT name, product FROM users JOIN orders ON users.id = orders.user_id "
+            "WHERE amount >= 900 AND age < 30");
+}
+
+void RegretBenchmark::run_corpus() {
+    if (options.timing.pin_cpu >= 0) {
+        pin_current_thread(options.timing.pin_cpu);
+    }
+    run_users_orders("uniform");
+    run_users_orders("skewed");
+
+    if (options.include_tpch) {
+        TpchGenerator generator(options.tpch_scale_factor, DataGenerator::get_seed());
+        generator.generate(*table_manager);
+        TpchGenerator::register_statistics(*table_manager, optimizer);
+        for (const auto& query : TpchGenerator::queries()) {
+            run_sql(std::string("TPCH_Q") + (query.number < 10 ? "0" : "") + std::to_string(query.number),
+                    "tpch", query.sql);
+        }
+    }
+}
+
+template <typename Fn>
+static void for_each_comparable(const std::vector<RegretResult>& results, Fn fn) {
+    for (const auto& result : results) {
+        if (result.error.empty() && result.candidates.size() >= 2) {
+            fn(result);
+        }
+    }
+}
+
+double RegretBenchmark::geometric_mean_regret() const {
+    double log_sum = 0.0;
+    size_t count = 0;
+    for_each_comparable(results, [&](const RegretResult& r) {
+        log_sum += std::log(r.regret);
+        count++;
+    });
+    return count > 0 ? std::exp(log_sum / count) : 1.0;
+}
+
+double RegretBenchmark::max_regret() const {
+    double worst = 1.0;
+    for_each_comparable(results, [&](const RegretResult& r) { worst = std::max(worst, r.regret); });
+    return worst;
+}
+
+double RegretBenchmark::mean_rank_correlation() const {
+    double sum = 0.0;
+    size_t count = 0;
+    for_each_comparable(results, [&](const RegretResult& r) {
+        sum += r.rank_correlation;
+        count++;
+    });
+    return count > 0 ? sum / count : 0.0;
+}
+
+size_t RegretBenchmark::suboptimal_choices(double tolerance) const {
+    size_t count = 0;
+    for_each_comparable(results, [&](const RegretResult& r) {
+        if (r.regret > tolerance) {
+            count++;
+        }
+    });
+    return count;
+}
+
+void RegretBenchmark::print_results() const {
+    std::cout << "\n=== Plan Regret (timeout " << options.timeout_ms << "ms) ===" << std::endl;
+    std::cout << std::left << std::setw(22) << "Query"
+              << std::setw(9) << "Data"
+              << std::setw(34) << "Chosen"
+              << std::setw(34) << "Fastest"
+              << std::right << std::setw(9) << "Regret"
+              << std::setw(8) << "Rho" << std::endl;
+    std::cout << std::string(116, '-') << std::endl;
+
+    for (const auto& result : results) {
+        std::cout << std::left << std::setw(22) << result.query_name << std::setw(9) << result.distribution;
+        if (!result.error.empty()) {
+            std::cout << "ERROR: " << result.error << std::endl;
+            continue;
+        }
+        const auto& chosen = result.candidates[result.chosen];
+        const auto& fastest = result.candidates[result.fastest];
+        std::cout << std::setw(34) << chosen.plan.substr(0, 33)
+                  << std::setw(34) << fastest.plan.substr(0, 33)
+                  << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(8) << result.regret << (result.regret_lower_bound ? "+" : " ")
+                  << std::setw(8) << result.rank_correlation << std::endl;
+
+        for (size_t i = 0; i < result.candidates.size(); ++i) {
+            const auto& run = result.candidates[i];
+            std::cout << "    " << (i == result.chosen ? "*" : " ") << " " << std::left << std::setw(40) << run.plan
+                      << std::right << std::scientific << std::setprecision(3) << std::setw(12) << run.estimated_cost
+                      << std::fixed << std::setprecision(2);
+            if (run.timed_out) {
+                std::cout << std::setw(12) << "timeout";
+            } else if (!run.error.empty()) {
+                std::cout << "  " << run.error;
+            } else {
+                std::cout << std::setw(10) << run.timing.median_ms << "ms";
+            }
+            std::cout << std::endl;
+        }
+    }
+
+    std::cout << "\nGeometric mean regret: " << std::fixed << std::setprecision(3) << geometric_mean_regret()
+              << " | Max: " << max_regret()
+              << " | Queries >1.1x: " << suboptimal_choices()
+              << " | Mean rank correlation: " << mean_rank_correlation() << std::endl;
+}
+
+BenchmarkReport RegretBenchmark::report() const {
+    BenchmarkReport out;
+    out.metadata = BenchmarkMetadata::collect();
+    out.metadata.parameters.emplace_back("seed", std::to_string(DataGenerator::get_seed()));
+    out.metadata.parameters.emplace_back("timeout_ms", std::to_string(options.timeout_ms));
+    out.metadata.parameters.emplace_back("geometric_mean_regret", std::to_string(geometric_mean_regret()));
+    out.metadata.parameters.emplace_back("mean_rank_correlation", std::to_string(mean_rank_correlation()));
+
+    for (const auto& result : results) {
+        for (size_t i = 0; i < result.candidates.size(); ++i) {
+            const auto& run = result.candidates[i];
+            if (run.timed_out || !run.error.empty()) {
+                continue;
+            }
+            BenchmarkEntry entry;
+            entry.query_name = "Regret_" + result.distribution + "_" + result.query_name;
+            entry.plan_type = (i == result.chosen ? "Chosen:" : "") + run.plan;
+            entry.estimated_cost = run.estimated_cost;
+            entry.result_size = run.result_size;
+            entry.timing = run.timing;
+            out.entries.push_back(entry);
+        }
+    }
+    return out;
+}
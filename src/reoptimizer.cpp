@@ -0,0 +1,196 @@
+#include "reoptimizer.h"
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <unordered_set>
+
+static SelectStatement clone_statement(const SelectStatement& stmt) {
+    SelectStatement copy;
+    for (const auto& item : stmt.select_list) {
+        copy.select_list.emplace_back(item.expression->clone(), item.alias);
+    }
+    copy.from_table = stmt.from_table;
+    for (const auto& join : stmt.joins) {
+        copy.joins.emplace_back(join.join_type, join.table, join.condition->clone());
+    }
+    if (stmt.where_clause) {
+        copy.where_clause = stmt.where_clause->clone();
+    }
+    return copy;
+}
+
+static bool is_join(const PlanNode& node) {
+    switch (node.type) {
+        case PlanNodeType::NESTED_LOOP_JOIN:
+        case PlanNodeType::HASH_JOIN:
+        case PlanNodeType::SORT_MERGE_JOIN:
+        case PlanNodeType::ADAPTIVE_JOIN:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static size_t count_joins(const PlanNode& node) {
+    size_t count = is_join(node) ? 1 : 0;
+    for (const auto& child : node.children) {
+        count += count_joins(*child);
+    }
+    return count;
+}
+
+// The deepest join, i.e. the first one to produce a complete result.
+static PlanNode* find_first_join(PlanNode& node, PlanNode*& parent) {
+    for (auto& child : node.children) {
+        if (PlanNode* found = find_first_join(*child, parent)) {
+            if (!parent) {
+                parent = &node;
+            }
+            return found;
+        }
+    }
+    return is_join(node) ? &node : nullptr;
+}
+
+static void collect_tables(const PlanNode& node, std::unordered_set<std::string>& tables) {
+    if (node.type == PlanNodeType::TABLE_SCAN) {
+        tables.insert(static_cast<const TableScanNode&>(node).table_name);
+    }
+    for (const auto& child : node.children) {
+        collect_tables(*child, tables);
+    }
+}
+
+// Temporary relation names are unique across the process, so reoptimizers
+// sharing a TableManager never overwrite or drop each other's tables.
+static std::atomic<uint64_t> next_temp_id{0};
+
+Reoptimizer::Reoptimizer(TableManager* tm, QueryOptimizer* query_optimizer, Executor* query_executor,
+                         const ReoptimizationOptions& reoptimization_options)
+    : table_manager(tm), optimizer(query_optimizer), executor(query_executor), options(reoptimization_options) {}
+
+Reoptimizer::~Reoptimizer() {
+    drop_temp_tables();
+}
+
+std::string Reoptimizer::materialize(const ResultSet& result) {
+    std::string name = "__reopt_" + std::to_string(next_temp_id++);
+    table_manager->create_table(name, result.get_schema());
+    temp_tables.push_back(name);
+
+    auto table = table_manager->get_table(name);
+    for (const auto& row : result.get_rows()) {
+        Row copy;
+        copy.values.reserve(row.size());
+        for (const auto& value : row.values) {
+            copy.add_value(value.type() == ValueType::STRING ? table->make_string(value.as_string()) : value);
+        }
+        table->add_row(std::move(copy));
+    }
+
+    return name;
+}
+
+void Reoptimizer::drop_temp_tables() {
+    for (const auto& name : temp_tables) {
+        table_manager->drop_table(name);
+        optimizer->remove_table_statistics(name);
+    }
+    temp_tables.clear();
+}
+
+std::unique_ptr<ResultSet> Reoptimizer::execute(const SelectStatement& stmt) {
+    drop_temp_tables();
+    events.clear();
+
+    SelectStatement current = clone_statement(stmt);
+    auto plan = optimizer->optimize(current);
+    if (!plan) {
+        throw std::runtime_error("No plan for query");
+    }
+
+    size_t replans = 0;
+
+    // The last join feeds the rest of the plan directly, so there is
+    // nothing left to re-plan once a single join remains.
+    while (count_joins(*plan) > 1) {
+        PlanNode* parent = nullptr;
+        PlanNode* join = find_first_join(*plan, parent);
+
+        size_t estimated = optimizer->estimate_cardinality(*join);
+        std::string relation;
+        size_t actual = 0;
+        {
+            auto result = executor->execute(*join);
+            actual = result->size();
+            relation = materialize(*result);
+        }
+
+        TableStatistics stats(actual, std::max<size_t>(1, actual / 100));
+        optimizer->set_table_statistics(relation, stats);
+
+        std::unordered_set<std::string> consumed;
+        collect_tables(*join, consumed);
+
+        SelectStatement next;
+        next.from_table = TableReference(relation);
+        for (const auto& item : current.select_list) {
+            next.select_list.emplace_back(item.expression->clone(), item.alias);
+        }
+        for (const auto& clause : current.joins) {
+            if (!consumed.count(clause.table.table_name)) {
+                next.joins.emplace_back(clause.join_type, clause.table, clause.condition->clone());
+            }
+        }
+        if (current.where_clause) {
+            next.where_clause = current.where_clause->clone();
+        }
+
+        double error = static_cast<double>(std::max<size_t>(actual, 1)) / std::max<size_t>(estimated, 1);
+        error = std::max(error, 1.0 / error);
+
+        // Re-planning restarts from the rewritten statement, which is only
+        // possible when the join consumed the statement's leading relation.
+        bool replan = error > options.misestimate_factor && replans < options.max_reoptimizations &&
+                      consumed.count(current.from_table.table_name);
+
+        if (replan) {
+            plan = optimizer->optimize(next);
+            if (!plan) {
+                throw std::runtime_error("No plan for the remaining joins");
+            }
+            replans++;
+        } else {
+            auto scan = std::make_unique<TableScanNode>(relation);
+            scan->stats = Statistics(actual, stats.page_count, 1.0);
+            for (auto& child : parent->children) {
+                if (child.get() == join) {
+                    child = std::move(scan);
+                    break;
+                }
+            }
+        }
+
+        current = std::move(next);
+        events.push_back({relation, estimated, actual, replan, plan->to_string()});
+    }
+
+    auto result = executor->execute(*plan);
+    if (temp_tables.empty()) {
+        return result;
+    }
+
+    // Rows may point at strings owned by the temporary tables.
+    auto owned = std::make_unique<ResultSet>(result->get_schema());
+    for (const auto& row : result->get_rows()) {
+        Row copy;
+        copy.values.reserve(row.size());
+        for (const auto& value : row.values) {
+            copy.add_value(value.type() == ValueType::STRING ? owned->make_string(value.as_string()) : value);
+        }
+        owned->add_row(std::move(copy));
+    }
+    drop_temp_tables();
+
+    return owned;
+}
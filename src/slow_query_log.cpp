@@ -0,0 +1,167 @@
+#include "slow_query_log.h"
+#include "query_session.h"
+#include "string_util.h"
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <stdexcept>
+
+static std::string utc_timestamp() {
+    auto now = std::chrono::system_clock::now();
+    std::time_t seconds = std::chrono::system_clock::to_time_t(now);
+    auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000;
+    std::tm utc;
+    gmtime_r(&seconds, &utc);
+    char buffer[32];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", &utc);
+    char fraction[8];
+    std::snprintf(fraction, sizeof(fraction), ".%03dZ", static_cast<int>(millis));
+    return std::string(buffer) + fraction;
+}
+
+static void plan_json(const PlanNode& node, const std::unordered_map<const PlanNode*, size_t>& actual_rows,
+                      std::string& out) {
+    std::string label = node.to_string(0);
+    label = label.substr(0, label.find('\n'));
+    out += "{\"operator\":\"" + json_escape(label) + "\",\"estimated_rows\":" + std::to_string(node.stats.row_count);
+
+    auto actual = actual_rows.find(&node);
+    if (actual != actual_rows.end()) {
+        double estimated = static_cast<double>(std::max<size_t>(node.stats.row_count, 1));
+        double rows = static_cast<double>(std::max<size_t>(actual->second, 1));
+        out += ",\"actual_rows\":" + std::to_string(actual->second) +
+               ",\"q_error\":" + format_double("%.2f", std::max(estimated / rows, rows / estimated));
+    }
+
+    out += ",\"children\":[";
+    for (size_t i = 0; i < node.children.size(); ++i) {
+        if (i > 0) out += ",";
+        plan_json(*node.children[i], actual_rows, out);
+    }
+    out += "]}";
+}
+
+std::string SlowQueryLog::format_entry(const std::string& sql, const QueryRun& run,
+                                       const std::unordered_map<const PlanNode*, size_t>& actual_rows,
+                                       const OptimizerStats& optimizer, const std::string& error) {
+    std::string out = "{\"time\":\"" + utc_timestamp() + "\"";
+    out += ",\"total_ms\":" + format_double("%.3f", run.total_ms);
+    out += ",\"parse_ms\":" + format_double("%.3f", run.parse_ms);
+    out += ",\"optimize_ms\":" + format_double("%.3f", run.optimize_ms);
+    out += ",\"queue_ms\":" + format_double("%.3f", run.queue_ms);
+    out += ",\"execute_ms\":" + format_double("%.3f", run.execute_ms);
+    out += ",\"rows\":" + std::to_string(run.result ? run.result->size() : 0);
+    out += ",\"spill_bytes\":" + std::to_string(run.spill_bytes);
+    if (!error.empty()) {
+        out += ",\"error\":\"" + json_escape(error) + "\"";
+    }
+    out += ",\"sql\":\"" + json_escape(sql) + "\"";
+    if (run.plan) {
+        out += ",\"plan_text\":\"" + json_escape(run.plan->to_string()) + "\",\"plan\":";
+        plan_json(*run.plan, actual_rows, out);
+    }
+    out += ",\"optimizer\":" + optimizer.to_json();
+    out += "}\n";
+    return out;
+}
+
+SlowQueryLog::SlowQueryLog(const SlowQueryLogOptions& opts) : options(opts), threshold_ms(opts.threshold_ms) {
+    std::ifstream existing(options.path, std::ios::binary | std::ios::ate);
+    if (existing) {
+        file_bytes = static_cast<size_t>(std::max<std::streamoff>(0, existing.tellg()));
+    }
+    file.open(options.path, std::ios::app);
+    if (!file) {
+        throw std::runtime_error("Cannot open slow query log: " + options.path);
+    }
+    writer = std::thread(&SlowQueryLog::writer_loop, this);
+}
+
+SlowQueryLog::~SlowQueryLog() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+}
+
+void SlowQueryLog::submit(std::string entry) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (queue.size() >= options.max_queued) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        queue.push_back(std::move(entry));
+        ++submitted;
+    }
+    wake.notify_one();
+}
+
+void SlowQueryLog::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    uint64_t target = submitted;
+    drained.wait(lock, [&] { return completed >= target; });
+}
+
+void SlowQueryLog::writer_loop() {
+    std::deque<std::string> batch;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            completed += batch.size();
+            if (!batch.empty()) {
+                drained.notify_all();
+            }
+            batch.clear();
+            wake.wait(lock, [&] { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                return;
+            }
+            batch.swap(queue);
+        }
+        for (const auto& entry : batch) {
+            write_entry(entry);
+        }
+        file.flush();
+        if (!file) {
+            write_errors.fetch_add(1, std::memory_order_relaxed);
+            file.clear();
+        }
+    }
+}
+
+void SlowQueryLog::write_entry(const std::string& entry) {
+    if (file_bytes > 0 && file_bytes + entry.size() > options.max_file_bytes) {
+        rotate();
+    }
+    file << entry;
+    if (!file) {
+        write_errors.fetch_add(1, std::memory_order_relaxed);
+        file.clear();
+        return;
+    }
+    file_bytes += entry.size();
+    written.fetch_add(1, std::memory_order_relaxed);
+}
+
+// path -> path.1 -> ... -> path.(max_files - 1), dropping the oldest.
+void SlowQueryLog::rotate() {
+    file.close();
+    if (options.max_files > 1) {
+        std::string oldest = options.path + "." + std::to_string(options.max_files - 1);
+        std::remove(oldest.c_str());
+        for (size_t i = options.max_files - 1; i > 1; --i) {
+            std::string from = options.path + "." + std::to_string(i - 1);
+            std::string to = options.path + "." + std::to_string(i);
+            std::rename(from.c_str(), to.c_str());
+        }
+        std::rename(options.path.c_str(), (options.path + ".1").c_str());
+    }
+    file.open(options.path, std::ios::trunc);
+    file_bytes = 0;
+    if (!file) {
+        write_errors.fetch_add(1, std::memory_order_relaxed);
+    }
+}
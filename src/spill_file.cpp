@@ -0,0 +1,138 @@
+#include "spill_file.h"
+#include <cstring>
+#include <stdexcept>
+
+SpillFile::SpillFile() : file(std::tmpfile()) {
+    if (!file) {
+        throw std::runtime_error("Failed to create spill file");
+    }
+}
+
+SpillFile::~SpillFile() {
+    std::fclose(file);
+}
+
+void SpillFile::write_row(const Row& row) {
+    char buffer[16];
+    uint32_t width = static_cast<uint32_t>(row.size());
+    std::fwrite(&width, sizeof(width), 1, file);
+    bytes_written += sizeof(width);
+
+    for (const auto& value : row.values) {
+        uint8_t tag = static_cast<uint8_t>(value.type());
+        size_t payload = 0;
+        switch (value.type()) {
+            case ValueType::NULL_VALUE:
+                break;
+            case ValueType::INT: {
+                int64_t v = value.as_int();
+                std::memcpy(buffer, &v, sizeof(v));
+                payload = sizeof(v);
+                break;
+            }
+            case ValueType::DOUBLE: {
+                double v = value.as_double();
+                std::memcpy(buffer, &v, sizeof(v));
+                payload = sizeof(v);
+                break;
+            }
+            case ValueType::BOOL:
+                buffer[0] = value.as_bool() ? 1 : 0;
+                payload = 1;
+                break;
+            case ValueType::DATE: {
+                int32_t v = value.as_date();
+                std::memcpy(buffer, &v, sizeof(v));
+                payload = sizeof(v);
+                break;
+            }
+            case ValueType::STRING: {
+                uint32_t length = static_cast<uint32_t>(value.as_string().size());
+                std::memcpy(buffer, &length, sizeof(length));
+                payload = sizeof(length);
+                break;
+            }
+        }
+
+        std::fwrite(&tag, 1, 1, file);
+        std::fwrite(buffer, 1, payload, file);
+        bytes_written += 1 + payload;
+
+        if (value.type() == ValueType::STRING) {
+            auto text = value.as_string();
+            std::fwrite(text.data(), 1, text.size(), file);
+            bytes_written += text.size();
+        }
+    }
+
+    if (std::ferror(file)) {
+        throw std::runtime_error("Failed to write spill file");
+    }
+    rows_written++;
+}
+
+void SpillFile::rewind() {
+    std::fflush(file);
+    std::rewind(file);
+}
+
+bool SpillFile::read_row(Row& row, StringHeap& strings) {
+    uint32_t width = 0;
+    if (std::fread(&width, sizeof(width), 1, file) != 1) {
+        return false;
+    }
+
+    row.values.clear();
+    row.values.reserve(width);
+    std::string text;
+
+    for (uint32_t i = 0; i < width; ++i) {
+        uint8_t tag = 0;
+        bool ok = std::fread(&tag, 1, 1, file) == 1;
+
+        switch (static_cast<ValueType>(tag)) {
+            case ValueType::NULL_VALUE:
+                row.add_value(Value::null());
+                break;
+            case ValueType::INT: {
+                int64_t v = 0;
+                ok = ok && std::fread(&v, sizeof(v), 1, file) == 1;
+                row.add_value(Value(v));
+                break;
+            }
+            case ValueType::DOUBLE: {
+                double v = 0;
+                ok = ok && std::fread(&v, sizeof(v), 1, file) == 1;
+                row.add_value(Value(v));
+                break;
+            }
+            case ValueType::BOOL: {
+                char v = 0;
+                ok = ok && std::fread(&v, 1, 1, file) == 1;
+                row.add_value(Value(v != 0));
+                break;
+            }
+            case ValueType::DATE: {
+                int32_t v = 0;
+                ok = ok && std::fread(&v, sizeof(v), 1, file) == 1;
+                row.add_value(Value::date(v));
+                break;
+            }
+            case ValueType::STRING: {
+                uint32_t length = 0;
+                ok = ok && std::fread(&length, sizeof(length), 1, file) == 1;
+                text.resize(length);
+                ok = ok && (length == 0 || std::fread(&text[0], 1, length, file) == length);
+                row.add_value(Value::string_ref(strings.store(text)));
+                break;
+            }
+            default:
+                ok = false;
+        }
+
+        if (!ok) {
+            throw std::runtime_error("Corrupt spill file");
+        }
+    }
+    return true;
+}
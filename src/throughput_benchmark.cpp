@@ -0,0 +1,270 @@
+#include "throughput_benchmark.h"
+#include "query_session.h"
+#include "time_util.h"
+#include <chrono>
+#include <condition_variable>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+
+ThroughputBenchmark::ThroughputBenchmark(TableManager* tm, const ThroughputOptions& opts)
+    : table_manager(tm), options(opts) {
+    DataGenerator::generate_large_dataset(*table_manager, options.users, options.orders);
+}
+
+const char* ThroughputBenchmark::query_name(WorkloadQuery query) {
+    switch (query) {
+        case WorkloadQuery::POINT_LOOKUP: return "point_lookup";
+        case WorkloadQuery::FILTERED_SCAN: return "filtered_scan";
+        case WorkloadQuery::JOIN: return "join";
+    }
+    return "unknown";
+}
+
+std::string ThroughputBenchmark::build_query(WorkloadQuery query, uint64_t value) const {
+    switch (query) {
+        case WorkloadQuery::POINT_LOOKUP:
+            return "SELECT name, city FROM users WHERE id = " + std::to_string(value % options.users + 1);
+        case WorkloadQuery::FILTERED_SCAN:
+            // Amounts are uniform in [10, 1000].
+            return "SELECT id, amount FROM orders WHERE amount > " + std::to_string(880 + value % 40);
+        case WorkloadQuery::JOIN:
+            return "SELECT users.name, orders.amount FROM users JOIN orders ON users.id = orders.user_id "
+                   "WHERE users.age > " + std::to_string(60 + value % 5);
+    }
+    return "";
+}
+
+namespace {
+
+struct ClientLog {
+    std::vector<double> latencies[3];   // indexed by WorkloadQuery
+    size_t errors = 0;
+};
+
+}
+
+ThroughputResult ThroughputBenchmark::run(size_t clients) {
+    // Orders inserted by an earlier run would make this one query a larger
+    // table; the generator is seeded, so regenerating restores the original.
+    Table* orders = table_manager->get_table("orders");
+    if (!orders || orders->row_count() != options.orders) {
+        DataGenerator::generate_large_dataset(*table_manager, options.users, options.orders);
+    }
+
+    std::vector<ClientLog> logs(clients);
+    // Clients warm up, then all start together. Every thread checks the
+    // deadline itself rather than waiting to be told to stop, which on a
+    // saturated machine may come late.
+    std::mutex mutex;
+    std::condition_variable start_line;
+    size_t ready = 0;
+    bool go = false;
+    std::chrono::steady_clock::time_point deadline;
+    auto wait_for_start = [&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        start_line.wait(lock, [&] { return go; });
+    };
+    uint64_t seed = DataGenerator::get_seed();
+
+    auto client = [&](size_t id) {
+        QuerySession session(table_manager);
+        std::mt19937_64 gen(seed + id);
+        std::discrete_distribution<int> pick({options.mix.point_lookups, options.mix.filtered_scans,
+                                              options.mix.joins});
+        ClientLog& log = logs[id];
+
+        auto next_query = [&]() {
+            auto query = static_cast<WorkloadQuery>(pick(gen));
+            return std::make_pair(query, build_query(query, gen()));
+        };
+
+        for (size_t i = 0; i < options.warmup_queries; ++i) {
+            try {
+                session.run(next_query().second);
+            } catch (const std::exception&) {
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++ready;
+        }
+        start_line.notify_all();
+        wait_for_start();
+
+        while (std::chrono::steady_clock::now() < deadline) {
+            auto [query, sql] = next_query();
+            auto start = std::chrono::steady_clock::now();
+            try {
+                session.run(sql);
+            } catch (const std::exception&) {
+                ++log.errors;
+                continue;
+            }
+            log.latencies[static_cast<int>(query)].push_back(elapsed_ms(start));
+        }
+    };
+
+    // Appends orders at a fixed rate, holding the table's write lock per row.
+    size_t inserts = 0;
+    auto writer = [&]() {
+        Table* orders = table_manager->get_table("orders");
+        std::mt19937_64 gen(seed + clients + 1);
+        std::uniform_int_distribution<int> user_dist(1, static_cast<int>(options.users));
+        std::uniform_int_distribution<int> product_dist(1, 200);
+        std::uniform_int_distribution<int> amount_dist(10, 1000);
+        auto interval = std::chrono::duration<double>(1.0 / options.inserts_per_sec);
+        auto next = std::chrono::steady_clock::now();
+
+        wait_for_start();
+        while (std::chrono::steady_clock::now() < deadline) {
+            {
+                auto lock = orders->write_lock();
+                Row row;
+                row.add_value(static_cast<int>(orders->row_count() + 1));
+                row.add_value(user_dist(gen));
+                row.add_value(orders->make_string("Product" + std::to_string(product_dist(gen))));
+                row.add_value(amount_dist(gen));
+                orders->add_row(std::move(row));
+            }
+            ++inserts;
+            next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(interval);
+            std::this_thread::sleep_until(next);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t c = 0; c < clients; ++c) {
+        threads.emplace_back(client, c);
+    }
+    std::thread insert_thread;
+    if (options.inserts_per_sec > 0.0) {
+        insert_thread = std::thread(writer);
+    }
+
+    std::chrono::steady_clock::time_point start;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        start_line.wait(lock, [&] { return ready == clients; });
+        start = std::chrono::steady_clock::now();
+        deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                               std::chrono::duration<double, std::milli>(options.duration_ms));
+        go = true;
+    }
+    start_line.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    ThroughputResult result;
+    result.clients = clients;
+    result.elapsed_ms = elapsed_ms(start);
+    if (insert_thread.joinable()) {
+        insert_thread.join();
+    }
+    result.inserts = inserts;
+
+    std::vector<double> all;
+    std::vector<double> by_query[3];
+    for (const auto& log : logs) {
+        result.errors += log.errors;
+        for (int q = 0; q < 3; ++q) {
+            by_query[q].insert(by_query[q].end(), log.latencies[q].begin(), log.latencies[q].end());
+            all.insert(all.end(), log.latencies[q].begin(), log.latencies[q].end());
+        }
+    }
+    result.queries = all.size();
+    result.qps = result.elapsed_ms > 0.0 ? result.queries * 1000.0 / result.elapsed_ms : 0.0;
+    result.latency = TimingStats::from_samples(std::move(all));
+    result.point_lookups = TimingStats::from_samples(std::move(by_query[0]));
+    result.filtered_scans = TimingStats::from_samples(std::move(by_query[1]));
+    result.joins = TimingStats::from_samples(std::move(by_query[2]));
+
+    results.push_back(result);
+    return result;
+}
+
+void ThroughputBenchmark::run_all(const std::vector<size_t>& client_counts) {
+    for (size_t clients : client_counts) {
+        run(clients);
+    }
+}
+
+void ThroughputBenchmark::print_results() const {
+    std::cout << std::defaultfloat << std::setprecision(6);
+    std::cout << "\n=== Throughput Benchmark (" << options.users << " users, " << options.orders << " orders, "
+              << options.duration_ms << "ms per run";
+    if (options.inserts_per_sec > 0.0) {
+        std::cout << ", " << options.inserts_per_sec << " inserts/s";
+    }
+    std::cout << ") ===" << std::endl;
+    std::cout << "Mix: " << options.mix.point_lookups << " point lookups, " << options.mix.filtered_scans
+              << " filtered scans, " << options.mix.joins << " joins; latencies in ms" << std::endl;
+    std::cout << std::right << std::setw(8) << "Clients"
+              << std::setw(10) << "QPS"
+              << std::setw(9) << "Scaling"
+              << std::setw(9) << "p50"
+              << std::setw(9) << "p95"
+              << std::setw(9) << "p99"
+              << std::setw(10) << "Point p99"
+              << std::setw(10) << "Scan p99"
+              << std::setw(10) << "Join p99"
+              << std::setw(8) << "Errors"
+              << std::setw(9) << "Inserts" << std::endl;
+    std::cout << std::string(101, '-') << std::endl;
+
+    // Scaling is QPS over clients times the single-client QPS.
+    double single_client_qps = 0.0;
+    for (const auto& result : results) {
+        if (result.clients == 1) {
+            single_client_qps = result.qps;
+            break;
+        }
+    }
+
+    for (const auto& result : results) {
+        std::cout << std::fixed << std::setprecision(0) << std::setw(8) << result.clients
+                  << std::setw(10) << result.qps;
+        if (single_client_qps > 0.0) {
+            std::cout << std::setprecision(2) << std::setw(9) << result.qps / (single_client_qps * result.clients);
+        } else {
+            std::cout << std::setw(9) << "-";
+        }
+        std::cout << std::setprecision(3) << std::setw(9) << result.latency.median_ms
+                  << std::setw(9) << result.latency.p95_ms
+                  << std::setw(9) << result.latency.p99_ms
+                  << std::setw(10) << result.point_lookups.p99_ms
+                  << std::setw(10) << result.filtered_scans.p99_ms
+                  << std::setw(10) << result.joins.p99_ms
+                  << std::setw(8) << result.errors
+                  << std::setw(9) << result.inserts << std::endl;
+    }
+}
+
+BenchmarkReport ThroughputBenchmark::report() const {
+    BenchmarkReport out;
+    out.metadata = BenchmarkMetadata::collect();
+    out.metadata.parameters.emplace_back("seed", std::to_string(DataGenerator::get_seed()));
+    out.metadata.parameters.emplace_back("users", std::to_string(options.users));
+    out.metadata.parameters.emplace_back("orders", std::to_string(options.orders));
+    out.metadata.parameters.emplace_back("duration_ms", std::to_string(options.duration_ms));
+    out.metadata.parameters.emplace_back("inserts_per_sec", std::to_string(options.inserts_per_sec));
+
+    // One entry per client count and query kind; result_size is the number
+    // of queries completed.
+    for (const auto& result : results) {
+        const TimingStats* timings[] = {&result.point_lookups, &result.filtered_scans, &result.joins};
+        for (int q = 0; q < 3; ++q) {
+            BenchmarkEntry entry;
+            entry.query_name = std::string("Throughput_") + query_name(static_cast<WorkloadQuery>(q)) + "_" +
+                               std::to_string(result.clients) + "_clients";
+            entry.plan_type = "Optimized";
+            entry.result_size = timings[q]->samples;
+            entry.timing = *timings[q];
+            out.entries.push_back(entry);
+        }
+    }
+    return out;
+}
@@ -1,4 +1,5 @@
 #include "tokenizer.h"
+#include "trace.h"
 #include <cctype>
 #include <algorithm>
 
@@ -140,6 +141,7 @@ Token Tokenizer::nextToken() {
 }
 
 std::vector<Token> Tokenizer::tokenize() {
+    TraceSpan span("parse", "tokenize");
     std::vector<Token> tokens;
     
     while (!isAtEnd()) {
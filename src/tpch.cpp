@@ -0,0 +1,560 @@
+#include "tpch.h"
+#include "string_util.h"
+#include "trace.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+std::string ResultChecksum::to_string() const {
+    char buffer[48];
+    std::snprintf(buffer, sizeof(buffer), "%zu rows, %016llx", rows, static_cast<unsigned long long>(hash));
+    return buffer;
+}
+
+static uint64_t mix64(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+ResultChecksum checksum_rows(const std::vector<Row>& rows) {
+    // Rows are hashed independently and summed, so any row order matches.
+    ResultChecksum checksum;
+    checksum.rows = rows.size();
+    for (const auto& row : rows) {
+        uint64_t hash = FNV1A_OFFSET_BASIS;
+        for (const auto& value : row.values) {
+            hash = fnv1a(value.to_string(), hash);
+            hash = fnv1a("\x1f", hash);
+        }
+        checksum.hash += mix64(hash);
+    }
+    return checksum;
+}
+
+namespace {
+
+// splitmix64; unlike <random> distributions its output is the same on
+// every standard library, which the reference checksums rely on.
+class TpchRandom {
+private:
+    uint64_t state;
+
+public:
+    explicit TpchRandom(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        state += 0x9e3779b97f4a7c15ULL;
+        return mix64(state - 0x9e3779b97f4a7c15ULL);
+    }
+
+    int64_t uniform(int64_t low, int64_t high) {
+        return low + static_cast<int64_t>(next() % static_cast<uint64_t>(high - low + 1));
+    }
+
+    template <size_t N>
+    const char* pick(const char* const (&options)[N]) {
+        return options[next() % N];
+    }
+};
+
+const char* const NATIONS[25] = {
+    "ALGERIA", "ARGENTINA", "BRAZIL", "CANADA", "EGYPT", "ETHIOPIA", "FRANCE", "GERMANY",
+    "INDIA", "INDONESIA", "IRAN", "IRAQ", "JAPAN", "JORDAN", "KENYA", "MOROCCO", "MOZAMBIQUE",
+    "PERU", "CHINA", "ROMANIA", "SAUDI ARABIA", "VIETNAM", "RUSSIA", "UNITED KINGDOM", "UNITED STATES"
+};
+const int NATION_REGIONS[25] = {0, 1, 1, 1, 4, 0, 3, 3, 2, 2, 4, 4, 2, 4, 0, 0, 0, 1, 2, 3, 4, 2, 3, 3, 1};
+const char* const REGIONS[5] = {"AFRICA", "AMERICA", "ASIA", "EUROPE", "MIDDLE EAST"};
+
+const char* const SEGMENTS[] = {"AUTOMOBILE", "BUILDING", "FURNITURE", "MACHINERY", "HOUSEHOLD"};
+const char* const PRIORITIES[] = {"1-URGENT", "2-HIGH", "3-MEDIUM", "4-NOT SPECIFIED", "5-LOW"};
+const char* const SHIP_MODES[] = {"REG AIR", "AIR", "RAIL", "SHIP", "TRUCK", "MAIL", "FOB"};
+const char* const INSTRUCTIONS[] = {"DELIVER IN PERSON", "COLLECT COD", "NONE", "TAKE BACK RETURN"};
+const char* const TYPE_SIZES[] = {"STANDARD", "SMALL", "MEDIUM", "LARGE", "ECONOMY", "PROMO"};
+const char* const TYPE_FINISHES[] = {"ANODIZED", "BURNISHED", "PLATED", "POLISHED", "BRUSHED"};
+const char* const TYPE_METALS[] = {"TIN", "NICKEL", "BRASS", "STEEL", "COPPER"};
+const char* const CONTAINER_SIZES[] = {"SM", "LG", "MED", "JUMBO", "WRAP"};
+const char* const CONTAINER_KINDS[] = {"CASE", "BOX", "BAG", "JAR", "PKG", "PACK", "CAN", "DRUM"};
+const char* const COLORS[] = {
+    "almond", "antique", "aquamarine", "azure", "beige", "bisque", "black", "blanched", "blue",
+    "blush", "brown", "burlywood", "chartreuse", "chiffon", "chocolate", "coral", "cornflower",
+    "cream", "cyan", "dark", "deep", "dim", "dodger", "drab", "firebrick", "forest", "frosted",
+    "gainsboro", "ghost", "goldenrod", "green", "grey", "honeydew", "hot", "indian", "ivory",
+    "khaki", "lace", "lavender", "lemon", "light", "lime", "linen", "magenta", "maroon", "medium",
+    "metallic", "midnight", "mint", "misty", "moccasin", "navajo", "navy", "olive", "orange",
+    "orchid", "pale", "papaya", "peach", "peru", "pink", "plum", "powder", "puff", "purple", "red",
+    "rose", "rosy", "royal", "saddle", "salmon", "sandy", "seashell", "sienna", "sky", "slate",
+    "smoke", "snow", "spring", "steel", "tan", "thistle", "tomato", "turquoise", "violet", "wheat",
+    "white", "yellow"
+};
+const char* const WORDS[] = {
+    "furiously", "quickly", "carefully", "blithely", "slyly", "final", "regular", "express",
+    "pending", "ironic", "bold", "even", "special", "unusual", "silent", "packages", "requests",
+    "accounts", "deposits", "foxes", "ideas", "theodolites", "pinto", "beans", "instructions",
+    "dependencies", "excuses", "platelets", "asymptotes", "courts", "dolphins", "sleep", "wake",
+    "are", "haggle", "nag", "use", "boost", "affix", "detect", "integrate", "cajole", "among",
+    "above", "against", "along", "across", "after"
+};
+
+enum TableId { REGION, NATION, SUPPLIER, CUSTOMER, PART, ORDERS };
+
+constexpr size_t CHUNK_ROWS = 8192;
+
+// One chunk's rows for a table and, for part and orders, its child table.
+struct GeneratedChunk {
+    std::vector<Row> rows;
+    StringHeap strings;
+    std::vector<Row> child_rows;
+    StringHeap child_strings;
+};
+
+struct ChunkContext {
+    TpchRandom random;
+    GeneratedChunk& out;
+
+    Value text(StringHeap& heap, const std::string& value) {
+        return Value::string_ref(heap.store(value));
+    }
+
+    Value comment(StringHeap& heap, int min_words, int max_words) {
+        std::string value;
+        int words = static_cast<int>(random.uniform(min_words, max_words));
+        for (int i = 0; i < words; ++i) {
+            if (i > 0) value += ' ';
+            value += random.pick(WORDS);
+        }
+        return text(heap, value);
+    }
+
+    Value money(int64_t low_cents, int64_t high_cents) {
+        return Value(static_cast<double>(random.uniform(low_cents, high_cents)) / 100.0);
+    }
+
+    Value phone(int nation) {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%d-%03d-%03d-%04d", nation + 10,
+                      static_cast<int>(random.uniform(100, 999)), static_cast<int>(random.uniform(100, 999)),
+                      static_cast<int>(random.uniform(1000, 9999)));
+        return text(out.strings, buffer);
+    }
+};
+
+std::string numbered(const char* prefix, int64_t number) {
+    char buffer[48];
+    std::snprintf(buffer, sizeof(buffer), "%s#%09lld", prefix, static_cast<long long>(number));
+    return buffer;
+}
+
+double round_cents(double value) {
+    return std::round(value * 100.0) / 100.0;
+}
+
+double retail_price(int64_t partkey) {
+    return (90000 + (partkey / 10) % 20001 + 100 * (partkey % 1000)) / 100.0;
+}
+
+// The i-th (0..3) supplier of a part, as in the TPC-H specification.
+int64_t part_supplier(int64_t partkey, int64_t i, int64_t suppliers) {
+    return (partkey + i * (suppliers / 4 + (partkey - 1) / suppliers)) % suppliers + 1;
+}
+
+TableSchema make_schema(std::initializer_list<std::pair<const char*, const char*>> columns) {
+    TableSchema schema;
+    for (const auto& [name, type] : columns) {
+        schema.add_column(name, type);
+    }
+    return schema;
+}
+
+// Generates `count` rows (1-based keys) in chunks across threads, then
+// appends the chunks in key order.
+template <typename Fill>
+void generate_chunked(size_t count, size_t threads, uint64_t seed, TableId id,
+                      Table* table, Table* child, Fill fill) {
+    size_t chunk_count = (count + CHUNK_ROWS - 1) / CHUNK_ROWS;
+    std::vector<GeneratedChunk> chunks(chunk_count);
+    std::atomic<size_t> next_chunk{0};
+
+    auto worker = [&]() {
+        for (size_t chunk = next_chunk++; chunk < chunk_count; chunk = next_chunk++) {
+            TraceSpan span("datagen", "generate chunk");
+            span.add_arg("chunk", static_cast<double>(chunk));
+            ChunkContext context{TpchRandom(mix64(seed ^ mix64(id * 1000003ULL + chunk))), chunks[chunk]};
+            int64_t first = static_cast<int64_t>(chunk * CHUNK_ROWS) + 1;
+            int64_t last = static_cast<int64_t>(std::min(count, (chunk + 1) * CHUNK_ROWS));
+            context.out.rows.reserve(last - first + 1);
+            for (int64_t key = first; key <= last; ++key) {
+                fill(context, key);
+            }
+        }
+    };
+
+    size_t worker_count = std::max<size_t>(1, std::min(threads, chunk_count));
+    std::vector<std::thread> pool;
+    for (size_t i = 1; i < worker_count; ++i) {
+        pool.emplace_back([&worker, i]() {
+            if (Tracer::enabled()) {
+                Tracer::set_thread_name("datagen worker " + std::to_string(i));
+            }
+            worker();
+        });
+    }
+    worker();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+
+    table->reserve(count);
+    for (auto& chunk : chunks) {
+        table->append_rows(std::move(chunk.rows), std::move(chunk.strings));
+        if (child) {
+            child->append_rows(std::move(chunk.child_rows), std::move(chunk.child_strings));
+        }
+    }
+}
+
+}
+
+TpchGenerator::TpchGenerator(double sf, uint64_t generator_seed, size_t thread_count)
+    : scale_factor(sf), seed(generator_seed), threads(thread_count) {
+    if (scale_factor <= 0.0) {
+        throw std::runtime_error("TPC-H scale factor must be positive");
+    }
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+size_t TpchGenerator::scaled(size_t rows_at_sf1) const {
+    return std::max<size_t>(1, static_cast<size_t>(std::llround(rows_at_sf1 * scale_factor)));
+}
+
+const std::vector<std::string>& TpchGenerator::table_names() {
+    static const std::vector<std::string> names = {
+        "region", "nation", "supplier", "customer", "part", "partsupp", "orders", "lineitem"
+    };
+    return names;
+}
+
+void TpchGenerator::generate(TableManager& tm) const {
+    const int64_t suppliers = static_cast<int64_t>(scaled(10000));
+    const int64_t customers = std::max<int64_t>(2, static_cast<int64_t>(scaled(150000)));
+    const int64_t parts = static_cast<int64_t>(scaled(200000));
+    const int64_t orders = static_cast<int64_t>(scaled(1500000));
+
+    int32_t start_date = 0, current_date = 0, end_date = 0;
+    Value::parse_date("1992-01-01", start_date);
+    Value::parse_date("1995-06-17", current_date);
+    Value::parse_date("1998-12-31", end_date);
+    const int32_t last_order_date = end_date - 151;
+
+    tm.create_table("region", make_schema({{"r_regionkey", "int"}, {"r_name", "string"}, {"r_comment", "string"}}));
+    tm.create_table("nation", make_schema({{"n_nationkey", "int"}, {"n_name", "string"},
+                                           {"n_regionkey", "int"}, {"n_comment", "string"}}));
+    tm.create_table("supplier", make_schema({{"s_suppkey", "int"}, {"s_name", "string"}, {"s_address", "string"},
+                                             {"s_nationkey", "int"}, {"s_phone", "string"},
+                                             {"s_acctbal", "double"}, {"s_comment", "string"}}));
+    tm.create_table("customer", make_schema({{"c_custkey", "int"}, {"c_name", "string"}, {"c_address", "string"},
+                                             {"c_nationkey", "int"}, {"c_phone", "string"}, {"c_acctbal", "double"},
+                                             {"c_mktsegment", "string"}, {"c_comment", "string"}}));
+    tm.create_table("part", make_schema({{"p_partkey", "int"}, {"p_name", "string"}, {"p_mfgr", "string"},
+                                         {"p_brand", "string"}, {"p_type", "string"}, {"p_size", "int"},
+                                         {"p_container", "string"}, {"p_retailprice", "double"},
+                                         {"p_comment", "string"}}));
+    tm.create_table("partsupp", make_schema({{"ps_partkey", "int"}, {"ps_suppkey", "int"}, {"ps_availqty", "int"},
+                                             {"ps_supplycost", "double"}, {"ps_comment", "string"}}));
+    tm.create_table("orders", make_schema({{"o_orderkey", "int"}, {"o_custkey", "int"}, {"o_orderstatus", "string"},
+                                           {"o_totalprice", "double"}, {"o_orderdate", "date"},
+                                           {"o_orderpriority", "string"}, {"o_clerk", "string"},
+                                           {"o_shippriority", "int"}, {"o_comment", "string"}}));
+    tm.create_table("lineitem", make_schema({{"l_orderkey", "int"}, {"l_partkey", "int"}, {"l_suppkey", "int"},
+                                             {"l_linenumber", "int"}, {"l_quantity", "double"},
+                                             {"l_extendedprice", "double"}, {"l_discount", "double"},
+                                             {"l_tax", "double"}, {"l_returnflag", "string"},
+                                             {"l_linestatus", "string"}, {"l_shipdate", "date"},
+                                             {"l_commitdate", "date"}, {"l_receiptdate", "date"},
+                                             {"l_shipinstruct", "string"}, {"l_shipmode", "string"},
+                                             {"l_comment", "string"}}));
+
+    generate_chunked(5, 1, seed, REGION, tm.get_table("region"), nullptr, [](ChunkContext& c, int64_t key) {
+        Row row;
+        row.add_value(key - 1);
+        row.add_value(c.text(c.out.strings, REGIONS[key - 1]));
+        row.add_value(c.comment(c.out.strings, 4, 10));
+        c.out.rows.push_back(std::move(row));
+    });
+
+    generate_chunked(25, 1, seed, NATION, tm.get_table("nation"), nullptr, [](ChunkContext& c, int64_t key) {
+        Row row;
+        row.add_value(key - 1);
+        row.add_value(c.text(c.out.strings, NATIONS[key - 1]));
+        row.add_value(NATION_REGIONS[key - 1]);
+        row.add_value(c.comment(c.out.strings, 4, 10));
+        c.out.rows.push_back(std::move(row));
+    });
+
+    generate_chunked(suppliers, threads, seed, SUPPLIER, tm.get_table("supplier"), nullptr,
+                     [](ChunkContext& c, int64_t key) {
+        int nation = static_cast<int>(c.random.uniform(0, 24));
+        Row row;
+        row.add_value(key);
+        row.add_value(c.text(c.out.strings, numbered("Supplier", key)));
+        row.add_value(c.comment(c.out.strings, 2, 4));
+        row.add_value(nation);
+        row.add_value(c.phone(nation));
+        row.add_value(c.money(-99999, 999999));
+        row.add_value(c.comment(c.out.strings, 5, 12));
+        c.out.rows.push_back(std::move(row));
+    });
+
+    generate_chunked(customers, threads, seed, CUSTOMER, tm.get_table("customer"), nullptr,
+                     [](ChunkContext& c, int64_t key) {
+        int nation = static_cast<int>(c.random.uniform(0, 24));
+        Row row;
+        row.add_value(key);
+        row.add_value(c.text(c.out.strings, numbered("Customer", key)));
+        row.add_value(c.comment(c.out.strings, 2, 4));
+        row.add_value(nation);
+        row.add_value(c.phone(nation));
+        row.add_value(c.money(-99999, 999999));
+        row.add_value(c.text(c.out.strings, c.random.pick(SEGMENTS)));
+        row.add_value(c.comment(c.out.strings, 5, 12));
+        c.out.rows.push_back(std::move(row));
+    });
+
+    generate_chunked(parts, threads, seed, PART, tm.get_table("part"), tm.get_table("partsupp"),
+                     [suppliers](ChunkContext& c, int64_t key) {
+        std::string name;
+        for (int i = 0; i < 5; ++i) {
+            if (i > 0) name += ' ';
+            name += c.random.pick(COLORS);
+        }
+        int64_t manufacturer = c.random.uniform(1, 5);
+        Row row;
+        row.add_value(key);
+        row.add_value(c.text(c.out.strings, name));
+        row.add_value(c.text(c.out.strings, "Manufacturer#" + std::to_string(manufacturer)));
+        row.add_value(c.text(c.out.strings, "Brand#" + std::to_string(manufacturer) +
+                                            std::to_string(c.random.uniform(1, 5))));
+        row.add_value(c.text(c.out.strings, std::string(c.random.pick(TYPE_SIZES)) + " " +
+                                            c.random.pick(TYPE_FINISHES) + " " + c.random.pick(TYPE_METALS)));
+        row.add_value(c.random.uniform(1, 50));
+        row.add_value(c.text(c.out.strings, std::string(c.random.pick(CONTAINER_SIZES)) + " " +
+                                            c.random.pick(CONTAINER_KINDS)));
+        row.add_value(retail_price(key));
+        row.add_value(c.comment(c.out.strings, 2, 5));
+        c.out.rows.push_back(std::move(row));
+
+        for (int64_t i = 0; i < 4; ++i) {
+            Row supply;
+            supply.add_value(key);
+            supply.add_value(part_supplier(key, i, suppliers));
+            supply.add_value(c.random.uniform(1, 9999));
+            supply.add_value(c.money(100, 100000));
+            supply.add_value(c.comment(c.out.child_strings, 5, 12));
+            c.out.child_rows.push_back(std::move(supply));
+        }
+    });
+
+    generate_chunked(orders, threads, seed, ORDERS, tm.get_table("orders"), tm.get_table("lineitem"),
+                     [=](ChunkContext& c, int64_t key) {
+        int64_t customer;
+        do {
+            // As in the spec, every third customer never orders.
+            customer = c.random.uniform(1, customers);
+        } while (customer % 3 == 0);
+        int32_t order_date = static_cast<int32_t>(c.random.uniform(start_date, last_order_date));
+
+        double total = 0.0;
+        size_t shipped = 0;
+        int64_t lines = c.random.uniform(1, 7);
+        for (int64_t line = 1; line <= lines; ++line) {
+            int64_t part = c.random.uniform(1, parts);
+            int64_t supplier = part_supplier(part, c.random.uniform(0, 3), suppliers);
+            int64_t quantity = c.random.uniform(1, 50);
+            double price = round_cents(quantity * retail_price(part));
+            double discount = c.random.uniform(0, 10) / 100.0;
+            double tax = c.random.uniform(0, 8) / 100.0;
+            int32_t ship_date = order_date + static_cast<int32_t>(c.random.uniform(1, 121));
+            int32_t commit_date = order_date + static_cast<int32_t>(c.random.uniform(30, 90));
+            int32_t receipt_date = ship_date + static_cast<int32_t>(c.random.uniform(1, 30));
+            const char* return_flag = receipt_date <= current_date ? (c.random.uniform(0, 1) ? "R" : "A") : "N";
+            bool open = ship_date > current_date;
+            shipped += open ? 0 : 1;
+            total += price * (1.0 + tax) * (1.0 - discount);
+
+            Row item;
+            item.add_value(key);
+            item.add_value(part);
+            item.add_value(supplier);
+            item.add_value(line);
+            item.add_value(static_cast<double>(quantity));
+            item.add_value(price);
+            item.add_value(discount);
+            item.add_value(tax);
+            item.add_value(c.text(c.out.child_strings, return_flag));
+            item.add_value(c.text(c.out.child_strings, open ? "O" : "F"));
+            item.add_value(Value::date(ship_date));
+            item.add_value(Value::date(commit_date));
+            item.add_value(Value::date(receipt_date));
+            item.add_value(c.text(c.out.child_strings, c.random.pick(INSTRUCTIONS)));
+            item.add_value(c.text(c.out.child_strings, c.random.pick(SHIP_MODES)));
+            item.add_value(c.comment(c.out.child_strings, 2, 6));
+            c.out.child_rows.push_back(std::move(item));
+        }
+
+        const char* status = shipped == static_cast<size_t>(lines) ? "F" : shipped == 0 ? "O" : "P";
+        Row row;
+        row.add_value(key);
+        row.add_value(customer);
+        row.add_value(c.text(c.out.strings, status));
+        row.add_value(round_cents(total));
+        row.add_value(Value::date(order_date));
+        row.add_value(c.text(c.out.strings, c.random.pick(PRIORITIES)));
+        row.add_value(c.text(c.out.strings, numbered("Clerk", c.random.uniform(1, std::max<int64_t>(1, orders / 1500)))));
+        row.add_value(0);
+        row.add_value(c.comment(c.out.strings, 3, 10));
+        c.out.rows.push_back(std::move(row));
+    });
+}
+
+void TpchGenerator::register_statistics(TableManager& tm, QueryOptimizer& optimizer) {
+    for (const auto& name : table_names()) {
+        Table* table = tm.get_table(name);
+        if (!table) {
+            continue;
+        }
+        size_t rows = table->row_count();
+        size_t width = table->get_schema().column_count() * sizeof(Value) +
+                       (rows > 0 ? table->string_bytes() / rows : 0);
+        optimizer.set_table_statistics(name, TableStatistics(rows, std::max<size_t>(1, rows * width / 4096), width));
+    }
+}
+
+const std::vector<TpchQuery>& TpchGenerator::queries() {
+    static const std::vector<TpchQuery> catalog = {
+        {1, "aggregation over the scan dropped",
+         "SELECT l_returnflag, l_linestatus, l_quantity, l_extendedprice, l_discount, l_tax FROM lineitem "
+         "WHERE l_shipdate <= '1998-09-02'",
+         {59311, 0x41be74b87ce6b5d3ULL}},
+        {2, "p_type LIKE and the minimum-cost subquery dropped",
+         "SELECT s_acctbal, s_name, n_name, p_partkey, p_mfgr, ps_supplycost FROM part "
+         "JOIN partsupp ON p_partkey = ps_partkey JOIN supplier ON ps_suppkey = s_suppkey "
+         "JOIN nation ON s_nationkey = n_nationkey JOIN region ON n_regionkey = r_regionkey "
+         "WHERE p_size = 15 AND r_name = 'EUROPE'",
+         {42, 0x41e1f0fd794fc37dULL}},
+        {3, "revenue aggregation and ordering dropped",
+         "SELECT l_orderkey, l_extendedprice, l_discount, o_orderdate, o_shippriority FROM customer "
+         "JOIN orders ON c_custkey = o_custkey JOIN lineitem ON o_orderkey = l_orderkey "
+         "WHERE c_mktsegment = 'BUILDING' AND o_orderdate < '1995-03-15' AND l_shipdate > '1995-03-15'",
+         {358, 0xd896656fae50ed20ULL}},
+        {4, "EXISTS becomes a join (one row per late line), count dropped",
+         "SELECT o_orderkey, o_orderpriority FROM orders JOIN lineitem ON o_orderkey = l_orderkey "
+         "WHERE o_orderdate >= '1993-07-01' AND o_orderdate < '1993-10-01' AND l_commitdate < l_receiptdate",
+         {1528, 0x83723d289c949917ULL}},
+        {5, "revenue aggregation dropped",
+         "SELECT n_name, l_extendedprice, l_discount FROM customer JOIN orders ON c_custkey = o_custkey "
+         "JOIN lineitem ON o_orderkey = l_orderkey JOIN supplier ON l_suppkey = s_suppkey "
+         "JOIN nation ON s_nationkey = n_nationkey JOIN region ON n_regionkey = r_regionkey "
+         "WHERE c_nationkey = s_nationkey AND r_name = 'ASIA' "
+         "AND o_orderdate >= '1994-01-01' AND o_orderdate < '1995-01-01'",
+         {62, 0x8c204938e0f3d093ULL}},
+        {6, "sum dropped",
+         "SELECT l_extendedprice, l_discount FROM lineitem "
+         "WHERE l_shipdate >= '1994-01-01' AND l_shipdate < '1995-01-01' "
+         "AND l_discount >= 0.05 AND l_discount <= 0.07 AND l_quantity < 24",
+         {1093, 0x0d6b001855108156ULL}},
+        {7, "second nation alias replaced by customer nation keys (FRANCE=6, GERMANY=7), aggregation dropped",
+         "SELECT n_name, c_nationkey, l_shipdate, l_extendedprice, l_discount FROM supplier "
+         "JOIN lineitem ON s_suppkey = l_suppkey JOIN orders ON l_orderkey = o_orderkey "
+         "JOIN customer ON o_custkey = c_custkey JOIN nation ON s_nationkey = n_nationkey "
+         "WHERE ((n_name = 'FRANCE' AND c_nationkey = 7) OR (n_name = 'GERMANY' AND c_nationkey = 6)) "
+         "AND l_shipdate >= '1995-01-01' AND l_shipdate <= '1996-12-31'",
+         {44, 0xad0ddab9dcecd3cbULL}},
+        {8, "supplier nation alias dropped (s_nationkey returned), market share aggregation dropped",
+         "SELECT o_orderdate, l_extendedprice, l_discount, s_nationkey FROM part "
+         "JOIN lineitem ON p_partkey = l_partkey JOIN supplier ON l_suppkey = s_suppkey "
+         "JOIN orders ON l_orderkey = o_orderkey JOIN customer ON o_custkey = c_custkey "
+         "JOIN nation ON c_nationkey = n_nationkey JOIN region ON n_regionkey = r_regionkey "
+         "WHERE r_name = 'AMERICA' AND o_orderdate >= '1995-01-01' AND o_orderdate <= '1996-12-31' "
+         "AND p_type = 'ECONOMY ANODIZED STEEL'",
+         {39, 0xe51228fc22baf30cULL}},
+        {9, "p_name LIKE replaced by a brand filter, profit aggregation dropped",
+         "SELECT n_name, o_orderdate, l_extendedprice, l_discount, ps_supplycost, l_quantity FROM part "
+         "JOIN lineitem ON p_partkey = l_partkey JOIN partsupp ON l_partkey = ps_partkey "
+         "JOIN supplier ON l_suppkey = s_suppkey JOIN orders ON l_orderkey = o_orderkey "
+         "JOIN nation ON s_nationkey = n_nationkey "
+         "WHERE ps_suppkey = l_suppkey AND p_brand = 'Brand#23'",
+         {2213, 0xf20b5a8637da10e4ULL}},
+        {10, "revenue aggregation and top-20 dropped",
+         "SELECT c_custkey, c_name, c_acctbal, n_name, l_extendedprice, l_discount FROM customer "
+         "JOIN orders ON c_custkey = o_custkey JOIN lineitem ON o_orderkey = l_orderkey "
+         "JOIN nation ON c_nationkey = n_nationkey "
+         "WHERE o_orderdate >= '1993-10-01' AND o_orderdate < '1994-01-01' AND l_returnflag = 'R'",
+         {1100, 0x226bda951f086d49ULL}},
+        {11, "value aggregation and HAVING subquery dropped",
+         "SELECT ps_partkey, ps_supplycost, ps_availqty FROM partsupp "
+         "JOIN supplier ON ps_suppkey = s_suppkey JOIN nation ON s_nationkey = n_nationkey "
+         "WHERE n_name = 'GERMANY'",
+         {320, 0xf50067c8d8e6cc7fULL}},
+        {12, "IN list written as OR, priority counts dropped",
+         "SELECT l_shipmode, o_orderpriority FROM orders JOIN lineitem ON o_orderkey = l_orderkey "
+         "WHERE (l_shipmode = 'MAIL' OR l_shipmode = 'SHIP') AND l_commitdate < l_receiptdate "
+         "AND l_shipdate < l_commitdate AND l_receiptdate >= '1994-01-01' AND l_receiptdate < '1995-01-01'",
+         {294, 0x4b0c097091104a4cULL}},
+        {13, "outer join becomes inner, NOT LIKE on o_comment becomes a priority filter, counts dropped",
+         "SELECT c_custkey, o_orderkey FROM customer JOIN orders ON c_custkey = o_custkey "
+         "WHERE o_orderpriority <> '1-URGENT'",
+         {12046, 0x27cb5b9315527246ULL}},
+        {14, "promo revenue ratio dropped (p_type returned instead)",
+         "SELECT p_type, l_extendedprice, l_discount FROM lineitem JOIN part ON l_partkey = p_partkey "
+         "WHERE l_shipdate >= '1995-09-01' AND l_shipdate < '1995-10-01'",
+         {738, 0x98ebdcdeecff05b2ULL}},
+        {15, "revenue view and max subquery dropped",
+         "SELECT s_suppkey, s_name, s_phone, l_extendedprice, l_discount FROM lineitem "
+         "JOIN supplier ON l_suppkey = s_suppkey "
+         "WHERE l_shipdate >= '1996-01-01' AND l_shipdate < '1996-04-01'",
+         {2332, 0x6d8765b1bcb1dad6ULL}},
+        {16, "IN list written as OR, NOT LIKE and complaint subquery dropped, distinct count dropped",
+         "SELECT p_brand, p_type, p_size, ps_suppkey FROM partsupp JOIN part ON ps_partkey = p_partkey "
+         "WHERE p_brand <> 'Brand#45' AND (p_size = 49 OR p_size = 14 OR p_size = 23 OR p_size = 45 "
+         "OR p_size = 19 OR p_size = 3 OR p_size = 36 OR p_size = 9)",
+         {1340, 0x0b973998d549cc0eULL}},
+        {17, "average-quantity subquery dropped",
+         "SELECT l_quantity, l_extendedprice FROM lineitem JOIN part ON l_partkey = p_partkey "
+         "WHERE p_brand = 'Brand#23' AND p_container = 'MED BOX'",
+         {31, 0x8bfc9c20aafe4edeULL}},
+        {18, "large-order HAVING subquery approximated by a total price threshold",
+         "SELECT c_name, c_custkey, o_orderkey, o_orderdate, o_totalprice, l_quantity FROM customer "
+         "JOIN orders ON c_custkey = o_custkey JOIN lineitem ON o_orderkey = l_orderkey "
+         "WHERE o_totalprice > 400000",
+         {69, 0xdcfa267bf07fc466ULL}},
+        {19, "IN lists written as OR, revenue sum dropped",
+         "SELECT l_extendedprice, l_discount FROM lineitem JOIN part ON l_partkey = p_partkey "
+         "WHERE (l_shipmode = 'AIR' OR l_shipmode = 'REG AIR') AND l_shipinstruct = 'DELIVER IN PERSON' "
+         "AND ((p_brand = 'Brand#12' AND p_size <= 5 AND l_quantity >= 1 AND l_quantity <= 11) "
+         "OR (p_brand = 'Brand#23' AND p_size <= 10 AND l_quantity >= 10 AND l_quantity <= 20) "
+         "OR (p_brand = 'Brand#34' AND p_size <= 15 AND l_quantity >= 20 AND l_quantity <= 30))",
+         {20, 0x05719f35152d5fe0ULL}},
+        {20, "nested IN subqueries flattened into joins, p_name LIKE replaced by a size filter",
+         "SELECT s_name, s_address, ps_partkey, ps_availqty FROM supplier "
+         "JOIN nation ON s_nationkey = n_nationkey JOIN partsupp ON s_suppkey = ps_suppkey "
+         "JOIN part ON ps_partkey = p_partkey "
+         "WHERE n_name = 'CANADA' AND p_size >= 45 AND ps_availqty > 5000",
+         {13, 0x87b5dfe56bce99e9ULL}},
+        {21, "EXISTS / NOT EXISTS on other suppliers' lines dropped, count dropped",
+         "SELECT s_name, l_orderkey FROM supplier JOIN lineitem ON s_suppkey = l_suppkey "
+         "JOIN orders ON l_orderkey = o_orderkey JOIN nation ON s_nationkey = n_nationkey "
+         "WHERE o_orderstatus = 'F' AND l_receiptdate > l_commitdate AND n_name = 'SAUDI ARABIA'",
+         {699, 0xc8d0ee64ce82b5b8ULL}},
+        {22, "phone prefixes written as nation keys, average-balance and NOT EXISTS subqueries dropped",
+         "SELECT c_custkey, c_phone, c_acctbal FROM customer WHERE c_acctbal > 0.00 "
+         "AND (c_nationkey = 3 OR c_nationkey = 21 OR c_nationkey = 13 OR c_nationkey = 19 "
+         "OR c_nationkey = 20 OR c_nationkey = 8 OR c_nationkey = 7)",
+         {393, 0x3a50d62d799eaf61ULL}},
+    };
+    return catalog;
+}
@@ -0,0 +1,182 @@
+#include "trace.h"
+#include "string_util.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+std::atomic<bool> Tracer::recording{false};
+
+namespace {
+
+struct ThreadBuffer {
+    uint32_t id = 0;
+    std::string name;
+    std::vector<TraceEvent> events;
+};
+
+// Buffers outlive their threads so that worker spans survive until the
+// trace is written.
+std::mutex registry_mutex;
+std::vector<std::unique_ptr<ThreadBuffer>> registry;
+thread_local ThreadBuffer* local_buffer = nullptr;
+
+const auto trace_epoch = std::chrono::steady_clock::now();
+
+ThreadBuffer& thread_buffer() {
+    if (!local_buffer) {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        registry.push_back(std::make_unique<ThreadBuffer>());
+        local_buffer = registry.back().get();
+        local_buffer->id = static_cast<uint32_t>(registry.size());
+        local_buffer->name = "thread " + std::to_string(local_buffer->id);
+    }
+    return *local_buffer;
+}
+
+void append_arg(std::string& args, const char* key, const std::string& json_value) {
+    if (!args.empty()) args += ",";
+    args += "\"";
+    args += key;
+    args += "\":";
+    args += json_value;
+}
+
+}  // namespace
+
+void Tracer::start() {
+    clear();
+    recording.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::stop() {
+    recording.store(false, std::memory_order_relaxed);
+}
+
+void Tracer::clear() {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    for (auto& buffer : registry) {
+        buffer->events.clear();
+    }
+}
+
+void Tracer::set_thread_name(const std::string& name) {
+    thread_buffer().name = name;
+}
+
+double Tracer::now_us() {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - trace_epoch).count();
+}
+
+void Tracer::record(TraceEvent event) {
+    ThreadBuffer& buffer = thread_buffer();
+    event.thread_id = buffer.id;
+    buffer.events.push_back(std::move(event));
+}
+
+void Tracer::instant(const char* category, const std::string& name) {
+    if (!enabled()) {
+        return;
+    }
+    TraceEvent event;
+    event.name = name;
+    event.category = category;
+    event.phase = 'i';
+    event.timestamp_us = now_us();
+    record(std::move(event));
+}
+
+std::vector<TraceEvent> Tracer::events() {
+    std::vector<TraceEvent> all;
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        for (const auto& buffer : registry) {
+            all.insert(all.end(), buffer->events.begin(), buffer->events.end());
+        }
+    }
+    // Enclosing spans first, so viewers nest equal start times correctly.
+    std::stable_sort(all.begin(), all.end(), [](const TraceEvent& a, const TraceEvent& b) {
+        if (a.timestamp_us != b.timestamp_us) return a.timestamp_us < b.timestamp_us;
+        return a.duration_us > b.duration_us;
+    });
+    return all;
+}
+
+std::string Tracer::to_json() {
+    std::vector<TraceEvent> all = events();
+    std::vector<std::pair<uint32_t, std::string>> threads;
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        for (const auto& buffer : registry) {
+            threads.emplace_back(buffer->id, buffer->name);
+        }
+    }
+
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"query optimizer\"}}";
+    for (const auto& [id, name] : threads) {
+        out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << id
+            << ",\"args\":{\"name\":\"" << json_escape(name) << "\"}}";
+    }
+    for (const auto& event : all) {
+        out << ",\n{\"name\":\"" << json_escape(event.name) << "\",\"cat\":\"" << json_escape(event.category)
+            << "\",\"ph\":\"" << event.phase << "\",\"ts\":" << event.timestamp_us;
+        if (event.phase == 'X') {
+            out << ",\"dur\":" << event.duration_us;
+        } else {
+            out << ",\"s\":\"t\"";
+        }
+        out << ",\"pid\":1,\"tid\":" << event.thread_id;
+        if (!event.args.empty()) {
+            out << ",\"args\":{" << event.args << "}";
+        }
+        out << "}";
+    }
+    out << "\n]}\n";
+    return out.str();
+}
+
+void Tracer::write_json(const std::string& filename) {
+    std::ofstream file(filename);
+    if (!file) {
+        throw std::runtime_error("Cannot write trace file: " + filename);
+    }
+    file << to_json();
+    if (!file) {
+        throw std::runtime_error("Failed writing trace file: " + filename);
+    }
+}
+
+TraceSpan::~TraceSpan() {
+    if (active) {
+        event.duration_us = Tracer::now_us() - event.timestamp_us;
+        Tracer::record(std::move(event));
+    }
+}
+
+void TraceSpan::set_name(const std::string& name) {
+    if (active) {
+        event.name = name;
+    }
+}
+
+void TraceSpan::add_arg(const char* key, double value) {
+    if (active) {
+        std::ostringstream text;
+        text << value;
+        append_arg(event.args, key, text.str());
+    }
+}
+
+void TraceSpan::add_arg(const char* key, const std::string& value) {
+    if (active) {
+        append_arg(event.args, key, "\"" + json_escape(value) + "\"");
+    }
+}
@@ -0,0 +1,356 @@
+#include "wire_protocol.h"
+#include <algorithm>
+#include <cstring>
+
+static constexpr uint8_t MIXED_COLUMN = 0xFF;
+
+void WireWriter::put_u32(uint32_t value) {
+    char bytes[4];
+    for (int i = 0; i < 4; ++i) {
+        bytes[i] = static_cast<char>(value >> (8 * i));
+    }
+    out.append(bytes, 4);
+}
+
+void WireWriter::put_u64(uint64_t value) {
+    char bytes[8];
+    for (int i = 0; i < 8; ++i) {
+        bytes[i] = static_cast<char>(value >> (8 * i));
+    }
+    out.append(bytes, 8);
+}
+
+void WireWriter::put_f64(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    put_u64(bits);
+}
+
+void WireWriter::put_string(std::string_view value) {
+    put_u32(static_cast<uint32_t>(value.size()));
+    out.append(value.data(), value.size());
+}
+
+void WireReader::need(size_t bytes) const {
+    if (data.size() - pos < bytes) {
+        throw ProtocolError("Truncated message");
+    }
+}
+
+uint8_t WireReader::get_u8() {
+    need(1);
+    return static_cast<uint8_t>(data[pos++]);
+}
+
+uint32_t WireReader::get_u32() {
+    need(4);
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value |= static_cast<uint32_t>(static_cast<uint8_t>(data[pos + i])) << (8 * i);
+    }
+    pos += 4;
+    return value;
+}
+
+uint64_t WireReader::get_u64() {
+    need(8);
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value |= static_cast<uint64_t>(static_cast<uint8_t>(data[pos + i])) << (8 * i);
+    }
+    pos += 8;
+    return value;
+}
+
+double WireReader::get_f64() {
+    uint64_t bits = get_u64();
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+std::string_view WireReader::get_string() {
+    return get_bytes(get_u32());
+}
+
+std::string_view WireReader::get_bytes(size_t size) {
+    need(size);
+    std::string_view bytes = data.substr(pos, size);
+    pos += size;
+    return bytes;
+}
+
+size_t begin_frame(std::string& out, MessageType type) {
+    size_t offset = out.size();
+    WireWriter writer(out);
+    writer.put_u32(0);
+    writer.put_u8(static_cast<uint8_t>(type));
+    return offset;
+}
+
+void end_frame(std::string& out, size_t offset) {
+    size_t payload = out.size() - offset - FRAME_HEADER_BYTES;
+    if (payload > MAX_FRAME_BYTES) {
+        out.resize(offset);
+        throw ProtocolError("Frame of " + std::to_string(payload) + " bytes exceeds the limit");
+    }
+    uint32_t length = static_cast<uint32_t>(payload);
+    for (int i = 0; i < 4; ++i) {
+        out[offset + i] = static_cast<char>(length >> (8 * i));
+    }
+}
+
+bool next_frame(const char* data, size_t size, MessageType& type, std::string_view& payload, size_t& frame_bytes) {
+    if (size < FRAME_HEADER_BYTES) {
+        return false;
+    }
+    WireReader header(std::string_view(data, FRAME_HEADER_BYTES));
+    uint32_t length = header.get_u32();
+    uint8_t tag = header.get_u8();
+    if (length > MAX_FRAME_BYTES) {
+        throw ProtocolError("Frame of " + std::to_string(length) + " bytes exceeds the limit");
+    }
+    if (tag < static_cast<uint8_t>(MessageType::QUERY) || tag > static_cast<uint8_t>(MessageType::ERROR)) {
+        throw ProtocolError("Unknown message type " + std::to_string(tag));
+    }
+    if (size < FRAME_HEADER_BYTES + length) {
+        return false;
+    }
+    type = static_cast<MessageType>(tag);
+    payload = std::string_view(data + FRAME_HEADER_BYTES, length);
+    frame_bytes = FRAME_HEADER_BYTES + length;
+    return true;
+}
+
+void encode_query(std::string& out, std::string_view sql) {
+    size_t frame = begin_frame(out, MessageType::QUERY);
+    WireWriter(out).put_bytes(sql.data(), sql.size());
+    end_frame(out, frame);
+}
+
+void encode_schema(std::string& out, const TableSchema& schema) {
+    size_t frame = begin_frame(out, MessageType::SCHEMA);
+    WireWriter writer(out);
+    writer.put_u32(static_cast<uint32_t>(schema.column_count()));
+    for (size_t i = 0; i < schema.column_count(); ++i) {
+        writer.put_string(schema.column_names[i]);
+        writer.put_string(i < schema.column_types.size() ? schema.column_types[i] : "");
+    }
+    end_frame(out, frame);
+}
+
+void encode_error(std::string& out, std::string_view message) {
+    size_t frame = begin_frame(out, MessageType::ERROR);
+    WireWriter(out).put_bytes(message.data(), message.size());
+    end_frame(out, frame);
+}
+
+void encode_complete(std::string& out, const QueryComplete& complete) {
+    size_t frame = begin_frame(out, MessageType::COMPLETE);
+    WireWriter writer(out);
+    writer.put_u64(complete.rows);
+    writer.put_f64(complete.parse_ms);
+    writer.put_f64(complete.optimize_ms);
+    writer.put_f64(complete.execute_ms);
+    writer.put_f64(complete.queue_ms);
+    writer.put_u8(complete.plan_cached ? 1 : 0);
+    end_frame(out, frame);
+}
+
+static void put_value(WireWriter& writer, const Value& value) {
+    switch (value.type()) {
+        case ValueType::NULL_VALUE: break;
+        case ValueType::INT: writer.put_u64(static_cast<uint64_t>(value.as_int())); break;
+        case ValueType::DOUBLE: writer.put_f64(value.as_double()); break;
+        case ValueType::BOOL: writer.put_u8(value.as_bool() ? 1 : 0); break;
+        case ValueType::DATE: writer.put_u32(static_cast<uint32_t>(value.as_date())); break;
+        case ValueType::STRING: writer.put_string(value.as_string()); break;
+    }
+}
+
+static Value get_value(WireReader& reader, ValueType type, StringHeap& strings) {
+    switch (type) {
+        case ValueType::NULL_VALUE: return Value::null();
+        case ValueType::INT: return Value(static_cast<int64_t>(reader.get_u64()));
+        case ValueType::DOUBLE: return Value(reader.get_f64());
+        case ValueType::BOOL: return Value(reader.get_u8() != 0);
+        case ValueType::DATE: return Value::date(static_cast<int32_t>(reader.get_u32()));
+        case ValueType::STRING: return Value::string_ref(strings.store(reader.get_string()));
+    }
+    throw ProtocolError("Unknown value type");
+}
+
+static ValueType get_type(WireReader& reader) {
+    uint8_t tag = reader.get_u8();
+    if (tag > static_cast<uint8_t>(ValueType::STRING)) {
+        throw ProtocolError("Unknown value type " + std::to_string(tag));
+    }
+    return static_cast<ValueType>(tag);
+}
+
+// At least the bytes encode_batch spends on value: its payload plus one
+// byte, which covers both a mixed column's type tag and a null-bitmap bit.
+static size_t encoded_value_bytes(const Value& value) {
+    switch (value.type()) {
+        case ValueType::NULL_VALUE: return 1;
+        case ValueType::INT: return 9;
+        case ValueType::DOUBLE: return 9;
+        case ValueType::BOOL: return 2;
+        case ValueType::DATE: return 5;
+        case ValueType::STRING: return 5 + value.as_string().size();
+    }
+    return 1;
+}
+
+size_t batch_end(const std::vector<Row>& rows, size_t begin, size_t max_rows, size_t columns, size_t max_bytes) {
+    size_t limit = std::min(rows.size(), begin + max_rows);
+    size_t bytes = 8 + columns;
+    size_t end = begin;
+    while (end < limit) {
+        size_t row_bytes = 0;
+        for (size_t c = 0; c < columns; ++c) {
+            row_bytes += encoded_value_bytes(rows[end].get(c));
+        }
+        if (end > begin && bytes + row_bytes > max_bytes) {
+            break;
+        }
+        bytes += row_bytes;
+        ++end;
+    }
+    return end;
+}
+
+void encode_batch(std::string& out, const std::vector<Row>& rows, size_t begin, size_t end, size_t columns) {
+    size_t frame = begin_frame(out, MessageType::BATCH);
+    WireWriter writer(out);
+    size_t count = end - begin;
+    writer.put_u32(static_cast<uint32_t>(count));
+    writer.put_u32(static_cast<uint32_t>(columns));
+
+    std::string nulls;
+    for (size_t c = 0; c < columns; ++c) {
+        ValueType type = ValueType::NULL_VALUE;
+        bool mixed = false;
+        for (size_t r = begin; r < end && !mixed; ++r) {
+            const Value& value = rows[r].get(c);
+            if (value.is_null()) {
+                continue;
+            }
+            if (type == ValueType::NULL_VALUE) {
+                type = value.type();
+            } else {
+                mixed = value.type() != type;
+            }
+        }
+
+        if (mixed) {
+            writer.put_u8(MIXED_COLUMN);
+            for (size_t r = begin; r < end; ++r) {
+                const Value& value = rows[r].get(c);
+                writer.put_u8(static_cast<uint8_t>(value.type()));
+                put_value(writer, value);
+            }
+            continue;
+        }
+
+        writer.put_u8(static_cast<uint8_t>(type));
+        if (type == ValueType::NULL_VALUE) {
+            continue;
+        }
+        nulls.assign((count + 7) / 8, '\0');
+        for (size_t r = begin; r < end; ++r) {
+            if (rows[r].get(c).is_null()) {
+                nulls[(r - begin) / 8] |= static_cast<char>(1 << ((r - begin) % 8));
+            }
+        }
+        writer.put_bytes(nulls.data(), nulls.size());
+        for (size_t r = begin; r < end; ++r) {
+            put_value(writer, rows[r].get(c));
+        }
+    }
+    end_frame(out, frame);
+}
+
+std::string decode_query(std::string_view payload) {
+    return std::string(payload);
+}
+
+TableSchema decode_schema(std::string_view payload) {
+    WireReader reader(payload);
+    TableSchema schema;
+    uint32_t columns = reader.get_u32();
+    for (uint32_t i = 0; i < columns; ++i) {
+        std::string name(reader.get_string());
+        std::string type(reader.get_string());
+        schema.add_column(name, type);
+    }
+    return schema;
+}
+
+std::string decode_error(std::string_view payload) {
+    return std::string(payload);
+}
+
+QueryComplete decode_complete(std::string_view payload) {
+    WireReader reader(payload);
+    QueryComplete complete;
+    complete.rows = reader.get_u64();
+    complete.parse_ms = reader.get_f64();
+    complete.optimize_ms = reader.get_f64();
+    complete.execute_ms = reader.get_f64();
+    complete.queue_ms = reader.get_f64();
+    complete.plan_cached = reader.get_u8() != 0;
+    return complete;
+}
+
+void decode_batch(std::string_view payload, ColumnBatch& batch) {
+    WireReader reader(payload);
+    batch.rows = reader.get_u32();
+    uint32_t columns = reader.get_u32();
+    if (batch.rows > MAX_BATCH_ROWS) {
+        throw ProtocolError("Batch of " + std::to_string(batch.rows) + " rows exceeds the limit");
+    }
+    batch.columns.assign(columns, std::vector<Value>());
+    batch.strings.clear();
+
+    for (auto& column : batch.columns) {
+        column.reserve(batch.rows);
+        uint8_t tag = reader.get_u8();
+        if (tag == MIXED_COLUMN) {
+            for (size_t r = 0; r < batch.rows; ++r) {
+                ValueType type = get_type(reader);
+                column.push_back(get_value(reader, type, batch.strings));
+            }
+            continue;
+        }
+        if (tag > static_cast<uint8_t>(ValueType::STRING)) {
+            throw ProtocolError("Unknown value type " + std::to_string(tag));
+        }
+        auto type = static_cast<ValueType>(tag);
+        if (type == ValueType::NULL_VALUE) {
+            column.assign(batch.rows, Value::null());
+            continue;
+        }
+        std::string_view nulls = reader.get_bytes((batch.rows + 7) / 8);
+        for (size_t r = 0; r < batch.rows; ++r) {
+            bool is_null = (static_cast<uint8_t>(nulls[r / 8]) >> (r % 8)) & 1;
+            column.push_back(is_null ? Value::null() : get_value(reader, type, batch.strings));
+        }
+    }
+    if (!reader.at_end()) {
+        throw ProtocolError("Trailing bytes after batch");
+    }
+}
+
+void ColumnBatch::append_rows(std::vector<Row>& out, StringHeap& heap) const {
+    for (size_t r = 0; r < rows; ++r) {
+        Row row;
+        row.values.reserve(columns.size());
+        for (const auto& column : columns) {
+            const Value& value = column[r];
+            row.add_value(value.type() == ValueType::STRING ? Value::string_ref(heap.store(value.as_string()))
+                                                             : value);
+        }
+        out.push_back(std::move(row));
+    }
+}
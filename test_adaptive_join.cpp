@@ -0,0 +1,66 @@
+#include <iostream>
+#include <chrono>
+#include "benchmark.h"
+#include "executor.h"
+
+static std::unique_ptr<PlanNode> make_join(PlanNodeType algorithm, std::unique_ptr<PlanNode> build,
+                                           size_t estimated_build_rows) {
+    std::unique_ptr<PlanNode> join;
+    if (algorithm == PlanNodeType::HASH_JOIN) {
+        join = std::make_unique<HashJoinNode>(JoinType::INNER, "users.id = orders.user_id");
+    } else {
+        join = std::make_unique<AdaptiveJoinNode>(JoinType::INNER, "users.id = orders.user_id");
+    }
+    build->stats.row_count = estimated_build_rows;
+    join->children.push_back(std::move(build));
+    join->children.push_back(std::make_unique<TableScanNode>("orders"));
+    return join;
+}
+
+static std::unique_ptr<PlanNode> users_where(const std::string& condition) {
+    auto filter = std::make_unique<FilterNode>(condition);
+    filter->children.push_back(std::make_unique<TableScanNode>("users"));
+    return filter;
+}
+
+static void run_case(Executor& executor, const std::string& label, const std::string& condition,
+                     size_t estimated_build_rows) {
+    auto adaptive = make_join(PlanNodeType::ADAPTIVE_JOIN, users_where(condition), estimated_build_rows);
+    auto hash = make_join(PlanNodeType::HASH_JOIN, users_where(condition), estimated_build_rows);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    auto adaptive_result = executor.execute(*adaptive);
+    auto middle = std::chrono::high_resolution_clock::now();
+    auto decisions = executor.get_last_join_decisions();
+    size_t adaptive_peak = executor.get_last_memory_usage().peak_bytes;
+    auto hash_result = executor.execute(*hash);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    std::cout << "\n" << label << " (" << condition << ")" << std::endl;
+    for (const auto& decision : decisions) {
+        std::cout << "  " << decision.to_string() << std::endl;
+    }
+    std::cout << "  Adaptive: " << adaptive_result->size() << " rows, "
+              << std::chrono::duration<double, std::milli>(middle - start).count() << "ms, peak "
+              << adaptive_peak << " bytes" << std::endl;
+    std::cout << "  HashJoin: " << hash_result->size() << " rows, "
+              << std::chrono::duration<double, std::milli>(end - middle).count() << "ms, peak "
+              << executor.get_last_memory_usage().peak_bytes << " bytes" << std::endl;
+    std::cout << "  Results match: " << (adaptive_result->size() == hash_result->size() ? "yes" : "NO") << std::endl;
+}
+
+int main() {
+    std::cout << "Adaptive Join Test" << std::endl;
+
+    TableManager tm;
+    DataGenerator::generate_large_dataset(tm, 50000, 200000);
+    Executor executor(&tm);
+
+    run_case(executor, "Tiny build, estimated large", "id < 20", 40000);
+    run_case(executor, "Medium build", "age > 30", 1000);
+
+    executor.set_join_memory_budget(512 * 1024);
+    run_case(executor, "Build over a 512KB budget", "age > 30", 1000);
+
+    return 0;
+}
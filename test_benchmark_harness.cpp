@@ -0,0 +1,55 @@
+#include <iostream>
+#include "benchmark.h"
+
+static bool same_rows(Table* a, Table* b) {
+    if (a->row_count() != b->row_count()) return false;
+    for (size_t i = 0; i < a->row_count(); ++i) {
+        const auto& x = a->get_rows()[i].values;
+        const auto& y = b->get_rows()[i].values;
+        for (size_t c = 0; c < x.size(); ++c) {
+            if (x[c].to_string() != y[c].to_string()) return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    std::cout << "=== Benchmark Harness Test ===" << std::endl;
+
+    // Known samples: 1..100ms
+    std::vector<double> samples;
+    for (int i = 100; i >= 1; --i) samples.push_back(i);
+    TimingStats stats = TimingStats::from_samples(samples);
+    std::cout << "\n1..100: " << stats.to_string() << std::endl;
+    std::cout << "Expected min=1 median=50.5 p95=95 p99=99 mean=50.5" << std::endl;
+
+    TimingStats single = TimingStats::from_samples({3.0});
+    std::cout << "Single sample: " << single.to_string() << std::endl;
+
+    // Same seed, same tables; different seed, different tables
+    TableManager first, second, third;
+    DataGenerator::generate_skewed_dataset(first, 1000, 5000);
+    DataGenerator::generate_skewed_dataset(second, 1000, 5000);
+    DataGenerator::set_seed(7);
+    DataGenerator::generate_skewed_dataset(third, 1000, 5000);
+    DataGenerator::set_seed(DataGenerator::DEFAULT_SEED);
+    std::cout << "\nSame seed reproduces tables: "
+              << (same_rows(first.get_table("users"), second.get_table("users")) &&
+                  same_rows(first.get_table("orders"), second.get_table("orders")) ? "yes" : "no") << std::endl;
+    std::cout << "Different seed changes tables: "
+              << (same_rows(first.get_table("orders"), third.get_table("orders")) ? "no" : "yes") << std::endl;
+
+    BenchmarkOptions options;
+    options.warmup_runs = 1;
+    options.repetitions = 15;
+    options.pin_cpu = 0;
+    std::cout << "\nPinning to CPU 0: " << (pin_current_thread(0) ? "ok" : "unsupported") << std::endl;
+
+    QueryBenchmark benchmark(&first, options);
+    benchmark.run_join_benchmarks();
+    for (const auto& result : benchmark.get_results()) {
+        std::cout << result.plan_type << ": " << result.timing.to_string() << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include <iostream>
+#include <cstdio>
+#include "benchmark_report.h"
+
+static TimingStats timings(double base, double spread, size_t n) {
+    std::vector<double> samples;
+    for (size_t i = 0; i < n; ++i) {
+        samples.push_back(base + spread * ((i * 7) % n) / n);
+    }
+    return TimingStats::from_samples(samples);
+}
+
+int main() {
+    std::cout << "=== Benchmark Report Test ===" << std::endl;
+
+    TableManager tm;
+    DataGenerator::generate_large_dataset(tm, 1000, 5000);
+
+    BenchmarkOptions options;
+    options.repetitions = 5;
+    QueryBenchmark benchmark(&tm, options);
+    benchmark.set_dataset_parameter("users", "1000");
+    benchmark.set_dataset_parameter("orders", "5000");
+    benchmark.run_join_benchmarks();
+
+    const std::string path = "benchmark_report_test.json";
+    benchmark.export_json(path);
+    BenchmarkReport loaded = BenchmarkReport::load(path);
+    std::remove(path.c_str());
+
+    std::cout << "\nMetadata:" << std::endl;
+    std::cout << "  git revision: " << loaded.metadata.git_revision << std::endl;
+    std::cout << "  compiler: " << loaded.metadata.compiler << std::endl;
+    std::cout << "  cpu: " << loaded.metadata.cpu_model << std::endl;
+    std::cout << "  timestamp: " << loaded.metadata.timestamp << std::endl;
+    for (const auto& [key, value] : loaded.metadata.parameters) {
+        std::cout << "  " << key << " = " << value << std::endl;
+    }
+    std::cout << "Entries round-tripped: " << loaded.entries.size() << " of "
+              << benchmark.get_results().size() << std::endl;
+    std::cout << "JSON stable across round trip: "
+              << (BenchmarkReport::from_json(loaded.to_json()).to_json() == loaded.to_json() ? "yes" : "no") << std::endl;
+
+    // Synthetic baselines: identical, 30% slower, 2% slower, 30% faster
+    BenchmarkReport baseline;
+    BenchmarkReport current;
+    const char* names[] = {"same", "slower", "noise", "faster"};
+    double factors[] = {1.0, 1.3, 1.02, 0.7};
+    for (int i = 0; i < 4; ++i) {
+        BenchmarkEntry before;
+        before.query_name = names[i];
+        before.plan_type = "Optimized";
+        before.timing = timings(10.0, 1.0, 20);
+        baseline.entries.push_back(before);
+
+        BenchmarkEntry after = before;
+        after.timing = timings(10.0 * factors[i], 1.0, 20);
+        current.entries.push_back(after);
+    }
+    BenchmarkEntry added;
+    added.query_name = "added";
+    added.plan_type = "Optimized";
+    added.timing = timings(5.0, 1.0, 20);
+    current.entries.push_back(added);
+
+    std::cout << "\nComparison (expect: same unchanged, slower regression, noise below threshold,"
+              << " faster improvement, added new):" << std::endl;
+    for (const auto& c : compare_reports(baseline, current)) {
+        std::cout << "  " << c.key << ": change=" << c.change * 100.0 << "% t=" << c.t_statistic
+                  << (c.missing ? " new/removed" : "")
+                  << (c.regression ? " REGRESSION" : "")
+                  << (c.improvement ? " improved" : "")
+                  << (c.significant && !c.regression && !c.improvement ? " significant" : "") << std::endl;
+    }
+
+    try {
+        BenchmarkReport::from_json("{\"format\": \"something-else\"}");
+        std::cout << "Foreign file accepted (unexpected)" << std::endl;
+    } catch (const std::exception& e) {
+        std::cout << "Foreign file rejected: " << e.what() << std::endl;
+    }
+
+    return 0;
+}
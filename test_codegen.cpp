@@ -0,0 +1,76 @@
+#include <iostream>
+#include <chrono>
+#include <filesystem>
+#include "benchmark.h"
+#include "codegen.h"
+
+static double run(Executor& executor, const PlanNode& plan, size_t& rows) {
+    auto start = std::chrono::high_resolution_clock::now();
+    auto result = executor.execute(plan);
+    auto end = std::chrono::high_resolution_clock::now();
+    rows = result->size();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main() {
+    std::cout << "Pipeline Code Generation Test" << std::endl;
+
+    TableManager tm;
+    DataGenerator::generate_large_dataset(tm, 500000, 10);
+
+    auto scan = std::make_unique<TableScanNode>("users");
+    auto filter = std::make_unique<FilterNode>("age > 30 AND age < 50 AND city = 'City7'");
+    filter->children.push_back(std::move(scan));
+    auto project = std::make_unique<ProjectNode>(std::vector<std::string>{"name", "age"});
+    project->children.push_back(std::move(filter));
+
+    std::cout << "\nPlan:\n" << project->to_string() << std::endl;
+
+    CodegenOptions options;
+    options.min_input_rows = 1000;
+    PipelineCompiler compiler(options);
+
+    Executor interpreter(&tm);
+    Executor compiled(&tm);
+    compiled.set_pipeline_compiler(&compiler);
+
+    size_t interpreted_rows = 0, compiled_rows = 0, cached_rows = 0;
+    double interpreted_ms = run(interpreter, *project, interpreted_rows);
+    double first_ms = run(compiled, *project, compiled_rows);
+    double cached_ms = run(compiled, *project, cached_rows);
+
+    std::cout << "\nInterpreted:        " << interpreted_rows << " rows, " << interpreted_ms << "ms" << std::endl;
+    std::cout << "Compiled (1st run): " << compiled_rows << " rows, " << first_ms << "ms" << std::endl;
+    std::cout << "Compiled (cached):  " << cached_rows << " rows, " << cached_ms << "ms" << std::endl;
+    std::cout << "Compilations: " << compiler.get_compilations()
+              << ", cache hits: " << compiler.get_cache_hits()
+              << ", failures: " << compiler.get_failures() << std::endl;
+    std::cout << "Results match: " << (interpreted_rows == compiled_rows && compiled_rows == cached_rows ? "yes" : "NO")
+              << std::endl;
+
+    // Different flags produce a different build id, so the libraries built
+    // above are not reused.
+    CodegenOptions rebuilt_options = options;
+    rebuilt_options.compile_flags += " -DQO_CODEGEN_TEST_REBUILD";
+    PipelineCompiler rebuilt(rebuilt_options);
+    Executor rebuilt_executor(&tm);
+    rebuilt_executor.set_pipeline_compiler(&rebuilt);
+    size_t rebuilt_rows = 0;
+    run(rebuilt_executor, *project, rebuilt_rows);
+    std::cout << "Changed flags: build id " << (rebuilt.get_build_id() != compiler.get_build_id() ? "differs" : "SAME")
+              << ", compilations: " << rebuilt.get_compilations() << ", cache hits: " << rebuilt.get_cache_hits()
+              << std::endl;
+
+    // A cache directory other users can write to is never loaded from.
+    CodegenOptions shared_options = options;
+    shared_options.cache_dir = "/tmp/qo_codegen_shared_test";
+    std::filesystem::create_directories(shared_options.cache_dir);
+    std::filesystem::permissions(shared_options.cache_dir, std::filesystem::perms::all);
+    PipelineCompiler shared_compiler(shared_options);
+    auto source = compiler.generate_source(nullptr, tm.get_table("users")->get_schema(), nullptr);
+    std::cout << "World-writable cache dir refused: " << (shared_compiler.compile(source) == nullptr ? "yes" : "NO")
+              << std::endl;
+    std::filesystem::remove_all(shared_options.cache_dir);
+
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include <iostream>
+#include <cmath>
+#include <cstdio>
+#include "cost_calibration.h"
+#include "optimizer.h"
+#include "executor.h"
+#include "benchmark.h"
+
+int main() {
+    std::cout << "=== Cost Calibration Test ===" << std::endl;
+
+    auto exact = fit_least_squares({{1, 0}, {0, 1}, {1, 1}, {2, 1}}, {2, 3, 5, 7});
+    std::cout << "Least squares for y = 2a + 3b: " << exact[0] << ", " << exact[1] << std::endl;
+
+    std::cout << "\nActive constants (" << CostConstants::active().source << "):\n"
+              << CostConstants::active().to_string();
+
+    CalibrationOptions options;
+    options.sizes = {10000, 20000, 40000};
+    CostCalibrator calibrator(options);
+    CostConstants calibrated = calibrator.calibrate();
+    std::cout << std::endl;
+    calibrator.print_report();
+
+    const std::string path = "/tmp/qo_test_cost_profile.conf";
+    calibrated.save(path);
+    CostConstants loaded = CostConstants::load(path);
+    std::cout << "\nProfile round trip: "
+              << (loaded.hash_probe_cost == calibrated.hash_probe_cost ? "ok" : "MISMATCH") << std::endl;
+
+    std::FILE* bad = std::fopen(path.c_str(), "w");
+    std::fputs("hash_build_cost = fast\n", bad);
+    std::fclose(bad);
+    try {
+        CostConstants::load(path);
+        std::cout << "Malformed profile accepted" << std::endl;
+    } catch (const std::runtime_error& e) {
+        std::cout << "Malformed profile: " << e.what() << std::endl;
+    }
+    std::remove(path.c_str());
+
+    // With calibrated constants the estimate is an expected runtime.
+    TableManager tm;
+    DataGenerator::generate_uniform_dataset(tm, 1000, 5000);
+    Executor executor(&tm);
+    SelectStatement stmt;
+    stmt.from_table = TableReference("users");
+    stmt.joins.emplace_back(JoinClause::INNER, TableReference("orders"),
+                            std::make_unique<BinaryOpExpression>(
+                                std::make_unique<ColumnExpression>("users", "id"),
+                                std::make_unique<ColumnExpression>("orders", "user_id"),
+                                BinaryOperator::EQUALS));
+    stmt.select_list.emplace_back(std::make_unique<ColumnExpression>("", "*"));
+
+    // CostModel and PlanNode::estimate_cost agree on hash joins in both
+    // input orders: each builds on the left.
+    {
+        QueryOptimizer optimizer;
+        CostModel model;
+        for (const auto& candidate : optimizer.generate_all_plans(stmt)) {
+            PlanNode* join = candidate.plan.get();
+            while (join->type != PlanNodeType::HASH_JOIN && !join->children.empty()) {
+                join = join->children[0].get();
+            }
+            if (join->type != PlanNodeType::HASH_JOIN || join->children[0]->type != PlanNodeType::TABLE_SCAN) {
+                continue;
+            }
+            double node_cost = join->estimate_cost().total_cost;
+            double model_cost = model.estimate_plan_cost(*join).total_cost;
+            std::cout << "\nHash join building on "
+                      << static_cast<const TableScanNode&>(*join->children[0]).table_name
+                      << ": node cost " << node_cost << ", cost model " << model_cost << ", same: "
+                      << (std::abs(node_cost - model_cost) < 1e-9 * std::max(1.0, node_cost) ? "yes" : "NO")
+                      << std::endl;
+        }
+    }
+
+    for (bool use_profile : {false, true}) {
+        CostConstants::set_active(use_profile ? calibrated : CostConstants());
+        QueryOptimizer optimizer;
+        auto candidates = optimizer.generate_all_plans(stmt);
+        std::cout << "\n" << (use_profile ? "Calibrated" : "Default") << " constants:" << std::endl;
+        for (const auto& candidate : candidates) {
+            auto start = std::chrono::steady_clock::now();
+            executor.execute(*candidate.plan);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            std::cout << "  " << candidate.plan->to_string().substr(0, candidate.plan->to_string().find('\n'))
+                      << " | estimated " << candidate.cost.total_cost << " | actual " << ms << "ms" << std::endl;
+        }
+    }
+    return 0;
+}
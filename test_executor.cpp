@@ -43,6 +43,16 @@ int main() {
     std::cout << "\nNested Loop Join (first 3 rows):" << std::endl;
     auto join_result = executor.execute(*nested_join);
     join_result->print(3);
+    std::cout << "Peak query memory: " << executor.get_last_memory_usage().peak_bytes << " bytes" << std::endl;
+    
+    std::cout << "\nTesting Memory Limit (1 MB):" << std::endl;
+    executor.set_memory_limit(1024 * 1024);
+    try {
+        executor.execute(*nested_join);
+        std::cout << "Unexpected: query finished under the limit" << std::endl;
+    } catch (const MemoryLimitExceeded& e) {
+        std::cout << "Aborted cleanly: " << e.what() << std::endl;
+    }
     
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,42 @@
+#include <iostream>
+#include "benchmark.h"
+#include "parser.h"
+#include "optimizer.h"
+
+int main() {
+    std::cout << "EXPLAIN ANALYZE Test" << std::endl;
+
+    TableManager tm;
+    DataGenerator::generate_large_dataset(tm, 20000, 100000);
+
+    QueryOptimizer optimizer;
+    Executor executor(&tm);
+
+    std::string sql = "SELECT users.name, orders.amount FROM users "
+                      "JOIN orders ON users.id = orders.user_id WHERE users.age > 60";
+    std::cout << "Query: " << sql << std::endl;
+
+    Tokenizer tokenizer(sql);
+    Parser parser(tokenizer.tokenize());
+    auto stmt = parser.parseSelectStatement();
+    auto plan = optimizer.optimize(*stmt);
+
+    OptimizerStats join_stats = optimizer.get_stats();
+    auto profile = executor.explain_analyze(*plan);
+    profile.set_optimizer_stats(join_stats);
+    std::cout << "\n" << profile.to_text();
+
+    std::string single = "SELECT name, city FROM users WHERE age > 30 AND city = 'City4'";
+    Tokenizer single_tokenizer(single);
+    Parser single_parser(single_tokenizer.tokenize());
+    auto single_plan = optimizer.optimize(*single_parser.parseSelectStatement());
+    OptimizerStats single_stats = optimizer.get_stats();
+
+    std::cout << "\nQuery: " << single << std::endl;
+    auto single_profile = executor.explain_analyze(*single_plan);
+    single_profile.set_optimizer_stats(single_stats);
+    std::cout << single_profile.to_text();
+    std::cout << "\nJSON:\n" << single_profile.to_json();
+
+    return 0;
+}
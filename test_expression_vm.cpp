@@ -0,0 +1,81 @@
+#include <iostream>
+#include <chrono>
+#include "benchmark.h"
+#include "expression_binder.h"
+#include "expression_vm.h"
+
+int main() {
+    std::cout << "Expression VM Test" << std::endl;
+
+    TableManager tm;
+    DataGenerator::generate_large_dataset(tm, 200000, 10);
+    auto users = tm.get_table("users");
+    const auto& rows = users->get_rows();
+
+    std::string condition =
+        "(age > 30 AND city = 'City3') OR (age > 30 AND city = 'City5') OR "
+        "(age < 20 AND 1 = 1) OR (id = 7 AND 2 > 3)";
+    std::cout << "Condition: " << condition << std::endl;
+
+    auto expr = BoundPredicate::parse_condition(condition);
+    BoundPredicate predicate(*expr, users->get_schema());
+    auto program = ExpressionProgram::compile(predicate.get_root());
+
+    std::cout << "\nBytecode (" << program.instruction_count() << " instructions, "
+              << program.get_folded_constants() << " folded, "
+              << program.get_shared_subexpressions() << " shared):" << std::endl;
+    std::cout << program.disassemble();
+
+    ExpressionVM vm;
+    std::vector<uint32_t> selection;
+    size_t vm_matches = 0, tree_matches = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t offset = 0; offset < rows.size(); offset += 1024) {
+        size_t count = std::min<size_t>(1024, rows.size() - offset);
+        selection.clear();
+        vm.run(program, rows.data() + offset, nullptr, count, selection);
+        vm_matches += selection.size();
+    }
+    auto middle = std::chrono::high_resolution_clock::now();
+    for (const auto& row : rows) {
+        if (predicate.evaluate(row)) tree_matches++;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    std::cout << "\nVM:        " << vm_matches << " rows, "
+              << std::chrono::duration<double, std::milli>(middle - start).count() << "ms" << std::endl;
+    std::cout << "Tree walk: " << tree_matches << " rows, "
+              << std::chrono::duration<double, std::milli>(end - middle).count() << "ms" << std::endl;
+    std::cout << "Results match: " << (vm_matches == tree_matches ? "yes" : "NO") << std::endl;
+
+    // Constants that print alike must still compile to distinct comparisons.
+    TableSchema price_schema;
+    price_schema.add_column("price", "double");
+    price_schema.add_column("label", "string");
+    Table prices("prices");
+    prices.set_schema(price_schema);
+    for (double price : {1.001, 1.002, 1.003}) {
+        Row row;
+        row.add_value(price);
+        row.add_value(prices.make_string("a,b)"));
+        prices.add_row(row);
+    }
+    for (const std::string& near_condition :
+         {std::string("price = 1.001 OR price = 1.002"), std::string("label = 'a,b)' OR label = 'a'")}) {
+        auto near_expr = BoundPredicate::parse_condition(near_condition);
+        BoundPredicate near_predicate(*near_expr, price_schema);
+        auto near_program = ExpressionProgram::compile(near_predicate.get_root());
+        selection.clear();
+        vm.run(near_program, prices.get_rows().data(), nullptr, prices.row_count(), selection);
+        size_t near_tree = 0;
+        for (const auto& row : prices.get_rows()) {
+            if (near_predicate.evaluate(row)) near_tree++;
+        }
+        std::cout << "\n" << near_condition << ":\n" << near_program.disassemble()
+                  << "VM " << selection.size() << " rows, tree walk " << near_tree << " rows, match: "
+                  << (selection.size() == near_tree ? "yes" : "NO") << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include <iostream>
+#include <algorithm>
+#include "benchmark.h"
+#include "parser.h"
+#include "optimizer.h"
+#include "feedback_cache.h"
+
+static double q_error(size_t estimated, size_t actual) {
+    double e = static_cast<double>(std::max<size_t>(estimated, 1));
+    double a = static_cast<double>(std::max<size_t>(actual, 1));
+    return std::max(e / a, a / e);
+}
+
+static void run_repeatedly(const std::string& sql, QueryOptimizer& optimizer, Executor& executor) {
+    Tokenizer tokenizer(sql);
+    Parser parser(tokenizer.tokenize());
+    auto stmt = parser.parseSelectStatement();
+
+    std::cout << "\n" << sql << std::endl;
+    for (int run = 1; run <= 3; ++run) {
+        auto plan = optimizer.optimize(*stmt);
+        auto result = executor.execute(*plan);
+        std::cout << "  Run " << run << ": estimated " << plan->stats.row_count
+                  << ", actual " << result->size()
+                  << ", q-error " << q_error(plan->stats.row_count, result->size()) << std::endl;
+    }
+}
+
+int main() {
+    std::cout << "Cardinality Feedback Test" << std::endl;
+
+    TableManager tm;
+    DataGenerator::generate_large_dataset(tm, 20000, 100000);
+
+    FeedbackCache feedback;
+    QueryOptimizer optimizer;
+    optimizer.set_table_statistics("users", TableStatistics(20000, 200, 120));
+    optimizer.set_table_statistics("orders", TableStatistics(100000, 1000, 80));
+    optimizer.set_feedback_cache(&feedback);
+
+    Executor executor(&tm);
+    executor.set_feedback_cache(&feedback);
+
+    run_repeatedly("SELECT name FROM users WHERE age > 30", optimizer, executor);
+    run_repeatedly("SELECT name FROM users WHERE city = 'City7' AND age < 40", optimizer, executor);
+    run_repeatedly("SELECT users.name, orders.amount FROM users JOIN orders ON users.id = orders.user_id",
+                   optimizer, executor);
+
+    std::cout << "\nFeedback cache (" << feedback.size() << " entries):" << std::endl;
+    std::cout << feedback.describe();
+
+    // Every distinct literal is a new signature; the cache stays bounded.
+    feedback.clear();
+    feedback.set_capacity(2);
+    for (int age : {20, 30, 40}) {
+        Tokenizer tokenizer("SELECT name FROM users WHERE age > " + std::to_string(age));
+        Parser parser(tokenizer.tokenize());
+        executor.execute(*optimizer.optimize(*parser.parseSelectStatement()));
+    }
+    std::cout << "\nWith capacity 2 after three literals (" << feedback.size() << " entries):" << std::endl;
+    std::cout << feedback.describe();
+
+    return 0;
+}
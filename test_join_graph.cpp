@@ -0,0 +1,34 @@
+#include <iostream>
+#include "join_graph_benchmark.h"
+
+int main() {
+    std::cout << "=== Join Graph Benchmark Test ===" << std::endl;
+
+    std::cout << "\nEdges of a 5-relation snowflake:";
+    for (const auto& [a, b] : JoinGraphBenchmark::edges(JoinGraphShape::SNOWFLAKE, 5)) {
+        std::cout << " " << a << "-" << b;
+    }
+    std::cout << std::endl;
+
+    SelectStatement cycle = JoinGraphBenchmark::build_query(JoinGraphShape::CYCLE, 4);
+    std::cout << "4-cycle: " << cycle.joins.size() << " joins, "
+              << (cycle.where_clause ? "closing edge in WHERE" : "no WHERE") << std::endl;
+
+    TableManager tm;
+    JoinGraphOptions options;
+    options.rows_per_table = 500;
+    options.timing.warmup_runs = 1;
+    options.timing.repetitions = 3;
+    JoinGraphBenchmark benchmark(&tm, options);
+
+    for (auto shape : {JoinGraphShape::CHAIN, JoinGraphShape::STAR, JoinGraphShape::SNOWFLAKE,
+                       JoinGraphShape::CYCLE, JoinGraphShape::CLIQUE}) {
+        for (size_t n : {2, 3, 4, 6, 8, 12, 16, 20}) {
+            benchmark.run(shape, n);
+        }
+    }
+    benchmark.print_results();
+
+    std::cout << "\nReport entries: " << benchmark.report().entries.size() << std::endl;
+    return 0;
+}
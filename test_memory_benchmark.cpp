@@ -0,0 +1,27 @@
+#include <iostream>
+#include "benchmark.h"
+#include "memory_benchmark.h"
+
+int main() {
+    std::cout << "=== Memory Benchmark ===" << std::endl;
+    std::cout << "Allocation counter installed: " << (AllocationCounter::installed() ? "yes" : "no") << std::endl;
+    std::cout << "Current RSS: " << current_rss_bytes() / 1024 << " KB" << std::endl;
+
+    MemoryBenchmark layouts(50000);
+    layouts.run();
+    layouts.print_results();
+
+    std::cout << "\n=== Per-Query Memory ===" << std::endl;
+    TableManager tm;
+    DataGenerator::generate_large_dataset(tm, 1000, 5000);
+
+    QueryBenchmark benchmark(&tm);
+    benchmark.run_join_benchmarks();
+    benchmark.print_results();
+
+    for (const auto& result : benchmark.get_results()) {
+        std::cout << result.query_name << " [" << result.plan_type << "]: "
+                  << result.memory.to_string() << std::endl;
+    }
+    return 0;
+}
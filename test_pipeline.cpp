@@ -0,0 +1,82 @@
+#include <iostream>
+#include <chrono>
+#include "table.h"
+#include "executor.h"
+#include "optimizer.h"
+#include "parser.h"
+
+static double time_ms(Executor& executor, const PlanNode& plan, size_t& rows) {
+    auto start = std::chrono::high_resolution_clock::now();
+    auto result = executor.execute(plan);
+    auto end = std::chrono::high_resolution_clock::now();
+    rows = result->size();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main() {
+    std::cout << "Fused Pipeline Test" << std::endl;
+
+    TableManager tm;
+    tm.populate_sample_data();
+
+    QueryOptimizer optimizer;
+    Executor executor(&tm);
+
+    SelectStatement stmt;
+    stmt.from_table = TableReference("users");
+    stmt.select_list.push_back(SelectItem(std::make_unique<ColumnExpression>("", "name")));
+    stmt.select_list.push_back(SelectItem(std::make_unique<ColumnExpression>("", "age")));
+    stmt.where_clause = std::make_unique<BinaryOpExpression>(
+        std::make_unique<BinaryOpExpression>(
+            std::make_unique<ColumnExpression>("", "age"),
+            std::make_unique<LiteralExpression>("25"),
+            BinaryOperator::GREATER),
+        std::make_unique<BinaryOpExpression>(
+            std::make_unique<ColumnExpression>("", "city"),
+            std::make_unique<LiteralExpression>("City3"),
+            BinaryOperator::EQUALS),
+        BinaryOperator::AND);
+
+    auto plan = optimizer.optimize(stmt);
+    std::cout << "\nPlan:" << std::endl;
+    std::cout << plan->to_string() << std::endl;
+
+    size_t fused_rows = 0, unfused_rows = 0;
+    executor.set_pipeline_fusion(true);
+    double fused_ms = time_ms(executor, *plan, fused_rows);
+    size_t fused_peak = executor.get_last_memory_usage().peak_bytes;
+
+    executor.set_pipeline_fusion(false);
+    double unfused_ms = time_ms(executor, *plan, unfused_rows);
+    size_t unfused_peak = executor.get_last_memory_usage().peak_bytes;
+
+    std::cout << "\nFused:   " << fused_rows << " rows, " << fused_ms << "ms, peak "
+              << fused_peak << " bytes" << std::endl;
+    std::cout << "Unfused: " << unfused_rows << " rows, " << unfused_ms << "ms, peak "
+              << unfused_peak << " bytes" << std::endl;
+    std::cout << "Results match: " << (fused_rows == unfused_rows ? "yes" : "NO") << std::endl;
+
+    executor.set_pipeline_fusion(true);
+    auto result = executor.execute(*plan);
+    result->print(3);
+
+    // Qualified columns bind to their own relation in a joined schema.
+    auto count_rows = [&](const std::string& sql) {
+        Tokenizer tokenizer(sql);
+        Parser parser(tokenizer.tokenize());
+        auto join_plan = optimizer.optimize(*parser.parseSelectStatement());
+        return executor.execute(*join_plan)->size();
+    };
+    std::cout << "\norders.id < 10 over users JOIN orders: "
+              << count_rows("SELECT users.name, orders.id FROM users JOIN orders ON users.id = orders.user_id "
+                            "WHERE orders.id < 10")
+              << " rows (expected 9)" << std::endl;
+    try {
+        count_rows("SELECT name FROM users JOIN orders ON users.id = orders.user_id WHERE id < 10");
+        std::cout << "Unqualified id: NOT rejected" << std::endl;
+    } catch (const std::runtime_error& e) {
+        std::cout << "Unqualified id: " << e.what() << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,167 @@
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include "benchmark.h"
+#include "query_scheduler.h"
+#include "query_session.h"
+#include "query_stats.h"
+
+static const char* JOIN_SQL =
+    "SELECT users.name, orders.amount FROM users JOIN orders ON users.id = orders.user_id WHERE users.age > 25";
+
+static void configure(QuerySession& session, TableManager& tm) {
+    for (const std::string name : {"users", "orders"}) {
+        session.get_optimizer().set_table_statistics(name, measure_table_statistics(*tm.get_table(name)));
+    }
+}
+
+// Point lookups from two clients while four others run large joins for
+// duration_ms, and prints the lookups' latency.
+static void run_mixed(TableManager& tm, QueryScheduler* scheduler, double duration_ms) {
+    LatencyHistogram point_latency;
+    std::atomic<size_t> joins{0};
+    std::atomic<bool> done{false};
+    std::vector<std::thread> threads;
+
+    for (int c = 0; c < 4; ++c) {
+        threads.emplace_back([&]() {
+            QuerySession session(&tm);
+            configure(session, tm);
+            session.set_scheduler(scheduler);
+            while (!done.load()) {
+                session.run(JOIN_SQL);
+                ++joins;
+            }
+        });
+    }
+    for (int c = 0; c < 2; ++c) {
+        threads.emplace_back([&, c]() {
+            QuerySession session(&tm);
+            configure(session, tm);
+            session.set_scheduler(scheduler);
+            for (uint64_t i = 0; !done.load(); ++i) {
+                auto start = std::chrono::steady_clock::now();
+                session.run("SELECT name FROM users WHERE id = " + std::to_string((c * 997 + i * 31) % 5000 + 1));
+                point_latency.record(std::chrono::duration_cast<std::chrono::microseconds>(
+                                         std::chrono::steady_clock::now() - start).count());
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            }
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(duration_ms));
+    done = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::cout << "  " << point_latency.count() << " point lookups: p50 "
+              << point_latency.value_at_quantile(0.50) / 1000.0 << "ms, p99 "
+              << point_latency.value_at_quantile(0.99) / 1000.0 << "ms; " << joins.load() << " joins" << std::endl;
+}
+
+int main() {
+    std::cout << "=== Query Scheduler ===" << std::endl;
+
+    TableManager tm;
+    DataGenerator::generate_large_dataset(tm, 5000, 25000);
+
+    // One query at a time, as on a box with memory for a single large join.
+    SchedulerOptions options;
+    options.max_concurrent = 1;
+    options.max_heavy = 1;
+    QueryScheduler scheduler(options);
+
+    // Classification from the optimizer's estimates.
+    QuerySession session(&tm);
+    configure(session, tm);
+    std::cout << "\nClassification:" << std::endl;
+    for (const std::string sql : {"SELECT name FROM users WHERE id = 42",
+                                  "SELECT id, amount FROM orders WHERE amount > 900", JOIN_SQL}) {
+        QueryRun run = session.run(sql);
+        size_t memory = session.get_optimizer().estimate_memory(*run.plan);
+        std::cout << "  " << QueryScheduler::class_name(scheduler.classify(*run.plan, memory)) << ": "
+                  << run.plan->stats.row_count << " rows, cost " << run.plan->cost.total_cost << ", "
+                  << memory / 1024 << " KB estimated peak (" << run.result->size() << " actual rows)\n    " << sql
+                  << std::endl;
+    }
+
+    // Lookups still scan their table, so a large table disqualifies them.
+    SchedulerOptions small_scans;
+    small_scans.point_max_scanned_rows = 1000;
+    QueryRun lookup = session.run("SELECT name FROM users WHERE id = 42");
+    std::cout << "  id = 42 over a 5000-row scan with point_max_scanned_rows 1000: "
+              << QueryScheduler::class_name(QueryScheduler(small_scans).classify(
+                     *lookup.plan, session.get_optimizer().estimate_memory(*lookup.plan)))
+              << std::endl;
+
+    // Admission limits and timeouts, driven directly.
+    SchedulerOptions strict;
+    strict.max_concurrent = 1;
+    strict.memory_budget_bytes = 1024 * 1024;
+    strict.queue_timeout_ms = 50.0;
+    strict.max_point_concurrent = 1;
+    QueryScheduler limited(strict);
+    {
+        QueryScheduler::Ticket running = limited.admit(QueryClass::NORMAL, 1024);
+        QueryScheduler::Ticket point = limited.admit(QueryClass::POINT, 0);
+        std::cout << "\nPoint lookup admitted beside a running query after " << point.get_queue_ms() << "ms"
+                  << std::endl;
+        try {
+            limited.admit(QueryClass::NORMAL, 1024);
+        } catch (const AdmissionError& e) {
+            std::cout << "Expected failure: " << e.what() << std::endl;
+        }
+        try {
+            limited.admit(QueryClass::POINT, 0);
+        } catch (const AdmissionError& e) {
+            std::cout << "Point lane full: " << e.what() << std::endl;
+        }
+    }
+    {
+        // Larger than the whole budget: admitted, but only alone.
+        QueryScheduler::Ticket oversized = limited.admit(QueryClass::HEAVY, 4 * 1024 * 1024);
+        std::cout << "Oversized query admitted alone, " << limited.get_stats().reserved_bytes << " bytes reserved"
+                  << std::endl;
+    }
+    std::cout << limited.get_stats().to_string();
+
+    // Waiters are released in order as slots free up.
+    std::vector<std::thread> waiters;
+    std::vector<double> waited(3, 0.0);
+    {
+        QueryScheduler::Ticket holder = scheduler.admit(QueryClass::HEAVY, 0);
+        for (int i = 0; i < 3; ++i) {
+            waiters.emplace_back([&scheduler, &waited, i]() {
+                QueryScheduler::Ticket ticket = scheduler.admit(QueryClass::HEAVY, 0);
+                waited[i] = ticket.get_queue_ms();
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            });
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        std::cout << "\nWhile a heavy query runs: " << scheduler.get_stats().of(QueryClass::HEAVY).waiting
+                  << " heavy queries waiting" << std::endl;
+    }
+    for (auto& thread : waiters) {
+        thread.join();
+    }
+    std::cout << "Their queue times:";
+    for (double ms : waited) {
+        std::cout << " " << ms << "ms";
+    }
+    std::cout << std::endl;
+    scheduler.reset_stats();
+
+    // Point lookups against a stream of joins. Without the point lane the
+    // lookups are ordinary queries and wait for the join ahead of them.
+    SchedulerOptions no_lane = options;
+    no_lane.point_max_rows = 0;
+    QueryScheduler single_queue(no_lane);
+    std::cout << "\nMixed load without a scheduler:" << std::endl;
+    run_mixed(tm, nullptr, 1000.0);
+    std::cout << "Mixed load, one query at a time, no point lane:" << std::endl;
+    run_mixed(tm, &single_queue, 1000.0);
+    std::cout << single_queue.get_stats().to_string();
+    std::cout << "Mixed load, one query at a time, point lane:" << std::endl;
+    run_mixed(tm, &scheduler, 1000.0);
+    std::cout << scheduler.get_stats().to_string();
+    return 0;
+}
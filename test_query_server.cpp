@@ -0,0 +1,203 @@
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "benchmark.h"
+#include "query_client.h"
+#include "query_server.h"
+#include "query_session.h"
+#include "tpch.h"
+
+static const std::string SOCKET_PATH = "/tmp/qo_test_server.sock";
+
+int main() {
+    std::cout << "=== Query Server ===" << std::endl;
+
+    TableManager tm;
+    DataGenerator::generate_large_dataset(tm, 5000, 25000);
+    TableSchema notes_schema;
+    notes_schema.add_column("id", "int");
+    notes_schema.add_column("body", "string");
+    tm.create_table("notes", notes_schema);
+    Table* notes = tm.get_table("notes");
+    for (int i = 0; i < 64; ++i) {
+        Row row;
+        row.add_value(i);
+        row.add_value(notes->make_string(std::string(100 * 1024, static_cast<char>('a' + i % 26))));
+        notes->add_row(row);
+    }
+
+    QueryServerOptions options;
+    options.socket_path = SOCKET_PATH;
+    options.worker_threads = 4;
+    options.batch_rows = 1000;
+    QueryServer server(&tm, options);
+    server.start();
+
+    // Results over the socket match running the query in-process.
+    QuerySession local(&tm);
+    QueryClient client(SOCKET_PATH);
+    for (const std::string sql : {"SELECT name, city FROM users WHERE id = 42",
+                                  "SELECT id, amount FROM orders WHERE amount > 900",
+                                  "SELECT users.name, orders.amount FROM users JOIN orders ON users.id = orders.user_id"}) {
+        ClientResult remote = client.query(sql);
+        QueryRun expected = local.run(sql);
+        std::cout << "\n" << sql << "\n  " << remote.rows.size() << " rows in " << remote.batches << " batches, "
+                  << remote.schema.column_count() << " columns, execute " << remote.complete.execute_ms
+                  << "ms, queued " << remote.complete.queue_ms << "ms; "
+                  << (checksum_rows(remote.rows) == checksum_rows(expected.result->get_rows()) ? "matches" : "DIFFERS")
+                  << " in-process result" << std::endl;
+    }
+
+    // Wide rows are cut into batches by encoded size, not only row count.
+    ClientResult wide = client.query("SELECT id, body FROM notes");
+    std::cout << "\nSELECT id, body FROM notes\n  " << wide.rows.size() << " rows of 100 KB in " << wide.batches
+              << " batches (batch_rows " << options.batch_rows << ", batch_bytes " << options.batch_bytes << ")"
+              << std::endl;
+    std::string frame;
+    try {
+        size_t offset = begin_frame(frame, MessageType::ERROR);
+        frame.append(MAX_FRAME_BYTES + size_t(1), 'x');
+        end_frame(frame, offset);
+        std::cout << "Oversized frame accepted" << std::endl;
+    } catch (const ProtocolError& e) {
+        std::cout << "Oversized frame: " << e.what() << ", " << frame.size() << " bytes left" << std::endl;
+    }
+
+    // The plan cache evicts the least recently used plan.
+    QuerySession cached(&tm);
+    cached.set_plan_cache_capacity(2);
+    for (const char* sql : {"SELECT name FROM users WHERE id = 1", "SELECT name FROM users WHERE id = 2",
+                            "SELECT name FROM users WHERE id = 1", "SELECT name FROM users WHERE id = 3",
+                            "SELECT name FROM users WHERE id = 1", "SELECT name FROM users WHERE id = 2"}) {
+        cached.run(sql);
+    }
+    std::cout << "\nPlan cache of 2 after 1,2,1,3,1,2: " << cached.get_plan_cache_hits() << " hits (expected 2), "
+              << cached.get_plan_cache_misses() << " misses (expected 4)" << std::endl;
+
+    ClientResult empty = client.query("SELECT name FROM users WHERE age > 1000");
+    std::cout << "\nEmpty result: " << empty.rows.size() << " rows, columns:";
+    for (const auto& column : empty.schema.column_names) {
+        std::cout << " " << column;
+    }
+    std::cout << std::endl;
+
+    // Errors are per query; the connection stays usable.
+    try {
+        client.query("SELECT name FROM missing_table");
+    } catch (const QueryError& e) {
+        std::cout << "Expected failure: " << e.what() << std::endl;
+    }
+    std::cout << "After the error: " << client.query("SELECT name FROM users WHERE id = 7").rows.size() << " row"
+              << std::endl;
+
+    // Pipelined queries come back in order.
+    client.send_query("SELECT name FROM users WHERE id = 1");
+    client.send_query("SELECT name FROM users WHERE id = 2");
+    client.send_query("SELECT name FROM users WHERE id = 3");
+    std::cout << "Pipelined:";
+    for (int i = 0; i < 3; ++i) {
+        client.read_result([](const TableSchema&, const ColumnBatch& batch) {
+            std::cout << " " << batch.columns[0][0].as_string();
+        });
+    }
+    std::cout << std::endl;
+
+    // Many connections: a few hundred idle ones plus clients issuing queries.
+    std::vector<std::unique_ptr<QueryClient>> idle;
+    for (int i = 0; i < 200; ++i) {
+        idle.push_back(std::make_unique<QueryClient>(SOCKET_PATH));
+    }
+    const int clients = 16;
+    std::vector<std::thread> threads;
+    std::vector<size_t> rows_seen(clients, 0);
+    for (int c = 0; c < clients; ++c) {
+        threads.emplace_back([c, &rows_seen]() {
+            QueryClient worker(SOCKET_PATH);
+            for (int i = 0; i < 25; ++i) {
+                rows_seen[c] += worker.query("SELECT name, age FROM users WHERE age > " + std::to_string(30 + i % 5))
+                                    .rows.size();
+                rows_seen[c] += worker.query("SELECT * FROM users WHERE id = " + std::to_string(c * 25 + i + 1))
+                                    .rows.size();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    size_t total_rows = 0;
+    for (size_t rows : rows_seen) {
+        total_rows += rows;
+    }
+    std::cout << "\n" << clients << " concurrent clients and " << idle.size() << " idle connections: "
+              << total_rows << " rows" << std::endl;
+    idle.clear();
+
+    // A malformed frame gets an ERROR and the connection is closed.
+    int raw = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::copy(SOCKET_PATH.begin(), SOCKET_PATH.end(), addr.sun_path);
+    if (connect(raw, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) {
+        const char bad[] = {'\xff', '\xff', '\xff', '\x7f', '\x01'};
+        ssize_t sent = send(raw, bad, sizeof(bad), 0);
+        char reply[256];
+        ssize_t received = recv(raw, reply, sizeof(reply), 0);
+        MessageType type;
+        std::string_view payload;
+        size_t frame_bytes;
+        if (sent > 0 && received > 0 && next_frame(reply, received, type, payload, frame_bytes) &&
+            type == MessageType::ERROR) {
+            std::cout << "Malformed frame: " << decode_error(payload)
+                      << (recv(raw, reply, sizeof(reply), 0) == 0 ? ", connection closed" : "") << std::endl;
+        }
+    }
+    close(raw);
+
+    // A client that pipelines past the pending-query cap and then shuts
+    // down its write side still gets every result before the close.
+    raw = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (connect(raw, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) {
+        const int burst = 3 * static_cast<int>(options.max_pending_queries);
+        std::string frames;
+        for (int i = 0; i < burst; ++i) {
+            encode_query(frames, "SELECT name FROM users WHERE id = " + std::to_string(i + 1));
+        }
+        for (size_t offset = 0; offset < frames.size();) {
+            ssize_t sent = send(raw, frames.data() + offset, frames.size() - offset, 0);
+            if (sent <= 0) {
+                break;
+            }
+            offset += static_cast<size_t>(sent);
+        }
+        shutdown(raw, SHUT_WR);
+
+        std::string received;
+        char chunk[64 * 1024];
+        for (ssize_t got; (got = recv(raw, chunk, sizeof(chunk), 0)) > 0;) {
+            received.append(chunk, static_cast<size_t>(got));
+        }
+        int completed = 0;
+        MessageType type;
+        std::string_view payload;
+        size_t frame_bytes;
+        for (size_t offset = 0;
+             next_frame(received.data() + offset, received.size() - offset, type, payload, frame_bytes);
+             offset += frame_bytes) {
+            completed += type == MessageType::COMPLETE;
+        }
+        std::cout << "Half-closed after " << burst << " pipelined queries: " << completed << " completed"
+                  << std::endl;
+    }
+    close(raw);
+
+    QueryServerStats stats = server.get_stats();
+    std::cout << "\nServer: " << stats.connections_accepted << " connections accepted, "
+              << stats.connections_open << " open, " << stats.queries << " queries, " << stats.errors << " errors, "
+              << stats.plan_cache_hits << " plan cache hits, " << stats.batches_sent << " batches, "
+              << stats.bytes_sent << " bytes sent" << std::endl;
+    server.stop();
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include <iostream>
+#include <thread>
+#include "benchmark.h"
+#include "query_session.h"
+#include "query_stats.h"
+
+int main() {
+    std::cout << "=== Query Statistics Registry ===" << std::endl;
+
+    std::cout << "\nNormalization:" << std::endl;
+    for (const std::string sql : {"select name from users where age > 30",
+                                  "SELECT name  FROM users WHERE age > 55;",
+                                  "SELECT * FROM users WHERE city = 'City4'"}) {
+        std::string normalized = normalize_query(sql);
+        std::cout << "  " << sql << "\n    -> " << normalized << " [" << std::hex
+                  << query_fingerprint(normalized) << std::dec << "]" << std::endl;
+    }
+
+    LatencyHistogram histogram;
+    for (uint64_t us = 1; us <= 100000; ++us) {
+        histogram.record(us);
+    }
+    std::cout << "\nHistogram of 1..100000us: p50=" << histogram.value_at_quantile(0.5)
+              << "us p99=" << histogram.value_at_quantile(0.99)
+              << "us p100=" << histogram.value_at_quantile(1.0) << "us" << std::endl;
+
+    TableManager tm;
+    DataGenerator::generate_large_dataset(tm, 5000, 25000);
+    QueryStatsRegistry registry;
+
+    // Four clients, each with its own session, record into one registry.
+    const size_t clients = 4;
+    std::vector<std::thread> threads;
+    for (size_t c = 0; c < clients; ++c) {
+        threads.emplace_back([&tm, &registry, c]() {
+            QuerySession session(&tm);
+            session.set_query_stats(&registry);
+            for (int i = 0; i < 50; ++i) {
+                int age = 20 + static_cast<int>((c * 50 + i) % 40);
+                session.run("SELECT name, age FROM users WHERE age > " + std::to_string(age));
+                session.run("SELECT * FROM users WHERE city = 'City" + std::to_string(i % 10 + 1) + "'");
+                if (i % 10 == 0) {
+                    session.run("SELECT users.name, orders.amount FROM users JOIN orders ON users.id = orders.user_id");
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // A session whose statistics make a nested loop look cheapest changes
+    // the join query's plan.
+    QuerySession skewed(&tm);
+    skewed.set_query_stats(&registry);
+    skewed.get_optimizer().set_table_statistics("users", TableStatistics(1, 1, 120));
+    skewed.get_optimizer().set_table_statistics("orders", TableStatistics(1000, 10, 80));
+    QueryRun run = skewed.run("SELECT users.name, orders.amount FROM users JOIN orders ON users.id = orders.user_id");
+    std::cout << "\nPlan under skewed statistics:\n" << run.plan->to_string() << std::endl;
+
+    try {
+        skewed.run("SELECT name FROM missing_table");
+    } catch (const std::exception& e) {
+        std::cout << "\nExpected failure: " << e.what() << std::endl;
+    }
+
+    std::cout << "\n" << registry.dump();
+    std::cout << "\nJSON:\n" << registry.to_json();
+    return 0;
+}
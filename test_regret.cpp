@@ -0,0 +1,36 @@
+#include <iostream>
+#include "regret_benchmark.h"
+
+int main() {
+    std::cout << "=== Plan Regret Benchmark Test ===" << std::endl;
+
+    std::cout << "\nSpearman, identical order: " << spearman_correlation({1, 2, 3, 4}, {10, 20, 30, 40}) << std::endl;
+    std::cout << "Spearman, reversed order: " << spearman_correlation({1, 2, 3, 4}, {40, 30, 20, 10}) << std::endl;
+    std::cout << "Spearman, with ties: " << spearman_correlation({1, 2, 2, 3}, {5, 7, 7, 9}) << std::endl;
+
+    // The timeout must stop a cross product that would otherwise run for minutes.
+    TableManager tm;
+    DataGenerator::generate_uniform_dataset(tm, 20000, 20000);
+    Executor executor(&tm);
+    executor.set_timeout(50.0);
+    auto cross = std::make_unique<NestedLoopJoinNode>(JoinType::INNER, "users.city = orders.product");
+    cross->children.push_back(std::make_unique<TableScanNode>("users"));
+    cross->children.push_back(std::make_unique<TableScanNode>("orders"));
+    try {
+        executor.execute(*cross);
+        std::cout << "Cross product finished" << std::endl;
+    } catch (const QueryTimeout& e) {
+        std::cout << "Cross product: " << e.what() << std::endl;
+    }
+
+    RegretOptions options;
+    options.timeout_ms = 500.0;
+    options.timing.warmup_runs = 1;
+    options.timing.repetitions = 3;
+    RegretBenchmark benchmark(&tm, options);
+    benchmark.run_corpus();
+    benchmark.print_results();
+
+    std::cout << "\nReport entries: " << benchmark.report().entries.size() << std::endl;
+    return 0;
+}
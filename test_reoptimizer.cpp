@@ -0,0 +1,83 @@
+#include <iostream>
+#include <chrono>
+#include "benchmark.h"
+#include "parser.h"
+#include "reoptimizer.h"
+
+static void add_products(TableManager& tm) {
+    TableSchema schema;
+    schema.add_column("product_name", "string");
+    schema.add_column("category", "string");
+    schema.add_column("price", "int");
+    tm.create_table("products", schema);
+
+    auto products = tm.get_table("products");
+    for (int i = 1; i <= 200; ++i) {
+        Row row;
+        row.add_value(products->make_string("Product" + std::to_string(i)));
+        row.add_value(products->make_string("Category" + std::to_string(i % 10)));
+        row.add_value(5 + i);
+        products->add_row(row);
+    }
+}
+
+static void run(const std::string& label, TableManager& tm, QueryOptimizer& optimizer, const SelectStatement& stmt) {
+    Executor executor(&tm);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    auto plan = optimizer.optimize(stmt);
+    auto static_result = executor.execute(*plan);
+    auto middle = std::chrono::high_resolution_clock::now();
+
+    Reoptimizer reoptimizer(&tm, &optimizer, &executor);
+    auto result = reoptimizer.execute(stmt);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    std::cout << "\n" << label << std::endl;
+    for (const auto& event : reoptimizer.get_events()) {
+        std::cout << "  Materialized " << event.relation << ": estimated " << event.estimated_rows
+                  << " rows, actual " << event.actual_rows
+                  << (event.replanned ? " -> re-planned:" : " -> kept plan:") << std::endl;
+        std::cout << event.remaining_plan << std::endl;
+    }
+    std::cout << "  Static plan: " << static_result->size() << " rows, "
+              << std::chrono::duration<double, std::milli>(middle - start).count() << "ms" << std::endl;
+    std::cout << "  Reoptimized: " << result->size() << " rows, "
+              << std::chrono::duration<double, std::milli>(end - middle).count() << "ms" << std::endl;
+    std::cout << "  Results match: " << (result->size() == static_result->size() ? "yes" : "NO") << std::endl;
+    size_t leftover = 0;
+    for (const auto& event : reoptimizer.get_events()) {
+        leftover += (tm.get_table(event.relation) ? 1 : 0) + (optimizer.has_table_statistics(event.relation) ? 1 : 0);
+    }
+    std::cout << "  Temporary tables or statistics left: " << leftover << std::endl;
+    result->print(3);
+}
+
+int main() {
+    std::cout << "Mid-Query Re-optimization Test" << std::endl;
+
+    TableManager tm;
+    DataGenerator::generate_large_dataset(tm, 20000, 100000);
+    add_products(tm);
+
+    std::string sql = "SELECT users.name, orders.amount, products.category FROM users "
+                      "JOIN orders ON users.id = orders.user_id "
+                      "JOIN products ON orders.product = products.product_name "
+                      "WHERE users.age > 60";
+    std::cout << "Query: " << sql << std::endl;
+
+    Tokenizer tokenizer(sql);
+    Parser parser(tokenizer.tokenize());
+    auto stmt = parser.parseSelectStatement();
+
+    QueryOptimizer stale;
+    run("Default statistics (users=1000, orders=5000)", tm, stale, *stmt);
+
+    QueryOptimizer accurate;
+    accurate.set_table_statistics("users", TableStatistics(20000, 200, 120));
+    accurate.set_table_statistics("orders", TableStatistics(100000, 1000, 80));
+    accurate.set_table_statistics("products", TableStatistics(200, 2, 60));
+    run("Accurate statistics", tm, accurate, *stmt);
+
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include <fstream>
+#include <iostream>
+#include "benchmark.h"
+#include "query_session.h"
+#include "slow_query_log.h"
+
+static void print_file(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        return;
+    }
+    std::cout << "\n--- " << path << " ---" << std::endl;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::cout << (line.size() > 300 ? line.substr(0, 300) + "..." : line) << std::endl;
+    }
+}
+
+int main() {
+    std::cout << "=== Slow Query Log ===" << std::endl;
+
+    const std::string path = "/tmp/qo_slow_queries.log";
+    for (const std::string& file : {path, path + ".1", path + ".2"}) {
+        std::remove(file.c_str());
+    }
+
+    TableManager tm;
+    DataGenerator::generate_large_dataset(tm, 5000, 25000);
+
+    // Small files so that a few entries already rotate.
+    SlowQueryLogOptions options;
+    options.path = path;
+    options.threshold_ms = 0.0;
+    options.max_file_bytes = 2 * 1024;
+    options.max_files = 3;
+
+    SlowQueryLog log(options);
+    QuerySession session(&tm);
+    session.set_slow_query_log(&log);
+
+    session.run("SELECT name, age FROM users WHERE age > 30");
+    session.run("SELECT users.name, orders.amount FROM users JOIN orders ON users.id = orders.user_id");
+    try {
+        session.run("SELECT name FROM missing_table");
+    } catch (const std::exception& e) {
+        std::cout << "Expected failure: " << e.what() << std::endl;
+    }
+
+    // Only queries above the threshold are logged from here on.
+    log.set_threshold(5.0);
+    for (int i = 0; i < 20; ++i) {
+        QueryRun run = session.run("SELECT * FROM users WHERE city = 'City" + std::to_string(i % 10 + 1) + "'");
+        std::cout << "  query " << i << ": " << run.total_ms << "ms" << (log.is_slow(run.total_ms) ? " (slow)" : "")
+                  << std::endl;
+    }
+    session.run("SELECT users.name, orders.amount FROM users JOIN orders ON users.id = orders.user_id");
+
+    log.flush();
+    std::cout << "\nWritten: " << log.get_written() << ", dropped: " << log.get_dropped()
+              << ", write errors: " << log.get_write_errors() << std::endl;
+
+    print_file(path + ".2");
+    print_file(path + ".1");
+    print_file(path);
+    return 0;
+}
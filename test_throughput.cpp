@@ -0,0 +1,34 @@
+#include <iostream>
+#include <thread>
+#include "throughput_benchmark.h"
+
+int main() {
+    std::cout << "=== Throughput Benchmark Test ===" << std::endl;
+    std::cout << "Hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+
+    ThroughputOptions options;
+    options.users = 5000;
+    options.orders = 20000;
+    options.duration_ms = 300.0;
+
+    TableManager tm;
+    ThroughputBenchmark benchmark(&tm, options);
+    for (auto query : {WorkloadQuery::POINT_LOOKUP, WorkloadQuery::FILTERED_SCAN, WorkloadQuery::JOIN}) {
+        std::cout << "  " << ThroughputBenchmark::query_name(query) << ": " << benchmark.build_query(query, 7)
+                  << std::endl;
+    }
+    benchmark.run_all({1, 2, 4, 8});
+    benchmark.print_results();
+
+    // Same workload while a writer appends orders.
+    options.inserts_per_sec = 2000.0;
+    TableManager shared;
+    ThroughputBenchmark with_inserts(&shared, options);
+    with_inserts.run_all({1, 4});
+    with_inserts.print_results();
+    std::cout << "\nOrders after inserts: " << shared.get_table("orders")->row_count() << std::endl;
+
+    BenchmarkReport report = benchmark.report();
+    std::cout << "Report entries: " << report.entries.size() << std::endl;
+    return 0;
+}
@@ -0,0 +1,65 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include "tpch.h"
+#include "benchmark.h"
+#include "executor.h"
+#include "tokenizer.h"
+#include "parser.h"
+
+int main() {
+    std::cout << "=== TPC-H Generator Test ===" << std::endl;
+
+    const double sf = TpchGenerator::REFERENCE_SCALE_FACTOR;
+    TableManager tm;
+    auto start = std::chrono::steady_clock::now();
+    TpchGenerator(sf).generate(tm);
+    double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "\nGenerated SF " << sf << " in " << std::fixed << std::setprecision(1) << elapsed << "ms" << std::endl;
+
+    TableManager single;
+    TpchGenerator(sf, TpchGenerator::DEFAULT_SEED, 1).generate(single);
+
+    bool same = true;
+    for (const auto& name : TpchGenerator::table_names()) {
+        ResultChecksum parallel = checksum_rows(tm.get_table(name)->get_rows());
+        ResultChecksum serial = checksum_rows(single.get_table(name)->get_rows());
+        same = same && parallel == serial;
+        std::cout << "  " << std::left << std::setw(10) << name << parallel.to_string() << std::endl;
+    }
+    std::cout << "Single-threaded output identical: " << (same ? "yes" : "no") << std::endl;
+
+    QueryOptimizer optimizer;
+    TpchGenerator::register_statistics(tm, optimizer);
+    Executor executor(&tm);
+
+    std::cout << "\nQueries:" << std::endl;
+    size_t matched = 0;
+    for (const auto& query : TpchGenerator::queries()) {
+        Tokenizer tokenizer(query.sql);
+        Parser parser(tokenizer.tokenize());
+        auto stmt = parser.parseSelectStatement();
+        auto plan = optimizer.optimize(*stmt);
+
+        auto query_start = std::chrono::steady_clock::now();
+        auto result = executor.execute(*plan);
+        double query_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - query_start).count();
+
+        ResultChecksum checksum = checksum_rows(result->get_rows());
+        bool ok = checksum == query.reference;
+        matched += ok ? 1 : 0;
+        std::cout << "  Q" << std::setw(2) << query.number << "  " << std::right << std::setw(8)
+                  << std::setprecision(2) << query_ms << "ms  " << checksum.to_string()
+                  << (ok ? "  ok" : "  MISMATCH") << std::left << std::endl;
+    }
+    std::cout << "Reference checksums matched: " << matched << " of " << TpchGenerator::queries().size() << std::endl;
+
+    BenchmarkOptions options;
+    options.warmup_runs = 1;
+    options.repetitions = 3;
+    TableManager bench_tables;
+    QueryBenchmark benchmark(&bench_tables, options);
+    benchmark.run_tpch_benchmarks(sf);
+
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include <iostream>
+#include <chrono>
+#include <map>
+#include "benchmark.h"
+#include "parser.h"
+#include "tpch.h"
+#include "trace.h"
+
+static std::unique_ptr<PlanNode> plan_query(QueryOptimizer& optimizer, const std::string& sql) {
+    Tokenizer tokenizer(sql);
+    Parser parser(tokenizer.tokenize());
+    auto stmt = parser.parseSelectStatement();
+    return optimizer.optimize(*stmt);
+}
+
+static double run_queries(TableManager& tm, const std::vector<std::string>& queries, int repetitions) {
+    QueryOptimizer optimizer;
+    Executor executor(&tm);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repetitions; ++i) {
+        for (const auto& sql : queries) {
+            auto plan = plan_query(optimizer, sql);
+            executor.execute(*plan);
+        }
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    std::cout << "=== Trace Export ===" << std::endl;
+
+    TableManager tm;
+    DataGenerator::generate_large_dataset(tm, 20000, 100000);
+    std::vector<std::string> queries = {
+        "SELECT name, age FROM users WHERE age > 30",
+        "SELECT * FROM users JOIN orders ON users.id = orders.user_id WHERE amount > 500",
+    };
+
+    // Disabled tracing should cost next to nothing.
+    run_queries(tm, queries, 1);
+    double untraced_ms = run_queries(tm, queries, 5);
+    Tracer::start();
+    double traced_ms = run_queries(tm, queries, 5);
+    Tracer::stop();
+    std::cout << "5 x " << queries.size() << " queries: " << untraced_ms << "ms untraced, "
+              << traced_ms << "ms traced, " << Tracer::events().size() << " events" << std::endl;
+
+    // One trace covering every span kind: worker threads, parse, optimize,
+    // operators, pipeline batches and a spilling join.
+    Tracer::start();
+    Tracer::set_thread_name("main");
+    TableManager tpch;
+    TpchGenerator(0.01, TpchGenerator::DEFAULT_SEED, 4).generate(tpch);
+    run_queries(tm, queries, 1);
+
+    Executor executor(&tm);
+    executor.set_join_memory_budget(256 * 1024);
+    AdaptiveJoinNode join(JoinType::INNER, "users.id = orders.user_id");
+    join.children.push_back(std::make_unique<TableScanNode>("users"));
+    join.children.push_back(std::make_unique<TableScanNode>("orders"));
+    auto result = executor.execute(join);
+    Tracer::stop();
+
+    std::map<std::string, size_t> per_category;
+    for (const auto& event : Tracer::events()) {
+        per_category[event.category]++;
+    }
+    std::cout << "\nEvents by category:" << std::endl;
+    for (const auto& [category, count] : per_category) {
+        std::cout << "  " << category << ": " << count << std::endl;
+    }
+    for (const auto& decision : executor.get_last_join_decisions()) {
+        std::cout << "Spilling join: " << decision.to_string() << std::endl;
+    }
+
+    Tracer::write_json("trace.json");
+    std::cout << "\nWrote trace.json; open it in ui.perfetto.dev or chrome://tracing" << std::endl;
+    return 0;
+}
@@ -0,0 +1,42 @@
+#include <cmath>
+#include <iostream>
+#include "table.h"
+
+int main() {
+    std::cout << "Value Test" << std::endl;
+    std::cout << "sizeof(Value): " << sizeof(Value) << " bytes" << std::endl;
+
+    Table table("people");
+
+    Row row;
+    row.add_value(42);
+    row.add_value(3.5);
+    row.add_value(true);
+    int32_t days = 0;
+    Value::parse_date("1995-03-15", days);
+    row.add_value(Value::date(days));
+    row.add_value(table.make_string("Alice"));
+    row.add_value(Value::null());
+
+    std::cout << "\nRow values:" << std::endl;
+    for (size_t i = 0; i < row.size(); ++i) {
+        std::cout << "  [" << i << "] " << row.get(i).to_string() << std::endl;
+    }
+    std::cout << "  [99] (out of range) " << row.get(99).to_string() << std::endl;
+
+    std::cout << "\nComparisons:" << std::endl;
+    std::cout << "42 == 42.0: " << (Value(42) == Value(42.0)) << std::endl;
+    std::cout << "hash(42) == hash(42.0): " << (Value(42).hash() == Value(42.0).hash()) << std::endl;
+    std::cout << "'Alice' < 'Bob': " << (table.make_string("Alice") < table.make_string("Bob")) << std::endl;
+    std::cout << "NULL < 0: " << (Value::null() < Value(0)) << std::endl;
+    Value nan_value(std::nan(""));
+    std::cout << "NaN > 1e308: " << (nan_value > Value(1e308)) << std::endl;
+    std::cout << "NaN == NaN: " << (nan_value == Value(-std::nan(""))) << std::endl;
+    std::cout << "hash(NaN) == hash(-NaN): " << (nan_value.hash() == Value(-std::nan("")).hash()) << std::endl;
+    std::cout << "as_int(1e300): " << Value(1e300).as_int() << std::endl;
+    std::cout << "as_int(NaN): " << nan_value.as_int() << std::endl;
+    std::cout << "Date round trip: " << Value::format_date(days) << std::endl;
+    std::cout << "String heap bytes: " << table.string_bytes() << std::endl;
+
+    return 0;
+}